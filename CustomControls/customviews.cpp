@@ -168,7 +168,6 @@ void WaveView::draw(CDrawContext* pContext)
     }
 }
 
-#ifdef HAVE_FFTW
 /**
 \brief SpectrumView constructor
 
@@ -195,12 +194,10 @@ SpectrumView::SpectrumView(const VSTGUI::CRect& size, IControlListener* listener
     currentFFTMagBuffer = nullptr;
 
     // --- FFTW inits
-    data        = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * FFT_LEN);
-    fft_result  = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * FFT_LEN);
-    ifft_result = (fftw_complex*) fftw_malloc(sizeof(fftw_complex) * FFT_LEN);
+    data        = fftw_alloc_real(FFT_LEN);
+    fft_result  = fftw_alloc_complex(FFT_LEN / 2 + 1);
 
-    plan_forward  = fftw_plan_dft_1d(FFT_LEN, data, fft_result, FFTW_FORWARD, FFTW_ESTIMATE);
-    plan_backward = fftw_plan_dft_1d(FFT_LEN, fft_result, ifft_result, FFTW_BACKWARD, FFTW_ESTIMATE);
+    plan_forward  = fftw_plan_dft_r2c_1d(FFT_LEN, data, fft_result, FFTW_ESTIMATE);
 
     // --- window
     setWindow(spectrumViewWindowType::kBlackmanHarrisWindow);
@@ -209,11 +206,9 @@ SpectrumView::SpectrumView(const VSTGUI::CRect& size, IControlListener* listener
 SpectrumView::~SpectrumView()
 {
     fftw_destroy_plan( plan_forward );
-    fftw_destroy_plan( plan_backward );
 
     fftw_free( data );
     fftw_free( fft_result );
-    fftw_free( ifft_result );
 
     if(dataQueue)
         delete dataQueue;
@@ -252,8 +247,7 @@ bool SpectrumView::addFFTInputData(double inputSample)
     if(fftInputCounter >= FFT_LEN)
         return false;
 
-    data[fftInputCounter][0] = inputSample*fftWindow[fftInputCounter]; // stick your audio samples in here
-    data[fftInputCounter][1] = 0.0; // use this if your data is complex valued
+    data[fftInputCounter] = inputSample*fftWindow[fftInputCounter]; // stick your audio samples in here
 
     fftInputCounter++;
     if(fftInputCounter == FFT_LEN)
@@ -306,14 +300,15 @@ void SpectrumView::updateView()
             return;
         }
 
+        // --- the upper bins of a real signal mirror the lower ones, so they are not computed or shown
         int maxIndex = 0;
-        for(int i=0; i<FFT_LEN; i++)
+        for(int i=0; i<FFT_LEN/2 + 1; i++)
         {
             bufferToFill[i] = (getMagnitude(fft_result[i][0], fft_result[i][1]));
         }
 
         // --- normalize the FFT buffer for max = 1.0 (note this is NOT dB!!)
-        normalizeBufferGetFMax(bufferToFill, 512, &maxIndex);
+        normalizeBufferGetFMax(bufferToFill, FFT_LEN/2 + 1, &maxIndex);
 
         // 1) homework = do plot in dB
         // 2) homework = add other windows
@@ -417,8 +412,6 @@ void SpectrumView::draw(CDrawContext* pContext)
     }
 }
 
-#endif
-
 /**
 \brief CustomKnobView constructor
 
@@ -93,9 +93,12 @@ private:
 
 };
 
+// --- FFT backend: FFTW when HAVE_FFTW is defined, otherwise the built-in FFT through its FFTW shim
 #ifdef HAVE_FFTW
-// --- FFTW (REQUIRED)
 #include "fftw3.h"
+#else
+#include "../PluginObjects/builtinfftw.h"
+#endif
 
 /**
 \enum spectrumViewWindowType
@@ -172,12 +175,10 @@ protected:
     //     implementation but you may need it for homework/upgrading the object
 	spectrumViewWindowType window = spectrumViewWindowType::kRectWindow; ///< window type
 
-    // --- setup FFTW
-    fftw_complex* data = nullptr;			///< fft input data
-	fftw_complex* fft_result = nullptr;		///< fft output data
-	fftw_complex* ifft_result = nullptr;	///< ifft output (not used)
+    // --- setup FFTW; real-to-complex, so only bins 0 to FFT_LEN/2 are computed
+    double* data = nullptr;					///< fft input data
+	fftw_complex* fft_result = nullptr;		///< fft output data, FFT_LEN/2 + 1 bins
 	fftw_plan plan_forward;					///< plan for FFT
-	fftw_plan plan_backward;				///< plan for IFFT (not used)
 
     // --- for FFT data input
     int fftInputCounter = 0;				///< input counter for FFT
@@ -279,7 +280,6 @@ private:
     moodycamel::ReaderWriterQueue<double*,2>* fftMagBuffersReady = nullptr; ///< example of queuing system (yes I know it is overkill here)
     moodycamel::ReaderWriterQueue<double*,2>* fftMagBuffersEmpty = nullptr; ///< example of queuing system (yes I know it is overkill here)
 };
-#endif // defined FFTW
 
 
 // --- custom view example
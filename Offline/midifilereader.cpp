@@ -0,0 +1,335 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  midifilereader.cpp
+//
+/**
+    \file   midifilereader.cpp
+    \brief  Standard MIDI File (SMF) reader for the headless offline renderer
+*/
+// -----------------------------------------------------------------------------
+#include "midifilereader.h"
+
+#include <stdio.h>
+#include <algorithm>
+
+// --- one parsed event before the tempo map is applied
+struct MidiRawEvent
+{
+	uint64_t tick = 0;
+	uint8_t status = 0;
+	uint8_t data1 = 0;
+	uint8_t data2 = 0;
+	bool isTempo = false;
+	uint32_t microsecondsPerQuarter = 0;
+};
+
+// --- big-endian helpers
+static uint32_t readBigEndian32(const uint8_t* data)
+{
+	return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (uint32_t)data[3];
+}
+
+static uint16_t readBigEndian16(const uint8_t* data)
+{
+	return (uint16_t)(((uint32_t)data[0] << 8) | (uint32_t)data[1]);
+}
+
+// --- variable length quantity; false if it runs off the end of the track
+static bool readVariableLength(const uint8_t* data, size_t size, size_t& position, uint32_t& value)
+{
+	value = 0;
+	for (int i = 0; i < 4; i++)
+	{
+		if (position >= size)
+			return false;
+
+		uint8_t byte = data[position++];
+		value = (value << 7) | (byte & 0x7F);
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+	return false;
+}
+
+/**
+\brief read and parse a MIDI file
+
+\param filePath path to the .mid file
+\return true if the file was parsed; see getErrorString() otherwise
+*/
+bool MidiFileReader::readMidiFile(const char* filePath)
+{
+	FILE* file = fopen(filePath, "rb");
+	if (!file)
+	{
+		errorString = std::string("cannot open ") + filePath;
+		return false;
+	}
+
+	std::vector<uint8_t> data;
+	uint8_t buffer[4096];
+	size_t bytesRead = 0;
+	while ((bytesRead = fread(buffer, 1, sizeof(buffer), file)) > 0)
+		data.insert(data.end(), buffer, buffer + bytesRead);
+	fclose(file);
+
+	return parseMidiData(data.data(), data.size());
+}
+
+/**
+\brief parse a MIDI file already in memory
+
+Operation:
+- read the MThd header and every MTrk chunk; unknown chunks are skipped
+- collect channel-voice and tempo events with absolute ticks, merge the tracks, build the tempo map
+- stamp each channel-voice event in seconds
+- NOTE: a note-on with zero velocity is delivered as a note-off
+
+\param data file contents
+\param size number of bytes
+\return true if the file was parsed; see getErrorString() otherwise
+*/
+bool MidiFileReader::parseMidiData(const uint8_t* data, size_t size)
+{
+	events.clear();
+	tempoMap.clear();
+	lengthInSeconds = 0.0;
+	secondsPerTick = 0.0;
+	errorString.clear();
+
+	if (size < 14 || readBigEndian32(data) != 0x4D546864 /* MThd */)
+	{
+		errorString = "not a Standard MIDI File";
+		return false;
+	}
+
+	uint32_t headerLength = readBigEndian32(data + 4);
+	uint16_t format = readBigEndian16(data + 8);
+	uint16_t numTracks = readBigEndian16(data + 10);
+	uint16_t division = readBigEndian16(data + 12);
+
+	if (format > 1)
+	{
+		errorString = "format 2 MIDI files are not supported";
+		return false;
+	}
+
+	if (division & 0x8000)
+	{
+		// --- SMPTE: negative frames per second in the high byte, ticks per frame in the low byte
+		int framesPerSecond = -(int8_t)(division >> 8);
+		int ticksPerFrame = division & 0xFF;
+		if (framesPerSecond <= 0 || ticksPerFrame == 0)
+		{
+			errorString = "invalid SMPTE time division";
+			return false;
+		}
+
+		// --- 29 means 29.97 drop-frame
+		double fps = framesPerSecond == 29 ? 29.97 : (double)framesPerSecond;
+		secondsPerTick = 1.0 / (fps * ticksPerFrame);
+	}
+	else
+	{
+		ticksPerQuarter = division;
+		if (ticksPerQuarter == 0)
+		{
+			errorString = "invalid time division";
+			return false;
+		}
+	}
+
+	std::vector<MidiRawEvent> rawEvents;
+	size_t position = 8 + (size_t)headerLength;
+	uint16_t tracksRead = 0;
+
+	while (position + 8 <= size && tracksRead < numTracks)
+	{
+		uint32_t chunkID = readBigEndian32(data + position);
+		uint32_t chunkLength = readBigEndian32(data + position + 4);
+		position += 8;
+
+		size_t chunkEnd = position + (size_t)chunkLength;
+		if (chunkEnd > size)
+			chunkEnd = size; // --- truncated file: read what is there
+
+		// --- skip anything that is not a track
+		if (chunkID != 0x4D54726B /* MTrk */)
+		{
+			position = chunkEnd;
+			continue;
+		}
+
+		const uint8_t* track = data + position;
+		size_t trackSize = chunkEnd - position;
+		size_t trackPosition = 0;
+		uint64_t tick = 0;
+		uint8_t runningStatus = 0;
+
+		while (trackPosition < trackSize)
+		{
+			uint32_t delta = 0;
+			if (!readVariableLength(track, trackSize, trackPosition, delta))
+				break;
+			tick += delta;
+
+			if (trackPosition >= trackSize)
+				break;
+
+			uint8_t status = track[trackPosition];
+			if (status & 0x80)
+				trackPosition++;
+			else if (runningStatus)
+				status = runningStatus;
+			else
+				break; // --- data byte with no running status: corrupt track
+
+			if (status == 0xFF)
+			{
+				// --- meta event
+				if (trackPosition >= trackSize)
+					break;
+				uint8_t metaType = track[trackPosition++];
+
+				uint32_t length = 0;
+				if (!readVariableLength(track, trackSize, trackPosition, length) || trackPosition + length > trackSize)
+					break;
+
+				if (metaType == 0x51 && length == 3)
+				{
+					MidiRawEvent tempo;
+					tempo.tick = tick;
+					tempo.isTempo = true;
+					tempo.microsecondsPerQuarter = ((uint32_t)track[trackPosition] << 16) |
+												   ((uint32_t)track[trackPosition + 1] << 8) |
+												   (uint32_t)track[trackPosition + 2];
+					if (tempo.microsecondsPerQuarter > 0)
+						rawEvents.push_back(tempo);
+				}
+				trackPosition += length;
+
+				// --- end of track
+				if (metaType == 0x2F)
+					break;
+			}
+			else if (status == 0xF0 || status == 0xF7)
+			{
+				// --- system exclusive: skip
+				uint32_t length = 0;
+				if (!readVariableLength(track, trackSize, trackPosition, length) || trackPosition + length > trackSize)
+					break;
+				trackPosition += length;
+			}
+			else if (status >= 0x80 && status < 0xF0)
+			{
+				runningStatus = status;
+
+				uint8_t message = status & 0xF0;
+				uint32_t numDataBytes = (message == 0xC0 || message == 0xD0) ? 1 : 2;
+				if (trackPosition + numDataBytes > trackSize)
+					break;
+
+				MidiRawEvent event;
+				event.tick = tick;
+				event.status = status;
+				event.data1 = track[trackPosition] & 0x7F;
+				event.data2 = numDataBytes == 2 ? track[trackPosition + 1] & 0x7F : 0;
+				trackPosition += numDataBytes;
+
+				// --- note-on with zero velocity is a note-off
+				if (message == 0x90 && event.data2 == 0)
+					event.status = 0x80 | (status & 0x0F);
+
+				rawEvents.push_back(event);
+			}
+			else
+			{
+				// --- system common/realtime messages do not belong in a file; stop here
+				break;
+			}
+		}
+
+		position = chunkEnd;
+		tracksRead++;
+	}
+
+	if (tracksRead == 0)
+	{
+		errorString = "no tracks found";
+		return false;
+	}
+
+	// --- merge tracks; stable so that same-tick events keep their file order
+	std::stable_sort(rawEvents.begin(), rawEvents.end(),
+		[](const MidiRawEvent& a, const MidiRawEvent& b) { return a.tick < b.tick; });
+
+	// --- build the tempo map first; each change is timed with the map built so far
+	tempoMap.push_back(MidiTempoChange());
+	for (const MidiRawEvent& event : rawEvents)
+	{
+		if (!event.isTempo)
+			continue;
+
+		MidiTempoChange change;
+		change.tick = event.tick;
+		change.timeSeconds = tickToSeconds(event.tick);
+		change.microsecondsPerQuarter = event.microsecondsPerQuarter;
+
+		if (tempoMap.back().tick == change.tick)
+			tempoMap.back() = change;
+		else
+			tempoMap.push_back(change);
+	}
+
+	// --- now stamp the channel events
+	events.reserve(rawEvents.size());
+	for (const MidiRawEvent& event : rawEvents)
+	{
+		if (event.isTempo)
+			continue;
+
+		events.push_back(MidiFileEvent(tickToSeconds(event.tick), event.status, event.data1, event.data2));
+	}
+
+	if (!events.empty())
+		lengthInSeconds = events.back().timeSeconds;
+
+	return true;
+}
+
+/**
+\brief convert a tick to seconds with the tempo map
+
+\param tick absolute tick
+\return absolute time in seconds
+*/
+double MidiFileReader::tickToSeconds(uint64_t tick) const
+{
+	if (secondsPerTick > 0.0)
+		return (double)tick * secondsPerTick;
+
+	// --- last tempo change at or before the tick
+	size_t index = 0;
+	while (index + 1 < tempoMap.size() && tempoMap[index + 1].tick <= tick)
+		index++;
+
+	const MidiTempoChange& change = tempoMap[index];
+	return change.timeSeconds + (double)(tick - change.tick) * (double)change.microsecondsPerQuarter / (1000000.0 * (double)ticksPerQuarter);
+}
+
+/**
+\brief tempo in BPM at a given time
+
+\param timeSeconds absolute time
+\return tempo in BPM; 120 BPM if the file has no tempo events
+*/
+double MidiFileReader::getBPMAtTime(double timeSeconds) const
+{
+	if (tempoMap.empty())
+		return 120.0;
+
+	size_t index = 0;
+	while (index + 1 < tempoMap.size() && tempoMap[index + 1].timeSeconds <= timeSeconds)
+		index++;
+
+	return 60000000.0 / (double)tempoMap[index].microsecondsPerQuarter;
+}
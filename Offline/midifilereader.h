@@ -0,0 +1,104 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  midifilereader.h
+//
+/**
+    \file   midifilereader.h
+    \brief  Standard MIDI File (SMF) reader for the headless offline renderer
+*/
+// -----------------------------------------------------------------------------
+#ifndef __midiFileReader_h__
+#define __midiFileReader_h__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+\struct MidiFileEvent
+\ingroup Offline
+\brief
+One channel-voice message from a MIDI file, already converted to absolute time in seconds.
+*/
+struct MidiFileEvent
+{
+	MidiFileEvent() {}
+	MidiFileEvent(double _timeSeconds, uint8_t _status, uint8_t _data1, uint8_t _data2)
+		: timeSeconds(_timeSeconds)
+		, status(_status)
+		, data1(_data1)
+		, data2(_data2) {}
+
+	double timeSeconds = 0.0;	///< absolute time of the event
+	uint8_t status = 0;			///< status byte: message in the high nibble, channel in the low nibble
+	uint8_t data1 = 0;			///< first data byte
+	uint8_t data2 = 0;			///< second data byte (0 for two-byte messages)
+};
+
+/**
+\struct MidiTempoChange
+\ingroup Offline
+\brief
+One entry in the tempo map.
+*/
+struct MidiTempoChange
+{
+	uint64_t tick = 0;						///< absolute tick of the tempo change
+	double timeSeconds = 0.0;				///< absolute time of the tempo change
+	uint32_t microsecondsPerQuarter = 500000;	///< new tempo
+};
+
+/**
+\class MidiFileReader
+\ingroup Offline
+\brief
+Reads format 0 and format 1 Standard MIDI Files.
+
+Operation:
+- all tracks are merged; events at the same tick keep their file order (track order, then position)
+- the tempo map is applied so that every event is stamped in seconds
+- SMPTE time division is supported
+- meta events (other than tempo) and system exclusive messages are skipped
+*/
+class MidiFileReader
+{
+public:
+	MidiFileReader() {}
+
+	/** read and parse a MIDI file
+	\param filePath path to the .mid file
+	\return true if the file was parsed; see getErrorString() otherwise
+	*/
+	bool readMidiFile(const char* filePath);
+
+	/** parse a MIDI file already in memory
+	\param data file contents
+	\param size number of bytes
+	\return true if the file was parsed; see getErrorString() otherwise
+	*/
+	bool parseMidiData(const uint8_t* data, size_t size);
+
+	/** the channel-voice events, sorted by time */
+	const std::vector<MidiFileEvent>& getEvents() const { return events; }
+
+	/** time of the last event (note-off, usually) in seconds */
+	double getLengthInSeconds() const { return lengthInSeconds; }
+
+	/** tempo in BPM at a given time; 120 BPM if the file has no tempo events */
+	double getBPMAtTime(double timeSeconds) const;
+
+	/** description of the last parse failure */
+	const std::string& getErrorString() const { return errorString; }
+
+protected:
+	/** convert a tick to seconds with the tempo map */
+	double tickToSeconds(uint64_t tick) const;
+
+	std::vector<MidiFileEvent> events;			///< parsed events
+	std::vector<MidiTempoChange> tempoMap;		///< tempo changes, sorted by tick
+	uint32_t ticksPerQuarter = 480;				///< PPQ time division
+	double secondsPerTick = 0.0;				///< SMPTE time division (0 for PPQ files)
+	double lengthInSeconds = 0.0;				///< time of the last event
+	std::string errorString;					///< last parse failure
+};
+
+#endif
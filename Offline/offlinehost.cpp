@@ -0,0 +1,435 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  offlinehost.cpp
+//
+/**
+    \file   offlinehost.cpp
+    \brief  headless host that drives PluginCore from a MIDI file into a WAV file
+*/
+// -----------------------------------------------------------------------------
+#include "offlinehost.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+/**
+\brief fire every queued event at or before this sample offset
+
+\param uSampleOffset the current frame in the block
+\return true if at least one event was fired
+*/
+bool OfflineMidiEventQueue::fireMidiEvents(uint32_t uSampleOffset)
+{
+	bool fired = false;
+	while (nextEvent < blockEvents.size() && blockEvents[nextEvent].midiSampleOffset <= uSampleOffset)
+	{
+		pluginCore->processMIDIEvent(blockEvents[nextEvent]);
+		nextEvent++;
+		fired = true;
+	}
+	return fired;
+}
+
+/**
+\brief read a .spf preset or a plain parameter list
+
+Operation:
+- every line of the form controlID:value is a parameter; anything else (name, count, blank lines) is skipped
+- values are actual (not normalized) parameter values, as in the .spf files RackAFX writes
+
+\param filePath preset path
+\param parameters receives the controlID/value pairs
+\return true if the file was read
+*/
+bool OfflineHost::readPresetFile(const std::string& filePath, std::vector<std::pair<uint32_t, double>>& parameters)
+{
+	std::ifstream file(filePath.c_str());
+	if (!file.is_open())
+		return false;
+
+	std::string line;
+	while (std::getline(file, line))
+	{
+		size_t colon = line.find(':');
+		if (colon == std::string::npos || colon == 0)
+			continue;
+
+		std::istringstream idStream(line.substr(0, colon));
+		std::istringstream valueStream(line.substr(colon + 1));
+		uint32_t controlID = 0;
+		double value = 0.0;
+		if ((idStream >> controlID) && (valueStream >> value))
+			parameters.push_back(std::make_pair(controlID, value));
+	}
+	return true;
+}
+
+/**
+\brief switch on master FX slots from a comma separated list of slot names
+
+\param slotList slot names, see getMasterFXSlotName()
+\param parameters receives the slot switch parameters (controlID::enablePhaser + slot = 1)
+\return true if every name was a slot
+*/
+bool OfflineHost::enableMasterFXSlots(const std::string& slotList, std::vector<std::pair<uint32_t, double>>& parameters)
+{
+	std::istringstream listStream(slotList);
+	std::string slotName;
+	while (std::getline(listStream, slotName, ','))
+	{
+		uint32_t slot = 0;
+		while (slot < kNumMasterFXSlots && slotName != getMasterFXSlotName(slot))
+			slot++;
+
+		if (slot == kNumMasterFXSlots)
+			return false;
+		parameters.push_back(std::make_pair((uint32_t)controlID::enablePhaser + slot, 1.0));
+	}
+	return true;
+}
+
+/**
+\brief load a convolution IR from a WAV file or generate a synthetic one; synthetic IRs use a fixed-seed
+generator so the golden renders stay reproducible
+
+\param spec WAV file path, or "noise:SECONDS"
+\param sampleRate render sample rate; a WAV file must match it, there is no resampling
+\param channels receives one or two IR channels
+\return true if the IR was loaded
+*/
+bool OfflineHost::loadImpulseResponse(const std::string& spec, double sampleRate, std::vector<std::vector<float>>& channels)
+{
+	channels.clear();
+
+	const std::string noisePrefix = "noise:";
+	if (spec.compare(0, noisePrefix.size(), noisePrefix) == 0)
+	{
+		double decay_Sec = atof(spec.c_str() + noisePrefix.size());
+		if (decay_Sec <= 0.0 || decay_Sec > 30.0)
+			return false;
+
+		// --- -60dB at decay_Sec; decorrelated channels from one LCG
+		uint32_t irLength = (uint32_t)(decay_Sec*sampleRate);
+		double decayPerSample = pow(10.0, -3.0 / (decay_Sec*sampleRate));
+		uint32_t seed = 22222;
+		channels.assign(2, std::vector<float>(irLength, 0.f));
+		double envelope = 0.25;
+		for (uint32_t i = 0; i < irLength; i++)
+		{
+			for (uint32_t c = 0; c < 2; c++)
+			{
+				seed = seed * 196314165 + 907633515;
+				channels[c][i] = (float)(envelope*((double)seed / 2147483648.0 - 1.0));
+			}
+			envelope *= decayPerSample;
+		}
+		return true;
+	}
+
+	WavFileReader wavFileReader;
+	if (!wavFileReader.readWavFile(spec.c_str()) || wavFileReader.getNumFrames() == 0)
+		return false;
+	if (wavFileReader.getSampleRate() != (uint32_t)sampleRate || wavFileReader.getNumChannels() > 2)
+		return false;
+
+	channels = wavFileReader.getChannels();
+	return true;
+}
+
+/**
+\brief apply a list of actual parameter values as a preset load; unknown control IDs are ignored
+
+\param pluginCore the plugin
+\param parameters controlID/value pairs
+*/
+void OfflineHost::applyParameters(PluginCore* pluginCore, const std::vector<std::pair<uint32_t, double>>& parameters)
+{
+	// --- look IDs up in the parameter list; the controlID map would grow a null entry for unknown IDs
+	std::set<uint32_t> knownControlIDs;
+	for (size_t i = 0; i < pluginCore->getPluginParameterCount(); i++)
+	{
+		PluginParameter* piParam = pluginCore->getPluginParameterByIndex((int32_t)i);
+		if (piParam)
+			knownControlIDs.insert(piParam->getControlID());
+	}
+
+	ParameterUpdateInfo paramInfo;
+	paramInfo.loadingPreset = true;
+
+	for (const std::pair<uint32_t, double>& parameter : parameters)
+	{
+		if (knownControlIDs.count(parameter.first))
+			pluginCore->updatePluginParameter(parameter.first, parameter.second, paramInfo);
+	}
+}
+
+/**
+\brief render one MIDI file to one WAV file
+
+\param midiFilePath input .mid file
+\param wavFilePath output .wav file
+\param settings render settings
+\return true if the file was rendered; see getErrorString() otherwise
+*/
+bool OfflineHost::renderMidiFile(const std::string& midiFilePath, const std::string& wavFilePath, const OfflineRenderSettings& settings)
+{
+	// --- the file is created with the first block, so a bad MIDI file or preset leaves nothing behind
+	WavFileWriter wavFile;
+	bool wavFileOpen = false;
+
+	BlockSink writeBlock = [&](float** outputs, uint32_t numFrames)
+	{
+		if (!wavFileOpen)
+		{
+			if (!wavFile.openWavFile(wavFilePath.c_str(), (uint32_t)(settings.sampleRate + 0.5), settings.numChannels, settings.sampleFormat))
+			{
+				errorString = "cannot create " + wavFilePath;
+				return false;
+			}
+			wavFileOpen = true;
+		}
+
+		if (!wavFile.writeFrames(outputs, numFrames))
+		{
+			errorString = "write failed for " + wavFilePath;
+			return false;
+		}
+		return true;
+	};
+
+	if (!renderMidi(midiFilePath, settings, writeBlock))
+		return false;
+
+	if (!wavFile.closeWavFile())
+	{
+		errorString = "cannot finalize " + wavFilePath;
+		return false;
+	}
+	return true;
+}
+
+/**
+\brief render one MIDI file into memory
+
+\param midiFilePath input .mid file
+\param settings render settings; sampleFormat is ignored
+\param channels receives settings.numChannels channels of float output
+\return true if the file was rendered; see getErrorString() otherwise
+*/
+bool OfflineHost::renderMidiFile(const std::string& midiFilePath, const OfflineRenderSettings& settings, std::vector<std::vector<float>>& channels)
+{
+	channels.assign(settings.numChannels, std::vector<float>());
+
+	BlockSink appendBlock = [&](float** outputs, uint32_t numFrames)
+	{
+		for (uint32_t i = 0; i < channels.size(); i++)
+			channels[i].insert(channels[i].end(), outputs[i], outputs[i] + numFrames);
+		return true;
+	};
+
+	return renderMidi(midiFilePath, settings, appendBlock);
+}
+
+/**
+\brief render one MIDI file, handing each block to the sink
+
+Operation:
+- read the MIDI file, create and reset a PluginCore, apply preset then parameters
+- render blocks of settings.blockSize frames until the last MIDI event plus the tail has been rendered
+- each block gets the MIDI events that land inside it, with their sample offsets, and the current tempo
+
+\param midiFilePath input .mid file
+\param settings render settings
+\param blockSink receives every rendered block
+\return true if the file was rendered; see getErrorString() otherwise
+*/
+bool OfflineHost::renderMidi(const std::string& midiFilePath, const OfflineRenderSettings& settings, BlockSink blockSink)
+{
+	errorString.clear();
+	renderedSeconds = 0.0;
+	perfFrames.clear();
+
+	if (settings.blockSize == 0 || settings.sampleRate <= 0.0 || settings.numChannels == 0 || settings.numChannels > 2)
+	{
+		errorString = "invalid render settings";
+		return false;
+	}
+
+	MidiFileReader midiFile;
+	if (!midiFile.readMidiFile(midiFilePath.c_str()))
+	{
+		errorString = midiFilePath + ": " + midiFile.getErrorString();
+		return false;
+	}
+
+	std::vector<std::pair<uint32_t, double>> presetParameters;
+	if (!settings.presetPath.empty() && !readPresetFile(settings.presetPath, presetParameters))
+	{
+		errorString = "cannot read preset " + settings.presetPath;
+		return false;
+	}
+
+	// --- a fresh plugin for every file: no state leaks between stems
+	std::unique_ptr<PluginCore> pluginCore(new PluginCore());
+
+	PluginInfo pluginInfo;
+	pluginInfo.pathToDLL = ".";
+	pluginCore->initialize(pluginInfo);
+
+	ResetInfo resetInfo(settings.sampleRate, 32);
+	pluginCore->reset(resetInfo);
+
+	applyParameters(pluginCore.get(), presetParameters);
+	applyParameters(pluginCore.get(), settings.parameters);
+	pluginCore->setVectorJoystickParameters(settings.vectorJoystick);
+
+	if (!settings.impulseResponse.empty())
+	{
+		std::vector<std::vector<float>> irChannels;
+		if (!loadImpulseResponse(settings.impulseResponse, settings.sampleRate, irChannels))
+		{
+			errorString = "cannot load impulse response " + settings.impulseResponse + " (a WAV file at the render sample rate, or noise:SECONDS)";
+			return false;
+		}
+
+		const float* irPointers[2] = { irChannels[0].data(), irChannels.back().data() };
+		pluginCore->synthEngine.setMasterFXImpulseResponse(irPointers, (uint32_t)irChannels.size(), (uint32_t)irChannels[0].size());
+	}
+
+	SynthPerfMonitor& perfMonitor = pluginCore->synthEngine.getPerfMonitor();
+	perfMonitor.setDetail(settings.perfDetailLevel);
+	pluginCore->synthEngine.getTraceLog().setLevel(settings.traceLogLevel);
+
+	// --- output buffers, non-interleaved
+	std::vector<std::vector<float>> outputBuffers(settings.numChannels, std::vector<float>(settings.blockSize, 0.f));
+	float* outputs[2] = { nullptr, nullptr };
+	for (uint32_t i = 0; i < settings.numChannels; i++)
+		outputs[i] = outputBuffers[i].data();
+
+	HostInfo hostInfo;
+	hostInfo.fTimeSigNumerator = 4.f;
+	hostInfo.uTimeSigDenomintor = 4;
+
+	OfflineMidiEventQueue midiEventQueue(pluginCore.get());
+
+	ProcessBufferInfo processBufferInfo;
+	processBufferInfo.outputs = outputs;
+	processBufferInfo.numAudioOutChannels = settings.numChannels;
+	processBufferInfo.channelIOConfig = ChannelIOConfig(kCFNone, settings.numChannels == 1 ? kCFMono : kCFStereo);
+	processBufferInfo.hostInfo = &hostInfo;
+	processBufferInfo.midiEventQueue = &midiEventQueue;
+
+	const std::vector<MidiFileEvent>& events = midiFile.getEvents();
+	size_t eventIndex = 0;
+
+	uint64_t totalFrames = (uint64_t)ceil((midiFile.getLengthInSeconds() + settings.tailSeconds) * settings.sampleRate);
+	uint64_t blockStart = 0;
+
+	while (blockStart < totalFrames)
+	{
+		uint32_t numFrames = (uint32_t)(totalFrames - blockStart < settings.blockSize ? totalFrames - blockStart : settings.blockSize);
+		uint64_t blockEnd = blockStart + numFrames;
+
+		// --- queue the events that land in this block
+		midiEventQueue.clearEvents();
+		while (eventIndex < events.size())
+		{
+			const MidiFileEvent& event = events[eventIndex];
+			uint64_t eventFrame = (uint64_t)llround(event.timeSeconds * settings.sampleRate);
+			if (eventFrame >= blockEnd)
+				break;
+
+			uint32_t offset = eventFrame > blockStart ? (uint32_t)(eventFrame - blockStart) : 0;
+			midiEventQueue.addEvent(midiEvent(event.status & 0xF0, event.status & 0x0F, event.data1, event.data2, offset));
+			eventIndex++;
+		}
+
+		hostInfo.dBPM = midiFile.getBPMAtTime((double)blockStart / settings.sampleRate);
+		processBufferInfo.numFramesToProcess = numFrames;
+
+		if (!pluginCore->processAudioBuffers(processBufferInfo))
+		{
+			errorString = "plugin failed to process " + midiFilePath;
+			return false;
+		}
+
+		// --- we are the GUI thread here: drain the queue every block so no frame is dropped
+		SynthPerfFrame perfFrame;
+		while (perfMonitor.readFrame(perfFrame))
+			perfFrames.push_back(perfFrame);
+
+		if (!blockSink(outputs, numFrames))
+			return false;
+
+		blockStart = blockEnd;
+	}
+
+	renderedSeconds = (double)totalFrames / settings.sampleRate;
+	return true;
+}
+
+/**
+\brief dump instrumentation frames as CSV or JSON
+
+Operation:
+- ticks are readPerfTicks() units; load and time_us are derived from the wall clock, so no calibration is needed
+- CSV has one row per block with a column per voice slot and per component; JSON has one object per block
+
+\param filePath output path
+\param frames the frames, usually getPerfFrames()
+\param asJSON true for JSON, false for CSV
+\return true if the file was written
+*/
+bool OfflineHost::writePerfLog(const std::string& filePath, const std::vector<SynthPerfFrame>& frames, bool asJSON)
+{
+	std::ofstream file(filePath.c_str());
+	if (!file.is_open())
+		return false;
+
+	if (!asJSON)
+	{
+		file << "block,frames,sample_rate,time_us,load,deadline_miss,block_ticks,active_voices,peak_voices,steals,steals_total,misses_total,dropped_total";
+		for (uint32_t i = 0; i < MAX_VOICES; i++)
+			file << ",voice" << i << "_ticks";
+		for (uint32_t i = 0; i < kNumPerfComponents; i++)
+			file << "," << getPerfComponentName(i) << "_ticks";
+		file << "\n";
+
+		for (const SynthPerfFrame& frame : frames)
+		{
+			file << frame.blockIndex << "," << frame.numFrames << "," << frame.sampleRate << "," << frame.blockTime_nSec / 1000.0 << ","
+				<< frame.getLoad() << "," << (frame.deadlineMiss ? 1 : 0) << "," << frame.blockTicks << "," << frame.activeVoices << ","
+				<< frame.peakActiveVoices << "," << frame.voiceSteals << "," << frame.voiceStealsTotal << "," << frame.deadlineMissesTotal << ","
+				<< frame.droppedFramesTotal;
+			for (uint32_t i = 0; i < MAX_VOICES; i++)
+				file << "," << frame.voiceTicks[i];
+			for (uint32_t i = 0; i < kNumPerfComponents; i++)
+				file << "," << frame.componentTicks[i];
+			file << "\n";
+		}
+		return file.good();
+	}
+
+	file << "[\n";
+	for (size_t f = 0; f < frames.size(); f++)
+	{
+		const SynthPerfFrame& frame = frames[f];
+		file << "  {\"block\": " << frame.blockIndex << ", \"frames\": " << frame.numFrames << ", \"sampleRate\": " << frame.sampleRate
+			<< ", \"time_us\": " << frame.blockTime_nSec / 1000.0 << ", \"load\": " << frame.getLoad()
+			<< ", \"deadlineMiss\": " << (frame.deadlineMiss ? "true" : "false") << ", \"blockTicks\": " << frame.blockTicks
+			<< ", \"activeVoices\": " << frame.activeVoices << ", \"peakActiveVoices\": " << frame.peakActiveVoices
+			<< ", \"steals\": " << frame.voiceSteals << ", \"stealsTotal\": " << frame.voiceStealsTotal
+			<< ", \"missesTotal\": " << frame.deadlineMissesTotal << ", \"droppedTotal\": " << frame.droppedFramesTotal << ", \"voiceTicks\": [";
+		for (uint32_t i = 0; i < MAX_VOICES; i++)
+			file << (i > 0 ? ", " : "") << frame.voiceTicks[i];
+		file << "], \"componentTicks\": {";
+		for (uint32_t i = 0; i < kNumPerfComponents; i++)
+			file << (i > 0 ? ", " : "") << "\"" << getPerfComponentName(i) << "\": " << frame.componentTicks[i];
+		file << "}}" << (f + 1 < frames.size() ? "," : "") << "\n";
+	}
+	file << "]\n";
+
+	return file.good();
+}
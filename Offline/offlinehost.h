@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  offlinehost.h
+//
+/**
+    \file   offlinehost.h
+    \brief  headless host that drives PluginCore from a MIDI file into a WAV file
+*/
+// -----------------------------------------------------------------------------
+#ifndef __offlineHost_h__
+#define __offlineHost_h__
+
+#include "plugincore.h"
+#include "midifilereader.h"
+#include "wavfilewriter.h"
+#include "wavfilereader.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+\struct OfflineRenderSettings
+\ingroup Offline
+\brief
+Everything needed to render one MIDI file; shared by all jobs in a batch.
+*/
+struct OfflineRenderSettings
+{
+	double sampleRate = 48000.0;					///< render sample rate
+	uint32_t blockSize = 512;						///< frames per processAudioBuffers() call
+	uint32_t numChannels = 2;						///< 1 = mono, 2 = stereo
+	wavSampleFormat sampleFormat = wavSampleFormat::kPCM24;	///< output sample format
+	double tailSeconds = 2.0;						///< render time after the last MIDI event
+	std::string presetPath;							///< optional .spf preset or parameter list
+	std::vector<std::pair<uint32_t, double>> parameters;	///< controlID, actual value; applied after the preset
+
+	// --- the voices blend their oscillators with the vector joystick, which a DAW session gets from the GUI;
+	//     default to the center position (equal mix) so a headless render is not silent
+	VectorJoystickData vectorJoystick = VectorJoystickData(0.25, 0.25, 0.25, 0.25, 0.5, 0.5);	///< oscillator blend
+
+	// --- engine instrumentation; the frames are collected after every block, see OfflineHost::getPerfFrames()
+	perfDetail perfDetailLevel = perfDetail::kOff;	///< what to time; kOff = no instrumentation
+
+	// --- engine MIDI/voice allocation log, printed to stderr by the logger's writer thread
+	traceLevel traceLogLevel = traceLevel::kOff;	///< what to log; kOff = nothing
+
+	// --- master FX rack: the slot switches are plugin parameters (see enableMasterFXSlots()); the IR is loaded directly
+	std::string impulseResponse;					///< convolution slot IR, see OfflineHost::loadImpulseResponse(); empty = none
+};
+
+/**
+\class OfflineMidiEventQueue
+\ingroup Offline
+\brief
+IMidiEventQueue for the offline host: holds the events that land in the current block and fires them
+at their sample offsets.
+*/
+class OfflineMidiEventQueue : public IMidiEventQueue
+{
+public:
+	OfflineMidiEventQueue(PluginCore* _pluginCore) : pluginCore(_pluginCore) {}
+	virtual ~OfflineMidiEventQueue() {}
+
+	/** drop the previous block's events (no allocation once the vector has grown) */
+	void clearEvents() { blockEvents.clear(); nextEvent = 0; }
+
+	/** add an event for the current block; offsets must not decrease */
+	void addEvent(const midiEvent& event) { blockEvents.push_back(event); }
+
+	/** IMidiEventQueue: number of events in the current block */
+	virtual uint32_t getEventCount() { return (uint32_t)blockEvents.size(); }
+
+	/** IMidiEventQueue: fire every event at or before this offset */
+	virtual bool fireMidiEvents(uint32_t uSampleOffset);
+
+protected:
+	PluginCore* pluginCore = nullptr;		///< the plugin
+	std::vector<midiEvent> blockEvents;		///< events for this block
+	size_t nextEvent = 0;					///< next event to fire
+};
+
+/**
+\class OfflineHost
+\ingroup Offline
+\brief
+Instantiates a PluginCore and renders MIDI files through it faster than real time.
+
+Operation:
+- one OfflineHost per thread; each render creates a fresh PluginCore so jobs never share state
+- the preset and parameter list are applied before the first buffer, exactly as a host loading a preset would
+- MIDI events are delivered through the MIDI event queue at their sample offsets within each block
+- the host tempo follows the MIDI file's tempo map
+*/
+class OfflineHost
+{
+public:
+	OfflineHost() {}
+
+	/** render one MIDI file to one WAV file
+	\param midiFilePath input .mid file
+	\param wavFilePath output .wav file
+	\param settings render settings
+	\return true if the file was rendered; see getErrorString() otherwise
+	*/
+	bool renderMidiFile(const std::string& midiFilePath, const std::string& wavFilePath, const OfflineRenderSettings& settings);
+
+	/** render one MIDI file into memory, for comparisons
+	\param midiFilePath input .mid file
+	\param settings render settings; sampleFormat is ignored
+	\param channels receives settings.numChannels channels of float output
+	\return true if the file was rendered; see getErrorString() otherwise
+	*/
+	bool renderMidiFile(const std::string& midiFilePath, const OfflineRenderSettings& settings, std::vector<std::vector<float>>& channels);
+
+	/** read a .spf preset (name, count, then controlID:value lines) or a plain list of controlID:value lines
+	\param filePath preset path
+	\param parameters receives the controlID/value pairs
+	\return true if the file was read
+	*/
+	static bool readPresetFile(const std::string& filePath, std::vector<std::pair<uint32_t, double>>& parameters);
+
+	/** switch on master FX slots by name (see getMasterFXSlotName()), e.g. "chorus,reverb"; the slot parameters keep their defaults
+	\param slotList comma separated slot names
+	\param parameters receives the slot switch parameters, applied like any other controlID/value pair
+	\return true if every name was a slot
+	*/
+	static bool enableMasterFXSlots(const std::string& slotList, std::vector<std::pair<uint32_t, double>>& parameters);
+
+	/** load an impulse response for the convolution slot: a .wav file at the render sample rate, or
+	"noise:SECONDS", a deterministic stereo noise burst decaying by 60dB over SECONDS
+	\param spec file path or noise spec
+	\param sampleRate render sample rate
+	\param channels receives one or two IR channels
+	\return true if the IR was loaded
+	*/
+	static bool loadImpulseResponse(const std::string& spec, double sampleRate, std::vector<std::vector<float>>& channels);
+
+	/** description of the last failure */
+	const std::string& getErrorString() const { return errorString; }
+
+	/** seconds of audio rendered by the last call */
+	double getRenderedSeconds() const { return renderedSeconds; }
+
+	/** engine instrumentation from the last call, one frame per block; empty unless settings.perfDetailLevel was set */
+	const std::vector<SynthPerfFrame>& getPerfFrames() const { return perfFrames; }
+
+	/** dump instrumentation frames as CSV (one row per block) or JSON (an array of block objects)
+	\param filePath output path
+	\param frames the frames, usually getPerfFrames()
+	\param asJSON true for JSON, false for CSV
+	\return true if the file was written
+	*/
+	static bool writePerfLog(const std::string& filePath, const std::vector<SynthPerfFrame>& frames, bool asJSON);
+
+protected:
+	/** receives each rendered block: non-interleaved channel pointers and the frame count; returns false to abort */
+	typedef std::function<bool(float** outputs, uint32_t numFrames)> BlockSink;
+
+	/** render one MIDI file, handing each block to the sink */
+	bool renderMidi(const std::string& midiFilePath, const OfflineRenderSettings& settings, BlockSink blockSink);
+
+	/** apply a list of actual parameter values; unknown control IDs are ignored */
+	void applyParameters(PluginCore* pluginCore, const std::vector<std::pair<uint32_t, double>>& parameters);
+
+	std::string errorString;			///< last failure
+	double renderedSeconds = 0.0;		///< length of the last render
+	std::vector<SynthPerfFrame> perfFrames;	///< instrumentation from the last render
+};
+
+#endif
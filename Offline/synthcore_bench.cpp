@@ -0,0 +1,1243 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  synthcore_bench.cpp
+//
+/**
+    \file   synthcore_bench.cpp
+    \brief  microbenchmarks for the synth components, the voice, the engine and the FX objects
+
+    usage: synthcore_bench [options] [filter ...]
+    every benchmark renders a fixed amount of audio per trial at 44.1 and 96 kHz and reports the
+    median cost in ns/sample, the load on one core and, for voice benchmarks, voices per core
+*/
+// -----------------------------------------------------------------------------
+#include "synthcore.h"
+#include "fxobjects.h"
+#include "convolver.h"
+#include "fdnreverb.h"
+#include "oversampler.h"
+#include "biquadcascade.h"
+#include "lookaheaddynamics.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+// --- every render function adds its output here so the optimizer cannot drop the work
+static volatile double benchmarkSink = 0.0;
+
+// --- render numSamples samples; created per sample rate by the benchmark's factory
+typedef std::function<void(uint32_t numSamples)> BenchmarkRender;
+
+/**
+\struct Benchmark
+\ingroup Offline
+\brief
+One named benchmark: a factory that builds and resets the object under test for a sample rate and returns
+its render function. numVoices > 0 marks a voice benchmark, which also reports voices per core.
+*/
+struct Benchmark
+{
+	std::string name;
+	uint32_t numVoices = 0;
+	std::function<BenchmarkRender(double sampleRate)> factory;
+};
+
+/**
+\struct BenchmarkSettings
+\ingroup Offline
+\brief
+Command line settings for a benchmark run.
+*/
+struct BenchmarkSettings
+{
+	uint32_t numTrials = 7;				///< timed trials per benchmark; the median is reported
+	double trialSeconds = 0.5;			///< seconds of audio rendered per trial
+	uint32_t blockSize = 64;			///< samples per render call
+	bool csvOutput = false;				///< CSV instead of a table
+	std::vector<std::string> filters;	///< run only benchmarks whose name contains one of these
+};
+
+// --- the sample rates every benchmark is measured at
+const double kBenchmarkSampleRates[] = { 44100.0, 96000.0 };
+
+// --- the MIDI globals the engine sets up in its constructor; standalone components need the same
+//     (centered pitch bend and master tuning, full volume) or they render out of tune or silent
+static std::shared_ptr<MidiInputData> makeMidiInputData()
+{
+	std::shared_ptr<MidiInputData> midiInputData = std::make_shared<MidiInputData>();
+	midiInputData->globalMIDIData[kCurrentMIDINoteNumber] = 128;
+	midiInputData->globalMIDIData[kLastMIDINoteNumber] = 128;
+	midiInputData->globalMIDIData[kMIDIPitchBendDataLSB] = 0;
+	midiInputData->globalMIDIData[kMIDIPitchBendDataMSB] = 64;
+	midiInputData->globalMIDIData[kMIDIMasterPBSensCoarse] = 1;
+	midiInputData->globalMIDIData[kMIDIMasterTuneCoarseMSB] = 65;
+	midiInputData->globalMIDIData[kMIDIMasterTuneFineMSB] = 65;
+	midiInputData->globalMIDIData[kMIDIMasterVolumeMSB] = 65;
+	midiInputData->ccMIDIData[VOLUME_CC07] = 127;
+	midiInputData->ccMIDIData[PAN_CC10] = 64;
+	return midiInputData;
+}
+
+// --- the wavetables are large and slow to build; share one set across all benchmarks
+static std::shared_ptr<WaveTableData> getWaveTableData()
+{
+	static std::shared_ptr<WaveTableData> waveTableData = std::make_shared<WaveTableData>();
+	return waveTableData;
+}
+
+/**
+\class BenchmarkVoice
+\ingroup Offline
+\brief
+SynthVoice with the modulation matrix exposed so it can be timed on its own.
+*/
+class BenchmarkVoice : public SynthVoice
+{
+public:
+	BenchmarkVoice(const std::shared_ptr<MidiInputData> _midiInputData,
+				   const std::shared_ptr<MidiOutputData> _midiOutputData,
+				   std::shared_ptr<SynthVoiceParameters> _parameters,
+				   std::shared_ptr<WaveTableData> _waveTableData)
+		: SynthVoice(_midiInputData, _midiOutputData, _parameters, _waveTableData) {}
+
+	void renderModulationMatrix() { runModulationMatrix(true); }
+};
+
+/**
+\struct VoiceBank
+\ingroup Offline
+\brief
+numVoices SynthVoices sharing parameters and mod matrix, wired and routed the way SynthEngine wires them,
+each holding a different note. Unlike the engine this is not limited to MAX_VOICES.
+*/
+struct VoiceBank
+{
+	VoiceBank(uint32_t numVoices, double sampleRate)
+	{
+		// --- same hardwired routings as SynthEngine::SynthEngine()
+		engineParameters.setMM_HardwiredRouting(kJoystickAC, kFilter1_fc);
+		engineParameters.setMM_HardwiredRouting(kEG1_Normal, kDCA_EGMod);
+		engineParameters.setMM_DestDefaultValue(kDCA_AmpMod, 1.0);
+
+		// --- center joystick: all four oscillators sound
+		engineParameters.voiceParameters->vectorJSData = VectorJoystickData(0.25, 0.25, 0.25, 0.25, 0.5, 0.5);
+
+		PluginInfo pluginInfo;
+		pluginInfo.pathToDLL = ".";
+		getWaveTableData()->resetWaveBanks(sampleRate);
+
+		for (uint32_t i = 0; i < numVoices; i++)
+		{
+			voices.push_back(std::unique_ptr<BenchmarkVoice>(new BenchmarkVoice(midiInputData, midiOutputData, engineParameters.voiceParameters, getWaveTableData())));
+			voices[i]->setModMatrixPtrs(engineParameters.modSourceData, engineParameters.modDestinationData);
+			voices[i]->initialize(pluginInfo);
+			voices[i]->reset(sampleRate);
+
+			midiEvent noteOn(NOTE_ON, 0, 36 + (i % 60), 100, 0);
+			voices[i]->processMIDIEvent(noteOn);
+		}
+	}
+
+	std::shared_ptr<MidiInputData> midiInputData = makeMidiInputData();
+	std::shared_ptr<MidiOutputData> midiOutputData = std::make_shared<MidiOutputData>();
+	SynthEngineParameters engineParameters;
+	std::vector<std::unique_ptr<BenchmarkVoice>> voices;
+};
+
+// --- per-sample drive for an IAudioSignalProcessor: a low-level sine so dynamics and saturators do real work
+static BenchmarkRender makeProcessorRender(std::shared_ptr<IAudioSignalProcessor> processor, double sampleRate)
+{
+	double phaseInc = 220.0 / sampleRate;
+	std::shared_ptr<double> phase = std::make_shared<double>(0.0);
+
+	return [processor, phaseInc, phase](uint32_t numSamples)
+	{
+		double sum = 0.0;
+		for (uint32_t i = 0; i < numSamples; i++)
+		{
+			double xn = 0.5 * sin(kTwoPi * (*phase));
+			*phase += phaseInc;
+			if (*phase >= 1.0) *phase -= 1.0;
+			sum += processor->processAudioSample(xn);
+		}
+		benchmarkSink = benchmarkSink + sum;
+	};
+}
+
+// --- stereo frame drive for processors that render stereo (delay, reverb)
+static BenchmarkRender makeFrameRender(std::shared_ptr<IAudioSignalProcessor> processor, double sampleRate)
+{
+	double phaseInc = 220.0 / sampleRate;
+	std::shared_ptr<double> phase = std::make_shared<double>(0.0);
+
+	return [processor, phaseInc, phase](uint32_t numSamples)
+	{
+		float inputFrame[2] = { 0.f, 0.f };
+		float outputFrame[2] = { 0.f, 0.f };
+		double sum = 0.0;
+		for (uint32_t i = 0; i < numSamples; i++)
+		{
+			inputFrame[0] = inputFrame[1] = (float)(0.5 * sin(kTwoPi * (*phase)));
+			*phase += phaseInc;
+			if (*phase >= 1.0) *phase -= 1.0;
+			processor->processAudioFrame(inputFrame, outputFrame, 2, 2);
+			sum += outputFrame[0] + outputFrame[1];
+		}
+		benchmarkSink = benchmarkSink + sum;
+	};
+}
+
+// --- stereo block drive in 64-frame blocks, for processors with a processAudioBlock() path
+static BenchmarkRender makeBlockRender(std::shared_ptr<IAudioSignalProcessor> processor, double sampleRate)
+{
+	double phaseInc = 220.0 / sampleRate;
+	std::shared_ptr<double> phase = std::make_shared<double>(0.0);
+	std::shared_ptr<std::vector<float>> buffers = std::make_shared<std::vector<float>>(4 * 64);
+
+	return [processor, phaseInc, phase, buffers](uint32_t numSamples)
+	{
+		const float* inputs[2] = { buffers->data(), buffers->data() + 64 };
+		float* outputs[2] = { buffers->data() + 128, buffers->data() + 192 };
+		double sum = 0.0;
+		uint32_t remaining = numSamples;
+		while (remaining > 0)
+		{
+			uint32_t numFrames = remaining < 64 ? remaining : 64;
+			for (uint32_t i = 0; i < numFrames; i++)
+			{
+				(*buffers)[i] = (*buffers)[64 + i] = (float)(0.5 * sin(kTwoPi * (*phase)));
+				*phase += phaseInc;
+				if (*phase >= 1.0) *phase -= 1.0;
+			}
+			processor->processAudioBlock(inputs, outputs, 2, 2, numFrames);
+			sum += outputs[0][0] + outputs[1][0];
+			remaining -= numFrames;
+		}
+		benchmarkSink = benchmarkSink + sum;
+	};
+}
+
+// --- FP_NORMAL if any value is normal, otherwise FP_SUBNORMAL if any is subnormal, otherwise FP_ZERO
+template <typename T>
+static int classifyState(const T* values, size_t count)
+{
+	bool subnormal = false;
+	for (size_t i = 0; i < count; i++)
+	{
+		int type = std::fpclassify(values[i]);
+		if (type == FP_NORMAL)
+			return FP_NORMAL;
+		if (type == FP_SUBNORMAL)
+			subnormal = true;
+	}
+	return subnormal ? FP_SUBNORMAL : FP_ZERO;
+}
+
+/**
+\class DenormalProbeZVAFilter
+\ingroup Offline
+rief
+ZVAFilter with its integrator state exposed, so the denormal benchmark can check where its tail is.
+*/
+class DenormalProbeZVAFilter : public ZVAFilter
+{
+public:
+	int classifyTail() { return classifyState(integrator_z, 2); }
+};
+
+/**
+\class DenormalProbeReverbTank
+\ingroup Offline
+rief
+FDNReverbTank (the master FX rack's reverb) with its delay lines exposed, so the denormal benchmark can check
+where its tail is. ReverbTank itself never gets there: its nested APFs flush anything below FLT_MIN to zero.
+*/
+class DenormalProbeReverbTank : public FDNReverbTank
+{
+public:
+	int classifyTail() { return classifyState(lineBuffer.data(), lineBuffer.size()); }
+};
+
+// --- a released note's tail: excite the processor with an impulse and render silence until its state has decayed
+//     into the subnormal range, where the filters and the reverb settle into a subnormal limit cycle instead of
+//     reaching zero; exits if the state is not subnormal, so the FTZ/DAZ off and on rows time what they claim to.
+//     The render feeds silence with and without the DenormalGuard that PluginBase::processAudioBuffers() installs
+static BenchmarkRender makeDenormalTailRender(const std::string& name, std::shared_ptr<IAudioSignalProcessor> processor,
+											  std::function<int()> classifyTail, double sampleRate, bool flushDenormals)
+{
+	const uint64_t maxSamples = (uint64_t)(600.0 * sampleRate);
+	uint64_t rendered = 0;
+
+	processor->processAudioSample(1.0);
+	while (classifyTail() == FP_NORMAL && rendered < maxSamples)
+	{
+		processor->processAudioSample(0.0);
+		rendered++;
+	}
+
+	// --- one more second, to be past the first subnormal samples of the decay
+	for (uint32_t i = 0; i < (uint32_t)sampleRate; i++)
+		processor->processAudioSample(0.0);
+
+	if (classifyTail() != FP_SUBNORMAL)
+	{
+		fprintf(stderr, "%s: the tail state is not subnormal after %.0f seconds; the benchmark would not measure denormals\n",
+				name.c_str(), (rendered + sampleRate) / sampleRate);
+		exit(EXIT_FAILURE);
+	}
+
+	return [processor, flushDenormals](uint32_t numSamples)
+	{
+		double sum = 0.0;
+		if (flushDenormals)
+		{
+			DenormalGuard denormalGuard;
+			for (uint32_t i = 0; i < numSamples; i++)
+				sum += processor->processAudioSample(0.0);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < numSamples; i++)
+				sum += processor->processAudioSample(0.0);
+		}
+		benchmarkSink = benchmarkSink + sum;
+	};
+}
+
+// --- reset a processor that runs on its default parameters
+static std::shared_ptr<IAudioSignalProcessor> resetProcessor(std::shared_ptr<IAudioSignalProcessor> processor, double sampleRate)
+{
+	processor->reset(sampleRate);
+	return processor;
+}
+
+// --- host a processor in an OversampledProcessor, then reset both
+static std::shared_ptr<IAudioSignalProcessor> oversampleProcessor(std::shared_ptr<IAudioSignalProcessor> processor, oversamplingRatio ratio, oversamplingFilter filter, double sampleRate)
+{
+	std::shared_ptr<OversampledProcessor> oversampled = std::make_shared<OversampledProcessor>(processor);
+	OversamplerParameters params = oversampled->getParameters();
+	params.ratio = ratio;
+	params.filter = filter;
+	oversampled->setParameters(params);
+	oversampled->reset(sampleRate);
+	return oversampled;
+}
+
+// --- build the full benchmark list
+static std::vector<Benchmark> makeBenchmarks()
+{
+	std::vector<Benchmark> benchmarks;
+
+	// --- WaveTableOsc::renderAudioOutput() for every populated waveform of every bank
+	std::shared_ptr<WaveTableData> waveTableData = getWaveTableData();
+	for (uint32_t bank = 0; bank < waveTableData->getNumWaveBanks(); bank++)
+	{
+		IWaveBank* waveBank = waveTableData->getInterface(bank);
+		std::vector<std::string> waveformNames = waveBank->getWaveformNames();
+		for (uint32_t waveform = 0; waveform < waveformNames.size(); waveform++)
+		{
+			if (waveformNames[waveform] == "-- empty --" || waveformNames[waveform].empty())
+				continue;
+
+			Benchmark benchmark;
+			benchmark.name = "osc/bank" + std::to_string(bank) + "/" + waveformNames[waveform];
+			benchmark.factory = [bank, waveform](double sampleRate) -> BenchmarkRender
+			{
+				std::shared_ptr<SynthOscParameters> parameters = std::make_shared<SynthOscParameters>();
+				parameters->oscillatorBankIndex = bank;
+				parameters->oscillatorWaveformIndex = waveform;
+
+				getWaveTableData()->resetWaveBanks(sampleRate);
+				std::shared_ptr<WaveTableOsc> osc = std::make_shared<WaveTableOsc>(makeMidiInputData(), parameters, getWaveTableData());
+				osc->reset(sampleRate);
+				osc->doNoteOn(midiNoteNumberToOscFrequency(60), 60, 100);
+
+				return [osc](uint32_t numSamples)
+				{
+					double sum = 0.0;
+					for (uint32_t i = 0; i < numSamples; i++)
+					{
+						osc->update(true);
+						sum += osc->renderAudioOutput().outputs[0];
+					}
+					benchmarkSink = benchmarkSink + sum;
+				};
+			};
+			benchmarks.push_back(benchmark);
+		}
+	}
+
+	// --- MoogFilter::processSynthAudio() per algorithm, with and without the nonlinear stage
+	const char* moogNames[] = { "lpf2", "hpf2", "lpf4", "hpf4" };
+	for (uint32_t algorithm = 0; algorithm < 4; algorithm++)
+	{
+		for (uint32_t nlp = 0; nlp < 2; nlp++)
+		{
+			Benchmark benchmark;
+			benchmark.name = std::string("moog/") + moogNames[algorithm] + (nlp ? "/nlp" : "");
+			benchmark.factory = [algorithm, nlp](double sampleRate) -> BenchmarkRender
+			{
+				std::shared_ptr<MoogFilterParameters> parameters = std::make_shared<MoogFilterParameters>();
+				parameters->filterAlgorithm = (moogFilterAlgorithm)algorithm;
+				parameters->fc = 2000.0;
+				parameters->Q = 5.0;
+				parameters->enableNLP = nlp != 0;
+
+				std::shared_ptr<MoogFilter> filter = std::make_shared<MoogFilter>(makeMidiInputData(), parameters);
+				filter->reset(sampleRate);
+				double phaseInc = 110.0 / sampleRate;
+				std::shared_ptr<double> phase = std::make_shared<double>(0.0);
+
+				return [filter, phaseInc, phase](uint32_t numSamples)
+				{
+					SynthProcessorData audioData;
+					audioData.numInputChannels = 1;
+					audioData.numOutputChannels = 1;
+					double sum = 0.0;
+					for (uint32_t i = 0; i < numSamples; i++)
+					{
+						audioData.inputs[0] = 2.0 * (*phase) - 1.0;
+						*phase += phaseInc;
+						if (*phase >= 1.0) *phase -= 1.0;
+
+						filter->update(true);
+						filter->processSynthAudio(&audioData);
+						sum += audioData.outputs[0];
+					}
+					benchmarkSink = benchmarkSink + sum;
+				};
+			};
+			benchmarks.push_back(benchmark);
+		}
+	}
+
+	// --- EnvelopeGenerator: retriggered so every state (attack, decay, sustain, release) is covered
+	{
+		Benchmark benchmark;
+		benchmark.name = "eg/adsr";
+		benchmark.factory = [](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<EGParameters> parameters = std::make_shared<EGParameters>();
+			parameters->attackTime_mSec = 10.0;
+			parameters->decayTime_mSec = 100.0;
+			parameters->sustainLevel = 0.7;
+			parameters->releaseTime_mSec = 200.0;
+
+			std::shared_ptr<EnvelopeGenerator> eg = std::make_shared<EnvelopeGenerator>(makeMidiInputData(), parameters);
+			eg->reset(sampleRate);
+			uint32_t cycleLength = (uint32_t)(0.5 * sampleRate);
+			std::shared_ptr<uint32_t> counter = std::make_shared<uint32_t>(0);
+
+			return [eg, cycleLength, counter](uint32_t numSamples)
+			{
+				double sum = 0.0;
+				for (uint32_t i = 0; i < numSamples; i++)
+				{
+					if (*counter == 0)
+						eg->doNoteOn(midiNoteNumberToOscFrequency(60), 60, 100);
+					else if (*counter == cycleLength / 2)
+						eg->doNoteOff(midiNoteNumberToOscFrequency(60), 60, 0);
+					if (++(*counter) == cycleLength)
+						*counter = 0;
+
+					eg->update(true);
+					sum += eg->renderModulatorOutput().modulationOutputs[kEGNormalOutput];
+				}
+				benchmarkSink = benchmarkSink + sum;
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	// --- SynthLFO::renderModulatorOutput() per waveform
+	const char* lfoNames[] = { "triangle", "sin", "saw", "rsh", "qrsh", "noise", "qrnoise" };
+	for (uint32_t waveform = 0; waveform < 7; waveform++)
+	{
+		Benchmark benchmark;
+		benchmark.name = std::string("lfo/") + lfoNames[waveform];
+		benchmark.factory = [waveform](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<SynthLFOParameters> parameters = std::make_shared<SynthLFOParameters>();
+			parameters->waveform = (LFOWaveform)waveform;
+			parameters->frequency_Hz = 5.0;
+
+			std::shared_ptr<SynthLFO> lfo = std::make_shared<SynthLFO>(makeMidiInputData(), parameters);
+			lfo->reset(sampleRate);
+			lfo->doNoteOn(midiNoteNumberToOscFrequency(60), 60, 100);
+
+			return [lfo](uint32_t numSamples)
+			{
+				double sum = 0.0;
+				for (uint32_t i = 0; i < numSamples; i++)
+				{
+					lfo->update(true);
+					sum += lfo->renderModulatorOutput().modulationOutputs[kLFONormalOutput];
+				}
+				benchmarkSink = benchmarkSink + sum;
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	// --- DCA: update + mono-to-stereo pan/gain, as the voice runs it
+	{
+		Benchmark benchmark;
+		benchmark.name = "dca/mono-to-stereo";
+		benchmark.factory = [](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<DCA> dca = std::make_shared<DCA>(makeMidiInputData(), std::make_shared<DCAParameters>());
+			dca->reset(sampleRate);
+			dca->doNoteOn(midiNoteNumberToOscFrequency(60), 60, 100);
+
+			return [dca](uint32_t numSamples)
+			{
+				SynthProcessorData audioData;
+				audioData.numInputChannels = 1;
+				audioData.numOutputChannels = 2;
+				double sum = 0.0;
+				for (uint32_t i = 0; i < numSamples; i++)
+				{
+					audioData.inputs[0] = (double)(i & 0xFF) / 256.0;
+					dca->update(true);
+					dca->processSynthAudio(&audioData);
+					sum += audioData.outputs[0] + audioData.outputs[1];
+				}
+				benchmarkSink = benchmarkSink + sum;
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	// --- SynthVoice::runModulationMatrix() on its own
+	{
+		Benchmark benchmark;
+		benchmark.name = "voice/modmatrix";
+		benchmark.factory = [](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<VoiceBank> voiceBank = std::make_shared<VoiceBank>(1, sampleRate);
+			return [voiceBank](uint32_t numSamples)
+			{
+				for (uint32_t i = 0; i < numSamples; i++)
+					voiceBank->voices[0]->renderModulationMatrix();
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	// --- whole voices at 1/8/32/64 voices; these give voices per core directly
+	const uint32_t voiceCounts[] = { 1, 8, 32, 64 };
+	for (uint32_t numVoices : voiceCounts)
+	{
+		Benchmark benchmark;
+		benchmark.name = "voice/x" + std::to_string(numVoices);
+		benchmark.numVoices = numVoices;
+		benchmark.factory = [numVoices](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<VoiceBank> voiceBank = std::make_shared<VoiceBank>(numVoices, sampleRate);
+			return [voiceBank](uint32_t numSamples)
+			{
+				double sum = 0.0;
+				for (uint32_t i = 0; i < numSamples; i++)
+				{
+					for (std::unique_ptr<BenchmarkVoice>& voice : voiceBank->voices)
+					{
+						const SynthRenderData render = voice->renderAudioOutput();
+						sum += render.synthOutputs[LEFT_CHANNEL];
+					}
+				}
+				benchmarkSink = benchmarkSink + sum;
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	// --- SynthEngine with held notes; the engine is compiled for MAX_VOICES so larger counts are capped
+	std::vector<uint32_t> engineVoiceCounts;
+	for (uint32_t numNotes : voiceCounts)
+	{
+		uint32_t numVoices = numNotes < MAX_VOICES ? numNotes : MAX_VOICES;
+		if (std::find(engineVoiceCounts.begin(), engineVoiceCounts.end(), numVoices) == engineVoiceCounts.end())
+			engineVoiceCounts.push_back(numVoices);
+	}
+
+	for (uint32_t numVoices : engineVoiceCounts)
+	{
+		Benchmark benchmark;
+		benchmark.name = "engine/x" + std::to_string(numVoices);
+		benchmark.numVoices = numVoices;
+		benchmark.factory = [numVoices](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<SynthEngine> engine = std::make_shared<SynthEngine>();
+			PluginInfo pluginInfo;
+			pluginInfo.pathToDLL = ".";
+			engine->initialize(pluginInfo);
+			engine->reset(sampleRate);
+
+			SynthEngineParameters parameters = engine->getParameters();
+			parameters.mode = synthMode::kPoly;
+			engine->setParameters(parameters);
+			engine->getVoiceParameters()->vectorJSData = VectorJoystickData(0.25, 0.25, 0.25, 0.25, 0.5, 0.5);
+
+			for (uint32_t i = 0; i < numVoices; i++)
+			{
+				midiEvent noteOn(NOTE_ON, 0, 48 + 4 * i, 100, 0);
+				engine->processMIDIEvent(noteOn);
+			}
+
+			std::shared_ptr<std::vector<float>> buffers = std::make_shared<std::vector<float>>(2 * 4096);
+			return [engine, buffers](uint32_t numSamples)
+			{
+				float* left = buffers->data();
+				float* right = left + 4096;
+				uint32_t remaining = numSamples;
+				while (remaining > 0)
+				{
+					uint32_t numFrames = remaining < 4096 ? remaining : 4096;
+					engine->renderAudioBlock(left, right, numFrames);
+					benchmarkSink = benchmarkSink + left[0];
+					remaining -= numFrames;
+				}
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	// --- fxobjects.h processors; reset comes before setParameters() so delay times and
+	//     coefficients are calculated at the benchmark sample rate
+	//     processors with a processAudioBlock() path are timed both ways, the block one as name/block
+	struct ProcessorBenchmark { const char* name; std::function<std::shared_ptr<IAudioSignalProcessor>(double)> create; bool stereo; bool hasBlockPath; };
+	std::vector<ProcessorBenchmark> processors =
+	{
+		{ "fx/audiofilter/lpf2", [](double sampleRate) {
+			std::shared_ptr<AudioFilter> filter = std::make_shared<AudioFilter>();
+			filter->reset(sampleRate);
+			AudioFilterParameters params = filter->getParameters();
+			params.algorithm = filterAlgorithm::kLPF2; params.fc = 1000.0; params.Q = 2.0;
+			filter->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(filter); }, false, true },
+		{ "fx/zvafilter/svf-lp", [](double sampleRate) {
+			std::shared_ptr<ZVAFilter> filter = std::make_shared<ZVAFilter>();
+			filter->reset(sampleRate);
+			ZVAFilterParameters params = filter->getParameters();
+			params.fc = 1000.0; params.Q = 2.0;
+			filter->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(filter); }, false, false },
+		{ "fx/lrfilterbank", [](double sampleRate) {
+			return resetProcessor(std::make_shared<LRFilterBank>(), sampleRate); }, false, false },
+		{ "fx/dynamics/compressor", [](double sampleRate) {
+			std::shared_ptr<DynamicsProcessor> dynamics = std::make_shared<DynamicsProcessor>();
+			dynamics->reset(sampleRate);
+			DynamicsProcessorParameters params = dynamics->getParameters();
+			params.ratio = 4.0; params.threshold_dB = -20.0; params.attackTime_mSec = 5.0; params.releaseTime_mSec = 100.0;
+			dynamics->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(dynamics); }, false, false },
+		{ "fx/peaklimiter", [](double sampleRate) {
+			return resetProcessor(std::make_shared<PeakLimiter>(), sampleRate); }, false, false },
+		{ "fx/envelopefollower", [](double sampleRate) {
+			return resetProcessor(std::make_shared<EnvelopeFollower>(), sampleRate); }, false, false },
+		{ "fx/phaseshifter", [](double sampleRate) {
+			std::shared_ptr<PhaseShifter> phaser = std::make_shared<PhaseShifter>();
+			phaser->reset(sampleRate);
+			PhaseShifterParameters params = phaser->getParameters();
+			params.lfoRate_Hz = 0.5; params.lfoDepth_Pct = 80.0; params.intensity_Pct = 75.0;
+			phaser->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(phaser); }, false, false },
+		{ "fx/triodeclassa", [](double sampleRate) {
+			return resetProcessor(std::make_shared<TriodeClassA>(), sampleRate); }, false, false },
+		{ "fx/classatubepre", [](double sampleRate) {
+			std::shared_ptr<ClassATubePre> tubePre = std::make_shared<ClassATubePre>();
+			tubePre->reset(sampleRate);
+			ClassATubePreParameters params = tubePre->getParameters();
+			params.saturation = 2.0; params.lowShelf_fc = 100.0; params.highShelf_fc = 5000.0;
+			tubePre->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(tubePre); }, false, false },
+		{ "fx/bitcrusher", [](double sampleRate) {
+			return resetProcessor(std::make_shared<BitCrusher>(), sampleRate); }, false, false },
+		{ "fx/oversampled/triodeclassa-4x-fir", [](double sampleRate) {
+			return oversampleProcessor(std::make_shared<TriodeClassA>(), oversamplingRatio::k4x, oversamplingFilter::kLinearPhaseFIR, sampleRate); }, false, true },
+		{ "fx/oversampled/triodeclassa-4x-iir", [](double sampleRate) {
+			return oversampleProcessor(std::make_shared<TriodeClassA>(), oversamplingRatio::k4x, oversamplingFilter::kHalfbandIIR, sampleRate); }, false, true },
+		{ "fx/oversampled/bitcrusher-2x-fir", [](double sampleRate) {
+			return oversampleProcessor(std::make_shared<BitCrusher>(), oversamplingRatio::k2x, oversamplingFilter::kLinearPhaseFIR, sampleRate); }, false, true },
+		{ "fx/oversampled/bitcrusher-8x-fir", [](double sampleRate) {
+			return oversampleProcessor(std::make_shared<BitCrusher>(), oversamplingRatio::k8x, oversamplingFilter::kLinearPhaseFIR, sampleRate); }, false, true },
+		{ "fx/analogfirfilter", [](double sampleRate) {
+			std::shared_ptr<AnalogFIRFilter> filter = std::make_shared<AnalogFIRFilter>();
+			filter->reset(sampleRate);
+			AnalogFIRFilterParameters params = filter->getParameters();
+			params.filterType = analogFilter::kLPF2; params.fc = 2000.0; params.Q = 2.0;
+			filter->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(filter); }, false, true },
+		{ "fx/wdf/rlc-lpf", [](double sampleRate) {
+			return resetProcessor(std::make_shared<WDFIdealRLCLPF>(), sampleRate); }, false, false },
+		{ "fx/audiodelay/stereo", [](double sampleRate) {
+			std::shared_ptr<AudioDelay> delay = std::make_shared<AudioDelay>();
+			delay->createDelayBuffers(sampleRate, 2000.0);
+			delay->reset(sampleRate);
+			AudioDelayParameters params = delay->getParameters();
+			params.leftDelay_mSec = 250.0; params.rightDelay_mSec = 375.0; params.feedback_Pct = 40.0;
+			delay->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(delay); }, true, true },
+		{ "fx/modulateddelay/chorus", [](double sampleRate) {
+			std::shared_ptr<ModulatedDelay> modDelay = std::make_shared<ModulatedDelay>();
+			modDelay->reset(sampleRate);
+			ModulatedDelayParameters params = modDelay->getParameters();
+			params.algorithm = modDelaylgorithm::kChorus; params.lfoRate_Hz = 0.5; params.lfoDepth_Pct = 50.0;
+			modDelay->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(modDelay); }, true, true },
+		{ "fx/modulateddelay/chorus-hermite", [](double sampleRate) {
+			std::shared_ptr<ModulatedDelay> modDelay = std::make_shared<ModulatedDelay>();
+			modDelay->reset(sampleRate);
+			ModulatedDelayParameters params = modDelay->getParameters();
+			params.algorithm = modDelaylgorithm::kChorus; params.lfoRate_Hz = 0.5; params.lfoDepth_Pct = 50.0;
+			params.interpolation = delayInterpolation::kHermite;
+			modDelay->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(modDelay); }, true, true },
+		{ "fx/reverbtank", [](double sampleRate) {
+			std::shared_ptr<ReverbTank> reverb = std::make_shared<ReverbTank>();
+			reverb->reset(sampleRate);
+			ReverbTankParameters params = reverb->getParameters();
+			params.kRT = 0.8; params.lpf_g = 0.3; params.preDelayTime_mSec = 20.0;
+			params.lowShelf_fc = 150.0; params.highShelf_fc = 4000.0;
+			reverb->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(reverb); }, true, false },
+		{ "fx/psmvocoder", [](double sampleRate) {
+			std::shared_ptr<PSMVocoder> vocoder = std::make_shared<PSMVocoder>();
+			vocoder->reset(sampleRate);
+			PSMVocoderParameters params = vocoder->getParameters();
+			params.pitchShiftSemitones = 7.0;
+			vocoder->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(vocoder); }, false, false },
+		{ "fx/reverbtank-fdn", [](double sampleRate) {
+			std::shared_ptr<FDNReverbTank> reverb = std::make_shared<FDNReverbTank>();
+			reverb->reset(sampleRate);
+			ReverbTankParameters params = reverb->getParameters();
+			params.kRT = 0.8; params.lpf_g = 0.3; params.preDelayTime_mSec = 20.0;
+			params.lowShelf_fc = 150.0; params.highShelf_fc = 4000.0;
+			reverb->setParameters(params);
+			return std::static_pointer_cast<IAudioSignalProcessor>(reverb); }, true, true },
+	};
+
+	for (const ProcessorBenchmark& processor : processors)
+	{
+		Benchmark benchmark;
+		benchmark.name = processor.name;
+		std::function<std::shared_ptr<IAudioSignalProcessor>(double)> create = processor.create;
+		bool stereo = processor.stereo;
+		benchmark.factory = [create, stereo](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<IAudioSignalProcessor> object = create(sampleRate);
+			return stereo ? makeFrameRender(object, sampleRate) : makeProcessorRender(object, sampleRate);
+		};
+		benchmarks.push_back(benchmark);
+
+		if (processor.hasBlockPath)
+		{
+			Benchmark blockBenchmark;
+			blockBenchmark.name = std::string(processor.name) + "/block";
+			blockBenchmark.factory = [create](double sampleRate) -> BenchmarkRender
+			{
+				return makeBlockRender(create(sampleRate), sampleRate);
+			};
+			benchmarks.push_back(blockBenchmark);
+		}
+	}
+
+	// --- stereo partitioned convolution at 2 and 5 second IRs, in 64-frame blocks like the master FX rack;
+	//     the tail levels run on the worker thread, so this is the audio thread's share only
+	const double irSeconds[] = { 2.0, 5.0 };
+	for (double irLength_Sec : irSeconds)
+	{
+		Benchmark benchmark;
+		benchmark.name = "fx/convolver/" + std::to_string((int)irLength_Sec) + "s";
+		benchmark.factory = [irLength_Sec](double sampleRate) -> BenchmarkRender
+		{
+			uint32_t irLength = (uint32_t)(irLength_Sec*sampleRate);
+			std::vector<float> ir[2] = { std::vector<float>(irLength), std::vector<float>(irLength) };
+			uint32_t seed = 1;
+			for (uint32_t i = 0; i < irLength; i++)
+			{
+				double envelope = pow(10.0, -3.0*i / irLength);
+				for (uint32_t c = 0; c < 2; c++)
+				{
+					seed = seed * 196314165 + 907633515;
+					ir[c][i] = (float)(envelope*((double)seed / 2147483648.0 - 1.0));
+				}
+			}
+
+			std::shared_ptr<PartitionedConvolver> convolver = std::make_shared<PartitionedConvolver>();
+			const float* irChannels[2] = { ir[0].data(), ir[1].data() };
+			convolver->setImpulseResponse(irChannels, 2, irLength, 2);
+
+			std::shared_ptr<std::vector<float>> buffers = std::make_shared<std::vector<float>>(4 * 64);
+			return [convolver, buffers](uint32_t numSamples)
+			{
+				float* input[2] = { buffers->data(), buffers->data() + 64 };
+				float* output[2] = { buffers->data() + 128, buffers->data() + 192 };
+				uint32_t remaining = numSamples;
+				uint32_t phase = 0;
+				while (remaining > 0)
+				{
+					uint32_t numFrames = remaining < 64 ? remaining : 64;
+					for (uint32_t i = 0; i < numFrames; i++)
+					{
+						input[0][i] = (float)((phase++ & 0xFF) / 256.0 - 0.5);
+						input[1][i] = -input[0][i];
+					}
+					convolver->processAudioBlock(input, output, numFrames);
+					benchmarkSink = benchmarkSink + output[0][0];
+					remaining -= numFrames;
+				}
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	// --- FFT backend (FFTW with -DHAVE_FFTW, otherwise the built-in FFT): a real FFT every frameLength samples,
+	//     and a pass-through phase vocoder at 75% overlap
+	const unsigned int fftLengths[] = { 512, 4096 };
+	for (unsigned int frameLength : fftLengths)
+	{
+		Benchmark fftBenchmark;
+		fftBenchmark.name = "fft/fastfft/" + std::to_string(frameLength);
+		fftBenchmark.factory = [frameLength](double /*sampleRate*/) -> BenchmarkRender
+		{
+			std::shared_ptr<FastFFT> fft = std::make_shared<FastFFT>();
+			fft->initialize(frameLength, windowType::kNoWindow);
+			std::shared_ptr<std::vector<double>> frame = std::make_shared<std::vector<double>>(frameLength);
+			std::shared_ptr<uint32_t> count = std::make_shared<uint32_t>(0);
+			return [fft, frame, count, frameLength](uint32_t numSamples)
+			{
+				for (uint32_t i = 0; i < numSamples; i++)
+				{
+					(*frame)[*count] = (double)((i & 0xFF) / 256.0 - 0.5);
+					if (++(*count) == frameLength)
+					{
+						fftw_complex* bins = fft->doFFT(frame->data());
+						benchmarkSink = benchmarkSink + bins[1][0];
+						*count = 0;
+					}
+				}
+			};
+		};
+		benchmarks.push_back(fftBenchmark);
+
+		Benchmark vocoderBenchmark;
+		vocoderBenchmark.name = "fft/phasevocoder/" + std::to_string(frameLength);
+		vocoderBenchmark.factory = [frameLength](double /*sampleRate*/) -> BenchmarkRender
+		{
+			std::shared_ptr<PhaseVocoder> vocoder = std::make_shared<PhaseVocoder>();
+			vocoder->initialize(frameLength, frameLength / 4, windowType::kHannWindow);
+			return [vocoder](uint32_t numSamples)
+			{
+				bool fftReady = false;
+				for (uint32_t i = 0; i < numSamples; i++)
+					benchmarkSink = benchmarkSink + vocoder->processAudioSample((double)((i & 0xFF) / 256.0 - 0.5), fftReady);
+			};
+		};
+		benchmarks.push_back(vocoderBenchmark);
+	}
+
+	// --- FIRConvolver across the direct/FFT switch-over, in 64-frame blocks, against the sample-by-sample
+	//     ImpulseConvolver it replaces in AnalogFIRFilter
+	const uint32_t firLengths[] = { 64, 256, 512, 1024, 4096, 16384 };
+	for (uint32_t firLength : firLengths)
+	{
+		Benchmark benchmark;
+		benchmark.name = "fir/convolver/" + std::to_string(firLength);
+		benchmark.factory = [firLength](double /*sampleRate*/) -> BenchmarkRender
+		{
+			std::vector<float> ir(firLength);
+			for (uint32_t i = 0; i < firLength; i++)
+				ir[i] = (float)(pow(10.0, -3.0*i / firLength) * ((i & 1) ? -0.1 : 0.1));
+
+			std::shared_ptr<FIRConvolver> convolver = std::make_shared<FIRConvolver>();
+			convolver->setImpulseResponse(ir.data(), firLength);
+
+			std::shared_ptr<std::vector<float>> buffers = std::make_shared<std::vector<float>>(2 * 64);
+			return [convolver, buffers](uint32_t numSamples)
+			{
+				float* input = buffers->data();
+				float* output = buffers->data() + 64;
+				uint32_t phase = 0;
+				for (uint32_t frame = 0; frame < numSamples; frame += 64)
+				{
+					uint32_t numFrames = numSamples - frame < 64 ? numSamples - frame : 64;
+					for (uint32_t i = 0; i < numFrames; i++)
+						input[i] = (float)((phase++ & 0xFF) / 256.0 - 0.5);
+					convolver->processAudioBlock(input, output, numFrames);
+					benchmarkSink = benchmarkSink + output[0];
+				}
+			};
+		};
+		benchmarks.push_back(benchmark);
+	}
+
+	Benchmark impulseConvolverBenchmark;
+	impulseConvolverBenchmark.name = "fir/impulseconvolver/" + std::to_string(IR_LEN);
+	impulseConvolverBenchmark.factory = [](double sampleRate) -> BenchmarkRender
+	{
+		std::shared_ptr<ImpulseConvolver> convolver = std::make_shared<ImpulseConvolver>();
+		std::vector<double> ir(IR_LEN);
+		for (uint32_t i = 0; i < IR_LEN; i++)
+			ir[i] = pow(10.0, -3.0*i / IR_LEN) * ((i & 1) ? -0.1 : 0.1);
+		convolver->setImpulseResponse(ir.data(), IR_LEN);
+		return makeProcessorRender(convolver, sampleRate);
+	};
+	benchmarks.push_back(impulseConvolverBenchmark);
+
+	// --- 8 sections on 4 channels: one BiquadCascade against 32 AudioFilter objects; then the 4-band stereo
+	//     Linkwitz-Riley crossover
+	Benchmark cascadeBenchmark;
+	cascadeBenchmark.name = "filter/biquadcascade/8x4";
+	cascadeBenchmark.factory = [](double sampleRate) -> BenchmarkRender
+	{
+		std::shared_ptr<BiquadCascade> cascade = std::make_shared<BiquadCascade>();
+		cascade->setNumSections(8);
+		for (uint32_t section = 0; section < 8; section++)
+		{
+			AudioFilterParameters params;
+			params.algorithm = filterAlgorithm::kCQParaEQ; params.fc = 100.0 * (section + 1); params.Q = 2.0; params.boostCut_dB = 3.0;
+			double coeffs[numCoeffs] = { 0.0 };
+			calculateAudioFilterCoeffs(params, sampleRate, coeffs);
+			cascade->setCoefficients(section, coeffs);
+		}
+
+		std::shared_ptr<std::vector<float>> buffers = std::make_shared<std::vector<float>>(4 * 64);
+		return [cascade, buffers](uint32_t numSamples)
+		{
+			float* channels[4] = { buffers->data(), buffers->data() + 64, buffers->data() + 128, buffers->data() + 192 };
+			uint32_t phase = 0;
+			for (uint32_t frame = 0; frame < numSamples; frame += 64)
+			{
+				uint32_t numFrames = numSamples - frame < 64 ? numSamples - frame : 64;
+				for (uint32_t i = 0; i < numFrames; i++)
+				{
+					float x = (float)((phase++ & 0xFF) / 256.0 - 0.5);
+					channels[0][i] = channels[1][i] = channels[2][i] = channels[3][i] = x;
+				}
+				cascade->processAudioBlock(channels, channels, 4, numFrames);
+				benchmarkSink = benchmarkSink + channels[3][0];
+			}
+		};
+	};
+	benchmarks.push_back(cascadeBenchmark);
+
+	Benchmark audioFilterChainBenchmark;
+	audioFilterChainBenchmark.name = "filter/audiofilter-chain/8x4";
+	audioFilterChainBenchmark.factory = [](double sampleRate) -> BenchmarkRender
+	{
+		std::shared_ptr<std::vector<AudioFilter>> filters = std::make_shared<std::vector<AudioFilter>>(32);
+		for (uint32_t i = 0; i < 32; i++)
+		{
+			AudioFilterParameters params;
+			params.algorithm = filterAlgorithm::kCQParaEQ; params.fc = 100.0 * (i % 8 + 1); params.Q = 2.0; params.boostCut_dB = 3.0;
+			(*filters)[i].reset(sampleRate);
+			(*filters)[i].setParameters(params);
+		}
+
+		return [filters](uint32_t numSamples)
+		{
+			IAudioSignalProcessor* chain[32];
+			for (uint32_t i = 0; i < 32; i++)
+				chain[i] = &(*filters)[i];
+
+			uint32_t phase = 0;
+			double sum = 0.0;
+			for (uint32_t i = 0; i < numSamples; i++)
+			{
+				double x = (phase++ & 0xFF) / 256.0 - 0.5;
+				for (uint32_t channel = 0; channel < 4; channel++)
+				{
+					double y = x;
+					for (uint32_t section = 0; section < 8; section++)
+						y = chain[channel * 8 + section]->processAudioSample(y);
+					sum += y;
+				}
+			}
+			benchmarkSink = benchmarkSink + sum;
+		};
+	};
+	benchmarks.push_back(audioFilterChainBenchmark);
+
+	Benchmark crossoverBenchmark;
+	crossoverBenchmark.name = "filter/lrcrossover/4band-stereo";
+	crossoverBenchmark.factory = [](double sampleRate) -> BenchmarkRender
+	{
+		std::shared_ptr<LRCrossover> crossover = std::make_shared<LRCrossover>();
+		LRCrossoverParameters params;
+		params.numBands = 4;
+		crossover->setParameters(params);
+		crossover->reset(sampleRate);
+
+		std::shared_ptr<std::vector<float>> buffers = std::make_shared<std::vector<float>>(10 * 64);
+		return [crossover, buffers](uint32_t numSamples)
+		{
+			float* input[2] = { buffers->data(), buffers->data() + 64 };
+			float* bandsL[4] = { buffers->data() + 128, buffers->data() + 192, buffers->data() + 256, buffers->data() + 320 };
+			float* bandsR[4] = { buffers->data() + 384, buffers->data() + 448, buffers->data() + 512, buffers->data() + 576 };
+			uint32_t phase = 0;
+			for (uint32_t frame = 0; frame < numSamples; frame += 64)
+			{
+				uint32_t numFrames = numSamples - frame < 64 ? numSamples - frame : 64;
+				for (uint32_t i = 0; i < numFrames; i++)
+				{
+					input[0][i] = (float)((phase & 0xFF) / 256.0 - 0.5);
+					input[1][i] = (float)((phase++ & 0x7F) / 128.0 - 0.5);
+				}
+				crossover->processAudioBlock(input[0], input[1], bandsL, bandsR, numFrames);
+				benchmarkSink = benchmarkSink + bandsL[0][0] + bandsR[3][0];
+			}
+		};
+	};
+	benchmarks.push_back(crossoverBenchmark);
+
+	// --- stereo-linked dynamics: the per-sample DynamicsProcessor pair the master rack used, against LookaheadDynamics
+	Benchmark linkedCompressorBenchmark;
+	linkedCompressorBenchmark.name = "fx/dynamics/compressor-linked";
+	linkedCompressorBenchmark.factory = [](double sampleRate) -> BenchmarkRender
+	{
+		std::shared_ptr<std::vector<DynamicsProcessor>> compressors = std::make_shared<std::vector<DynamicsProcessor>>(2);
+		for (uint32_t channel = 0; channel < 2; channel++)
+		{
+			DynamicsProcessor& compressor = (*compressors)[channel];
+			compressor.reset(sampleRate);
+			DynamicsProcessorParameters params = compressor.getParameters();
+			params.ratio = 4.0; params.threshold_dB = -20.0; params.kneeWidth_dB = 6.0; params.attackTime_mSec = 5.0; params.releaseTime_mSec = 100.0;
+			params.enableSidechain = true;
+			compressor.setParameters(params);
+		}
+
+		return [compressors](uint32_t numSamples)
+		{
+			uint32_t phase = 0;
+			double sum = 0.0;
+			for (uint32_t i = 0; i < numSamples; i++)
+			{
+				double left = (phase & 0xFF) / 256.0 - 0.5;
+				double right = (phase++ & 0x7F) / 128.0 - 0.5;
+				double sidechain = fmax(fabs(left), fabs(right));
+				(*compressors)[0].processAuxInputAudioSample(sidechain);
+				(*compressors)[1].processAuxInputAudioSample(sidechain);
+				sum += (*compressors)[0].processAudioSample(left) + (*compressors)[1].processAudioSample(right);
+			}
+			benchmarkSink = benchmarkSink + sum;
+		};
+	};
+	benchmarks.push_back(linkedCompressorBenchmark);
+
+	const char* lookaheadDynamicsNames[3] = { "fx/lookaheaddynamics/compressor", "fx/lookaheaddynamics/limiter", "fx/lookaheaddynamics/limiter-1ms" };
+	for (uint32_t type = 0; type < 3; type++)
+	{
+		Benchmark dynamicsBenchmark;
+		dynamicsBenchmark.name = lookaheadDynamicsNames[type];
+		dynamicsBenchmark.factory = [type](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<LookaheadDynamics> dynamics = std::make_shared<LookaheadDynamics>();
+			dynamics->reset(sampleRate);
+			LookaheadDynamicsParameters params = dynamics->getParameters();
+			params.ratio = 4.0; params.threshold_dB = -20.0; params.kneeWidth_dB = 6.0; params.attackTime_mSec = 5.0; params.releaseTime_mSec = 100.0;
+			if (type > 0)
+			{
+				params.hardLimitGate = true; params.threshold_dB = -6.0; params.kneeWidth_dB = 10.0; params.releaseTime_mSec = 25.0;
+				params.lookahead_mSec = type == 2 ? 1.0 : 0.0;
+			}
+			dynamics->setParameters(params);
+
+			std::shared_ptr<std::vector<float>> buffers = std::make_shared<std::vector<float>>(2 * 64);
+			return [dynamics, buffers](uint32_t numSamples)
+			{
+				float* channels[2] = { buffers->data(), buffers->data() + 64 };
+				uint32_t phase = 0;
+				for (uint32_t frame = 0; frame < numSamples; frame += 64)
+				{
+					uint32_t numFrames = numSamples - frame < 64 ? numSamples - frame : 64;
+					for (uint32_t i = 0; i < numFrames; i++)
+					{
+						channels[0][i] = (float)((phase & 0xFF) / 256.0 - 0.5);
+						channels[1][i] = (float)((phase++ & 0x7F) / 128.0 - 0.5);
+					}
+					dynamics->processAudioBlock(channels, channels, 2, numFrames);
+					benchmarkSink = benchmarkSink + channels[0][0] + channels[1][0];
+				}
+			};
+		};
+		benchmarks.push_back(dynamicsBenchmark);
+	}
+
+	// --- denormal release tails, FTZ/DAZ off vs on; the state is checked to be subnormal before timing
+	for (uint32_t flush = 0; flush < 2; flush++)
+	{
+		const char* suffix = flush ? "/ftz-on" : "/ftz-off";
+
+		Benchmark zvaTail;
+		zvaTail.name = std::string("denormal/zvafilter-tail") + suffix;
+		zvaTail.factory = [flush, name = zvaTail.name](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<DenormalProbeZVAFilter> filter = std::make_shared<DenormalProbeZVAFilter>();
+			filter->reset(sampleRate);
+			ZVAFilterParameters params = filter->getParameters();
+			params.filterAlgorithm = vaFilterAlgorithm::kSVF_LP; params.fc = 100.0; params.Q = 10.0;
+			filter->setParameters(params);
+			return makeDenormalTailRender(name, filter, [filter]() { return filter->classifyTail(); }, sampleRate, flush != 0);
+		};
+		benchmarks.push_back(zvaTail);
+
+		Benchmark reverbTail;
+		reverbTail.name = std::string("denormal/reverbtank-fdn-tail") + suffix;
+		reverbTail.factory = [flush, name = reverbTail.name](double sampleRate) -> BenchmarkRender
+		{
+			std::shared_ptr<DenormalProbeReverbTank> reverb = std::make_shared<DenormalProbeReverbTank>();
+			reverb->reset(sampleRate);
+			ReverbTankParameters params = reverb->getParameters();
+			params.kRT = 0.9; params.lpf_g = 0.3;
+			reverb->setParameters(params);
+			return makeDenormalTailRender(name, reverb, [reverb]() { return reverb->classifyTail(); }, sampleRate, flush != 0);
+		};
+		benchmarks.push_back(reverbTail);
+	}
+
+	return benchmarks;
+}
+
+// --- true if the name passes the command line filters
+static bool matchesFilters(const std::string& name, const std::vector<std::string>& filters)
+{
+	if (filters.empty())
+		return true;
+
+	for (const std::string& filter : filters)
+	{
+		if (name.find(filter) != std::string::npos)
+			return true;
+	}
+	return false;
+}
+
+// --- time one benchmark at one sample rate; returns the median ns/sample over the trials
+static double runBenchmark(const Benchmark& benchmark, double sampleRate, const BenchmarkSettings& settings)
+{
+	BenchmarkRender render = benchmark.factory(sampleRate);
+	uint32_t samplesPerTrial = (uint32_t)(settings.trialSeconds * sampleRate);
+
+	// --- warm up caches, branch predictors and any lazily built tables
+	for (uint32_t rendered = 0; rendered < samplesPerTrial / 4; rendered += settings.blockSize)
+		render(settings.blockSize);
+
+	std::vector<double> trialResults;
+	for (uint32_t trial = 0; trial < settings.numTrials; trial++)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		uint32_t rendered = 0;
+		for (; rendered < samplesPerTrial; rendered += settings.blockSize)
+			render(settings.blockSize);
+		double elapsed_nSec = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+		trialResults.push_back(elapsed_nSec / rendered);
+	}
+
+	std::sort(trialResults.begin(), trialResults.end());
+	return trialResults[trialResults.size() / 2];
+}
+
+// --- print the command line help
+static void printUsage(const char* programName)
+{
+	printf("usage: %s [options] [filter ...]\n"
+		"  filter                  run only benchmarks whose name contains this text (e.g. moog, voice/, fx/)\n"
+		"  -l, --list              list the benchmark names and exit\n"
+		"  -n, --trials N          timed trials per benchmark, median is reported (default 7)\n"
+		"  -s, --seconds S         seconds of audio per trial (default 0.5)\n"
+		"  -b, --block-size N      samples per render call (default 64)\n"
+		"  --csv                   CSV output\n"
+		"  -h, --help              this text\n", programName);
+}
+
+int main(int argc, char* argv[])
+{
+	BenchmarkSettings settings;
+	bool listOnly = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+		else if (arg == "-l" || arg == "--list")
+			listOnly = true;
+		else if (arg == "--csv")
+			settings.csvOutput = true;
+		else if ((arg == "-n" || arg == "--trials") && hasValue)
+			settings.numTrials = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		else if ((arg == "-s" || arg == "--seconds") && hasValue)
+			settings.trialSeconds = strtod(argv[++i], nullptr);
+		else if ((arg == "-b" || arg == "--block-size") && hasValue)
+			settings.blockSize = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			fprintf(stderr, "unknown option '%s'\n", arg.c_str());
+			printUsage(argv[0]);
+			return 2;
+		}
+		else
+			settings.filters.push_back(arg);
+	}
+
+	if (settings.numTrials == 0 || settings.trialSeconds <= 0.0 || settings.blockSize == 0)
+	{
+		fprintf(stderr, "invalid trial count, trial length or block size\n");
+		return 2;
+	}
+
+	std::vector<Benchmark> benchmarks = makeBenchmarks();
+
+	if (listOnly)
+	{
+		for (const Benchmark& benchmark : benchmarks)
+		{
+			if (matchesFilters(benchmark.name, settings.filters))
+				printf("%s\n", benchmark.name.c_str());
+		}
+		return 0;
+	}
+
+	if (settings.csvOutput)
+		printf("benchmark,sample_rate,ns_per_sample,core_load_pct,voices_per_core\n");
+	else
+		printf("%-36s %8s %12s %10s %12s\n", "benchmark", "fs", "ns/sample", "core %", "voices/core");
+
+	for (const Benchmark& benchmark : benchmarks)
+	{
+		if (!matchesFilters(benchmark.name, settings.filters))
+			continue;
+
+		for (double sampleRate : kBenchmarkSampleRates)
+		{
+			double nsPerSample = runBenchmark(benchmark, sampleRate, settings);
+
+			// --- fraction of one core needed to keep up in real time
+			double coreLoad = nsPerSample * sampleRate * 1.0e-9;
+			double voicesPerCore = benchmark.numVoices > 0 && coreLoad > 0.0 ? benchmark.numVoices / coreLoad : 0.0;
+
+			if (settings.csvOutput)
+				printf("%s,%.0f,%.3f,%.4f,%.1f\n", benchmark.name.c_str(), sampleRate, nsPerSample, 100.0 * coreLoad, voicesPerCore);
+			else if (benchmark.numVoices > 0)
+				printf("%-36s %8.0f %12.2f %10.3f %12.1f\n", benchmark.name.c_str(), sampleRate, nsPerSample, 100.0 * coreLoad, voicesPerCore);
+			else
+				printf("%-36s %8.0f %12.2f %10.3f %12s\n", benchmark.name.c_str(), sampleRate, nsPerSample, 100.0 * coreLoad, "-");
+			fflush(stdout);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,515 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  synthcore_golden.cpp
+//
+/**
+    \file   synthcore_golden.cpp
+    \brief  golden-output regression harness: renders reference scenarios and compares them with stored WAVs
+
+    usage: synthcore_golden [options] scenarios.txt
+    renders are deterministic: the synth noise seed is fixed and each scenario gets a fresh PluginCore;
+    --update (re)writes the goldens, otherwise every scenario is compared and the exit code is 0 only if all pass;
+    the goldens checked in with golden/scenarios.txt are compared at peak:-120 unless -t or tolerance= says otherwise
+*/
+// -----------------------------------------------------------------------------
+#include "offlinehost.h"
+#include "wavfilereader.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <complex>
+#include <fstream>
+#include <sstream>
+
+/**
+\enum goldenCompareMode
+\ingroup Offline
+\brief
+How a render is compared with its golden.
+
+- kBitExact: every sample identical
+- kPeakError: largest sample difference at or below the threshold, in dBFS
+- kSpectral: per-frame RMS difference of the magnitude spectra at or below the threshold, in dB
+*/
+enum class goldenCompareMode { kBitExact, kPeakError, kSpectral };
+
+/**
+\struct GoldenTolerance
+\ingroup Offline
+\brief
+Comparison mode and threshold; parsed from "bitexact", "peak:DB" or "spectral:DB".
+*/
+struct GoldenTolerance
+{
+	goldenCompareMode mode = goldenCompareMode::kPeakError;
+	double threshold_dB = -120.0;	///< dBFS for kPeakError, dB for kSpectral
+
+	bool parse(const std::string& text)
+	{
+		size_t colon = text.find(':');
+		std::string name = text.substr(0, colon);
+		char* end = nullptr;
+		double value = colon != std::string::npos ? strtod(text.c_str() + colon + 1, &end) : 0.0;
+		bool hasValue = colon != std::string::npos && end && *end == '\0' && end != text.c_str() + colon + 1;
+
+		if (name == "bitexact" && colon == std::string::npos)
+			mode = goldenCompareMode::kBitExact;
+		else if (name == "peak" && hasValue)
+		{
+			mode = goldenCompareMode::kPeakError;
+			threshold_dB = value;
+		}
+		else if (name == "spectral" && hasValue)
+		{
+			mode = goldenCompareMode::kSpectral;
+			threshold_dB = value;
+		}
+		else
+			return false;
+		return true;
+	}
+};
+
+/**
+\struct GoldenScenario
+\ingroup Offline
+\brief
+One line of the scenario file.
+*/
+struct GoldenScenario
+{
+	std::string name;
+	std::string midiFilePath;
+	OfflineRenderSettings settings;
+	GoldenTolerance tolerance;
+	bool hasTolerance = false;		///< true if the line overrides the command line tolerance
+};
+
+// --- the directory part of a path, with a trailing slash; empty for a bare file name
+static std::string getDirectory(const std::string& filePath)
+{
+	size_t slash = filePath.find_last_of("/\\");
+	return slash == std::string::npos ? std::string() : filePath.substr(0, slash + 1);
+}
+
+// --- resolve a path from the scenario file relative to that file
+static std::string resolvePath(const std::string& baseDirectory, const std::string& path)
+{
+	if (path.empty() || path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'))
+		return path;
+	return baseDirectory + path;
+}
+
+// --- parse the scenario file; reports the first bad line
+static bool readScenarioFile(const std::string& filePath, std::vector<GoldenScenario>& scenarios, std::string& errorString)
+{
+	std::ifstream file(filePath.c_str());
+	if (!file.is_open())
+	{
+		errorString = "cannot open " + filePath;
+		return false;
+	}
+
+	std::string baseDirectory = getDirectory(filePath);
+	std::string line;
+	uint32_t lineNumber = 0;
+
+	while (std::getline(file, line))
+	{
+		lineNumber++;
+		if (!line.empty() && line[line.size() - 1] == '\r')
+			line.erase(line.size() - 1);
+
+		std::istringstream fields(line);
+		GoldenScenario scenario;
+		if (!(fields >> scenario.name) || scenario.name[0] == '#')
+			continue;
+
+		std::string field;
+		std::string badField;
+		while (fields >> field)
+		{
+			size_t equals = field.find('=');
+			std::string key = field.substr(0, equals);
+			std::string value = equals == std::string::npos ? std::string() : field.substr(equals + 1);
+			double blend[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+			if (key == "midi" && !value.empty())
+				scenario.midiFilePath = resolvePath(baseDirectory, value);
+			else if (key == "preset" && !value.empty())
+				scenario.settings.presetPath = resolvePath(baseDirectory, value);
+			else if (key == "rate" && !value.empty())
+				scenario.settings.sampleRate = strtod(value.c_str(), nullptr);
+			else if (key == "block" && !value.empty())
+				scenario.settings.blockSize = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+			else if (key == "channels" && !value.empty())
+				scenario.settings.numChannels = (uint32_t)strtoul(value.c_str(), nullptr, 10);
+			else if (key == "tail" && !value.empty())
+				scenario.settings.tailSeconds = strtod(value.c_str(), nullptr);
+			else if (key == "vector" && sscanf(value.c_str(), "%lf,%lf,%lf,%lf", &blend[0], &blend[1], &blend[2], &blend[3]) == 4)
+				scenario.settings.vectorJoystick = VectorJoystickData(blend[0], blend[1], blend[2], blend[3], blend[0] + blend[2], blend[1] + blend[3]);
+			else if (key == "param" && value.find('=') != std::string::npos)
+			{
+				size_t idEnd = value.find('=');
+				scenario.settings.parameters.push_back(std::make_pair((uint32_t)strtoul(value.substr(0, idEnd).c_str(), nullptr, 10),
+																	  strtod(value.substr(idEnd + 1).c_str(), nullptr)));
+			}
+			else if (key == "fx" && !value.empty())
+			{
+				if (!OfflineHost::enableMasterFXSlots(value, scenario.settings.parameters))
+					badField = field;
+			}
+			else if (key == "ir" && !value.empty())
+				scenario.settings.impulseResponse = value.compare(0, 6, "noise:") == 0 ? value : resolvePath(baseDirectory, value);
+			else if (key == "tolerance" && scenario.tolerance.parse(value))
+				scenario.hasTolerance = true;
+			else
+				badField = field;
+		}
+
+		if (!badField.empty() || scenario.midiFilePath.empty())
+		{
+			errorString = filePath + ":" + std::to_string(lineNumber) + ": " + (badField.empty() ? "missing midi=" : "bad field '" + badField + "'");
+			return false;
+		}
+
+		// --- goldens are stored as float so sub-LSB differences are visible
+		scenario.settings.sampleFormat = wavSampleFormat::kFloat32;
+		scenarios.push_back(scenario);
+	}
+
+	return true;
+}
+
+// --- in-place radix-2 FFT; size must be a power of two
+static void doFFT(std::vector<std::complex<double>>& data)
+{
+	size_t size = data.size();
+	for (size_t i = 1, j = 0; i < size; i++)
+	{
+		size_t bit = size >> 1;
+		for (; j & bit; bit >>= 1)
+			j ^= bit;
+		j ^= bit;
+		if (i < j)
+			std::swap(data[i], data[j]);
+	}
+
+	for (size_t length = 2; length <= size; length <<= 1)
+	{
+		std::complex<double> step = std::polar(1.0, -kTwoPi / (double)length);
+		for (size_t start = 0; start < size; start += length)
+		{
+			std::complex<double> twiddle(1.0, 0.0);
+			for (size_t k = 0; k < length / 2; k++)
+			{
+				std::complex<double> even = data[start + k];
+				std::complex<double> odd = data[start + k + length / 2] * twiddle;
+				data[start + k] = even + odd;
+				data[start + k + length / 2] = even - odd;
+				twiddle *= step;
+			}
+		}
+	}
+}
+
+// --- magnitude spectrum of one Hann-windowed frame in dBFS (a full scale sine reads 0 dB), floored at -140 dB
+static void getFrameSpectrum_dB(const std::vector<float>& channel, size_t start, const std::vector<double>& window,
+								std::vector<std::complex<double>>& fftBuffer, std::vector<double>& spectrum_dB)
+{
+	size_t frameSize = window.size();
+	double windowGain = 0.0;
+	for (size_t i = 0; i < frameSize; i++)
+	{
+		double sample = start + i < channel.size() ? channel[start + i] : 0.0;
+		fftBuffer[i] = std::complex<double>(sample * window[i], 0.0);
+		windowGain += window[i];
+	}
+
+	doFFT(fftBuffer);
+
+	for (size_t bin = 0; bin < spectrum_dB.size(); bin++)
+	{
+		double magnitude = 2.0 * std::abs(fftBuffer[bin]) / windowGain;
+		spectrum_dB[bin] = magnitude > 1.0e-7 ? 20.0 * log10(magnitude) : -140.0;
+	}
+}
+
+/**
+\struct GoldenResult
+\ingroup Offline
+\brief
+Outcome of one comparison; measure is the peak error (dBFS) or worst spectral difference (dB).
+*/
+struct GoldenResult
+{
+	bool passed = false;
+	double measure = -INFINITY;
+	double worstTime_Sec = 0.0;
+	std::string message;
+};
+
+// --- compare a render with its golden
+static GoldenResult compareWithGolden(const std::vector<std::vector<float>>& render, const WavFileReader& golden,
+									  const GoldenTolerance& tolerance, double sampleRate)
+{
+	GoldenResult result;
+	const std::vector<std::vector<float>>& goldenChannels = golden.getChannels();
+
+	if (golden.getNumChannels() != render.size() || (uint32_t)(sampleRate + 0.5) != golden.getSampleRate())
+	{
+		result.message = "format differs from the golden (channels or sample rate)";
+		return result;
+	}
+	if (golden.getNumFrames() != render[0].size())
+	{
+		result.message = "length differs: " + std::to_string(render[0].size()) + " frames, golden has " + std::to_string(golden.getNumFrames());
+		return result;
+	}
+
+	// --- peak sample error always; it is the whole test for bitexact and peak
+	double peakError = 0.0;
+	size_t peakFrame = 0;
+	bool identical = true;
+	for (size_t channel = 0; channel < render.size(); channel++)
+	{
+		for (size_t frame = 0; frame < render[channel].size(); frame++)
+		{
+			float renderSample = render[channel][frame];
+			float goldenSample = goldenChannels[channel][frame];
+			if (memcmp(&renderSample, &goldenSample, sizeof(float)) != 0)
+				identical = false;
+
+			double error = fabs((double)renderSample - (double)goldenSample);
+			if (error > peakError)
+			{
+				peakError = error;
+				peakFrame = frame;
+			}
+		}
+	}
+
+	result.measure = peakError > 0.0 ? 20.0 * log10(peakError) : -INFINITY;
+	result.worstTime_Sec = peakFrame / sampleRate;
+
+	if (tolerance.mode == goldenCompareMode::kBitExact)
+	{
+		result.passed = identical;
+		if (!identical)
+			result.message = "not bit-exact";
+		return result;
+	}
+
+	if (tolerance.mode == goldenCompareMode::kPeakError)
+	{
+		result.passed = result.measure <= tolerance.threshold_dB;
+		if (!result.passed)
+			result.message = "peak error above threshold";
+		return result;
+	}
+
+	// --- spectral: RMS of the dB difference over the bins either side considers audible, per frame
+	const size_t frameSize = 2048;
+	const size_t hopSize = frameSize / 2;
+	const double audibleFloor_dB = -100.0;
+
+	std::vector<double> window(frameSize);
+	for (size_t i = 0; i < frameSize; i++)
+		window[i] = 0.5 - 0.5 * cos(kTwoPi * (double)i / (double)frameSize);
+
+	std::vector<std::complex<double>> fftBuffer(frameSize);
+	std::vector<double> renderSpectrum(frameSize / 2 + 1);
+	std::vector<double> goldenSpectrum(frameSize / 2 + 1);
+
+	double worstDifference = 0.0;
+	size_t worstFrame = 0;
+	for (size_t channel = 0; channel < render.size(); channel++)
+	{
+		for (size_t start = 0; start < render[channel].size(); start += hopSize)
+		{
+			getFrameSpectrum_dB(render[channel], start, window, fftBuffer, renderSpectrum);
+			getFrameSpectrum_dB(goldenChannels[channel], start, window, fftBuffer, goldenSpectrum);
+
+			double sumSquares = 0.0;
+			uint32_t numBins = 0;
+			for (size_t bin = 0; bin < renderSpectrum.size(); bin++)
+			{
+				if (renderSpectrum[bin] < audibleFloor_dB && goldenSpectrum[bin] < audibleFloor_dB)
+					continue;
+				double difference = renderSpectrum[bin] - goldenSpectrum[bin];
+				sumSquares += difference * difference;
+				numBins++;
+			}
+
+			double rmsDifference = numBins > 0 ? sqrt(sumSquares / numBins) : 0.0;
+			if (rmsDifference > worstDifference)
+			{
+				worstDifference = rmsDifference;
+				worstFrame = start;
+			}
+		}
+	}
+
+	result.measure = worstDifference;
+	result.worstTime_Sec = worstFrame / sampleRate;
+	result.passed = worstDifference <= tolerance.threshold_dB;
+	if (!result.passed)
+		result.message = "spectral difference above threshold";
+	return result;
+}
+
+// --- write a render as a float WAV (goldens and kept failures)
+static bool writeRender(const std::string& filePath, const std::vector<std::vector<float>>& channels, double sampleRate)
+{
+	WavFileWriter wavFile;
+	if (!wavFile.openWavFile(filePath.c_str(), (uint32_t)(sampleRate + 0.5), (uint32_t)channels.size(), wavSampleFormat::kFloat32))
+		return false;
+
+	float* outputs[2] = { nullptr, nullptr };
+	for (size_t i = 0; i < channels.size() && i < 2; i++)
+		outputs[i] = const_cast<float*>(channels[i].data());
+
+	return wavFile.writeFrames(outputs, (uint32_t)channels[0].size()) && wavFile.closeWavFile();
+}
+
+// --- print the command line help
+static void printUsage(const char* programName)
+{
+	printf("usage: %s [options] scenarios.txt\n"
+		"  -g, --golden-dir DIR    golden WAV folder (default: the scenario file's folder)\n"
+		"  -u, --update            render every scenario and (re)write its golden instead of comparing\n"
+		"  -t, --tolerance T       bitexact, peak:DB (max sample error, dBFS) or spectral:DB\n"
+		"                          (default peak:-120); a scenario's tolerance= overrides this\n"
+		"  -k, --keep-failures DIR write the render of each failing scenario here for inspection\n"
+		"  -s, --seed N            synth noise seed, must match the goldens (default 1)\n"
+		"  -h, --help              this text\n", programName);
+}
+
+int main(int argc, char* argv[])
+{
+	std::string scenarioFilePath;
+	std::string goldenDirectory;
+	std::string failureDirectory;
+	GoldenTolerance defaultTolerance;
+	uint32_t noiseSeed = 1;
+	bool update = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+		else if (arg == "-u" || arg == "--update")
+			update = true;
+		else if ((arg == "-g" || arg == "--golden-dir") && hasValue)
+			goldenDirectory = argv[++i];
+		else if ((arg == "-k" || arg == "--keep-failures") && hasValue)
+			failureDirectory = argv[++i];
+		else if ((arg == "-s" || arg == "--seed") && hasValue)
+			noiseSeed = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		else if ((arg == "-t" || arg == "--tolerance") && hasValue)
+		{
+			if (!defaultTolerance.parse(argv[++i]))
+			{
+				fprintf(stderr, "bad tolerance '%s'\n", argv[i]);
+				return 2;
+			}
+		}
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			fprintf(stderr, "unknown option '%s'\n", arg.c_str());
+			printUsage(argv[0]);
+			return 2;
+		}
+		else
+			scenarioFilePath = arg;
+	}
+
+	if (scenarioFilePath.empty() || noiseSeed == 0)
+	{
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	std::vector<GoldenScenario> scenarios;
+	std::string errorString;
+	if (!readScenarioFile(scenarioFilePath, scenarios, errorString))
+	{
+		fprintf(stderr, "%s\n", errorString.c_str());
+		return 2;
+	}
+
+	if (goldenDirectory.empty())
+		goldenDirectory = getDirectory(scenarioFilePath);
+	else if (goldenDirectory[goldenDirectory.size() - 1] != '/' && goldenDirectory[goldenDirectory.size() - 1] != '\\')
+		goldenDirectory += "/";
+	if (!failureDirectory.empty() && failureDirectory[failureDirectory.size() - 1] != '/' && failureDirectory[failureDirectory.size() - 1] != '\\')
+		failureDirectory += "/";
+
+	// --- every noise source is seeded from this and its stream index, so a render only changes when the DSP does
+	setSynthNoiseSeed(noiseSeed);
+
+	OfflineHost host;
+	uint32_t numFailures = 0;
+
+	for (const GoldenScenario& scenario : scenarios)
+	{
+		std::vector<std::vector<float>> render;
+		std::string goldenFilePath = goldenDirectory + scenario.name + ".wav";
+
+		if (!host.renderMidiFile(scenario.midiFilePath, scenario.settings, render))
+		{
+			printf("ERROR  %-20s %s\n", scenario.name.c_str(), host.getErrorString().c_str());
+			numFailures++;
+			continue;
+		}
+
+		if (update)
+		{
+			if (!writeRender(goldenFilePath, render, scenario.settings.sampleRate))
+			{
+				printf("ERROR  %-20s cannot write %s\n", scenario.name.c_str(), goldenFilePath.c_str());
+				numFailures++;
+			}
+			else
+				printf("WROTE  %-20s %s\n", scenario.name.c_str(), goldenFilePath.c_str());
+			continue;
+		}
+
+		WavFileReader golden;
+		if (!golden.readWavFile(goldenFilePath.c_str()))
+		{
+			printf("ERROR  %-20s %s: %s (run with --update to create it)\n", scenario.name.c_str(), goldenFilePath.c_str(), golden.getErrorString().c_str());
+			numFailures++;
+			continue;
+		}
+
+		const GoldenTolerance& tolerance = scenario.hasTolerance ? scenario.tolerance : defaultTolerance;
+		GoldenResult result = compareWithGolden(render, golden, tolerance, scenario.settings.sampleRate);
+
+		const char* measureUnits = tolerance.mode == goldenCompareMode::kSpectral ? "dB spectral" : "dBFS peak error";
+		if (result.passed)
+			printf("PASS   %-20s %8.1f %s\n", scenario.name.c_str(), result.measure, measureUnits);
+		else
+		{
+			numFailures++;
+			if (result.measure == -INFINITY) // --- format or length mismatch, nothing was measured
+				printf("FAIL   %-20s %s\n", scenario.name.c_str(), result.message.c_str());
+			else
+				printf("FAIL   %-20s %8.1f %s at %.3f s: %s\n", scenario.name.c_str(), result.measure, measureUnits, result.worstTime_Sec, result.message.c_str());
+
+			std::string failureFilePath = failureDirectory + scenario.name + ".wav";
+			if (!failureDirectory.empty() && !writeRender(failureFilePath, render, scenario.settings.sampleRate))
+				printf("       %-20s cannot write %s\n", scenario.name.c_str(), failureFilePath.c_str());
+		}
+	}
+
+	printf("%u of %u scenarios %s\n", (uint32_t)scenarios.size() - numFailures, (uint32_t)scenarios.size(), update ? "written" : "passed");
+	return numFailures > 0 ? 1 : 0;
+}
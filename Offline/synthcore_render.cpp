@@ -0,0 +1,270 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  synthcore_render.cpp
+//
+/**
+    \file   synthcore_render.cpp
+    \brief  command line front end for the headless offline renderer
+
+    usage: synthcore_render [options] file.mid [file.mid ...]
+    see printUsage() for the options; files are rendered in parallel, one PluginCore per file
+*/
+// -----------------------------------------------------------------------------
+#include "offlinehost.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+// --- print the command line help
+static void printUsage(const char* programName)
+{
+	printf("usage: %s [options] file.mid [file.mid ...]\n"
+		"  -o, --output-dir DIR    write the WAV files here (default: next to each MIDI file)\n"
+		"  -p, --preset FILE       .spf preset or a list of controlID:value lines\n"
+		"  -P, --param ID=VALUE    set one parameter (actual value) after the preset; repeatable\n"
+		"  -r, --sample-rate HZ    sample rate (default 48000)\n"
+		"  -b, --block-size N      frames per buffer (default 512)\n"
+		"  -c, --channels N        1 = mono, 2 = stereo (default 2)\n"
+		"  -f, --format F          16, 24 or 32f (default 24)\n"
+		"  -t, --tail SECONDS      render time after the last MIDI event (default 2)\n"
+		"  -v, --vector A,B,C,D    vector joystick oscillator blend (default 0.25,0.25,0.25,0.25)\n"
+		"  -s, --seed N            fixed noise seed for repeatable renders (default 0 = random)\n"
+		"  -j, --jobs N            worker threads (default: one per core)\n"
+		"  --perf csv|json         write engine timings/voice counts per block next to each WAV (name.perf.csv/.json)\n"
+		"  --perf-detail D         block, voice or component (default component); use -j 1 for clean timings\n"
+		"  --trace LEVEL           log engine MIDI events to stderr: warning, info (notes, steals) or verbose (+ CCs)\n"
+		"  --fx SLOTS              master FX slots to switch on, e.g. chorus,reverb: phaser, chorus, delay, reverb,\n"
+		"                          convolution, compressor, limiter\n"
+		"  --ir SPEC               convolution slot impulse response: a WAV file at the render rate, or noise:SECONDS\n"
+		"  -q, --quiet             only report errors\n"
+		"  -h, --help              this text\n", programName);
+}
+
+// --- output path: output dir (or the MIDI file's dir) + MIDI file name with a .wav extension
+static std::string makeOutputPath(const std::string& midiFilePath, const std::string& outputDirectory)
+{
+	std::string fileName = midiFilePath;
+	size_t slash = midiFilePath.find_last_of("/\\");
+	if (!outputDirectory.empty() && slash != std::string::npos)
+		fileName = midiFilePath.substr(slash + 1);
+
+	size_t dot = fileName.find_last_of('.');
+	size_t nameStart = fileName.find_last_of("/\\");
+	if (dot != std::string::npos && (nameStart == std::string::npos || dot > nameStart))
+		fileName = fileName.substr(0, dot);
+	fileName += ".wav";
+
+	if (outputDirectory.empty())
+		return fileName;
+
+	char last = outputDirectory[outputDirectory.size() - 1];
+	return outputDirectory + (last == '/' || last == '\\' ? "" : "/") + fileName;
+}
+
+int main(int argc, char* argv[])
+{
+	OfflineRenderSettings settings;
+	std::string outputDirectory;
+	std::vector<std::string> midiFiles;
+	uint32_t numJobs = std::thread::hardware_concurrency();
+	bool quiet = false;
+	std::string perfLogFormat;
+	perfDetail perfLogDetail = perfDetail::kComponent;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "-h" || arg == "--help")
+		{
+			printUsage(argv[0]);
+			return 0;
+		}
+		else if (arg == "-q" || arg == "--quiet")
+			quiet = true;
+		else if ((arg == "-o" || arg == "--output-dir") && hasValue)
+			outputDirectory = argv[++i];
+		else if ((arg == "-p" || arg == "--preset") && hasValue)
+			settings.presetPath = argv[++i];
+		else if ((arg == "-P" || arg == "--param") && hasValue)
+		{
+			std::string assignment = argv[++i];
+			size_t equals = assignment.find('=');
+			if (equals == std::string::npos)
+			{
+				fprintf(stderr, "bad parameter '%s', expected ID=VALUE\n", assignment.c_str());
+				return 2;
+			}
+			settings.parameters.push_back(std::make_pair((uint32_t)strtoul(assignment.substr(0, equals).c_str(), nullptr, 10),
+														 strtod(assignment.substr(equals + 1).c_str(), nullptr)));
+		}
+		else if ((arg == "-r" || arg == "--sample-rate") && hasValue)
+			settings.sampleRate = strtod(argv[++i], nullptr);
+		else if ((arg == "-b" || arg == "--block-size") && hasValue)
+			settings.blockSize = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		else if ((arg == "-c" || arg == "--channels") && hasValue)
+			settings.numChannels = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		else if ((arg == "-t" || arg == "--tail") && hasValue)
+			settings.tailSeconds = strtod(argv[++i], nullptr);
+		else if ((arg == "-v" || arg == "--vector") && hasValue)
+		{
+			double blend[4] = { 0.0, 0.0, 0.0, 0.0 };
+			if (sscanf(argv[++i], "%lf,%lf,%lf,%lf", &blend[0], &blend[1], &blend[2], &blend[3]) != 4)
+			{
+				fprintf(stderr, "bad vector blend '%s', expected A,B,C,D\n", argv[i]);
+				return 2;
+			}
+			settings.vectorJoystick = VectorJoystickData(blend[0], blend[1], blend[2], blend[3], blend[0] + blend[2], blend[1] + blend[3]);
+		}
+		else if ((arg == "-s" || arg == "--seed") && hasValue)
+			setSynthNoiseSeed((uint32_t)strtoul(argv[++i], nullptr, 10));
+		else if ((arg == "-j" || arg == "--jobs") && hasValue)
+			numJobs = (uint32_t)strtoul(argv[++i], nullptr, 10);
+		else if (arg == "--perf" && hasValue)
+		{
+			perfLogFormat = argv[++i];
+			if (perfLogFormat != "csv" && perfLogFormat != "json")
+			{
+				fprintf(stderr, "unknown perf log format '%s'\n", perfLogFormat.c_str());
+				return 2;
+			}
+		}
+		else if (arg == "--trace" && hasValue)
+		{
+			std::string level = argv[++i];
+			if (level == "warning")
+				settings.traceLogLevel = traceLevel::kWarning;
+			else if (level == "info")
+				settings.traceLogLevel = traceLevel::kInfo;
+			else if (level == "verbose")
+				settings.traceLogLevel = traceLevel::kVerbose;
+			else
+			{
+				fprintf(stderr, "unknown trace level '%s'\n", level.c_str());
+				return 2;
+			}
+		}
+		else if (arg == "--fx" && hasValue)
+		{
+			if (!OfflineHost::enableMasterFXSlots(argv[++i], settings.parameters))
+			{
+				fprintf(stderr, "unknown master FX slot in '%s'\n", argv[i]);
+				return 2;
+			}
+		}
+		else if (arg == "--ir" && hasValue)
+			settings.impulseResponse = argv[++i];
+		else if (arg == "--perf-detail" && hasValue)
+		{
+			std::string detail = argv[++i];
+			if (detail == "block")
+				perfLogDetail = perfDetail::kBlock;
+			else if (detail == "voice")
+				perfLogDetail = perfDetail::kVoice;
+			else if (detail == "component")
+				perfLogDetail = perfDetail::kComponent;
+			else
+			{
+				fprintf(stderr, "unknown perf detail '%s'\n", detail.c_str());
+				return 2;
+			}
+		}
+		else if ((arg == "-f" || arg == "--format") && hasValue)
+		{
+			std::string format = argv[++i];
+			if (format == "16")
+				settings.sampleFormat = wavSampleFormat::kPCM16;
+			else if (format == "24")
+				settings.sampleFormat = wavSampleFormat::kPCM24;
+			else if (format == "32f")
+				settings.sampleFormat = wavSampleFormat::kFloat32;
+			else
+			{
+				fprintf(stderr, "unknown format '%s'\n", format.c_str());
+				return 2;
+			}
+		}
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			fprintf(stderr, "unknown option '%s'\n", arg.c_str());
+			printUsage(argv[0]);
+			return 2;
+		}
+		else
+			midiFiles.push_back(arg);
+	}
+
+	if (midiFiles.empty())
+	{
+		printUsage(argv[0]);
+		return 2;
+	}
+
+	if (settings.sampleRate < 8000.0 || settings.blockSize == 0 || settings.numChannels < 1 || settings.numChannels > 2)
+	{
+		fprintf(stderr, "invalid sample rate, block size or channel count\n");
+		return 2;
+	}
+
+	if (!perfLogFormat.empty())
+		settings.perfDetailLevel = perfLogDetail;
+
+	if (numJobs == 0)
+		numJobs = 1;
+	if (numJobs > midiFiles.size())
+		numJobs = (uint32_t)midiFiles.size();
+
+	// --- simple work queue: each worker pulls the next file index
+	std::atomic<size_t> nextFile(0);
+	std::atomic<uint32_t> numFailures(0);
+	std::mutex printMutex;
+
+	auto worker = [&]()
+	{
+		OfflineHost host;
+		for (size_t index = nextFile++; index < midiFiles.size(); index = nextFile++)
+		{
+			const std::string& midiFilePath = midiFiles[index];
+			std::string wavFilePath = makeOutputPath(midiFilePath, outputDirectory);
+
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			bool success = host.renderMidiFile(midiFilePath, wavFilePath, settings);
+			double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			// --- name.wav -> name.perf.csv (or .json)
+			std::string perfLogPath = wavFilePath.substr(0, wavFilePath.size() - 4) + ".perf." + perfLogFormat;
+			bool perfLogFailed = success && !perfLogFormat.empty() && !OfflineHost::writePerfLog(perfLogPath, host.getPerfFrames(), perfLogFormat == "json");
+
+			std::lock_guard<std::mutex> lock(printMutex);
+			if (!success)
+			{
+				numFailures++;
+				fprintf(stderr, "FAILED %s: %s\n", midiFilePath.c_str(), host.getErrorString().c_str());
+			}
+			else if (perfLogFailed)
+			{
+				numFailures++;
+				fprintf(stderr, "FAILED %s: cannot write %s\n", midiFilePath.c_str(), perfLogPath.c_str());
+			}
+			else if (!quiet)
+			{
+				printf("%s -> %s (%.2f s audio in %.2f s, %.1fx real time)\n", midiFilePath.c_str(), wavFilePath.c_str(),
+					host.getRenderedSeconds(), elapsed, elapsed > 0.0 ? host.getRenderedSeconds() / elapsed : 0.0);
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 1; i < numJobs; i++)
+		workers.push_back(std::thread(worker));
+	worker();
+	for (std::thread& thread : workers)
+		thread.join();
+
+	return numFailures > 0 ? 1 : 0;
+}
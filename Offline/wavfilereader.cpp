@@ -0,0 +1,139 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  wavfilereader.cpp
+//
+/**
+    \file   wavfilereader.cpp
+    \brief  WAV file reader for the golden-output regression harness
+*/
+// -----------------------------------------------------------------------------
+#include "wavfilereader.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// --- little-endian helpers; the file layout does not depend on the host byte order
+static uint16_t getLittleEndian16(const uint8_t* source)
+{
+	return (uint16_t)(source[0] | (source[1] << 8));
+}
+
+static uint32_t getLittleEndian32(const uint8_t* source)
+{
+	return (uint32_t)source[0] | ((uint32_t)source[1] << 8) | ((uint32_t)source[2] << 16) | ((uint32_t)source[3] << 24);
+}
+
+/**
+\brief read the file
+
+\param filePath input path
+\return true if the file was read; see getErrorString() otherwise
+*/
+bool WavFileReader::readWavFile(const char* filePath)
+{
+	channels.clear();
+	sampleRate = 0;
+	errorString.clear();
+
+	FILE* file = fopen(filePath, "rb");
+	if (!file)
+	{
+		errorString = "cannot open file";
+		return false;
+	}
+
+	std::vector<uint8_t> fileData;
+	uint8_t readBuffer[65536];
+	size_t bytesRead = 0;
+	while ((bytesRead = fread(readBuffer, 1, sizeof(readBuffer), file)) > 0)
+		fileData.insert(fileData.end(), readBuffer, readBuffer + bytesRead);
+	fclose(file);
+
+	if (fileData.size() < 12 || memcmp(&fileData[0], "RIFF", 4) != 0 || memcmp(&fileData[8], "WAVE", 4) != 0)
+	{
+		errorString = "not a RIFF/WAVE file";
+		return false;
+	}
+
+	// --- walk the chunks for fmt and data
+	uint16_t formatTag = 0;
+	uint16_t numChannels = 0;
+	uint16_t bitsPerSample = 0;
+	const uint8_t* audioData = nullptr;
+	uint32_t audioBytes = 0;
+
+	size_t position = 12;
+	while (position + 8 <= fileData.size())
+	{
+		const uint8_t* chunk = &fileData[position];
+		uint32_t chunkSize = getLittleEndian32(chunk + 4);
+		size_t available = fileData.size() - position - 8;
+		if (chunkSize > available)
+			chunkSize = (uint32_t)available; // --- tolerate an unpatched or truncated final chunk
+
+		if (memcmp(chunk, "fmt ", 4) == 0 && chunkSize >= 16)
+		{
+			formatTag = getLittleEndian16(chunk + 8);
+			numChannels = getLittleEndian16(chunk + 10);
+			sampleRate = getLittleEndian32(chunk + 12);
+			bitsPerSample = getLittleEndian16(chunk + 22);
+
+			// --- WAVE_FORMAT_EXTENSIBLE: the real format is the first two bytes of the sub-format GUID
+			if (formatTag == 0xFFFE && chunkSize >= 40)
+				formatTag = getLittleEndian16(chunk + 32);
+		}
+		else if (memcmp(chunk, "data", 4) == 0)
+		{
+			audioData = chunk + 8;
+			audioBytes = chunkSize;
+		}
+
+		position += 8 + chunkSize + (chunkSize & 1); // --- chunks are word aligned
+	}
+
+	if (numChannels == 0 || !audioData)
+	{
+		errorString = "missing fmt or data chunk";
+		return false;
+	}
+
+	bool isFloat = formatTag == 3 && bitsPerSample == 32;
+	bool isPCM = formatTag == 1 && (bitsPerSample == 16 || bitsPerSample == 24 || bitsPerSample == 32);
+	if (!isFloat && !isPCM)
+	{
+		errorString = "unsupported sample format";
+		return false;
+	}
+
+	uint32_t bytesPerSample = bitsPerSample / 8;
+	uint64_t numFrames = audioBytes / (bytesPerSample * numChannels);
+	channels.assign(numChannels, std::vector<float>((size_t)numFrames, 0.f));
+
+	const uint8_t* source = audioData;
+	for (uint64_t frame = 0; frame < numFrames; frame++)
+	{
+		for (uint32_t channel = 0; channel < numChannels; channel++)
+		{
+			float sample = 0.f;
+			if (isFloat)
+			{
+				uint32_t bits = getLittleEndian32(source);
+				memcpy(&sample, &bits, sizeof(sample));
+			}
+			else if (bitsPerSample == 16)
+				sample = (float)((int16_t)getLittleEndian16(source) / 32767.0);
+			else if (bitsPerSample == 24)
+			{
+				// --- sign-extend the 24 bit value through the top of a 32 bit word
+				int32_t value = (int32_t)(((uint32_t)source[0] << 8) | ((uint32_t)source[1] << 16) | ((uint32_t)source[2] << 24)) >> 8;
+				sample = (float)(value / 8388607.0);
+			}
+			else
+				sample = (float)((int32_t)getLittleEndian32(source) / 2147483647.0);
+
+			channels[channel][(size_t)frame] = sample;
+			source += bytesPerSample;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  wavfilereader.h
+//
+/**
+    \file   wavfilereader.h
+    \brief  WAV file reader for the golden-output regression harness
+*/
+// -----------------------------------------------------------------------------
+#ifndef __wavFileReader_h__
+#define __wavFileReader_h__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+\class WavFileReader
+\ingroup Offline
+\brief
+Reads a whole RIFF/WAVE file into non-interleaved float channels.
+
+Operation:
+- 16, 24 and 32 bit PCM and 32 bit IEEE float, including WAVE_FORMAT_EXTENSIBLE headers
+- PCM is scaled to [-1, +1) with the same factors WavFileWriter uses, so float files round-trip exactly
+*/
+class WavFileReader
+{
+public:
+	WavFileReader() {}
+
+	/** read the file
+	\param filePath input path
+	\return true if the file was read; see getErrorString() otherwise
+	*/
+	bool readWavFile(const char* filePath);
+
+	/** the audio, one vector per channel */
+	const std::vector<std::vector<float>>& getChannels() const { return channels; }
+
+	/** sample rate in Hz */
+	uint32_t getSampleRate() const { return sampleRate; }
+
+	/** channel count */
+	uint32_t getNumChannels() const { return (uint32_t)channels.size(); }
+
+	/** frames per channel */
+	uint64_t getNumFrames() const { return channels.empty() ? 0 : channels[0].size(); }
+
+	/** description of the last failure */
+	const std::string& getErrorString() const { return errorString; }
+
+protected:
+	std::vector<std::vector<float>> channels;	///< decoded audio
+	uint32_t sampleRate = 0;					///< sample rate
+	std::string errorString;					///< last failure
+};
+
+#endif
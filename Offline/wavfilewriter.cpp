@@ -0,0 +1,175 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  wavfilewriter.cpp
+//
+/**
+    \file   wavfilewriter.cpp
+    \brief  streaming WAV file writer for the headless offline renderer
+*/
+// -----------------------------------------------------------------------------
+#include "wavfilewriter.h"
+
+#include <string.h>
+
+// --- little-endian helpers; the file layout does not depend on the host byte order
+static void putLittleEndian16(uint8_t* destination, uint16_t value)
+{
+	destination[0] = (uint8_t)(value & 0xFF);
+	destination[1] = (uint8_t)(value >> 8);
+}
+
+static void putLittleEndian32(uint8_t* destination, uint32_t value)
+{
+	destination[0] = (uint8_t)(value & 0xFF);
+	destination[1] = (uint8_t)((value >> 8) & 0xFF);
+	destination[2] = (uint8_t)((value >> 16) & 0xFF);
+	destination[3] = (uint8_t)(value >> 24);
+}
+
+/**
+\brief create the file and write the header
+
+\param filePath output path
+\param _sampleRate sample rate in Hz
+\param _numChannels channel count
+\param _format sample format
+\return true if the file was created
+*/
+bool WavFileWriter::openWavFile(const char* filePath, uint32_t _sampleRate, uint32_t _numChannels, wavSampleFormat _format)
+{
+	closeWavFile();
+
+	if (_numChannels == 0)
+		return false;
+
+	sampleRate = _sampleRate;
+	numChannels = _numChannels;
+	format = _format;
+	framesWritten = 0;
+
+	switch (format)
+	{
+		case wavSampleFormat::kPCM16: bytesPerSample = 2; break;
+		case wavSampleFormat::kPCM24: bytesPerSample = 3; break;
+		case wavSampleFormat::kFloat32: bytesPerSample = 4; break;
+	}
+
+	file = fopen(filePath, "wb");
+	if (!file)
+		return false;
+
+	return writeHeader();
+}
+
+/**
+\brief (re)write the RIFF, fmt and data chunk headers; sizes come from framesWritten
+
+\return true if the header was written
+*/
+bool WavFileWriter::writeHeader()
+{
+	if (!file)
+		return false;
+
+	uint32_t blockAlign = numChannels * bytesPerSample;
+	uint64_t dataBytes64 = framesWritten * blockAlign;
+	uint32_t dataBytes = dataBytes64 > 0xFFFFFFFFull - 36 ? 0xFFFFFFFFu - 36 : (uint32_t)dataBytes64;
+
+	uint8_t header[44] = { 0 };
+	memcpy(header, "RIFF", 4);
+	putLittleEndian32(header + 4, 36 + dataBytes);
+	memcpy(header + 8, "WAVE", 4);
+
+	memcpy(header + 12, "fmt ", 4);
+	putLittleEndian32(header + 16, 16);
+	putLittleEndian16(header + 20, format == wavSampleFormat::kFloat32 ? 3 : 1); // --- 3 = IEEE float, 1 = PCM
+	putLittleEndian16(header + 22, (uint16_t)numChannels);
+	putLittleEndian32(header + 24, sampleRate);
+	putLittleEndian32(header + 28, sampleRate * blockAlign);
+	putLittleEndian16(header + 32, (uint16_t)blockAlign);
+	putLittleEndian16(header + 34, (uint16_t)(bytesPerSample * 8));
+
+	memcpy(header + 36, "data", 4);
+	putLittleEndian32(header + 40, dataBytes);
+
+	if (fseek(file, 0, SEEK_SET) != 0)
+		return false;
+	if (fwrite(header, 1, sizeof(header), file) != sizeof(header))
+		return false;
+
+	return fseek(file, 0, SEEK_END) == 0;
+}
+
+/**
+\brief write one block of non-interleaved audio
+
+\param channels array of numChannels channel pointers
+\param numFrames frames in the block
+\return true if the block was written
+*/
+bool WavFileWriter::writeFrames(float** channels, uint32_t numFrames)
+{
+	if (!file)
+		return false;
+
+	size_t numBytes = (size_t)numFrames * numChannels * bytesPerSample;
+	if (interleaveBuffer.size() < numBytes)
+		interleaveBuffer.resize(numBytes);
+
+	uint8_t* destination = interleaveBuffer.data();
+	for (uint32_t frame = 0; frame < numFrames; frame++)
+	{
+		for (uint32_t channel = 0; channel < numChannels; channel++)
+		{
+			float sample = channels[channel][frame];
+
+			if (format == wavSampleFormat::kFloat32)
+			{
+				uint32_t bits = 0;
+				memcpy(&bits, &sample, sizeof(bits));
+				putLittleEndian32(destination, bits);
+			}
+			else
+			{
+				if (sample > 1.f) sample = 1.f;
+				if (sample < -1.f) sample = -1.f;
+
+				if (format == wavSampleFormat::kPCM16)
+				{
+					int32_t value = (int32_t)(sample * 32767.f + (sample >= 0.f ? 0.5f : -0.5f));
+					putLittleEndian16(destination, (uint16_t)(int16_t)value);
+				}
+				else
+				{
+					int32_t value = (int32_t)((double)sample * 8388607.0 + (sample >= 0.f ? 0.5 : -0.5));
+					destination[0] = (uint8_t)(value & 0xFF);
+					destination[1] = (uint8_t)((value >> 8) & 0xFF);
+					destination[2] = (uint8_t)((value >> 16) & 0xFF);
+				}
+			}
+			destination += bytesPerSample;
+		}
+	}
+
+	if (fwrite(interleaveBuffer.data(), 1, numBytes, file) != numBytes)
+		return false;
+
+	framesWritten += numFrames;
+	return true;
+}
+
+/**
+\brief patch the header and close the file
+
+\return true if the file was finalized
+*/
+bool WavFileWriter::closeWavFile()
+{
+	if (!file)
+		return false;
+
+	bool success = writeHeader();
+	success = fclose(file) == 0 && success;
+	file = nullptr;
+
+	return success;
+}
@@ -0,0 +1,80 @@
+// -----------------------------------------------------------------------------
+//    SynthCore Offline File:  wavfilewriter.h
+//
+/**
+    \file   wavfilewriter.h
+    \brief  streaming WAV file writer for the headless offline renderer
+*/
+// -----------------------------------------------------------------------------
+#ifndef __wavFileWriter_h__
+#define __wavFileWriter_h__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/**
+\enum wavSampleFormat
+\ingroup Offline
+\brief
+Output sample formats.
+
+- enum class wavSampleFormat { kPCM16, kPCM24, kFloat32 };
+*/
+enum class wavSampleFormat { kPCM16, kPCM24, kFloat32 };
+
+/**
+\class WavFileWriter
+\ingroup Offline
+\brief
+Writes non-interleaved float blocks to a RIFF/WAVE file as they are rendered.
+
+Operation:
+- openWavFile() writes a placeholder header
+- writeFrames() interleaves, converts and writes one block; PCM output is clipped to [-1, +1]
+- closeWavFile() patches the chunk sizes; it is also called by the destructor
+*/
+class WavFileWriter
+{
+public:
+	WavFileWriter() {}
+	~WavFileWriter() { closeWavFile(); }
+
+	/** create the file and write the header
+	\param filePath output path
+	\param sampleRate sample rate in Hz
+	\param numChannels channel count
+	\param format sample format
+	\return true if the file was created
+	*/
+	bool openWavFile(const char* filePath, uint32_t sampleRate, uint32_t numChannels, wavSampleFormat format);
+
+	/** write one block of non-interleaved audio
+	\param channels array of numChannels channel pointers
+	\param numFrames frames in the block
+	\return true if the block was written
+	*/
+	bool writeFrames(float** channels, uint32_t numFrames);
+
+	/** patch the header and close the file
+	\return true if the file was finalized
+	*/
+	bool closeWavFile();
+
+	/** frames written so far */
+	uint64_t getFramesWritten() const { return framesWritten; }
+
+protected:
+	/** (re)write the RIFF, fmt and data chunk headers */
+	bool writeHeader();
+
+	FILE* file = nullptr;						///< output file
+	uint32_t sampleRate = 44100;				///< sample rate
+	uint32_t numChannels = 2;					///< channel count
+	wavSampleFormat format = wavSampleFormat::kPCM24;	///< sample format
+	uint32_t bytesPerSample = 3;				///< bytes per sample
+	uint64_t framesWritten = 0;					///< frames written so far
+	std::vector<uint8_t> interleaveBuffer;		///< one block of interleaved output bytes
+};
+
+#endif
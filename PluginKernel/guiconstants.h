@@ -421,5 +421,182 @@ private:
 	smoothingMethod smootherType = smoothingMethod::kLPFSmoother; ///< smoothing type
 };
 
+/**
+\class BlockParamSmoother
+\ingroup ASPiK-Core
+\brief
+The BlockParamSmoother object smooths a whole bank of parameters once per sub-block instead of once per sample.
+State is held in contiguous arrays (structure-of-arrays) and only parameters that are still moving are visited.
+
+- LPF smoothing uses the closed-form block step: end = target + (start - target)*a^N, with a^N cached per step size
+- linear smoothing steps N increments at once and clamps at the target
+- after advance(), the moved list holds the indexes that changed; the owner applies their values once per step, so
+  stepping every few dozen frames gives a staircase fine enough to stay free of zipper noise
+
+NOTE:
+- init() allocates and is NOT real-time safe; everything else is allocation-free
+*/
+class BlockParamSmoother
+{
+public:
+	BlockParamSmoother() {}
+
+	/** allocate storage for a bank of parameters (not real-time safe)
+	\param count number of smoothing slots
+	*/
+	void init(uint32_t count)
+	{
+		numSlots = count;
+		current.assign(count, 0.0);
+		target.assign(count, 0.0);
+		coeffA.assign(count, 0.0);
+		coeffAN.assign(count, 0.0);
+		linInc.assign(count, 0.0);
+		tolerance.assign(count, 0.0);
+		isLinear.assign(count, 0);
+		isActive.assign(count, 0);
+		activeList.assign(count, 0);
+		movedList.assign(count, 0);
+		numActive = 0;
+		numMoved = 0;
+		lastBlockSize = 0;
+	}
+
+	/** set the smoothing coefficients for one slot; see ParamSmoother for the coefficient calculations
+	\param index slot index
+	\param smoothingTimeInMs the smoothing time in mSec to move between the two control extrema (min and max values)
+	\param samplingRate the sampling rate
+	\param minControlValue minimum numerical value control takes
+	\param maxControlValue maximum numerical value control takes
+	\param smoother type of smoothing
+	*/
+	void setCoefficients(uint32_t index, double smoothingTimeInMs, double samplingRate,
+		double minControlValue, double maxControlValue,
+		smoothingMethod smoother = smoothingMethod::kLPFSmoother)
+	{
+		if (index >= numSlots) return;
+
+		double samples = smoothingTimeInMs * 0.001 * samplingRate;
+		if (samples < 1.0) samples = 1.0;
+
+		coeffA[index] = exp(-kTwoPi / samples);
+		linInc[index] = (maxControlValue - minControlValue) / samples;
+		isLinear[index] = smoother == smoothingMethod::kLinearSmoother ? 1 : 0;
+
+		// --- snap when within a millionth of the control range
+		tolerance[index] = 1.0e-6 * fabs(maxControlValue - minControlValue);
+
+		// --- force a^N recalculation on next block
+		lastBlockSize = 0;
+	}
+
+	/** jump immediately to a value with no smoothing
+	\param index slot index
+	\param value the new value
+	*/
+	void setValue(uint32_t index, double value)
+	{
+		if (index >= numSlots) return;
+		current[index] = value;
+		target[index] = value;
+
+		// --- an active slot is now at its target and drops off the active list on the next advance()
+	}
+
+	/** set a new smoothing target; the slot becomes active if the target changed
+	\param index slot index
+	\param value the new target value
+	*/
+	inline void setTarget(uint32_t index, double value)
+	{
+		target[index] = value;
+		if (!isActive[index] && current[index] != value)
+		{
+			isActive[index] = 1;
+			activeList[numActive++] = index;
+		}
+	}
+
+	/** advance all active slots by one step
+	\param numFrames step size in samples
+	\return true if at least one slot moved
+	*/
+	bool advance(uint32_t numFrames)
+	{
+		numMoved = 0;
+		if (numActive == 0 || numFrames == 0)
+			return false;
+
+		// --- a^N only changes with block size
+		if (numFrames != lastBlockSize)
+		{
+			for (uint32_t i = 0; i < numSlots; i++)
+				coeffAN[i] = pow(coeffA[i], (double)numFrames);
+			lastBlockSize = numFrames;
+		}
+
+		uint32_t stillActive = 0;
+
+		for (uint32_t n = 0; n < numActive; n++)
+		{
+			uint32_t i = activeList[n];
+			double start = current[i];
+			double end = target[i];
+
+			if (isLinear[i])
+			{
+				double step = linInc[i] * (double)numFrames;
+				if (end > start)
+					end = start + step < end ? start + step : end;
+				else
+					end = start - step > end ? start - step : end;
+			}
+			else
+			{
+				end = target[i] + (start - target[i]) * coeffAN[i];
+				if (fabs(end - target[i]) <= tolerance[i])
+					end = target[i];
+			}
+
+			current[i] = end;
+
+			if (end != start)
+				movedList[numMoved++] = i;
+
+			if (end != target[i])
+				activeList[stillActive++] = i;
+			else
+				isActive[i] = 0;
+		}
+		numActive = stillActive;
+
+		return numMoved > 0;
+	}
+
+	uint32_t getNumMoved() const { return numMoved; }								///< number of slots moved on last advance()
+	uint32_t getNumActive() const { return numActive; }							///< number of slots still moving
+	uint32_t getMovedIndex(uint32_t n) const { return movedList[n]; }				///< slot index of n-th moved slot
+	double getValue(uint32_t index) const { return current[index]; }				///< value at end of last step
+	bool getIsActive(uint32_t index) const { return isActive[index] != 0; }		///< still moving toward target
+	uint32_t getNumSlots() const { return numSlots; }								///< number of slots
+
+private:
+	std::vector<double> current;		///< value at end of last block
+	std::vector<double> target;			///< smoothing targets
+	std::vector<double> coeffA;			///< LPF per-sample coefficient
+	std::vector<double> coeffAN;		///< LPF per-block coefficient a^N
+	std::vector<double> linInc;			///< linear per-sample increment
+	std::vector<double> tolerance;		///< LPF snap-to-target tolerance
+	std::vector<uint8_t> isLinear;		///< smoothing type flags
+	std::vector<uint8_t> isActive;		///< active flags
+	std::vector<uint32_t> activeList;	///< compact list of active slots
+	std::vector<uint32_t> movedList;	///< compact list of slots moved in last block
+
+	uint32_t numSlots = 0;			///< slot count
+	uint32_t numActive = 0;			///< active slot count
+	uint32_t numMoved = 0;			///< moved slot count
+	uint32_t lastBlockSize = 0;		///< block size a^N was computed for
+};
+
 
 #endif
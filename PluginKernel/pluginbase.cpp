@@ -77,6 +77,9 @@ bool PluginBase::reset(ResetInfo& resetInfo)
 			piParam->updateSampleRate(resetInfo.sampleRate);
 	}
 
+	// --- update block smoother
+	initBlockParameterSmoothing(resetInfo.sampleRate);
+
 	return true;
 }
 
@@ -100,6 +103,7 @@ bool PluginBase::initialize(PluginInfo& _pluginInfo)
 Operation:
 - iterate through parameters and copy their values into the bound variables you set up
 - then, call the postUpdatePluginParameter method to do any post-update cooking required to use the variable for processing
+- NOTE: only bound variables whose values actually change are updated and posted
 */
 void PluginBase::syncInBoundVariables()
 {
@@ -110,7 +114,7 @@ void PluginBase::syncInBoundVariables()
 	// --- rip through and synch em
 	for (unsigned int i = 0; i < numPluginParameters; i++)
 	{
-		if (pluginParameterArray[i] && pluginParameterArray[i]->updateInBoundVariable())
+		if (pluginParameterArray[i] && pluginParameterArray[i]->updateInBoundVariableIfChanged())
 		{
 			postUpdatePluginParameter(pluginParameterArray[i]->getControlID(), pluginParameterArray[i]->getControlValue(), info);
 		}
@@ -133,6 +137,9 @@ Operation:
 */
 bool PluginBase::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
 {
+	// --- flush denormals to zero for the whole buffer; restored on return
+	DenormalGuard denormalGuard;
+
 	memset(&inputFrame, 0, sizeof(float)*MAX_CHANNEL_COUNT);
 	memset(&outputFrame, 0, sizeof(float)*MAX_CHANNEL_COUNT);
 	memset(&auxInputFrame, 0, sizeof(float)*MAX_CHANNEL_COUNT);
@@ -160,12 +167,26 @@ bool PluginBase::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
 		info.hostInfo = processBufferInfo.hostInfo;
 		info.midiEventQueue = processBufferInfo.midiEventQueue;
 
+		// --- VST3 automation: pull the queues once for the whole buffer
+		buildSampleAccurateAutomationRamps(processBufferInfo.numFramesToProcess);
+
+		// --- smoothing targets once for the whole buffer; the smoother is stepped per sub-block below
+		setBlockParameterSmoothingTargets();
+		uint32_t subBlock = getControlRateFrames();
+
 		// --- sync internal bound variables
 		preProcessAudioBuffers(processBufferInfo);
 
 		// --- build frames, one sample from each channel
 		for (uint32_t frame = 0; frame<processBufferInfo.numFramesToProcess; frame++)
 		{
+			// --- step the smoother at the top of each sub-block
+			if (frame % subBlock == 0)
+			{
+				uint32_t framesLeft = processBufferInfo.numFramesToProcess - frame;
+				doBlockParameterSmoothing(framesLeft < subBlock ? framesLeft : subBlock);
+			}
+
 			for (uint32_t i = 0; i<processBufferInfo.numAudioInChannels; i++)
 			{
 				inputFrame[i] = processBufferInfo.inputs[i][frame];
@@ -232,73 +253,267 @@ bool PluginBase::updateOutBoundVariables()
 
 
 /**
-\brief combines parameter smoothing and VST3 sample accurate updates
+\brief converts the VST3 parameter update queues into per-block automation ramps
+
+Operation:
+- iterate through the smoothable parameter list (double and float only)
+- for each parameter with a queue, read it at the first frame of each control-rate sub-block and at the last frame of
+  the block, and build a piecewise-linear ramp in actual (plain) units; those are the only frames the ramp is applied at
+- collinear values merge into one segment, so a linear VST3 segment still costs one breakpoint
+- only parameters whose ramp actually moves are placed on the compact automatedParameters list
+
+NOTE:
+- as before, normalized values are mapped without the control taper
+- a ramp holds kMaxAutomationRampPoints at a time; when the block has more sub-blocks, the rest is read as the ramp
+  plays (see fillAutomationRamp()), so no sub-block is dropped however long the block is
+
+\param numFrames the number of frames in the block
+*/
+void PluginBase::buildSampleAccurateAutomationRamps(uint32_t numFrames)
+{
+	numAutomatedParameters = 0;
+	automationBlockSize = numFrames;
+
+	if (numSmoothablePluginParameters == 0 || numFrames == 0 || !wantsVST3SampleAccurateAutomation() ||
+		automationRamps.size() != numSmoothablePluginParameters)
+		return;
+
+	for (unsigned int i = 0; i < numSmoothablePluginParameters; i++)
+	{
+		PluginParameter* piParam = smoothablePluginParameters[i];
+
+		// --- NOTE you can disable sample accurate automation for each parameter when you set them up if needed
+		if (!piParam || !piParam->getParameterUpdateQueue() || !piParam->getEnableVSTSampleAccurateAutomation())
+			continue;
+
+		ParameterAutomationRamp& ramp = automationRamps[i];
+		ramp.reset(piParam->getControlValue());
+
+		// --- the queue is read starting from the current normalized value
+		double range = piParam->getMaxValue() - piParam->getMinValue();
+		ramp.queueValue = range != 0.0 ? (piParam->getControlValue() - piParam->getMinValue()) / range : 0.0;
+
+		fillAutomationRamp(i);
+
+		if (ramp.isMoving())
+			automatedParameters[numAutomatedParameters++] = i;
+	}
+}
+
+/**
+\brief reads the next set of sub-block values from a parameter's queue into its ramp, starting where the last read stopped
+
+Operation:
+- getValueAtOffset() is called once per control-rate sub-block, plus once for the last frame of the block
+- stops when the ramp is full and flags the ramp so doSampleAccurateParameterUpdates() calls again at its last point
+
+\param slot the smoothable parameter / ramp slot
+*/
+void PluginBase::fillAutomationRamp(uint32_t slot)
+{
+	PluginParameter* piParam = smoothablePluginParameters[slot];
+	IParameterUpdateQueue* queue = piParam->getParameterUpdateQueue();
+	ParameterAutomationRamp& ramp = automationRamps[slot];
+
+	if (ramp.hasMorePoints)
+		ramp.continueFromLastPoint();
+	ramp.hasMorePoints = false;
+
+	uint32_t subBlock = getControlRateFrames();
+	uint32_t lastFrame = automationBlockSize - 1;
+	for (uint32_t frame = ramp.queuePosition; frame <= lastFrame; )
+	{
+		double nextValue = ramp.queueValue;
+		queue->getValueAtOffset(frame, ramp.queueValue, nextValue);
+		if (!ramp.addPoint(frame, piParam->getControlValueWithNormalizedValue(nextValue, false)))
+		{
+			ramp.queuePosition = frame;
+			ramp.hasMorePoints = true;
+			return;
+		}
+		ramp.queueValue = nextValue;
+
+		if (frame == lastFrame)
+			break;
+		frame = frame + subBlock < lastFrame ? frame + subBlock : lastFrame;
+	}
+	ramp.queuePosition = automationBlockSize;
+}
+
+/**
+\brief performs VST3 sample accurate updates from the per-block automation ramps
+
+Operation:
+- does nothing except on the first frame of each getControlRateFrames() sub-block
+- only the parameters on the compact automatedParameters list are visited
+- each sub-block gets the ramp value at its first frame; the last sub-block gets the value at the block's last frame,
+  so the block always ends on the queue's final value
+- a parameter whose ramp has passed its last point is dropped from the list for the rest of the block
 
 NOTE:
 - beware: this function can eat a lot of CPU if the sample accurate updates trigger complex cooking functions
-- to combat CPU usage, you can set the VST3 sample granularity in initPluginDescriptors() apiSpecificInfo.vst3SampleAccurateGranularity
-- you can also change the parameter smoothing granularity
-- but in either case, the list MUST be iterated; this function is the reason for the old-fashioned C-array of pointers\n
-  as it was found to be faster than any other list method for entire-list iteration (if you have a faster way, let me knmow!)
-- the parameter is updated with the smoothed value
+- to combat CPU usage, the parameters are only touched once per sub-block; set a coarser interval in initPluginDescriptors()
+  apiSpecificInfo.vst3SampleAccurateGranularity if that is still too often
+- parameter smoothing is no longer done here; see doBlockParameterSmoothing()
+- the parameter is updated with the new value
 - the post-parameter update function is then called (complex cooking functions here will eat the CPU as well)
+
+\param frame the frame in the block
+\return true if at least one parameter was updated on this frame
 */
-void PluginBase::doSampleAccurateParameterUpdates()
+bool PluginBase::doSampleAccurateParameterUpdates(uint32_t frame)
 {
-	if (numSmoothablePluginParameters == 0)
-		return;
+	if (numAutomatedParameters == 0)
+		return false;
+
+	uint32_t subBlock = getControlRateFrames();
+	if (frame % subBlock != 0)
+		return false;
+
+	// --- the last sub-block heads straight for the block-end value
+	if (frame + subBlock >= automationBlockSize)
+		frame = automationBlockSize - 1;
 
-	// --- do updates
-	double value = 0;
-	bool vstSAAutomated = false;
 	ParameterUpdateInfo vst3Update(false, true); /// false = this is NOT called from smoothing operation, true: this is a VST sample accurate update
 	vst3Update.isVSTSampleAccurateUpdate = true;
 
-	ParameterUpdateInfo paramSmoothUpdate(true, false); /// true = this is called from smoothing operation, false = NOT VST sample accurate update
-	paramSmoothUpdate.isSmoothing = true;
-
-	// --- rip through the array
-	for (unsigned int i = 0; i < numSmoothablePluginParameters; i++)
+	bool updated = false;
+	uint32_t n = 0;
+	while (n < numAutomatedParameters)
 	{
-		PluginParameter* piParam = smoothablePluginParameters[i];
-		if (piParam)
+		uint32_t index = automatedParameters[n];
+		ParameterAutomationRamp& ramp = automationRamps[index];
+		PluginParameter* piParam = smoothablePluginParameters[index];
+
+		// --- the ramp was full: read the rest of the queue once its last point is reached
+		while (ramp.needsRefill(frame))
+			fillAutomationRamp(index);
+
+		double value = ramp.getValueAtFrame(frame);
+		if (value != ramp.lastAppliedValue)
 		{
-			// --- VST sample accurate stuff
-			if (wantsVST3SampleAccurateAutomation())
-			{
-				// --- if we get here getParameterUpdateQueue() should be non-null
-				//     NOTE you can disable sample accurate automation for each parameter when you set them up if needed
-				if (piParam->getParameterUpdateQueue() && piParam->getEnableVSTSampleAccurateAutomation())
-				{
-					if (piParam->getParameterUpdateQueue()->getNextValue(value))
-					{
-						piParam->setControlValueNormalized(value, false, true); // false = do not apply taper, true = ignore smoothing (not needed here)
-						vstSAAutomated = true;
-
-						// --- now update the bound variable
-						if (piParam->updateInBoundVariable())
-						{
-							vst3Update.boundVariableUpdate = true;
-						}
-						postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), vst3Update);
-					}
-				}
-			}
+			ramp.lastAppliedValue = value;
+			piParam->setControlValue(value, true); // true = ignore smoothing (not needed here)
 
-			// --- do smoothing, but not if we did a sample accurate automation update!
-			if (!vstSAAutomated && piParam->smoothParameterValue())
+			// --- now update the bound variable
+			if (piParam->updateInBoundVariable())
 			{
-				// --- update bound variable, if there is one
-				if (piParam->updateInBoundVariable())
-				{
-					paramSmoothUpdate.boundVariableUpdate = true;
-				}
-				postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), paramSmoothUpdate);
+				vst3Update.boundVariableUpdate = true;
 			}
+			postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), vst3Update);
+			updated = true;
 		}
+
+		// --- done for this block: swap-remove
+		if (ramp.isFinished())
+			automatedParameters[n] = automatedParameters[--numAutomatedParameters];
+		else
+			n++;
+	}
+	return updated;
+}
+
+/**
+\brief (re)initializes the block smoother
+
+Operation:
+- recalculate coefficients for each smoothable parameter
+- snap the smoother state to the parameter's current value (no smoothing across a reset)
+
+\param sampleRate the current sample rate
+*/
+void PluginBase::initBlockParameterSmoothing(double sampleRate)
+{
+	if (blockParamSmoother.getNumSlots() != numSmoothablePluginParameters)
+		blockParamSmoother.init(numSmoothablePluginParameters);
+
+	for (unsigned int i = 0; i < numSmoothablePluginParameters; i++)
+	{
+		PluginParameter* piParam = smoothablePluginParameters[i];
+		if (!piParam) continue;
+
+		blockParamSmoother.setCoefficients(i, piParam->getSmoothingTimeMsec(), sampleRate,
+										   piParam->getMinValue(), piParam->getMaxValue(),
+										   piParam->getSmoothingMethod());
+		blockParamSmoother.setValue(i, piParam->getControlValue());
 	}
 }
 
+/**
+\brief pushes the smoothing targets into the block smoother; call once per block, before doBlockParameterSmoothing()
+
+Operation:
+- push each smoothing-enabled parameter's target into the block smoother
+
+NOTE:
+- parameters driven by VST3 sample accurate automation are skipped here, as before
+*/
+void PluginBase::setBlockParameterSmoothingTargets()
+{
+	if (numSmoothablePluginParameters == 0 || blockParamSmoother.getNumSlots() != numSmoothablePluginParameters)
+		return;
+
+	bool vst3SA = wantsVST3SampleAccurateAutomation();
+
+	// --- push targets
+	for (unsigned int i = 0; i < numSmoothablePluginParameters; i++)
+	{
+		PluginParameter* piParam = smoothablePluginParameters[i];
+		if (!piParam || !piParam->getParameterSmoothing())
+			continue;
+
+		if (vst3SA && piParam->getParameterUpdateQueue() && piParam->getEnableVSTSampleAccurateAutomation())
+			continue;
+
+		// --- a settled slot picks up any direct (unsmoothed) writes before heading to the new target
+		if (!blockParamSmoother.getIsActive(i))
+			blockParamSmoother.setValue(i, piParam->getControlValue());
+
+		blockParamSmoother.setTarget(i, piParam->getSmoothingTarget());
+	}
+}
+
+/**
+\brief smooths all smoothable parameters by one control-rate sub-block
+
+Operation:
+- advance the smoother by the sub-block size; only parameters still moving are visited
+- for each parameter that moved: write the sub-block-end value, update the bound variable and post ONE update
+- the caller steps every getControlRateFrames() frames, so a long buffer gets a fine staircase instead of one jump
+
+\param numFrames the number of frames in the sub-block
+\return true if at least one parameter moved
+*/
+bool PluginBase::doBlockParameterSmoothing(uint32_t numFrames)
+{
+	if (numSmoothablePluginParameters == 0 || blockParamSmoother.getNumSlots() != numSmoothablePluginParameters)
+		return false;
+
+	// --- smooth
+	if (!blockParamSmoother.advance(numFrames))
+		return false;
+
+	ParameterUpdateInfo paramSmoothUpdate(true, false); /// true = this is called from smoothing operation, false = NOT VST sample accurate update
+	paramSmoothUpdate.isSmoothing = true;
+
+	// --- write back only what moved
+	for (uint32_t n = 0; n < blockParamSmoother.getNumMoved(); n++)
+	{
+		uint32_t index = blockParamSmoother.getMovedIndex(n);
+		PluginParameter* piParam = smoothablePluginParameters[index];
+
+		piParam->setSmoothedControlValue(blockParamSmoother.getValue(index));
+
+		// --- update bound variable, if there is one
+		if (piParam->updateInBoundVariable())
+		{
+			paramSmoothUpdate.boundVariableUpdate = true;
+		}
+		postUpdatePluginParameter(piParam->getControlID(), piParam->getControlValue(), paramSmoothUpdate);
+	}
+	return true;
+}
+
 /**
 \brief adds a new plugin parameter to the parameter map
 
@@ -840,6 +1055,14 @@ void PluginBase::initPluginParameterArray()
 		}
 	}
 
+	// --- block smoother slots mirror the smoothable array
+	initBlockParameterSmoothing(audioProcDescriptor.sampleRate);
+
+	// --- as do the automation ramps
+	automationRamps.assign(numSmoothablePluginParameters, ParameterAutomationRamp());
+	automatedParameters.assign(numSmoothablePluginParameters, 0);
+	numAutomatedParameters = 0;
+
 	if (outboundPluginParameters)
 		delete[] outboundPluginParameters;
 
@@ -268,8 +268,29 @@ public:
 	/** ASPiK midi event system: base class implementation is empty */
 	virtual bool processMIDIEvent(midiEvent& event) { return true; }
 
-	/** perform parameter smoothing or VST3 sample accurate upates */
-	void doSampleAccurateParameterUpdates();
+	/** apply the VST3 automation ramps at one frame; only the first frame of each control-rate sub-block does any work; true if any parameter changed */
+	bool doSampleAccurateParameterUpdates(uint32_t frame);
+
+	/** convert VST3 parameter update queues into per-block piecewise-linear ramps */
+	void buildSampleAccurateAutomationRamps(uint32_t numFrames);
+
+	/** read the next set of points from one parameter's queue into its ramp */
+	void fillAutomationRamp(uint32_t slot);
+
+	/** true if any VST3 automation ramp is still moving in this block */
+	bool hasSampleAccurateAutomation() { return numAutomatedParameters > 0; }
+
+	/** push the smoothing targets into the block smoother, once per block */
+	void setBlockParameterSmoothingTargets();
+
+	/** step parameter smoothing by one control-rate sub-block and apply the values; true if any parameter moved */
+	bool doBlockParameterSmoothing(uint32_t numFrames);
+
+	/** true while any smoothed parameter is still moving toward its target */
+	bool isSmoothingParameters() { return blockParamSmoother.getNumActive() > 0; }
+
+	/** (re)calculate the block smoother coefficients and snap its state to the current parameter values */
+	void initBlockParameterSmoothing(double sampleRate);
 
 	/** only for a vector joystick control from DAW that implements it (reserved for future use): base class implementation is empty */
 	virtual bool setVectorJoystickParameters(const VectorJoystickData& vectorJoysickData) { return true; }
@@ -563,6 +584,17 @@ public:
 	*/
 	uint32_t getVST3SampleAccuracyGranularity() { return apiSpecificInfo.vst3SampleAccurateGranularity; }
 
+	/**
+	\brief control-rate sub-block size: kControlRateFrames, or the VST3 granularity if that is coarser
+
+	\return frames between parameter updates inside a buffer
+	*/
+	uint32_t getControlRateFrames()
+	{
+		uint32_t granularity = getVST3SampleAccuracyGranularity();
+		return granularity > kControlRateFrames ? granularity : kControlRateFrames;
+	}
+
 	/**
 	\brief Description query: VST3 Bundle ID
 
@@ -601,6 +633,11 @@ protected:
 	uint32_t numPluginParameters = 0;							///< total number of parameters
 	PluginParameter** smoothablePluginParameters = nullptr;		///< old-fashioned C-arrays of pointers for smoothable parameters
 	uint32_t numSmoothablePluginParameters = 0;					///< number of smoothable parameters only
+	BlockParamSmoother blockParamSmoother;						///< block-rate smoother; slot i matches smoothablePluginParameters[i]
+	std::vector<ParameterAutomationRamp> automationRamps;		///< VST3 automation ramps; slot i matches smoothablePluginParameters[i]
+	std::vector<uint32_t> automatedParameters;					///< compact list of ramp slots that move in this block
+	uint32_t numAutomatedParameters = 0;						///< number of ramp slots that move in this block
+	uint32_t automationBlockSize = 0;							///< frames in the current block
 	PluginParameter** outboundPluginParameters = nullptr;		///< old-fashioned C-arrays of pointers for outbound (meter) parameters
 	uint32_t numOutboundPluginParameters = 0;					///< total number of outbound (meter) parameters
 
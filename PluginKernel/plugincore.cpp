@@ -12,7 +12,11 @@
 // -----------------------------------------------------------------------------
 #include "plugincore.h"
 #include "plugindescription.h"
+
+// --- the headless (offline) host has no GUI, and therefore no VSTGUI
+#ifndef OFFLINEPLUGIN
 #include "bankwaveviews.h"
+#endif
 
 /**
 \brief PluginCore constructor is launching pad for object initialization
@@ -51,6 +55,9 @@ PluginCore::PluginCore()
 
     // --- create the presets
     initPluginPresets();
+
+	// --- our copy of the engine parameters shares the engine's voice and mod matrix structures
+	engineParameters = synthEngine.getParameters();
 }
 
 /**
@@ -464,6 +471,95 @@ bool PluginCore::initPluginParameters()
 	piParam->setBoundVariable(&unisonDetune_Cents, boundVariableType::kDouble);
 	addPluginParameter(piParam);
 
+	// --- discrete control: Voice Steal; the order matches voiceStealPolicy
+	piParam = new PluginParameter(controlID::stealPolicy, "Voice Steal", "Oldest,Quietest,Protect_Lowest,Release_First", "Protect_Lowest");
+	piParam->setBoundVariable(&stealPolicy, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Steal Mode; the order matches voiceStealMode
+	piParam = new PluginParameter(controlID::stealMode, "Steal Mode", "Shutdown_EG,Crossfade", "Shutdown_EG");
+	piParam->setBoundVariable(&stealMode, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- continuous control: Steal XFade
+	piParam = new PluginParameter(controlID::stealXFadeTime_mSec, "Steal XFade", "mSec", controlVariableType::kDouble, 1.000000, 5.000000, 2.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(false);
+	piParam->setSmoothingTimeMsec(100.00);
+	piParam->setBoundVariable(&stealXFadeTime_mSec, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Phaser
+	piParam = new PluginParameter(controlID::enablePhaser, "Phaser", "SWITCH OFF,SWITCH ON", "SWITCH OFF");
+	piParam->setBoundVariable(&enablePhaser, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Chorus
+	piParam = new PluginParameter(controlID::enableChorus, "Chorus", "SWITCH OFF,SWITCH ON", "SWITCH OFF");
+	piParam->setBoundVariable(&enableChorus, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Delay
+	piParam = new PluginParameter(controlID::enableDelay, "Delay", "SWITCH OFF,SWITCH ON", "SWITCH OFF");
+	piParam->setBoundVariable(&enableDelay, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Reverb
+	piParam = new PluginParameter(controlID::enableReverb, "Reverb", "SWITCH OFF,SWITCH ON", "SWITCH OFF");
+	piParam->setBoundVariable(&enableReverb, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Convolution
+	piParam = new PluginParameter(controlID::enableConvolution, "Convolution", "SWITCH OFF,SWITCH ON", "SWITCH OFF");
+	piParam->setBoundVariable(&enableConvolution, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Compressor
+	piParam = new PluginParameter(controlID::enableCompressor, "Compressor", "SWITCH OFF,SWITCH ON", "SWITCH OFF");
+	piParam->setBoundVariable(&enableCompressor, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- discrete control: Limiter
+	piParam = new PluginParameter(controlID::enableLimiter, "Limiter", "SWITCH OFF,SWITCH ON", "SWITCH OFF");
+	piParam->setBoundVariable(&enableLimiter, boundVariableType::kInt);
+	piParam->setIsDiscreteSwitch(true);
+	addPluginParameter(piParam);
+
+	// --- continuous control: Limiter Threshold
+	piParam = new PluginParameter(controlID::limiterThreshold_dB, "Limiter Threshold", "dB", controlVariableType::kDouble, -20.000000, 0.000000, -1.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(false);
+	piParam->setSmoothingTimeMsec(100.00);
+	piParam->setBoundVariable(&limiterThreshold_dB, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	// --- continuous control: Limiter Lookahead; delays the output, not reported as plugin latency
+	piParam = new PluginParameter(controlID::limiterLookahead_mSec, "Limiter Lookahead", "mSec", controlVariableType::kDouble, 0.000000, 10.000000, 0.000000, taper::kLinearTaper);
+	piParam->setParameterSmoothing(false);
+	piParam->setSmoothingTimeMsec(100.00);
+	piParam->setBoundVariable(&limiterLookahead_mSec, boundVariableType::kDouble);
+	addPluginParameter(piParam);
+
+	// --- meter control: CPU Load; worst block load since the last GUI timer ping, 1.0 = the real-time budget
+	piParam = new PluginParameter(controlID::cpuLoadMeter, "CPU Load", 10.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLinearMeter);
+	piParam->setInvertedMeter(false);
+	piParam->setIsProtoolsGRMeter(false);
+	piParam->setBoundVariable(&cpuLoadMeter, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
+	// --- meter control: Voices; sounding voices as a fraction of MAX_VOICES
+	piParam = new PluginParameter(controlID::voiceMeter, "Voices", 10.00, 500.00, ENVELOPE_DETECT_MODE_PEAK, meterCal::kLinearMeter);
+	piParam->setInvertedMeter(false);
+	piParam->setIsProtoolsGRMeter(false);
+	piParam->setBoundVariable(&voiceMeter, boundVariableType::kFloat);
+	addPluginParameter(piParam);
+
 	// --- Aux Attributes
 	AuxParameterAttribute auxAttribute;
 
@@ -768,6 +864,66 @@ bool PluginCore::initPluginParameters()
 	auxAttribute.setUintAttribute(2147483648);
 	setParamAuxAttribute(controlID::unisonDetune_Cents, auxAttribute);
 
+	// --- controlID::stealPolicy
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(805306368);
+	setParamAuxAttribute(controlID::stealPolicy, auxAttribute);
+
+	// --- controlID::stealMode
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(805306368);
+	setParamAuxAttribute(controlID::stealMode, auxAttribute);
+
+	// --- controlID::stealXFadeTime_mSec
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(2147483648);
+	setParamAuxAttribute(controlID::stealXFadeTime_mSec, auxAttribute);
+
+	// --- controlID::enablePhaser
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(1073741824);
+	setParamAuxAttribute(controlID::enablePhaser, auxAttribute);
+
+	// --- controlID::enableChorus
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(1073741824);
+	setParamAuxAttribute(controlID::enableChorus, auxAttribute);
+
+	// --- controlID::enableDelay
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(1073741824);
+	setParamAuxAttribute(controlID::enableDelay, auxAttribute);
+
+	// --- controlID::enableReverb
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(1073741824);
+	setParamAuxAttribute(controlID::enableReverb, auxAttribute);
+
+	// --- controlID::enableConvolution
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(1073741824);
+	setParamAuxAttribute(controlID::enableConvolution, auxAttribute);
+
+	// --- controlID::enableCompressor
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(1073741824);
+	setParamAuxAttribute(controlID::enableCompressor, auxAttribute);
+
+	// --- controlID::enableLimiter
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(1073741824);
+	setParamAuxAttribute(controlID::enableLimiter, auxAttribute);
+
+	// --- controlID::limiterThreshold_dB
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(2147483648);
+	setParamAuxAttribute(controlID::limiterThreshold_dB, auxAttribute);
+
+	// --- controlID::limiterLookahead_mSec
+	auxAttribute.reset(auxGUIIdentifier::guiControlData);
+	auxAttribute.setUintAttribute(2147483648);
+	setParamAuxAttribute(controlID::limiterLookahead_mSec, auxAttribute);
+
 
 	// **--0xEDA5--**
    
@@ -802,6 +958,9 @@ bool PluginCore::reset(ResetInfo& resetInfo)
 	// --- reset engine
 	synthEngine.reset(resetInfo.sampleRate);
 
+	// --- push everything on the next buffer
+	parameterDirtyFlags.markAllDirty();
+
 	
 
     // --- other reset inits
@@ -839,98 +998,361 @@ bool PluginCore::preProcessAudioBuffers(ProcessBufferInfo& processInfo)
 {
     // --- sync internal variables to GUI parameters; you can also do this manually if you don't
     //     want to use the auto-variable-binding
+	//     NOTE: this posts only the bound variables that changed, which flags their groups
     syncInBoundVariables();
 
-	// --- update all parameters ONCE per buffer
-	updateParameters();
+	// --- collect the dirty groups; a value that lands after the sync is caught by the next one
+	uint64_t dirtyGroups = parameterDirtyFlags.getAndClearDirty();
+
+	// --- pick up the newest joystick snapshot from the GUI thread; the voices read the shared
+	//     voice parameters only on this thread, so they never see a partial update
+	if (vectorJoystickSnapshot.acquire())
+		synthEngine.getVoiceParameters()->vectorJSData = vectorJoystickSnapshot.read();
+
+	// --- unison assigns detune/pan as voices start, so it keeps the per-buffer engine update
+	if (compareEnumToInt(modeEnum::Unison, mode))
+		dirtyGroups |= kMasterParamGroup;
+
+	// --- update changed parameters ONCE per buffer
+	updateParameters(dirtyGroups);
 
     return true;
 }
 
-void PluginCore::updateParameters()
+/**
+\brief map a control ID to the parameter group(s) that must be re-cooked when it changes
+
+\param controlID the control ID value of the parameter
+\return bitmask of parameterGroup values; 0 for controls that are not connected to the engine
+*/
+uint64_t PluginCore::getParameterGroups(int32_t controlID)
 {
-	SynthEngineParameters engineParams = synthEngine.getParameters();
+	switch (controlID)
+	{
+		case controlID::masterPitchBend:
+		case controlID::masterTune:
+		case controlID::masterVolume_dB:
+		case controlID::mode:
+		case controlID::unisonDetune_Cents:
+		case controlID::stealPolicy:
+		case controlID::stealMode:
+		case controlID::stealXFadeTime_mSec:
+			return kMasterParamGroup;
+
+		case controlID::enablePhaser:
+		case controlID::enableChorus:
+		case controlID::enableDelay:
+		case controlID::enableReverb:
+		case controlID::enableConvolution:
+		case controlID::enableCompressor:
+		case controlID::enableLimiter:
+		case controlID::limiterThreshold_dB:
+		case controlID::limiterLookahead_mSec:
+			return kMasterFXParamGroup;
+
+		case controlID::lfo1Frequency_Hz:
+		case controlID::lfo1Waveform:
+		case controlID::lfo1Mode:
+		case controlID::lfo1DelayTime_mSec:
+		case controlID::lfo1RampTime_mSec:
+		case controlID::lfo1Shape:
+		case controlID::lfo1ShapeSplit:
+			return kLFO1ParamGroup;
+
+		case controlID::lfo2Frequency_Hz:
+		case controlID::lfo2Waveform:
+		case controlID::lfo2Mode:
+		case controlID::lfo2Shape:
+		case controlID::lfo2ShapeSplit:
+			return kLFO2ParamGroup;
+
+		// --- LFO2 target routes through both LFO1 and the DCA
+		case controlID::lfo2ModTarget:
+			return kLFO1ParamGroup | kDCAParamGroup;
+
+		case controlID::osc1Waveform:
+		case controlID::osc1BankIndex:
+		case controlID::osc2Waveform:
+		case controlID::osc2BankIndex:
+		case controlID::osc3Waveform:
+		case controlID::osc3BankIndex:
+		case controlID::osc4Waveform:
+		case controlID::osc4BankIndex:
+		case controlID::osc1Detune_cents:
+			return kOscParamGroup;
+
+		case controlID::eg1DelayTime_mSec:
+		case controlID::eg1AttackTime_mSec:
+		case controlID::eg1HoldTime_mSec:
+		case controlID::eg1DecayTime_mSec:
+		case controlID::eg1SustainLevel:
+		case controlID::eg1ReleaseTime_mSec:
+		case controlID::eg1Mode:
+		case controlID::eg1AutoRetrigger:
+		case controlID::eg1ManualTrigger:
+			return kAmpEGParamGroup;
+
+		case controlID::fc1_hertz:
+		case controlID::q1Control:
+		case controlID::enableKeyTrack:
+		case controlID::keyTrackRatio:
+			return kFilterParamGroup;
+
+		case controlID::lfo1Amplitude:
+		case controlID::eg1ModOut:
+		case controlID::lfo1_to_osc1Fo:
+		case controlID::lfo1_to_osc2Fo:
+		case controlID::eg1_to_osc1Fo:
+		case controlID::osc1FoModIn:
+		case controlID::osc2FoModIn:
+			return kModMatrixParamGroup;
 
-	// --- collect GUI control update values
-	engineParams.masterPitchBendSensCoarse = (unsigned int)masterPitchBend; // --- this is pitch bend max range in semitones
+		default:
+			return 0; // --- not (yet) connected to the engine
+	}
+}
 
-	engineParams.masterPitchBendSensFine = (unsigned int)(100.0*(masterPitchBend - engineParams.masterPitchBendSensCoarse)); // this is pitch bend max range in semitones
+/**
+\brief push GUI parameters into the synth engine; only the groups flagged in dirtyGroups are re-cooked
 
-	// --- create two tuning offsets from one master tune value
-	engineParams.masterTuningCoarse = (int)masterTune;
+\param dirtyGroups bitmask of parameterGroup values that changed since the last buffer
+*/
+void PluginCore::updateParameters(uint64_t dirtyGroups)
+{
+	// --- tempo comes from the host rather than a parameter
+	if (bpm != lastBPM)
+	{
+		lastBPM = bpm;
+		dirtyGroups |= kDCAParamGroup;
+	}
 
-	engineParams.masterTuningFine = (int)(100.0*(masterTune - engineParams.masterTuningCoarse)); // --- get fraction and convert to cents (1/100th of a semitone)
+	// --- nothing changed: no copies, no refcount traffic, no cooking
+	if (dirtyGroups == 0)
+		return;
 
-	engineParams.masterVolume_dB = masterVolume_dB;
+	// --- voice parameters are shared with every voice, write them in place
+	std::shared_ptr<SynthVoiceParameters> voiceParameters = synthEngine.getVoiceParameters();
 
 	/// LFO 1 Parameters
-	engineParams.voiceParameters->lfo1Parameters->frequency_Hz = lfo1Frequency_Hz;
-	engineParams.voiceParameters->lfo1Parameters->waveform = convertIntToEnum(lfo1Waveform, LFOWaveform);
-	engineParams.voiceParameters->lfo1Parameters->mode = convertIntToEnum(lfo1Mode, LFOMode);
-	engineParams.voiceParameters->lfo1Parameters->lfoDelay_mSec = lfo1DelayTime_mSec;
-	engineParams.voiceParameters->lfo1Parameters->lfoRamp_mSec = lfo1RampTime_mSec;
-	engineParams.voiceParameters->lfo1Parameters->lfoShape = lfo1Shape;
-	engineParams.voiceParameters->lfo1Parameters->shapeSplitpoint = lfo1ShapeSplit;
-	engineParams.voiceParameters->lfo1Parameters->modRoute = convertIntToEnum(lfo2ModTarget, ModRouting);
+	if (dirtyGroups & kLFO1ParamGroup)
+	{
+		voiceParameters->lfo1Parameters->frequency_Hz = lfo1Frequency_Hz;
+		voiceParameters->lfo1Parameters->waveform = convertIntToEnum(lfo1Waveform, LFOWaveform);
+		voiceParameters->lfo1Parameters->mode = convertIntToEnum(lfo1Mode, LFOMode);
+		voiceParameters->lfo1Parameters->lfoDelay_mSec = lfo1DelayTime_mSec;
+		voiceParameters->lfo1Parameters->lfoRamp_mSec = lfo1RampTime_mSec;
+		voiceParameters->lfo1Parameters->lfoShape = lfo1Shape;
+		voiceParameters->lfo1Parameters->shapeSplitpoint = lfo1ShapeSplit;
+		voiceParameters->lfo1Parameters->modRoute = convertIntToEnum(lfo2ModTarget, ModRouting);
+	}
 
 	/// LFO 2 Parameters
-	engineParams.voiceParameters->lfo2Parameters->frequency_Hz = lfo2Frequency_Hz;
-	engineParams.voiceParameters->lfo2Parameters->waveform = convertIntToEnum(lfo2Waveform, LFOWaveform);
-	engineParams.voiceParameters->lfo2Parameters->mode = convertIntToEnum(lfo2Mode, LFOMode);
-	engineParams.voiceParameters->lfo2Parameters->lfoShape = lfo2Shape;
-	engineParams.voiceParameters->lfo2Parameters->shapeSplitpoint = lfo2ShapeSplit;
+	if (dirtyGroups & kLFO2ParamGroup)
+	{
+		voiceParameters->lfo2Parameters->frequency_Hz = lfo2Frequency_Hz;
+		voiceParameters->lfo2Parameters->waveform = convertIntToEnum(lfo2Waveform, LFOWaveform);
+		voiceParameters->lfo2Parameters->mode = convertIntToEnum(lfo2Mode, LFOMode);
+		voiceParameters->lfo2Parameters->lfoShape = lfo2Shape;
+		voiceParameters->lfo2Parameters->shapeSplitpoint = lfo2ShapeSplit;
+	}
 
-	//engineParams.voiceParameters->osc1Parameters->scaleSelect = convertIntToEnum(scaleMode, ScaleMode);
+	//voiceParameters->osc1Parameters->scaleSelect = convertIntToEnum(scaleMode, ScaleMode);
 	
-	engineParams.voiceParameters->dcaParameters->bpm = bpm;
+	if (dirtyGroups & kDCAParamGroup)
+	{
+		voiceParameters->dcaParameters->bpm = bpm;
+		voiceParameters->dcaParameters->modRoute = convertIntToEnum(lfo2ModTarget, ModRouting);
+	}
 
-	engineParams.voiceParameters->dcaParameters->modRoute = convertIntToEnum(lfo2ModTarget, ModRouting);
+	if (dirtyGroups & kOscParamGroup)
+	{
+		voiceParameters->osc1Parameters->oscillatorWaveformIndex = osc1Waveform;
+		voiceParameters->osc1Parameters->oscillatorBankIndex = osc1BankIndex;
+		voiceParameters->osc2Parameters->oscillatorWaveformIndex = osc2Waveform;
+		voiceParameters->osc2Parameters->oscillatorBankIndex = osc2BankIndex;
+		voiceParameters->osc3Parameters->oscillatorWaveformIndex = osc3Waveform;
+		voiceParameters->osc3Parameters->oscillatorBankIndex = osc3BankIndex;
+		voiceParameters->osc4Parameters->oscillatorWaveformIndex = osc4Waveform;
+		voiceParameters->osc4Parameters->oscillatorBankIndex = osc4BankIndex;
+
+		voiceParameters->osc1Parameters->detuneCents = osc1Detune_cents;
+	}
 
-	engineParams.voiceParameters->osc1Parameters->oscillatorWaveformIndex = osc1Waveform;
-	engineParams.voiceParameters->osc1Parameters->oscillatorBankIndex = osc1BankIndex;
-	engineParams.voiceParameters->osc2Parameters->oscillatorWaveformIndex = osc2Waveform;
-	engineParams.voiceParameters->osc2Parameters->oscillatorBankIndex = osc2BankIndex;
-	engineParams.voiceParameters->osc3Parameters->oscillatorWaveformIndex = osc3Waveform;
-	engineParams.voiceParameters->osc3Parameters->oscillatorBankIndex = osc3BankIndex;
-	engineParams.voiceParameters->osc4Parameters->oscillatorWaveformIndex = osc4Waveform;
-	engineParams.voiceParameters->osc4Parameters->oscillatorBankIndex = osc4BankIndex;
+	// EG1 Parameters
+	if (dirtyGroups & kAmpEGParamGroup)
+	{
+		voiceParameters->ampEGParameters->delayTime_mSec = eg1DelayTime_mSec;
+		voiceParameters->ampEGParameters->attackTime_mSec = eg1AttackTime_mSec;
+		voiceParameters->ampEGParameters->holdTime_mSec = eg1HoldTime_mSec;
+		voiceParameters->ampEGParameters->decayTime_mSec = eg1DecayTime_mSec;
+		voiceParameters->ampEGParameters->sustainLevel = eg1SustainLevel;
+		voiceParameters->ampEGParameters->releaseTime_mSec = eg1ReleaseTime_mSec;
+		voiceParameters->ampEGParameters->egContourType = convertIntToEnum(eg1Mode, egType);
+		voiceParameters->ampEGParameters->autoRetrigger = eg1AutoRetrigger;
+		voiceParameters->ampEGParameters->manualRetrigger = eg1ManualTrigger;
+	}
 
-	engineParams.voiceParameters->osc1Parameters->detuneCents = osc1Detune_cents;
+	if (dirtyGroups & kFilterParamGroup)
+	{
+		voiceParameters->moogFilterParameters->fc = fc1_hertz;
+		voiceParameters->moogFilterParameters->Q = q1Control;
+		voiceParameters->moogFilterParameters->enableKeyTrack = (enableKeyTrack == 1);
+		voiceParameters->moogFilterParameters->keyTrackRatio = keyTrackRatio;
+	}
 
-	// EG1 Parameters
-	engineParams.voiceParameters->ampEGParameters->delayTime_mSec = eg1DelayTime_mSec;
-	engineParams.voiceParameters->ampEGParameters->attackTime_mSec = eg1AttackTime_mSec;
-	engineParams.voiceParameters->ampEGParameters->holdTime_mSec = eg1HoldTime_mSec;
-	engineParams.voiceParameters->ampEGParameters->decayTime_mSec = eg1DecayTime_mSec;
-	engineParams.voiceParameters->ampEGParameters->sustainLevel = eg1SustainLevel;
-	engineParams.voiceParameters->ampEGParameters->releaseTime_mSec = eg1ReleaseTime_mSec;
-	engineParams.voiceParameters->ampEGParameters->egContourType = convertIntToEnum(eg1Mode, egType);
-	engineParams.voiceParameters->ampEGParameters->autoRetrigger = eg1AutoRetrigger;
-	engineParams.voiceParameters->ampEGParameters->manualRetrigger = eg1ManualTrigger;
-
-	engineParams.voiceParameters->moogFilterParameters->fc = fc1_hertz;
-	engineParams.voiceParameters->moogFilterParameters->Q = q1Control;
-	engineParams.voiceParameters->moogFilterParameters->enableKeyTrack = (enableKeyTrack == 1);
-	engineParams.voiceParameters->moogFilterParameters->keyTrackRatio = keyTrackRatio;
-
-	engineParams.setMM_SourceMasterIntensity(kLFO1_Normal, lfo1Amplitude);
-	engineParams.setMM_SourceMasterIntensity(kEG1_Normal, eg1ModOut);
-
-	engineParams.setMM_ChannelEnable(kLFO1_Normal, kOsc1_fo, lfo1_to_osc1Fo);
-	engineParams.setMM_ChannelEnable(kLFO1_Normal, kOsc2_fo, lfo1_to_osc2Fo);
-	engineParams.setMM_ChannelEnable(kEG1_Normal, kOsc1_fo, eg1_to_osc1Fo);
-
-	engineParams.setMM_DestMasterIntensity(kOsc1_fo, osc1FoModIn);
-	engineParams.setMM_DestMasterIntensity(kOsc2_fo, osc2FoModIn);
-
-	engineParams.mode = convertIntToEnum(mode, synthMode);
-	engineParams.masterUnisonDetune_Cents = unisonDetune_Cents;
+	// --- the mod matrix and the engine-level values go through our copy of the engine parameter structure
+	if (dirtyGroups & (kModMatrixParamGroup | kMasterParamGroup))
+	{
+		// --- mod matrix rows/columns are shared arrays, written in place
+		if (dirtyGroups & kModMatrixParamGroup)
+		{
+			engineParameters.setMM_SourceMasterIntensity(kLFO1_Normal, lfo1Amplitude);
+			engineParameters.setMM_SourceMasterIntensity(kEG1_Normal, eg1ModOut);
 
-	
+			engineParameters.setMM_ChannelEnable(kLFO1_Normal, kOsc1_fo, lfo1_to_osc1Fo);
+			engineParameters.setMM_ChannelEnable(kLFO1_Normal, kOsc2_fo, lfo1_to_osc2Fo);
+			engineParameters.setMM_ChannelEnable(kEG1_Normal, kOsc1_fo, eg1_to_osc1Fo);
+
+			engineParameters.setMM_DestMasterIntensity(kOsc1_fo, osc1FoModIn);
+			engineParameters.setMM_DestMasterIntensity(kOsc2_fo, osc2FoModIn);
+		}
+
+		if (dirtyGroups & kMasterParamGroup)
+		{
+			// --- collect GUI control update values
+			engineParameters.masterPitchBendSensCoarse = (unsigned int)masterPitchBend; // --- this is pitch bend max range in semitones
+
+			engineParameters.masterPitchBendSensFine = (unsigned int)(100.0*(masterPitchBend - engineParameters.masterPitchBendSensCoarse)); // this is pitch bend max range in semitones
+
+			// --- create two tuning offsets from one master tune value
+			engineParameters.masterTuningCoarse = (int)masterTune;
+
+			engineParameters.masterTuningFine = (int)(100.0*(masterTune - engineParameters.masterTuningCoarse)); // --- get fraction and convert to cents (1/100th of a semitone)
+
+			engineParameters.masterVolume_dB = masterVolume_dB;
+
+			engineParameters.mode = convertIntToEnum(mode, synthMode);
+			engineParameters.masterUnisonDetune_Cents = unisonDetune_Cents;
+			engineParameters.stealPolicy = convertIntToEnum(stealPolicy, voiceStealPolicy);
+			engineParameters.stealMode = convertIntToEnum(stealMode, voiceStealMode);
+			engineParameters.stealXFadeTime_mSec = stealXFadeTime_mSec;
+
+			// --- THE update - this trickles all param updates
+			// via the setParameters( ) of each; the engine applies the block whole on its next render or MIDI call
+			synthEngine.publishParameters(engineParameters);
+		}
+	}
+
+	// --- the master FX rack is only re-cooked when one of its own controls changed
+	if (dirtyGroups & kMasterFXParamGroup)
+	{
+		MasterFXParameters masterFXParams = synthEngine.getMasterFXParameters();
+		masterFXParams.enableSlot[kMasterFXPhaser] = (enablePhaser == 1);
+		masterFXParams.enableSlot[kMasterFXChorus] = (enableChorus == 1);
+		masterFXParams.enableSlot[kMasterFXDelay] = (enableDelay == 1);
+		masterFXParams.enableSlot[kMasterFXReverb] = (enableReverb == 1);
+		masterFXParams.enableSlot[kMasterFXConvolution] = (enableConvolution == 1);
+		masterFXParams.enableSlot[kMasterFXCompressor] = (enableCompressor == 1);
+		masterFXParams.enableSlot[kMasterFXLimiter] = (enableLimiter == 1);
+		masterFXParams.limiterThreshold_dB = limiterThreshold_dB;
+		masterFXParams.limiterLookahead_mSec = limiterLookahead_mSec;
+		synthEngine.setMasterFXParameters(masterFXParams);
+	}
+}
+
+/**
+\brief buffer-processing method
+
+Operation:
+- FX plugins (and odd channel setups with no outputs) use the base class frame processing
+- synth plugins render directly into the non-interleaved output buffers; there is no frame gather/scatter
+- with no MIDI, no moving VST3 automation and no parameter smoothing in the buffer, the engine renders the whole
+  buffer in one call
+- otherwise the buffer is split into control-rate sub-blocks (getControlRateFrames()); VST3 automation is applied,
+  the smoother stepped and the changed groups pushed to the engine once at the start of each sub-block, never per sample
+- MIDI events are still fired on each sample interval, so a sub-block with MIDI pending renders one sample at a time;
+  without MIDI the engine renders the whole sub-block in one call
+
+\param processBufferInfo structure of information about *buffer* processing
+
+\return true if operation succeeds, false otherwise
+*/
+bool PluginCore::processAudioBuffers(ProcessBufferInfo& processBufferInfo)
+{
+	if (getPluginType() != kSynthPlugin || processBufferInfo.numAudioOutChannels == 0)
+		return PluginBase::processAudioBuffers(processBufferInfo);
+
+	// --- flush denormals to zero for the whole buffer; restored on return
+	DenormalGuard denormalGuard;
 
-	// --- THE update - this trickles all param updates
-	// via the setParameters( ) of each
-	synthEngine.setParameters(engineParams);
+	uint32_t numFrames = processBufferInfo.numFramesToProcess;
+	synthEngine.getPerfMonitor().beginBlock(numFrames);
+
+	float* leftOutput = processBufferInfo.outputs[0];
+	float* rightOutput = nullptr;
+	if (processBufferInfo.numAudioOutChannels > 1 && processBufferInfo.channelIOConfig.outputChannelFormat == kCFStereo)
+		rightOutput = processBufferInfo.outputs[1];
+
+	// --- extra outputs are silent, as in the frame path
+	for (uint32_t i = rightOutput ? 2 : 1; i < processBufferInfo.numAudioOutChannels; i++)
+		memset(processBufferInfo.outputs[i], 0, numFrames * sizeof(float));
+	for (uint32_t i = 0; i < processBufferInfo.numAuxAudioOutChannels; i++)
+		memset(processBufferInfo.auxOutputs[i], 0, numFrames * sizeof(float));
+
+	bpm = processBufferInfo.hostInfo->dBPM;
+
+	// --- parameter ramps and smoothing targets, then sync internal bound variables
+	buildSampleAccurateAutomationRamps(numFrames);
+	setBlockParameterSmoothingTargets();
+	preProcessAudioBuffers(processBufferInfo);
+
+	IMidiEventQueue* midiEventQueue = processBufferInfo.midiEventQueue;
+	bool midiPending = midiEventQueue && midiEventQueue->getEventCount() > 0;
+
+	if (!midiPending && !hasSampleAccurateAutomation() && !isSmoothingParameters())
+	{
+		// --- nothing happens mid-buffer: one call for the whole block
+		synthEngine.renderAudioBlock(leftOutput, rightOutput, numFrames);
+	}
+	else
+	{
+		uint32_t subBlock = getControlRateFrames();
+		for (uint32_t start = 0; start < numFrames; start += subBlock)
+		{
+			uint32_t subBlockFrames = numFrames - start < subBlock ? numFrames - start : subBlock;
+
+			// --- VST automation ramps and one smoothing step; changed groups go to the engine once per sub-block
+			bool automated = doSampleAccurateParameterUpdates(start);
+			bool smoothed = doBlockParameterSmoothing(subBlockFrames);
+			if (automated || smoothed)
+				updateParameters(parameterDirtyFlags.getAndClearDirty());
+
+			if (!midiPending)
+			{
+				synthEngine.renderAudioBlock(leftOutput + start, rightOutput ? rightOutput + start : nullptr, subBlockFrames);
+				continue;
+			}
+
+			for (uint32_t frame = start; frame < start + subBlockFrames; frame++)
+			{
+				// --- fire any MIDI events for this sample interval
+				midiEventQueue->fireMidiEvents(frame);
+				synthEngine.renderAudioBlock(leftOutput + frame, rightOutput ? rightOutput + frame : nullptr, 1);
+			}
+		}
+	}
+
+	// --- update per-buffer
+	processBufferInfo.hostInfo->uAbsoluteFrameBufferIndex += numFrames;
+	processBufferInfo.hostInfo->dAbsoluteFrameBufferTime += numFrames / audioProcDescriptor.sampleRate;
+
+	// --- generally not used
+	postProcessAudioBuffers(processBufferInfo);
+
+	// --- publish this buffer's timings and counters
+	synthEngine.getPerfMonitor().endBlock();
+
+	return true; /// processed
 }
 
 /**
@@ -939,7 +1361,9 @@ void PluginCore::updateParameters()
 Operation:
 - decode the plugin type - for synth plugins, fill in the rendering code; for FX plugins, delete the if(synth) portion and add your processing code
 - note that MIDI events are fired for each sample interval so that MIDI is tightly sunk with audio
-- doSampleAccurateParameterUpdates will perform per-sample interval smoothing
+- doSampleAccurateParameterUpdates applies the VST3 automation ramps on the first frame of each control-rate sub-block;
+  any groups they or the smoother (stepped by the base class on the same frames) change are pushed to the engine
+  right away rather than waiting for the next buffer
 
 \param processFrameInfo structure of information about *frame* processing
 
@@ -952,8 +1376,15 @@ bool PluginCore::processAudioFrame(ProcessFrameInfo& processFrameInfo)
 
 	bpm = processFrameInfo.hostInfo->dBPM;
 
-	// --- do per-frame updates; VST automation and parameter smoothing
-	doSampleAccurateParameterUpdates();
+	// --- once per control-rate sub-block: VST automation ramps, then the groups they and the smoother changed
+	if (processFrameInfo.currentFrame % getControlRateFrames() == 0)
+	{
+		doSampleAccurateParameterUpdates(processFrameInfo.currentFrame);
+
+		uint64_t dirtyGroups = parameterDirtyFlags.getAndClearDirty();
+		if (dirtyGroups)
+			updateParameters(dirtyGroups);
+	}
 
     // --- decode the channelIOConfiguration and process accordingly
     //
@@ -1015,6 +1446,9 @@ bool PluginCore::updatePluginParameter(int32_t controlID, double controlValue, P
     // --- use base class helper
     setPIParamValue(controlID, controlValue);
 
+	// --- flag the group AFTER the value is stored
+	parameterDirtyFlags.markDirty(getParameterGroups(controlID));
+
     // --- do any post-processing
     postUpdatePluginParameter(controlID, controlValue, paramInfo);
 
@@ -1039,6 +1473,9 @@ bool PluginCore::updatePluginParameterNormalized(int32_t controlID, double norma
 	// --- use base class helper, returns actual value
 	double controlValue = setPIParamValueNormalized(controlID, normalizedValue, paramInfo.applyTaper);
 
+	// --- flag the group AFTER the value is stored
+	parameterDirtyFlags.markDirty(getParameterGroups(controlID));
+
 	// --- do any post-processing
 	postUpdatePluginParameter(controlID, controlValue, paramInfo);
 
@@ -1060,6 +1497,10 @@ bool PluginCore::updatePluginParameterNormalized(int32_t controlID, double norma
 */
 bool PluginCore::postUpdatePluginParameter(int32_t controlID, double controlValue, ParameterUpdateInfo& paramInfo)
 {
+	// --- every path lands here after a value change (buffer sync, smoothing, VST3 sample accurate automation,
+	//     direct host calls); flag the group so it is pushed to the engine at the top of the next buffer
+	parameterDirtyFlags.markDirty(getParameterGroups(controlID));
+
     // --- now do any post update cooking; be careful with VST Sample Accurate automation
     //     If enabled, then make sure the cooking functions are short and efficient otherwise disable it
     //     for the Parameter involved
@@ -1096,6 +1537,9 @@ WARNING:
 */
 bool PluginCore::guiParameterChanged(int32_t controlID, double actualValue)
 {
+	// --- GUI thread: flag the group; the value itself arrives through the host
+	parameterDirtyFlags.markDirty(getParameterGroups(controlID));
+
 	/*
 	switch (controlID)
 	{
@@ -1112,6 +1556,21 @@ bool PluginCore::guiParameterChanged(int32_t controlID, double actualValue)
 	return false; /// not handled
 }
 
+/**
+\brief empty the engine's instrumentation queue: keeps the newest frame in perfFrame and the worst load of
+the frames read in perfPeakLoad; GUI thread only (the queue has a single reader)
+*/
+void PluginCore::drainPerfFrames()
+{
+	perfPeakLoad = 0.0;
+	SynthPerfFrame nextFrame;
+	while (synthEngine.getPerfMonitor().readFrame(nextFrame))
+	{
+		perfPeakLoad = fmax(perfPeakLoad, nextFrame.getLoad());
+		perfFrame = nextFrame;
+	}
+}
+
 /**
 \brief For Custom View and Custom Sub-Controller Operations
 
@@ -1134,6 +1593,8 @@ bool PluginCore::processMessage(MessageInfo& messageInfo)
 		if (bankAndWaveGroup_0)
 			bankAndWaveGroup_0->updateView();
 
+		// --- the timer does not ping while the GUI is closed: throw away the frames that piled up meanwhile
+		drainPerfFrames();
 		return false;
 	}
 
@@ -1146,6 +1607,11 @@ bool PluginCore::processMessage(MessageInfo& messageInfo)
 	// --- update view; this will only be called if the GUI is actually open
 	case PLUGINGUI_TIMERPING:
 	{
+		drainPerfFrames();
+
+		// --- meters: worst load since the last ping and the voices in use
+		cpuLoadMeter = (float)fmin(perfPeakLoad, 1.0);
+		voiceMeter = (float)perfFrame.activeVoices / (float)MAX_VOICES;
 		return false;
 	}
 
@@ -1158,6 +1624,7 @@ bool PluginCore::processMessage(MessageInfo& messageInfo)
 
 	case PLUGINGUI_REGISTER_SUBCONTROLLER:
 	{
+#ifndef OFFLINEPLUGIN
 		// --- decode name string
 		if (messageInfo.inMessageString.compare("BankWaveController_0") == 0)
 		{
@@ -1195,6 +1662,8 @@ bool PluginCore::processMessage(MessageInfo& messageInfo)
 			// --- registered!
 			return true;
 		}
+#endif
+		return false;
 	}
 
 	case PLUGINGUI_QUERY_HASUSERCUSTOM:
@@ -1247,9 +1716,8 @@ NOTES:
 */
 bool PluginCore::setVectorJoystickParameters(const VectorJoystickData& vectorJoysickData)
 {
-	SynthEngineParameters engineParams = synthEngine.getParameters();
-	engineParams.voiceParameters->vectorJSData = vectorJoysickData;
-	synthEngine.setParameters(engineParams);
+	// --- called from the GUI thread: publish a snapshot, the audio thread applies it at the top of the next buffer
+	vectorJoystickSnapshot.publish(vectorJoysickData);
 	return true;
 }
 
@@ -1334,6 +1802,18 @@ bool PluginCore::initPluginPresets()
 	setPresetParameter(preset->presetParameters, controlID::eg2Mode, -0.000000);
 	setPresetParameter(preset->presetParameters, controlID::mode, -0.000000);
 	setPresetParameter(preset->presetParameters, controlID::unisonDetune_Cents, 0.000000);
+	setPresetParameter(preset->presetParameters, controlID::stealPolicy, 2.000000);
+	setPresetParameter(preset->presetParameters, controlID::stealMode, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::stealXFadeTime_mSec, 2.000000);
+	setPresetParameter(preset->presetParameters, controlID::enablePhaser, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::enableChorus, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::enableDelay, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::enableReverb, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::enableConvolution, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::enableCompressor, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::enableLimiter, -0.000000);
+	setPresetParameter(preset->presetParameters, controlID::limiterThreshold_dB, -1.000000);
+	setPresetParameter(preset->presetParameters, controlID::limiterLookahead_mSec, 0.000000);
 	addPreset(preset);
 
 
@@ -80,11 +80,40 @@ enum controlID {
 	eg1Mode = 60,
 	eg2Mode = 70,
 	mode = 2,
-	unisonDetune_Cents = 4
+	unisonDetune_Cents = 4,
+	stealPolicy = 12,
+	stealMode = 13,
+	stealXFadeTime_mSec = 14,
+	enablePhaser = 90,		// --- 90-96: master FX slot switches, in masterFXSlot order
+	enableChorus = 91,
+	enableDelay = 92,
+	enableReverb = 93,
+	enableConvolution = 94,
+	enableCompressor = 95,
+	enableLimiter = 96,
+	limiterThreshold_dB = 97,
+	limiterLookahead_mSec = 98,
+	cpuLoadMeter = 190,
+	voiceMeter = 191
 };
 
 	// **--0x0F1F--**
 
+// --- parameter groups for dirty-flag tracking; each group is re-cooked as a unit in updateParameters()
+enum parameterGroup : uint64_t
+{
+	kMasterParamGroup		= 1 << 0,	///< engine-level: pitch bend, tuning, volume, mode, unison detune, voice stealing
+	kLFO1ParamGroup			= 1 << 1,
+	kLFO2ParamGroup			= 1 << 2,
+	kDCAParamGroup			= 1 << 3,
+	kOscParamGroup			= 1 << 4,
+	kAmpEGParamGroup		= 1 << 5,
+	kFilterParamGroup		= 1 << 6,
+	kModMatrixParamGroup	= 1 << 7,
+	kMasterFXParamGroup		= 1 << 8,	///< master FX rack: slot switches and limiter; never forced by unison
+	kAllParamGroups			= 0x1FF
+};
+
 /**
 \class PluginCore
 \ingroup ASPiK-Core
@@ -130,9 +159,8 @@ public:
 	/** process frames of data */
 	virtual bool processAudioFrame(ProcessFrameInfo& processFrameInfo);
 
-	// --- uncomment and override this for buffer processing; see base class implementation for
-	//     help on breaking up buffers and getting info from processBufferInfo
-	//virtual bool processAudioBuffers(ProcessBufferInfo& processBufferInfo);
+	/** synth mode: render blocks straight into the output buffers; FX mode uses the base class frame processing */
+	virtual bool processAudioBuffers(ProcessBufferInfo& processBufferInfo);
 
 	/** preProcess: do any post-buffer processing required; default operation is to send metering data to GUI  */
 	virtual bool postProcessAudioBuffers(ProcessBufferInfo& processInfo);
@@ -179,11 +207,28 @@ public:
 
 	*/
 	SynthEngine synthEngine; ///< 
-	void updateParameters();
-	double bpm;
+	void updateParameters(uint64_t dirtyGroups = kAllParamGroups);
+	double bpm = 0.0;
+
+	// --- vector joystick data arrives on the GUI thread; voices only see whole snapshots
+	ParameterSnapshotExchange<VectorJoystickData> vectorJoystickSnapshot;
+
+	// --- engine-level parameters are composed here and published to the engine as one block
+	SynthEngineParameters engineParameters;
+
+	// --- dirty tracking: only the parameter groups that changed are pushed to the engine
+	ParameterDirtyFlags parameterDirtyFlags;
+	uint64_t getParameterGroups(int32_t controlID);
+	double lastBPM = -1.0;
 
 	ICustomView* bankAndWaveGroup_0 = nullptr;
 
+	// --- engine instrumentation, collected from the lock-free queue on the GUI timer and shown on the
+	//     cpuLoadMeter and voiceMeter meters; the timer only runs while the GUI is open
+	SynthPerfFrame perfFrame;			///< newest block measurements
+	double perfPeakLoad = 0.0;			///< highest block load since the last timer ping
+	void drainPerfFrames();
+
 	// --- END USER VARIABLES AND FUNCTIONS -------------------------------------- //
 
 private:
@@ -224,6 +269,13 @@ private:
 	double eg1Offset = 0.0;
 	double eg2Offset = 0.0;
 	double unisonDetune_Cents = 0.0;
+	double stealXFadeTime_mSec = 0.0;
+	double limiterThreshold_dB = 0.0;
+	double limiterLookahead_mSec = 0.0;
+
+	// --- Meter Plugin Variables
+	float cpuLoadMeter = 0.f;
+	float voiceMeter = 0.f;
 
 	// --- Discrete Plugin Variables 
 	int lfo1Waveform = 0;
@@ -304,6 +356,33 @@ private:
 	int mode = 0;
 	enum class modeEnum { Poly,Mono,Unison };	// to compare: if(compareEnumToInt(modeEnum::Poly, mode)) etc... 
 
+	int stealPolicy = 0;
+	enum class stealPolicyEnum { Oldest,Quietest,Protect_Lowest,Release_First };	// to compare: if(compareEnumToInt(stealPolicyEnum::Oldest, stealPolicy)) etc... 
+
+	int stealMode = 0;
+	enum class stealModeEnum { Shutdown_EG,Crossfade };	// to compare: if(compareEnumToInt(stealModeEnum::Shutdown_EG, stealMode)) etc... 
+
+	int enablePhaser = 0;
+	enum class enablePhaserEnum { SWITCH_OFF,SWITCH_ON };	// to compare: if(compareEnumToInt(enablePhaserEnum::SWITCH_OFF, enablePhaser)) etc... 
+
+	int enableChorus = 0;
+	enum class enableChorusEnum { SWITCH_OFF,SWITCH_ON };	// to compare: if(compareEnumToInt(enableChorusEnum::SWITCH_OFF, enableChorus)) etc... 
+
+	int enableDelay = 0;
+	enum class enableDelayEnum { SWITCH_OFF,SWITCH_ON };	// to compare: if(compareEnumToInt(enableDelayEnum::SWITCH_OFF, enableDelay)) etc... 
+
+	int enableReverb = 0;
+	enum class enableReverbEnum { SWITCH_OFF,SWITCH_ON };	// to compare: if(compareEnumToInt(enableReverbEnum::SWITCH_OFF, enableReverb)) etc... 
+
+	int enableConvolution = 0;
+	enum class enableConvolutionEnum { SWITCH_OFF,SWITCH_ON };	// to compare: if(compareEnumToInt(enableConvolutionEnum::SWITCH_OFF, enableConvolution)) etc... 
+
+	int enableCompressor = 0;
+	enum class enableCompressorEnum { SWITCH_OFF,SWITCH_ON };	// to compare: if(compareEnumToInt(enableCompressorEnum::SWITCH_OFF, enableCompressor)) etc... 
+
+	int enableLimiter = 0;
+	enum class enableLimiterEnum { SWITCH_OFF,SWITCH_ON };	// to compare: if(compareEnumToInt(enableLimiterEnum::SWITCH_OFF, enableLimiter)) etc... 
+
 	// **--0x1A7F--**
     // --- end member variables
 
@@ -18,6 +18,7 @@
 #include <sstream>
 #include <atomic>
 #include <map>
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
 
@@ -428,6 +429,18 @@ public:
         paramSmoother.setSampleRate(sampleRate);
     }
 
+	/**
+	\brief get the current smoothing target; used by the block smoother in PluginBase
+	\return the target value the control is smoothing toward
+	*/
+	double getSmoothingTarget() const { return getSmoothedTargetValue(); }
+
+	/**
+	\brief write a smoothed value directly into the control; used by the block smoother in PluginBase
+	\param smoothedValue the new (smoothed) control value
+	*/
+	void setSmoothedControlValue(double smoothedValue) { setAtomicControlValueDouble(smoothedValue); }
+
 	/**
 	\brief perform smoothing operation on data
 
@@ -503,6 +516,41 @@ public:
 		return false;
 	}
 
+	/**
+	\brief perform the variable binding update only when the bound variable differs from the control value
+
+	\return true if the bound variable was changed
+	*/
+	bool updateInBoundVariableIfChanged()
+	{
+		double value = getControlValue();
+		if (boundVariableUInt)
+		{
+			if (*boundVariableUInt == (uint32_t)value) return false;
+			*boundVariableUInt = (uint32_t)value;
+			return true;
+		}
+		else if (boundVariableInt)
+		{
+			if (*boundVariableInt == (int)value) return false;
+			*boundVariableInt = (int)value;
+			return true;
+		}
+		else if (boundVariableFloat)
+		{
+			if (*boundVariableFloat == (float)value) return false;
+			*boundVariableFloat = (float)value;
+			return true;
+		}
+		else if (boundVariableDouble)
+		{
+			if (*boundVariableDouble == value) return false;
+			*boundVariableDouble = value;
+			return true;
+		}
+		return false;
+	}
+
 	/**
 	\brief perform the variable binding update on meter data
 
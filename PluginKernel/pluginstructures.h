@@ -20,10 +20,20 @@
 #include <sstream>
 #include <vector>
 #include <stdint.h>
+#include <string.h>
+#include <atomic>
 
 #include "readerwriterqueue.h"
 #include "atomicops.h"
 
+// --- FTZ/DAZ control for DenormalGuard
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+#include <xmmintrin.h>
+#define DENORMAL_GUARD_SSE 1
+#elif defined(__aarch64__)
+#define DENORMAL_GUARD_ARM64 1
+#endif
+
 class IGUIPluginConnector;
 class IGUIWindowFrame;
 class IGUIView;
@@ -1595,6 +1605,150 @@ public:
 	virtual bool getNextValue(double& _nextValue) = 0;
 };
 
+const uint32_t kMaxAutomationRampPoints = 64;	///< breakpoints one ramp holds at a time; a full ramp is refilled as it plays
+const uint32_t kControlRateFrames = 32;			///< sub-block size for control-rate parameter updates inside a buffer
+
+/**
+\class ParameterAutomationRamp
+\ingroup ASPiK-Core
+\brief
+Piecewise-linear automation ramp for one parameter across one audio block.
+
+Operation:
+- reset() with the parameter's value at the start of the block (the anchor at frame 0)
+- addPoint() for each automation breakpoint in increasing frame order; values are actual (plain) control values
+- a point on the line of the last segment extends that segment, so a linear run of any length is one breakpoint
+- addPoint() returns false once kMaxAutomationRampPoints are held; the owner sets hasMorePoints and, when
+  needsRefill() says the last point has been reached, calls continueFromLastPoint() and adds the rest
+- getValueAtFrame() with non-decreasing frames returns the interpolated value with no virtual calls
+- the value holds at the last point once it has been passed
+*/
+class ParameterAutomationRamp
+{
+public:
+	ParameterAutomationRamp() {}
+
+	/** start a new block
+	\param startValue the control value at the start of the block
+	*/
+	void reset(double startValue)
+	{
+		anchorFrame = 0;
+		anchorValue = startValue;
+		lastAppliedValue = startValue;
+		numPoints = 0;
+		cursor = 0;
+		hasMorePoints = false;
+		queuePosition = 0;
+		queueValue = 0.0;
+	}
+
+	/** start the next set of points where the current set ends; the last point becomes the anchor */
+	void continueFromLastPoint()
+	{
+		if (numPoints > 0)
+		{
+			anchorFrame = pointFrame[numPoints - 1];
+			anchorValue = pointValue[numPoints - 1];
+		}
+		numPoints = 0;
+		cursor = 0;
+	}
+
+	/** add a breakpoint; a point at or before the previous point's frame replaces it, and a point on the line of
+	the last segment extends it
+	\param frame sample offset in the block
+	\param value control value reached at that frame
+	\return false if the ramp is full and the point was not added
+	*/
+	bool addPoint(uint32_t frame, double value)
+	{
+		if (numPoints > 0)
+		{
+			uint32_t lastFrame = pointFrame[numPoints - 1];
+			if (frame <= lastFrame)
+			{
+				// --- same frame (or out of order): the newer value wins
+				frame = lastFrame;
+				numPoints--;
+			}
+			else
+			{
+				// --- collinear: move the last point forward instead of adding one
+				double predicted = pointValue[numPoints - 1] + slope[numPoints - 1] * (double)(frame - lastFrame);
+				if (fabs(value - predicted) <= 1.0e-9 * (1.0 + fabs(value)))
+					numPoints--;
+				else if (numPoints == kMaxAutomationRampPoints)
+					return false;
+			}
+		}
+
+		uint32_t prevFrame = numPoints > 0 ? pointFrame[numPoints - 1] : anchorFrame;
+		double prevValue = numPoints > 0 ? pointValue[numPoints - 1] : anchorValue;
+
+		pointFrame[numPoints] = frame;
+		pointValue[numPoints] = value;
+		slope[numPoints] = frame > prevFrame ? (value - prevValue) / (double)(frame - prevFrame) : 0.0;
+		numPoints++;
+		return true;
+	}
+
+	/** true if the queue still holds points and the read position has reached the last one held
+	\param frame the next frame to be read
+	*/
+	bool needsRefill(uint32_t frame) const { return hasMorePoints && (numPoints == 0 || frame >= pointFrame[numPoints - 1]); }
+
+	/** true if any breakpoint moves the value away from the anchor, or more points are still to come */
+	bool isMoving() const
+	{
+		if (hasMorePoints)
+			return true;
+
+		for (uint32_t i = 0; i < numPoints; i++)
+		{
+			if (pointValue[i] != anchorValue)
+				return true;
+		}
+		return false;
+	}
+
+	/** get the ramp value at a frame; frames must not decrease within a block
+	\param frame sample offset in the block
+	\return the interpolated control value
+	*/
+	inline double getValueAtFrame(uint32_t frame)
+	{
+		while (cursor < numPoints && frame >= pointFrame[cursor])
+			cursor++;
+
+		if (cursor == numPoints)
+			return numPoints > 0 ? pointValue[numPoints - 1] : anchorValue;
+
+		uint32_t prevFrame = cursor > 0 ? pointFrame[cursor - 1] : anchorFrame;
+		double prevValue = cursor > 0 ? pointValue[cursor - 1] : anchorValue;
+		return prevValue + (double)(frame - prevFrame) * slope[cursor];
+	}
+
+	/** true once the last breakpoint has been passed and the queue holds no more */
+	bool isFinished() const { return cursor == numPoints && !hasMorePoints; }
+
+	double lastAppliedValue = 0.0;	///< last value written to the parameter
+
+	// --- refill state, owned by the code that reads the queue
+	bool hasMorePoints = false;		///< the queue holds points that did not fit
+	uint32_t queuePosition = 0;		///< next frame to read from the queue
+	double queueValue = 0.0;		///< last normalized value read from the queue
+
+private:
+	uint32_t anchorFrame = 0;								///< frame of the anchor: 0, or the last point of the previous set
+	double anchorValue = 0.0;								///< value at the anchor frame
+	uint32_t pointFrame[kMaxAutomationRampPoints] = { 0 };	///< breakpoint frames
+	double pointValue[kMaxAutomationRampPoints] = { 0.0 };	///< breakpoint values
+	double slope[kMaxAutomationRampPoints] = { 0.0 };		///< per-sample slope INTO each breakpoint
+	uint32_t numPoints = 0;									///< breakpoint count
+	uint32_t cursor = 0;									///< next breakpoint ahead of the read position
+};
+
 // --------------------------------------------------------------------------------------------------------------------------- //
 // --- HELPER FUNCTIONS
 // --------------------------------------------------------------------------------------------------------------------------- //
@@ -1684,4 +1838,135 @@ inline std::string boolToStdString(bool value)
 }
 
 
+/**
+\class DenormalGuard
+\ingroup Constants-Enums
+\brief
+Scoped flush-to-zero/denormals-are-zero switch for the audio thread. Construct one on the stack around
+rendering; the previous FPU state is restored when it goes out of scope so the host's own settings are untouched.
+
+- x86/x64: sets FTZ (MXCSR bit 15) and DAZ (MXCSR bit 6)
+- ARM64: sets FZ (FPCR bit 24)
+- other targets: no-op
+
+Decaying filter integrators, EG release tails and feedback delay lines all head toward zero and would
+otherwise spend many samples in the (very slow) denormal range after notes are released.
+*/
+class DenormalGuard
+{
+public:
+	DenormalGuard()
+	{
+#if defined(DENORMAL_GUARD_SSE)
+		savedState = _mm_getcsr();
+		_mm_setcsr(savedState | 0x8040);
+#elif defined(DENORMAL_GUARD_ARM64)
+		uint64_t fpcr = 0;
+		__asm__ __volatile__("mrs %0, fpcr" : "=r"(fpcr));
+		savedState = fpcr;
+		fpcr |= (1ULL << 24);
+		__asm__ __volatile__("msr fpcr, %0" : : "r"(fpcr));
+#endif
+	}
+
+	~DenormalGuard()
+	{
+#if defined(DENORMAL_GUARD_SSE)
+		_mm_setcsr((unsigned int)savedState);
+#elif defined(DENORMAL_GUARD_ARM64)
+		__asm__ __volatile__("msr fpcr, %0" : : "r"(savedState));
+#endif
+	}
+
+private:
+	DenormalGuard(const DenormalGuard&) = delete;
+	DenormalGuard& operator=(const DenormalGuard&) = delete;
+
+	uint64_t savedState = 0; ///< MXCSR or FPCR value at construction
+};
+
+/**
+\class ParameterDirtyFlags
+\ingroup Constants-Enums
+\brief
+Lock-free set of up to 64 dirty bits, usually one per parameter group. Any thread (host, GUI, audio) may mark bits;
+the audio thread collects and clears them with one atomic exchange at the top of each buffer so that only
+the groups that actually changed are re-cooked.
+
+- everything starts out dirty so that the first buffer does a full update
+*/
+class ParameterDirtyFlags
+{
+public:
+	ParameterDirtyFlags() {}
+
+	void markDirty(uint64_t mask) { flags.fetch_or(mask, std::memory_order_release); }		///< set one or more bits
+	void markAllDirty() { flags.store(~(uint64_t)0, std::memory_order_release); }			///< force a full update
+	uint64_t getAndClearDirty() { return flags.exchange(0, std::memory_order_acq_rel); }	///< collect and reset; call once per buffer or control-rate sub-block
+	bool isDirty() { return flags.load(std::memory_order_acquire) != 0; }					///< peek without clearing
+
+private:
+	std::atomic<uint64_t> flags{ ~(uint64_t)0 };
+};
+
+/**
+\class ParameterSnapshotExchange
+\ingroup Constants-Enums
+\brief
+Lock-free triple buffer for handing a complete parameter structure from one writer thread (GUI/host) to the audio thread.
+
+- the writer fills the back slot and publishes it with one atomic exchange
+- the audio thread acquires the newest published slot with one atomic exchange and then reads plain fields; it
+  always sees a complete, consistent snapshot and never a half-written one
+- the three slots are pre-allocated, so nothing is ever allocated or freed on either side
+- T must be copy-assignable; for more than one writer thread, serialize the writers
+*/
+template <typename T>
+class ParameterSnapshotExchange
+{
+public:
+	ParameterSnapshotExchange() {}
+
+	// --- WRITER: fill this, then publish()
+	T& getWriteSlot() { return slots[backIndex]; }
+
+	// --- WRITER: make the back slot the newest snapshot
+	void publish()
+	{
+		backIndex = middle.exchange(backIndex | kFreshBit, std::memory_order_acq_rel) & kIndexMask;
+	}
+
+	// --- WRITER: copy and publish in one call
+	void publish(const T& snapshot)
+	{
+		slots[backIndex] = snapshot;
+		publish();
+	}
+
+	// --- READER: take the newest snapshot, if there is one; returns true if it changed
+	bool acquire()
+	{
+		if ((middle.load(std::memory_order_acquire) & kFreshBit) == 0)
+			return false;
+
+		frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & kIndexMask;
+		return true;
+	}
+
+	// --- READER: the most recently acquired snapshot
+	const T& read() const { return slots[frontIndex]; }
+
+private:
+	ParameterSnapshotExchange(const ParameterSnapshotExchange&) = delete;
+	ParameterSnapshotExchange& operator=(const ParameterSnapshotExchange&) = delete;
+
+	static const uint32_t kIndexMask = 0x3;
+	static const uint32_t kFreshBit = 0x4;
+
+	T slots[3];
+	uint32_t backIndex = 0;					///< owned by the writer
+	std::atomic<uint32_t> middle{ 1 };		///< shared; index | kFreshBit when a new snapshot is waiting
+	uint32_t frontIndex = 2;				///< owned by the reader
+};
+
 #endif //_pluginstructures_h
@@ -0,0 +1,424 @@
+#include "biquadcascade.h"
+
+#include <algorithm>
+
+/**
+\brief Run an AudioFilter design and copy out its coefficients; the AudioFilter lives on the stack and does not
+allocate, so this is safe on the audio thread
+
+\param params the filter algorithm, fc, Q and gain
+\param sampleRate the sample rate the filter runs at
+\param coeffs array of numCoeffs values that receives the coefficients
+*/
+void calculateAudioFilterCoeffs(const AudioFilterParameters& params, double sampleRate, double* coeffs)
+{
+	AudioFilter filter;
+
+	// --- the sample rate first: setParameters() skips the calculation when the parameters equal the defaults
+	filter.setSampleRate(sampleRate);
+	filter.setParameters(params);
+	filter.getCoefficients(coeffs);
+}
+
+#ifdef BIQUAD_CASCADE_SSE2
+// --- one section on two lanes; c holds a0, a1, a2, b1, b2
+static inline __m128d biquadStep(__m128d x, const __m128d* c, __m128d& s1, __m128d& s2)
+{
+	__m128d y = _mm_add_pd(_mm_mul_pd(c[0], x), s1);
+	s1 = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(c[1], x), _mm_mul_pd(c[3], y)), s2);
+	s2 = _mm_sub_pd(_mm_mul_pd(c[2], x), _mm_mul_pd(c[4], y));
+	return y;
+}
+#endif
+
+// --- one section over a block of interleaved lanes:
+//     y = a0*x + s1; s1 = a1*x - b1*y + s2; s2 = a2*x - b2*y
+static void processSection(const double (&c)[5][BIQUAD_CASCADE_LANES], double (&s)[2][BIQUAD_CASCADE_LANES], double* frames, uint32_t numFrames)
+{
+#ifdef BIQUAD_CASCADE_SSE2
+	__m128d coeffs[2][5];
+	for (uint32_t half = 0; half < 2; half++)
+	{
+		for (uint32_t k = 0; k < 5; k++)
+			coeffs[half][k] = _mm_load_pd(&c[k][2 * half]);
+	}
+
+	__m128d s1[2] = { _mm_load_pd(&s[0][0]), _mm_load_pd(&s[0][2]) };
+	__m128d s2[2] = { _mm_load_pd(&s[1][0]), _mm_load_pd(&s[1][2]) };
+
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		double* frame = frames + i * BIQUAD_CASCADE_LANES;
+		_mm_storeu_pd(frame, biquadStep(_mm_loadu_pd(frame), coeffs[0], s1[0], s2[0]));
+		_mm_storeu_pd(frame + 2, biquadStep(_mm_loadu_pd(frame + 2), coeffs[1], s1[1], s2[1]));
+	}
+
+	for (uint32_t half = 0; half < 2; half++)
+	{
+		_mm_store_pd(&s[0][2 * half], s1[half]);
+		_mm_store_pd(&s[1][2 * half], s2[half]);
+	}
+#else
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		double* frame = frames + i * BIQUAD_CASCADE_LANES;
+		for (uint32_t lane = 0; lane < BIQUAD_CASCADE_LANES; lane++)
+		{
+			double x = frame[lane];
+			double y = c[0][lane] * x + s[0][lane];
+			s[0][lane] = c[1][lane] * x - c[3][lane] * y + s[1][lane];
+			s[1][lane] = c[2][lane] * x - c[4][lane] * y;
+			frame[lane] = y;
+		}
+	}
+#endif
+}
+
+// --- two sections in series in one pass; the recursion of section B on frame n overlaps section A on frame n + 1,
+//     and the low and high lane pairs run side by side
+static void processSectionPair(const double (&cA)[5][BIQUAD_CASCADE_LANES], double (&sA)[2][BIQUAD_CASCADE_LANES],
+							   const double (&cB)[5][BIQUAD_CASCADE_LANES], double (&sB)[2][BIQUAD_CASCADE_LANES],
+							   double* frames, uint32_t numFrames)
+{
+#ifdef BIQUAD_CASCADE_SSE2
+	__m128d coeffsA[2][5], coeffsB[2][5];
+	for (uint32_t half = 0; half < 2; half++)
+	{
+		for (uint32_t k = 0; k < 5; k++)
+		{
+			coeffsA[half][k] = _mm_load_pd(&cA[k][2 * half]);
+			coeffsB[half][k] = _mm_load_pd(&cB[k][2 * half]);
+		}
+	}
+
+	__m128d s1A[2] = { _mm_load_pd(&sA[0][0]), _mm_load_pd(&sA[0][2]) };
+	__m128d s2A[2] = { _mm_load_pd(&sA[1][0]), _mm_load_pd(&sA[1][2]) };
+	__m128d s1B[2] = { _mm_load_pd(&sB[0][0]), _mm_load_pd(&sB[0][2]) };
+	__m128d s2B[2] = { _mm_load_pd(&sB[1][0]), _mm_load_pd(&sB[1][2]) };
+
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		double* frame = frames + i * BIQUAD_CASCADE_LANES;
+		__m128d yLow = biquadStep(_mm_loadu_pd(frame), coeffsA[0], s1A[0], s2A[0]);
+		__m128d yHigh = biquadStep(_mm_loadu_pd(frame + 2), coeffsA[1], s1A[1], s2A[1]);
+		_mm_storeu_pd(frame, biquadStep(yLow, coeffsB[0], s1B[0], s2B[0]));
+		_mm_storeu_pd(frame + 2, biquadStep(yHigh, coeffsB[1], s1B[1], s2B[1]));
+	}
+
+	for (uint32_t half = 0; half < 2; half++)
+	{
+		_mm_store_pd(&sA[0][2 * half], s1A[half]);
+		_mm_store_pd(&sA[1][2 * half], s2A[half]);
+		_mm_store_pd(&sB[0][2 * half], s1B[half]);
+		_mm_store_pd(&sB[1][2 * half], s2B[half]);
+	}
+#else
+	processSection(cA, sA, frames, numFrames);
+	processSection(cB, sB, frames, numFrames);
+#endif
+}
+
+BiquadCascade::BiquadCascade()
+{
+	for (uint32_t section = 0; section < BIQUAD_CASCADE_MAX_SECTIONS; section++)
+	{
+		for (uint32_t lane = 0; lane < BIQUAD_CASCADE_LANES; lane++)
+			setPassThrough(section, lane);
+	}
+	reset();
+}
+
+/**
+\brief Clear the section states
+*/
+void BiquadCascade::reset()
+{
+	memset(&states[0][0][0], 0, sizeof(states));
+}
+
+/**
+\brief Set the number of sections in series; sections beyond the old count start as pass-through with clear states,
+so lanes that are not given coefficients just pass the signal
+
+\param _numSections 0 to BIQUAD_CASCADE_MAX_SECTIONS
+*/
+void BiquadCascade::setNumSections(uint32_t _numSections)
+{
+	_numSections = std::min(_numSections, BIQUAD_CASCADE_MAX_SECTIONS);
+	for (uint32_t section = numSections; section < _numSections; section++)
+	{
+		for (uint32_t lane = 0; lane < BIQUAD_CASCADE_LANES; lane++)
+		{
+			setPassThrough(section, lane);
+			states[section][0][lane] = 0.0;
+			states[section][1][lane] = 0.0;
+		}
+	}
+	numSections = _numSections;
+}
+
+/**
+\brief Set one section of one lane; AudioFilter returns y = d0*x + c0*H(x), and since H has the denominator
+1 + b1 z^-1 + b2 z^-2, the dry term folds into the numerator as d0 * (1, b1, b2)
+
+\param section the section, 0 to BIQUAD_CASCADE_MAX_SECTIONS - 1
+\param lane the lane, 0 to BIQUAD_CASCADE_LANES - 1
+\param coeffs numCoeffs values in the filterCoeff layout
+*/
+void BiquadCascade::setCoefficients(uint32_t section, uint32_t lane, const double* coeffs)
+{
+	if (section >= BIQUAD_CASCADE_MAX_SECTIONS || lane >= BIQUAD_CASCADE_LANES)
+		return;
+
+	this->coeffs[section][0][lane] = coeffs[c0] * coeffs[a0] + coeffs[d0];
+	this->coeffs[section][1][lane] = coeffs[c0] * coeffs[a1] + coeffs[d0] * coeffs[b1];
+	this->coeffs[section][2][lane] = coeffs[c0] * coeffs[a2] + coeffs[d0] * coeffs[b2];
+	this->coeffs[section][3][lane] = coeffs[b1];
+	this->coeffs[section][4][lane] = coeffs[b2];
+}
+
+/**
+\brief Set one section of every lane
+
+\param section the section, 0 to BIQUAD_CASCADE_MAX_SECTIONS - 1
+\param coeffs numCoeffs values in the filterCoeff layout
+*/
+void BiquadCascade::setCoefficients(uint32_t section, const double* coeffs)
+{
+	for (uint32_t lane = 0; lane < BIQUAD_CASCADE_LANES; lane++)
+		setCoefficients(section, lane, coeffs);
+}
+
+/**
+\brief Make one section of one lane a pass-through
+*/
+void BiquadCascade::setPassThrough(uint32_t section, uint32_t lane)
+{
+	if (section >= BIQUAD_CASCADE_MAX_SECTIONS || lane >= BIQUAD_CASCADE_LANES)
+		return;
+
+	coeffs[section][0][lane] = 1.0;
+	for (uint32_t i = 1; i < 5; i++)
+		coeffs[section][i][lane] = 0.0;
+}
+
+/**
+\brief Run the cascade over interleaved frames in place, two sections per pass
+
+\param frames numFrames * BIQUAD_CASCADE_LANES doubles, lane-interleaved
+\param numFrames the number of frames
+*/
+void BiquadCascade::processInterleaved(double* frames, uint32_t numFrames)
+{
+	uint32_t section = 0;
+	for (; section + 1 < numSections; section += 2)
+		processSectionPair(coeffs[section], states[section], coeffs[section + 1], states[section + 1], frames, numFrames);
+
+	if (section < numSections)
+		processSection(coeffs[section], states[section], frames, numFrames);
+}
+
+/**
+\brief Run the cascade over non-interleaved channels, one per lane, in chunks of BIQUAD_CASCADE_BLOCK_SIZE frames;
+the unused lanes run on silence
+
+\param inputs one pointer per channel
+\param outputs one pointer per channel; may be the inputs
+\param numChannels 1 to BIQUAD_CASCADE_LANES
+\param numFrames the number of frames
+*/
+void BiquadCascade::processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t numChannels, uint32_t numFrames)
+{
+	numChannels = std::min(numChannels, BIQUAD_CASCADE_LANES);
+
+	for (uint32_t offset = 0; offset < numFrames; offset += BIQUAD_CASCADE_BLOCK_SIZE)
+	{
+		uint32_t chunkFrames = std::min(numFrames - offset, BIQUAD_CASCADE_BLOCK_SIZE);
+
+		memset(laneBuffer, 0, sizeof(double) * chunkFrames * BIQUAD_CASCADE_LANES);
+		for (uint32_t c = 0; c < numChannels; c++)
+		{
+			for (uint32_t i = 0; i < chunkFrames; i++)
+				laneBuffer[i * BIQUAD_CASCADE_LANES + c] = inputs[c][offset + i];
+		}
+
+		processInterleaved(laneBuffer, chunkFrames);
+
+		for (uint32_t c = 0; c < numChannels; c++)
+		{
+			for (uint32_t i = 0; i < chunkFrames; i++)
+				outputs[c][offset + i] = (float)laneBuffer[i * BIQUAD_CASCADE_LANES + c];
+		}
+	}
+}
+
+/**
+\brief Flush the filters and design them for the new sample rate
+
+\param _sampleRate the new sample rate
+*/
+bool LRCrossover::reset(double _sampleRate)
+{
+	sampleRate = _sampleRate;
+	updateFilters();
+
+	for (uint32_t k = 0; k < LR_CROSSOVER_MAX_BANDS - 1; k++)
+		split[k].reset();
+	allpass.reset();
+	return true;
+}
+
+/**
+\brief Store the parameters and re-design the filters; the states are kept, so the split points can move while
+audio runs
+
+\param params the new parameters
+*/
+void LRCrossover::setParameters(const LRCrossoverParameters& params)
+{
+	parameters = params;
+	parameters.numBands = std::min(std::max(parameters.numBands, 2u), LR_CROSSOVER_MAX_BANDS);
+
+	if (sampleRate > 0.0)
+		updateFilters();
+}
+
+/**
+\brief Design the splits and the phase compensation:
+- split k: Butterworth LPF twice on lanes 0/1, Butterworth HPF twice on lanes 2/3 (4th order Linkwitz-Riley)
+- the LR4 low and high outputs sum to the 2nd order allpass with the Butterworth denominator, whose numerator is
+  the denominator reversed: (b2, b1, 1)
+- band b (below the last split) passes through the allpass of each split above it: band 0 on lanes 0/1 of the allpass
+  cascade, band 1 on lanes 2/3
+*/
+void LRCrossover::updateFilters()
+{
+	const uint32_t numSplits = parameters.numBands - 1;
+	double allpassCoeffs[LR_CROSSOVER_MAX_BANDS - 1][numCoeffs] = { { 0.0 } };
+
+	for (uint32_t k = 0; k < numSplits; k++)
+	{
+		AudioFilterParameters filterParameters;
+		filterParameters.fc = std::min(std::max(parameters.splitFrequency[k], 10.0), 0.45 * sampleRate);
+
+		double lowpass[numCoeffs] = { 0.0 };
+		filterParameters.algorithm = filterAlgorithm::kButterLPF2;
+		calculateAudioFilterCoeffs(filterParameters, sampleRate, lowpass);
+
+		double highpass[numCoeffs] = { 0.0 };
+		filterParameters.algorithm = filterAlgorithm::kButterHPF2;
+		calculateAudioFilterCoeffs(filterParameters, sampleRate, highpass);
+
+		split[k].setNumSections(2);
+		for (uint32_t section = 0; section < 2; section++)
+		{
+			split[k].setCoefficients(section, 0, lowpass);
+			split[k].setCoefficients(section, 1, lowpass);
+			split[k].setCoefficients(section, 2, highpass);
+			split[k].setCoefficients(section, 3, highpass);
+		}
+
+		allpassCoeffs[k][a0] = lowpass[b2];
+		allpassCoeffs[k][a1] = lowpass[b1];
+		allpassCoeffs[k][a2] = 1.0;
+		allpassCoeffs[k][b1] = lowpass[b1];
+		allpassCoeffs[k][b2] = lowpass[b2];
+		allpassCoeffs[k][c0] = 1.0;
+		allpassCoeffs[k][d0] = 0.0;
+	}
+
+	// --- band 0 needs splits 1 .. numSplits - 1, band 1 needs splits 2 .. numSplits - 1
+	allpass.setNumSections(numSplits - 1);
+	for (uint32_t section = 0; section + 1 < numSplits; section++)
+	{
+		allpass.setCoefficients(section, 0, allpassCoeffs[section + 1]);
+		allpass.setCoefficients(section, 1, allpassCoeffs[section + 1]);
+
+		if (section + 2 < numSplits)
+		{
+			allpass.setCoefficients(section, 2, allpassCoeffs[section + 2]);
+			allpass.setCoefficients(section, 3, allpassCoeffs[section + 2]);
+		}
+		else
+		{
+			allpass.setPassThrough(section, 2);
+			allpass.setPassThrough(section, 3);
+		}
+	}
+}
+
+/**
+\brief Split a stereo block into bands, in chunks of BIQUAD_CASCADE_BLOCK_SIZE frames
+
+\param inputL left input
+\param inputR right input
+\param bandsL one left output per band, lowest band first
+\param bandsR one right output per band, lowest band first
+\param numFrames the number of frames
+*/
+void LRCrossover::processAudioBlock(const float* inputL, const float* inputR, float* const* bandsL, float* const* bandsR, uint32_t numFrames)
+{
+	for (uint32_t offset = 0; offset < numFrames; offset += BIQUAD_CASCADE_BLOCK_SIZE)
+		processChunk(inputL, inputR, bandsL, bandsR, offset, std::min(numFrames - offset, BIQUAD_CASCADE_BLOCK_SIZE));
+}
+
+/**
+\brief Split one chunk: the input is read completely before any band is written, so the band buffers may be the
+input buffers
+*/
+void LRCrossover::processChunk(const float* inputL, const float* inputR, float* const* bandsL, float* const* bandsR, uint32_t offset, uint32_t numFrames)
+{
+	const uint32_t numSplits = parameters.numBands - 1;
+	const uint32_t L = BIQUAD_CASCADE_LANES;
+
+	// --- the first split sees the input on both its low and high lanes
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		splitBuffer[0][i * L + 0] = splitBuffer[0][i * L + 2] = inputL[offset + i];
+		splitBuffer[0][i * L + 1] = splitBuffer[0][i * L + 3] = inputR[offset + i];
+	}
+	split[0].processInterleaved(splitBuffer[0], numFrames);
+
+	// --- each further split gets the high side of the one below
+	for (uint32_t k = 1; k < numSplits; k++)
+	{
+		for (uint32_t i = 0; i < numFrames; i++)
+		{
+			splitBuffer[k][i * L + 0] = splitBuffer[k][i * L + 2] = splitBuffer[k - 1][i * L + 2];
+			splitBuffer[k][i * L + 1] = splitBuffer[k][i * L + 3] = splitBuffer[k - 1][i * L + 3];
+		}
+		split[k].processInterleaved(splitBuffer[k], numFrames);
+	}
+
+	// --- phase compensation for the bands below the last split
+	if (numSplits > 1)
+	{
+		for (uint32_t i = 0; i < numFrames; i++)
+		{
+			allpassBuffer[i * L + 0] = splitBuffer[0][i * L + 0];
+			allpassBuffer[i * L + 1] = splitBuffer[0][i * L + 1];
+			allpassBuffer[i * L + 2] = splitBuffer[1][i * L + 0];
+			allpassBuffer[i * L + 3] = splitBuffer[1][i * L + 1];
+		}
+		allpass.processInterleaved(allpassBuffer, numFrames);
+	}
+
+	// --- band b is the low side of split b (compensated if a split lies above it); the last band is the high side
+	//     of the last split
+	for (uint32_t band = 0; band <= numSplits; band++)
+	{
+		const double* source = nullptr;
+		if (band == numSplits)
+			source = splitBuffer[numSplits - 1] + 2;
+		else if (band + 1 < numSplits)
+			source = allpassBuffer + 2 * band;
+		else
+			source = splitBuffer[band];
+
+		for (uint32_t i = 0; i < numFrames; i++)
+		{
+			bandsL[band][offset + i] = (float)source[i * L + 0];
+			bandsR[band][offset + i] = (float)source[i * L + 1];
+		}
+	}
+}
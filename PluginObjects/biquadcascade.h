@@ -0,0 +1,191 @@
+#ifndef __biquadCascade_h__
+#define __biquadCascade_h__
+
+#include "fxobjects.h"
+
+// --- SSE2 double precision for the lanes, two lanes per vector; other targets use the scalar loops, which the
+//     compiler can still vectorize
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BIQUAD_CASCADE_SSE2 1
+#endif
+
+// --- one SIMD lane per channel (or voice, or band); two SSE2 vectors
+const uint32_t BIQUAD_CASCADE_LANES = 4;
+
+// --- enough for 4 bands of Linkwitz-Riley crossover plus a few EQ sections
+const uint32_t BIQUAD_CASCADE_MAX_SECTIONS = 8;
+
+// --- frames per internal chunk of processAudioBlock(); the blocks passed in may be any size
+const uint32_t BIQUAD_CASCADE_BLOCK_SIZE = 64;
+
+// --- the crossover splits into at most this many bands
+const uint32_t LR_CROSSOVER_MAX_BANDS = 4;
+
+/**
+@calculateAudioFilterCoeffs
+\ingroup FX-Functions
+
+@brief designs an AudioFilter and returns its coefficients, so the same designs can run in a BiquadCascade
+
+\param params the filter algorithm, fc, Q and gain
+\param sampleRate the sample rate the filter runs at
+\param coeffs array of numCoeffs values (filterCoeff layout) that receives the coefficients
+*/
+void calculateAudioFilterCoeffs(const AudioFilterParameters& params, double sampleRate, double* coeffs);
+
+/**
+\class BiquadCascade
+\ingroup SynthClasses
+\brief
+Up to BIQUAD_CASCADE_MAX_SECTIONS biquads in series, run on BIQUAD_CASCADE_LANES channels at once: each lane is one
+SIMD lane and has its own coefficients, so one cascade can hold the left and right channel of a filter, or the low and
+high side of a crossover split, or four voices.
+
+The sections use the transposed canonical form (transposed direct form II, as AudioFilter uses it by default):
+- y(n) = a0*x(n) + s1
+- s1 = a1*x(n) - b1*y(n) + s2
+- s2 = a2*x(n) - b2*y(n)
+
+Processing runs two sections at a time over the whole block, so their coefficients and states stay in registers and
+the two recursions overlap in the pipeline; there are no per-sample virtual calls. The math is double precision, as
+in Biquad: in single precision the transposed form is too noisy for low corners at high sample rates (a 20 Hz
+Butterworth at 192 kHz is only about 30 dB clean). There is no per-sample underflow check; the engine's FTZ/DAZ guard
+keeps the decaying states out of denormals.
+
+Audio I/O:
+- processInterleaved(): BIQUAD_CASCADE_LANES doubles per frame, in place
+- processAudioBlock(): up to BIQUAD_CASCADE_LANES non-interleaved channels, one per lane
+*/
+class BiquadCascade
+{
+public:
+	BiquadCascade();
+	~BiquadCascade() {}
+
+	/** clear the section states */
+	void reset();
+
+	/** set the number of sections in series; new sections start as pass-through */
+	void setNumSections(uint32_t _numSections);
+
+	/** number of sections in series */
+	uint32_t getNumSections() { return numSections; }
+
+	/** set one section of one lane from a numCoeffs array (filterCoeff layout); the c0/d0 wet/dry mix of
+	    AudioFilter is folded into the numerator */
+	void setCoefficients(uint32_t section, uint32_t lane, const double* coeffs);
+
+	/** set one section of every lane */
+	void setCoefficients(uint32_t section, const double* coeffs);
+
+	/** make one section of one lane a pass-through (a0 = 1) */
+	void setPassThrough(uint32_t section, uint32_t lane);
+
+	/** process numFrames interleaved frames of BIQUAD_CASCADE_LANES doubles in place */
+	void processInterleaved(double* frames, uint32_t numFrames);
+
+	/** process up to BIQUAD_CASCADE_LANES non-interleaved channels, one per lane; the inputs and outputs may be the
+	    same buffers */
+	void processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t numChannels, uint32_t numFrames);
+
+protected:
+	uint32_t numSections = 0;
+
+	// --- per section: a0, a1, a2, b1, b2, each one vector of lanes
+	alignas(16) double coeffs[BIQUAD_CASCADE_MAX_SECTIONS][5][BIQUAD_CASCADE_LANES];
+
+	// --- per section: s1, s2, each one vector of lanes
+	alignas(16) double states[BIQUAD_CASCADE_MAX_SECTIONS][2][BIQUAD_CASCADE_LANES];
+
+	// --- interleaving buffer for processAudioBlock()
+	alignas(16) double laneBuffer[BIQUAD_CASCADE_BLOCK_SIZE * BIQUAD_CASCADE_LANES];
+};
+
+/**
+\struct LRCrossoverParameters
+\ingroup SynthStructures
+\brief
+Custom parameter structure for the LRCrossover object.
+*/
+struct LRCrossoverParameters
+{
+	LRCrossoverParameters() {}
+
+	/** all FXObjects parameter objects require overloaded= operator so remember to add new entries if you add new variables. */
+	LRCrossoverParameters& operator=(const LRCrossoverParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		numBands = params.numBands;
+		for (uint32_t i = 0; i < LR_CROSSOVER_MAX_BANDS - 1; i++)
+			splitFrequency[i] = params.splitFrequency[i];
+		return *this;
+	}
+
+	// --- individual parameters
+	uint32_t numBands = 3;													///< 2 to LR_CROSSOVER_MAX_BANDS
+	double splitFrequency[LR_CROSSOVER_MAX_BANDS - 1] = { 200.0, 2000.0, 8000.0 };	///< rising split points (Hz); the first numBands - 1 are used
+};
+
+/**
+\class LRCrossover
+\ingroup SynthClasses
+\brief
+Stereo multi-band crossover for band-split dynamics, built from 4th order Linkwitz-Riley splits (two Butterworth
+sections per side) running in BiquadCascade lanes:
+
+- each split is one cascade whose lanes are the low-pass left/right and the high-pass left/right, so a split costs two
+  SIMD sections per frame
+- the high side of a split feeds the next split
+- the lower bands pass through the allpass of every split above them, in one more cascade, so all bands stay in phase
+  and their sum is the input through an allpass: flat magnitude, the bands can be recombined after processing
+
+A 4-band stereo split costs 8 SIMD sections per frame, where separate AudioFilter objects would run 30 sections
+one sample at a time. LRFilterBank remains the per-sample 2-band (2nd order) splitter.
+
+Control I/F:
+- Use LRCrossoverParameters structure to get/set object params; a change re-designs the filters without flushing them
+*/
+class LRCrossover
+{
+public:
+	LRCrossover() {}
+	~LRCrossover() {}
+
+	/** flush the filters and design them for the new sample rate */
+	bool reset(double _sampleRate);
+
+	/** get parameters */
+	LRCrossoverParameters getParameters() { return parameters; }
+
+	/** set parameters */
+	void setParameters(const LRCrossoverParameters& params);
+
+	/** split a stereo block into getParameters().numBands stereo bands, lowest first; bandsL[b] and bandsR[b] hold
+	    numFrames samples each and may be the input buffers */
+	void processAudioBlock(const float* inputL, const float* inputR, float* const* bandsL, float* const* bandsR, uint32_t numFrames);
+
+protected:
+	LRCrossoverParameters parameters;
+	double sampleRate = 0.0;
+
+	// --- split k: lanes are low-pass L, low-pass R, high-pass L, high-pass R
+	BiquadCascade split[LR_CROSSOVER_MAX_BANDS - 1];
+
+	// --- phase compensation: lanes are band 0 L/R and band 1 L/R
+	BiquadCascade allpass;
+
+	// --- interleaved lane buffers, one per split plus one for the allpass cascade
+	alignas(16) double splitBuffer[LR_CROSSOVER_MAX_BANDS - 1][BIQUAD_CASCADE_BLOCK_SIZE * BIQUAD_CASCADE_LANES];
+	alignas(16) double allpassBuffer[BIQUAD_CASCADE_BLOCK_SIZE * BIQUAD_CASCADE_LANES];
+
+	// --- design all cascades from the parameters
+	void updateFilters();
+
+	// --- split one chunk of at most BIQUAD_CASCADE_BLOCK_SIZE frames
+	void processChunk(const float* inputL, const float* inputR, float* const* bandsL, float* const* bandsR, uint32_t offset, uint32_t numFrames);
+};
+
+#endif /* defined(__biquadCascade_h__) */
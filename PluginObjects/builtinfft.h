@@ -0,0 +1,356 @@
+#ifndef __builtinFFT_h__
+#define __builtinFFT_h__
+
+// --- Header-only power-of-two FFT: complex and real (r2c/c2r) transforms on plans, under its own names so it can
+//     be linked next to FFTW. The convolvers use it directly; builtinfftw.h maps the FFTW API used by the FFT
+//     objects (FastFFT, PhaseVocoder, FastConvolver, PSMVocoder, SpectrumView) onto it when HAVE_FFTW is not defined.
+//
+//     - power-of-two lengths only; plan creation returns nullptr for other lengths
+//     - unnormalized transforms with FFTW's sign and layout conventions (interleaved complex, N/2 + 1 bins for r2c/c2r)
+//     - plans are read-only after creation, so one plan may be executed on several threads at once with the
+//       functions that take the arrays
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+// --- SSE2 butterflies: one double complex per register; other targets use the scalar loop
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define BUILTIN_FFT_SSE2 1
+#endif
+
+typedef double builtinFFTComplex[2];	///< re, im; the same layout as fftw_complex
+
+/**
+\enum builtinFFTKind
+\ingroup Constants-Enums
+\brief
+The transform a BuiltinFFTPlan computes.
+*/
+enum class builtinFFTKind { kForward, kBackward, kRealToComplex, kComplexToReal };
+
+/**
+\struct BuiltinFFTPlan
+\ingroup FFTW-Objects
+\brief
+A plan of the built-in FFT: the tables for one transform length and kind. The real transforms run a complex
+FFT of half the length on the even/odd sample pairs, plus a split step.
+*/
+struct BuiltinFFTPlan
+{
+	builtinFFTKind kind = builtinFFTKind::kForward;
+	unsigned int length = 0;				///< transform length N
+	unsigned int complexLength = 0;			///< complex FFT length M: N, or N/2 for the real transforms
+	bool inverse = false;					///< positive exponent: kBackward and kComplexToReal
+	std::vector<double> twiddles;			///< per stage of span s >= 4: exp(-+j2pi k/2s), k < s, at offset s - 4; interleaved
+	std::vector<double> splitTwiddles;		///< exp(-+j2pi k/N), k < M/2, interleaved; real transforms only
+	std::vector<unsigned int> bitReverse;	///< M-point bit reversal
+	void* input = nullptr;					///< planning arrays, for executeBuiltinFFTPlan()
+	void* output = nullptr;
+};
+
+// --- aligned allocation: 32 bytes, for SSE/AVX loads; the malloc() pointer is kept just below the block
+inline void* builtinFFTMalloc(size_t n)
+{
+	void* raw = malloc(n + 32 + sizeof(void*));
+	if (!raw)
+		return nullptr;
+
+	uintptr_t aligned = ((uintptr_t)raw + sizeof(void*) + 31) & ~(uintptr_t)31;
+	((void**)aligned)[-1] = raw;
+	return (void*)aligned;
+}
+
+inline void builtinFFTFree(void* p)
+{
+	if (p)
+		free(((void**)p)[-1]);
+}
+
+inline double* builtinFFTAllocReal(size_t n) { return (double*)builtinFFTMalloc(sizeof(double) * n); }
+inline builtinFFTComplex* builtinFFTAllocComplex(size_t n) { return (builtinFFTComplex*)builtinFFTMalloc(sizeof(builtinFFTComplex) * n); }
+
+/**
+\brief creates the tables for a plan; nullptr if the length is not a power of two
+*/
+inline BuiltinFFTPlan* createBuiltinFFTPlan(builtinFFTKind kind, int n, void* in, void* out)
+{
+	if (n < 1 || (n & (n - 1)) != 0)
+		return nullptr;
+
+	bool realTransform = kind == builtinFFTKind::kRealToComplex || kind == builtinFFTKind::kComplexToReal;
+	if (realTransform && n < 2)
+		return nullptr;
+
+	BuiltinFFTPlan* plan = new BuiltinFFTPlan;
+	plan->kind = kind;
+	plan->length = n;
+	plan->complexLength = realTransform ? n / 2 : n;
+	plan->input = in;
+	plan->output = out;
+
+	const double pi = 3.14159265358979323846;
+	plan->inverse = kind == builtinFFTKind::kBackward || kind == builtinFFTKind::kComplexToReal;
+	const double sign = plan->inverse ? 1.0 : -1.0;
+	const unsigned int M = plan->complexLength;
+
+	// --- contiguous twiddles for each radix-2 stage after the first radix-4 pass
+	plan->twiddles.resize(M > 4 ? 2 * (M - 4) : 2);
+	for (unsigned int span = 4; span < M; span <<= 1)
+	{
+		double* w = &plan->twiddles[2 * (span - 4)];
+		for (unsigned int k = 0; k < span; k++)
+		{
+			w[2 * k] = cos(pi * k / span);
+			w[2 * k + 1] = sign * sin(pi * k / span);
+		}
+	}
+
+	if (realTransform)
+	{
+		plan->splitTwiddles.resize(M > 1 ? M : 2);
+		for (unsigned int k = 0; k < M / 2; k++)
+		{
+			plan->splitTwiddles[2 * k] = cos(2.0 * pi * k / n);
+			plan->splitTwiddles[2 * k + 1] = sign * sin(2.0 * pi * k / n);
+		}
+	}
+
+	unsigned int numBits = 0;
+	while ((1u << numBits) < M)
+		numBits++;
+
+	plan->bitReverse.resize(M);
+	for (unsigned int i = 0; i < M; i++)
+	{
+		unsigned int reversed = 0;
+		for (unsigned int bit = 0; bit < numBits; bit++)
+			reversed |= ((i >> bit) & 1) << (numBits - 1 - bit);
+		plan->bitReverse[i] = reversed;
+	}
+
+	return plan;
+}
+
+/**
+\brief decimation-in-time butterflies, in place on M interleaved complex values in bit-reversed order: one radix-4
+pass (the first two stages, whose twiddles are 1 and -+j), then radix-2 stages with contiguous twiddles
+*/
+inline void doBuiltinFFTButterflies(double* data, unsigned int M, const double* twiddles, bool inverse)
+{
+	if (M == 2)
+	{
+		double ar = data[0], ai = data[1];
+		data[0] = ar + data[2];
+		data[1] = ai + data[3];
+		data[2] = ar - data[2];
+		data[3] = ai - data[3];
+		return;
+	}
+
+	// --- j * sign of the plan: -j forward, +j inverse
+	const double jSign = inverse ? 1.0 : -1.0;
+	for (unsigned int i = 0; i + 3 < M; i += 4)
+	{
+		double* x = &data[2 * i];
+		double a0r = x[0] + x[2], a0i = x[1] + x[3];
+		double a1r = x[0] - x[2], a1i = x[1] - x[3];
+		double a2r = x[4] + x[6], a2i = x[5] + x[7];
+		double a3r = x[4] - x[6], a3i = x[5] - x[7];
+
+		// --- w * a3 with w = jSign * j
+		double t3r = -jSign * a3i, t3i = jSign * a3r;
+
+		x[0] = a0r + a2r;
+		x[1] = a0i + a2i;
+		x[2] = a1r + t3r;
+		x[3] = a1i + t3i;
+		x[4] = a0r - a2r;
+		x[5] = a0i - a2i;
+		x[6] = a1r - t3r;
+		x[7] = a1i - t3i;
+	}
+
+#ifdef BUILTIN_FFT_SSE2
+	const __m128d signFlip = _mm_set_pd(1.0, -1.0);	// --- (-1 low, +1 high)
+#endif
+
+	for (unsigned int span = 4; span < M; span <<= 1)
+	{
+		const double* stageTwiddles = &twiddles[2 * (span - 4)];
+		for (unsigned int start = 0; start < M; start += 2 * span)
+		{
+			double* top = &data[2 * start];
+			double* bottom = &data[2 * (start + span)];
+			for (unsigned int j = 0; j < span; j++)
+			{
+				const double* w = &stageTwiddles[2 * j];
+#ifdef BUILTIN_FFT_SSE2
+				// --- t = w * bottom = (br*wr - bi*wi, br*wi + bi*wr)
+				__m128d wv = _mm_loadu_pd(w);
+				__m128d b = _mm_loadu_pd(&bottom[2 * j]);
+				__m128d t = _mm_add_pd(_mm_mul_pd(_mm_unpacklo_pd(b, b), wv),
+									   _mm_mul_pd(_mm_mul_pd(_mm_unpackhi_pd(b, b), _mm_shuffle_pd(wv, wv, 1)), signFlip));
+				__m128d u = _mm_loadu_pd(&top[2 * j]);
+				_mm_storeu_pd(&top[2 * j], _mm_add_pd(u, t));
+				_mm_storeu_pd(&bottom[2 * j], _mm_sub_pd(u, t));
+#else
+				double br = bottom[2 * j], bi = bottom[2 * j + 1];
+				double tr = br*w[0] - bi*w[1];
+				double ti = br*w[1] + bi*w[0];
+				double ur = top[2 * j], ui = top[2 * j + 1];
+				top[2 * j] = ur + tr;
+				top[2 * j + 1] = ui + ti;
+				bottom[2 * j] = ur - tr;
+				bottom[2 * j + 1] = ui - ti;
+#endif
+			}
+		}
+	}
+}
+
+/**
+\brief complex transform of a kForward or kBackward plan; in and out may be the same array
+*/
+inline void executeBuiltinFFT(const BuiltinFFTPlan* p, builtinFFTComplex* in, builtinFFTComplex* out)
+{
+	const unsigned int M = p->complexLength;
+	double* data = &out[0][0];
+
+	if (in == out)
+	{
+		for (unsigned int i = 0; i < M; i++)
+		{
+			unsigned int j = p->bitReverse[i];
+			if (j > i)
+			{
+				double r = out[i][0], im = out[i][1];
+				out[i][0] = out[j][0];
+				out[i][1] = out[j][1];
+				out[j][0] = r;
+				out[j][1] = im;
+			}
+		}
+	}
+	else
+	{
+		for (unsigned int i = 0; i < M; i++)
+		{
+			out[p->bitReverse[i]][0] = in[i][0];
+			out[p->bitReverse[i]][1] = in[i][1];
+		}
+	}
+
+	doBuiltinFFTButterflies(data, M, p->twiddles.data(), p->inverse);
+}
+
+/**
+\brief N reals -> N/2 + 1 bins: a complex FFT of the N/2 (even, odd) pairs in the output, then
+X[k] = E + W^k O and X[M-k] = conj(E - W^k O), with E = (Z[k] + conj Z[M-k])/2 and O = -j(Z[k] - conj Z[M-k])/2
+*/
+inline void executeBuiltinRealFFT(const BuiltinFFTPlan* p, const double* in, builtinFFTComplex* out)
+{
+	const unsigned int M = p->complexLength;
+
+	for (unsigned int i = 0; i < M; i++)
+	{
+		out[p->bitReverse[i]][0] = in[2 * i];
+		out[p->bitReverse[i]][1] = in[2 * i + 1];
+	}
+	doBuiltinFFTButterflies(&out[0][0], M, p->twiddles.data(), p->inverse);
+
+	const double* w = p->splitTwiddles.data();
+	for (unsigned int k = 1; k < (M + 1) / 2; k++)
+	{
+		double ar = out[k][0], ai = out[k][1];
+		double br = out[M - k][0], bi = out[M - k][1];
+
+		double er = 0.5*(ar + br), ei = 0.5*(ai - bi);
+		double or_ = 0.5*(ai + bi), oi = -0.5*(ar - br);
+
+		double tr = w[2 * k] * or_ - w[2 * k + 1] * oi;
+		double ti = w[2 * k] * oi + w[2 * k + 1] * or_;
+
+		out[k][0] = er + tr;
+		out[k][1] = ei + ti;
+		out[M - k][0] = er - tr;
+		out[M - k][1] = -(ei - ti);
+	}
+
+	// --- X[M/2] = conj(Z[M/2])
+	if (M >= 2)
+		out[M / 2][1] = -out[M / 2][1];
+
+	// --- DC and Nyquist
+	double zr = out[0][0], zi = out[0][1];
+	out[0][0] = zr + zi;
+	out[0][1] = 0.0;
+	out[M][0] = zr - zi;
+	out[M][1] = 0.0;
+}
+
+/**
+\brief N/2 + 1 bins -> N reals: Z[k] = S + V and Z[M-k] = conj(S - V), with S = X[k] + conj X[M-k] and
+V = j W^-k (X[k] - conj X[M-k]), then a complex inverse FFT of length N/2 in the output; the input is left intact
+*/
+inline void executeBuiltinInverseRealFFT(const BuiltinFFTPlan* p, const builtinFFTComplex* in, double* out)
+{
+	const unsigned int M = p->complexLength;
+	builtinFFTComplex* z = (builtinFFTComplex*)out;
+	const unsigned int* reverse = p->bitReverse.data();
+
+	// --- DC and Nyquist; their imaginary parts are ignored
+	z[reverse[0]][0] = in[0][0] + in[M][0];
+	z[reverse[0]][1] = in[0][0] - in[M][0];
+
+	const double* w = p->splitTwiddles.data();
+	for (unsigned int k = 1; k < (M + 1) / 2; k++)
+	{
+		double ar = in[k][0], ai = in[k][1];
+		double br = in[M - k][0], bi = in[M - k][1];
+
+		double sr = ar + br, si = ai - bi;
+		double dr = ar - br, di = ai + bi;
+
+		// --- V = j * w * D
+		double vr = -(w[2 * k] * di + w[2 * k + 1] * dr);
+		double vi = w[2 * k] * dr - w[2 * k + 1] * di;
+
+		z[reverse[k]][0] = sr + vr;
+		z[reverse[k]][1] = si + vi;
+		z[reverse[M - k]][0] = sr - vr;
+		z[reverse[M - k]][1] = -(si - vi);
+	}
+
+	// --- Z[M/2] = 2 conj(X[M/2])
+	if (M >= 2)
+	{
+		z[reverse[M / 2]][0] = 2.0*in[M / 2][0];
+		z[reverse[M / 2]][1] = -2.0*in[M / 2][1];
+	}
+
+	doBuiltinFFTButterflies(out, M, p->twiddles.data(), p->inverse);
+}
+
+/**
+\brief run a plan on the arrays it was created with
+*/
+inline void executeBuiltinFFTPlan(const BuiltinFFTPlan* p)
+{
+	if (p->kind == builtinFFTKind::kRealToComplex)
+		executeBuiltinRealFFT(p, (double*)p->input, (builtinFFTComplex*)p->output);
+	else if (p->kind == builtinFFTKind::kComplexToReal)
+		executeBuiltinInverseRealFFT(p, (builtinFFTComplex*)p->input, (double*)p->output);
+	else
+		executeBuiltinFFT(p, (builtinFFTComplex*)p->input, (builtinFFTComplex*)p->output);
+}
+
+inline void destroyBuiltinFFTPlan(BuiltinFFTPlan* p)
+{
+	delete p;
+}
+
+#endif /* defined(__builtinFFT_h__) */
@@ -0,0 +1,50 @@
+#ifndef __builtinFFTW_h__
+#define __builtinFFTW_h__
+
+// --- Thin FFTW-compatible shim over builtinfft.h: the part of the FFTW API used by the FFT objects (FastFFT,
+//     PhaseVocoder, FastConvolver, PSMVocoder, SpectrumView). fxobjects.h and customviews.h include it instead of
+//     fftw3.h when HAVE_FFTW is not defined; with HAVE_FFTW the real library is used and only the convolvers,
+//     which call the built-in FFT by its own names, keep running on it.
+//
+//     - the planner flags are accepted and ignored
+//     - everything else is forwarded unchanged; see builtinfft.h for the transform conventions
+
+#include "builtinfft.h"
+
+typedef builtinFFTComplex fftw_complex;
+typedef BuiltinFFTPlan* fftw_plan;
+
+#define FFTW_FORWARD (-1)
+#define FFTW_BACKWARD (+1)
+#define FFTW_MEASURE (0U)
+#define FFTW_DESTROY_INPUT (1U << 0)
+#define FFTW_PRESERVE_INPUT (1U << 4)
+#define FFTW_ESTIMATE (1U << 6)
+
+inline void* fftw_malloc(size_t n) { return builtinFFTMalloc(n); }
+inline void fftw_free(void* p) { builtinFFTFree(p); }
+inline double* fftw_alloc_real(size_t n) { return builtinFFTAllocReal(n); }
+inline fftw_complex* fftw_alloc_complex(size_t n) { return builtinFFTAllocComplex(n); }
+
+inline fftw_plan fftw_plan_dft_1d(int n, fftw_complex* in, fftw_complex* out, int sign, unsigned /*flags*/)
+{
+	return createBuiltinFFTPlan(sign == FFTW_FORWARD ? builtinFFTKind::kForward : builtinFFTKind::kBackward, n, in, out);
+}
+
+inline fftw_plan fftw_plan_dft_r2c_1d(int n, double* in, fftw_complex* out, unsigned /*flags*/)
+{
+	return createBuiltinFFTPlan(builtinFFTKind::kRealToComplex, n, in, out);
+}
+
+inline fftw_plan fftw_plan_dft_c2r_1d(int n, fftw_complex* in, double* out, unsigned /*flags*/)
+{
+	return createBuiltinFFTPlan(builtinFFTKind::kComplexToReal, n, in, out);
+}
+
+inline void fftw_execute_dft(const fftw_plan p, fftw_complex* in, fftw_complex* out) { executeBuiltinFFT(p, in, out); }
+inline void fftw_execute_dft_r2c(const fftw_plan p, double* in, fftw_complex* out) { executeBuiltinRealFFT(p, in, out); }
+inline void fftw_execute_dft_c2r(const fftw_plan p, fftw_complex* in, double* out) { executeBuiltinInverseRealFFT(p, in, out); }
+inline void fftw_execute(const fftw_plan p) { executeBuiltinFFTPlan(p); }
+inline void fftw_destroy_plan(fftw_plan p) { destroyBuiltinFFTPlan(p); }
+
+#endif /* defined(__builtinFFTW_h__) */
@@ -0,0 +1,621 @@
+#include "convolver.h"
+
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+
+// --- 4-wide SSE for the dot products and spectral multiply-accumulates; other targets use the scalar loops
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#include <xmmintrin.h>
+#define CONVOLVER_SSE 1
+#endif
+
+// --- sum += x * h over split complex arrays; each bin is computed exactly as the scalar loop does
+static inline void complexMultiplyAccumulate(const float* xReal, const float* xImag, const float* hReal, const float* hImag,
+											 float* sumReal, float* sumImag, uint32_t numBins)
+{
+	uint32_t k = 0;
+#ifdef CONVOLVER_SSE
+	for (; k + 4 <= numBins; k += 4)
+	{
+		__m128 xr = _mm_loadu_ps(xReal + k);
+		__m128 xi = _mm_loadu_ps(xImag + k);
+		__m128 hr = _mm_loadu_ps(hReal + k);
+		__m128 hi = _mm_loadu_ps(hImag + k);
+		__m128 real = _mm_sub_ps(_mm_mul_ps(xr, hr), _mm_mul_ps(xi, hi));
+		__m128 imag = _mm_add_ps(_mm_mul_ps(xr, hi), _mm_mul_ps(xi, hr));
+		_mm_storeu_ps(sumReal + k, _mm_add_ps(_mm_loadu_ps(sumReal + k), real));
+		_mm_storeu_ps(sumImag + k, _mm_add_ps(_mm_loadu_ps(sumImag + k), imag));
+	}
+#endif
+	for (; k < numBins; k++)
+	{
+		sumReal[k] += xReal[k] * hReal[k] - xImag[k] * hImag[k];
+		sumImag[k] += xReal[k] * hImag[k] + xImag[k] * hReal[k];
+	}
+}
+
+// --- sum of a[i] * b[i]; length is a multiple of 4
+static inline float dotProduct(const float* a, const float* b, uint32_t length)
+{
+#ifdef CONVOLVER_SSE
+	__m128 acc0 = _mm_setzero_ps();
+	__m128 acc1 = _mm_setzero_ps();
+	uint32_t i = 0;
+	for (; i + 8 <= length; i += 8)
+	{
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+	}
+	if (i < length)
+		acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+	acc0 = _mm_add_ps(acc0, acc1);
+	acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+	acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(acc0);
+#else
+	float acc[4] = { 0.f, 0.f, 0.f, 0.f };
+	for (uint32_t i = 0; i < length; i += 4)
+	{
+		for (uint32_t k = 0; k < 4; k++)
+			acc[k] += a[i + k] * b[i + k];
+	}
+	return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+#endif
+}
+
+// --- RealFFT ---
+void RealFFT::initialize(uint32_t _fftLength)
+{
+	fftLength = _fftLength;
+	halfLength = _fftLength / 2;
+
+	timeBuffer.assign(fftLength, 0.0);
+	binBuffer.assign(2 * (halfLength + 1), 0.0);
+
+	// --- the plans are executed with the array functions on this object's scratch
+	forwardPlan.reset(createBuiltinFFTPlan(builtinFFTKind::kRealToComplex, fftLength, nullptr, nullptr), destroyBuiltinFFTPlan);
+	inversePlan.reset(createBuiltinFFTPlan(builtinFFTKind::kComplexToReal, fftLength, nullptr, nullptr), destroyBuiltinFFTPlan);
+}
+
+void RealFFT::forward(const float* input, float* real, float* imag)
+{
+	double* time = timeBuffer.data();
+	builtinFFTComplex* bins = (builtinFFTComplex*)binBuffer.data();
+
+	for (uint32_t n = 0; n < fftLength; n++)
+		time[n] = input[n];
+
+	executeBuiltinRealFFT(forwardPlan.get(), time, bins);
+
+	for (uint32_t k = 0; k <= halfLength; k++)
+	{
+		real[k] = (float)bins[k][0];
+		imag[k] = (float)bins[k][1];
+	}
+}
+
+void RealFFT::inverse(const float* real, const float* imag, float* output)
+{
+	double* time = timeBuffer.data();
+	builtinFFTComplex* bins = (builtinFFTComplex*)binBuffer.data();
+
+	for (uint32_t k = 0; k <= halfLength; k++)
+	{
+		bins[k][0] = real[k];
+		bins[k][1] = imag[k];
+	}
+
+	executeBuiltinInverseRealFFT(inversePlan.get(), bins, time);
+
+	// --- the c2r plan is unnormalized
+	double scale = 1.0 / fftLength;
+	for (uint32_t n = 0; n < fftLength; n++)
+		output[n] = (float)(time[n] * scale);
+}
+
+// --- PartitionedConvolver ---
+
+/**
+\brief Build the direct head and the partition levels for a new IR and start the worker if any level
+runs in the background. Allocates; do not call while processAudioBlock() may run.
+*/
+bool PartitionedConvolver::setImpulseResponse(const float* const* irChannels, uint32_t numIRChannels, uint32_t irLength, uint32_t _numChannels)
+{
+	stopWorker();
+
+	levels.clear();
+	deadlineMisses.store(0);
+	impulseLength = 0;
+	longestQuietRun = 0;
+	numChannels = _numChannels < CONVOLVER_MAX_CHANNELS ? _numChannels : CONVOLVER_MAX_CHANNELS;
+	memset(headTaps, 0, sizeof(headTaps));
+
+	if (!irChannels || numIRChannels == 0 || irLength == 0 || numChannels == 0)
+	{
+		numChannels = 0;
+		return irLength == 0;
+	}
+	impulseLength = irLength;
+
+	// --- head, reversed
+	for (uint32_t c = 0; c < numChannels; c++)
+	{
+		const float* ir = irChannels[c < numIRChannels ? c : numIRChannels - 1];
+		for (uint32_t i = 0; i < CONVOLVER_HEAD_LENGTH && i < irLength; i++)
+			headTaps[c][CONVOLVER_HEAD_LENGTH - 1 - i] = ir[i];
+	}
+
+	// --- levels: P = HEAD_LENGTH from HEAD_LENGTH, then 4P from 8P, 16P from 32P, ... each ending where the next begins
+	uint32_t partitionLength = CONVOLVER_HEAD_LENGTH;
+	uint32_t tapOffset = CONVOLVER_HEAD_LENGTH;
+	uint32_t longestPartition = CONVOLVER_HEAD_LENGTH;
+	while (tapOffset < irLength)
+	{
+		uint32_t nextPartitionLength = partitionLength * 4 < CONVOLVER_MAX_PARTITION ? partitionLength * 4 : CONVOLVER_MAX_PARTITION;
+		uint32_t levelEnd = partitionLength == CONVOLVER_MAX_PARTITION ? irLength : 2 * nextPartitionLength;
+		if (levelEnd > irLength)
+			levelEnd = irLength;
+
+		std::unique_ptr<ConvolverLevel> level(new ConvolverLevel);
+		level->partitionLength = partitionLength;
+		level->tapOffset = tapOffset;
+		level->numPartitions = (levelEnd - tapOffset + partitionLength - 1) / partitionLength;
+		level->numBins = partitionLength + 1;
+		level->background = tapOffset >= 2 * partitionLength;
+		level->fft.initialize(2 * partitionLength);
+
+		uint32_t spectrumSize = level->numPartitions * level->numBins;
+		level->timeBuffer.assign(2 * partitionLength, 0.f);
+		level->sumReal.assign(level->numBins, 0.f);
+		level->sumImag.assign(level->numBins, 0.f);
+
+		for (uint32_t c = 0; c < numChannels; c++)
+		{
+			const float* ir = irChannels[c < numIRChannels ? c : numIRChannels - 1];
+			level->filterReal[c].assign(spectrumSize, 0.f);
+			level->filterImag[c].assign(spectrumSize, 0.f);
+			level->spectraReal[c].assign(spectrumSize, 0.f);
+			level->spectraImag[c].assign(spectrumSize, 0.f);
+			level->input[c].assign(2 * partitionLength, 0.f);
+			level->output[c].assign(2 * partitionLength, 0.f);
+
+			// --- partition spectra: P taps zero-padded to 2P
+			for (uint32_t p = 0; p < level->numPartitions; p++)
+			{
+				std::fill(level->timeBuffer.begin(), level->timeBuffer.end(), 0.f);
+				uint32_t firstTap = tapOffset + p * partitionLength;
+				for (uint32_t i = 0; i < partitionLength && firstTap + i < irLength; i++)
+					level->timeBuffer[i] = ir[firstTap + i];
+
+				level->fft.forward(level->timeBuffer.data(), &level->filterReal[c][p * level->numBins], &level->filterImag[c][p * level->numBins]);
+			}
+		}
+
+		longestPartition = partitionLength;
+		levels.push_back(std::move(level));
+
+		tapOffset = levelEnd;
+		partitionLength = nextPartitionLength;
+	}
+
+	// --- input history: enough for the longest level's 2P frame
+	uint32_t historyLength = 1;
+	while (historyLength < 2 * longestPartition)
+		historyLength <<= 1;
+	historyMask = historyLength - 1;
+	for (uint32_t c = 0; c < CONVOLVER_MAX_CHANNELS; c++)
+		inputHistory[c].assign(c < numChannels ? historyLength : 0, 0.f);
+
+	// --- longest quiet stretch, for the owner's silence detection
+	float peak = 0.f;
+	for (uint32_t c = 0; c < numIRChannels; c++)
+	{
+		for (uint32_t i = 0; i < irLength; i++)
+			peak = fmaxf(peak, fabsf(irChannels[c][i]));
+	}
+
+	float quietLevel = peak * 1.5849e-5f; // -96dB
+	uint32_t quietRun = 0;
+	for (uint32_t i = 0; i < irLength; i++)
+	{
+		bool quiet = true;
+		for (uint32_t c = 0; c < numIRChannels; c++)
+			quiet = quiet && fabsf(irChannels[c][i]) <= quietLevel;
+
+		quietRun = quiet ? quietRun + 1 : 0;
+		if (quietRun > longestQuietRun)
+			longestQuietRun = quietRun;
+	}
+
+	reset();
+	startWorker();
+	return true;
+}
+
+/**
+\brief Flush the signal history and the partition outputs; waits for any background block first
+*/
+void PartitionedConvolver::reset()
+{
+	for (std::unique_ptr<ConvolverLevel>& level : levels)
+	{
+		// --- not a deadline miss; nothing is due
+		while (level->blockPending.load(std::memory_order_acquire))
+			std::this_thread::yield();
+
+		level->spectrumIndex = 0;
+		level->blockTime = 0;
+		for (uint32_t c = 0; c < numChannels; c++)
+		{
+			std::fill(level->spectraReal[c].begin(), level->spectraReal[c].end(), 0.f);
+			std::fill(level->spectraImag[c].begin(), level->spectraImag[c].end(), 0.f);
+			std::fill(level->output[c].begin(), level->output[c].end(), 0.f);
+		}
+	}
+
+	for (uint32_t c = 0; c < CONVOLVER_MAX_CHANNELS; c++)
+		std::fill(inputHistory[c].begin(), inputHistory[c].end(), 0.f);
+
+	memset(headLine, 0, sizeof(headLine));
+	sampleTime = 0;
+}
+
+/**
+\brief One block of a level: transform the last 2P inputs, multiply-accumulate against every partition
+through the frequency-domain delay line and write the P valid outputs tapOffset samples ahead
+*/
+void PartitionedConvolver::computeLevelBlock(ConvolverLevel& level)
+{
+	uint32_t numBins = level.numBins;
+	uint32_t outputMask = 2 * level.partitionLength - 1;
+	uint64_t firstOutputTime = level.blockTime - level.partitionLength + level.tapOffset;
+
+	for (uint32_t c = 0; c < numChannels; c++)
+	{
+		level.fft.forward(level.input[c].data(), &level.spectraReal[c][level.spectrumIndex * numBins], &level.spectraImag[c][level.spectrumIndex * numBins]);
+
+		float* sumReal = level.sumReal.data();
+		float* sumImag = level.sumImag.data();
+		memset(sumReal, 0, numBins * sizeof(float));
+		memset(sumImag, 0, numBins * sizeof(float));
+
+		// --- partition p meets the input spectrum from p blocks ago
+		uint32_t spectrum = level.spectrumIndex;
+		for (uint32_t p = 0; p < level.numPartitions; p++)
+		{
+			const float* xReal = &level.spectraReal[c][spectrum * numBins];
+			const float* xImag = &level.spectraImag[c][spectrum * numBins];
+			const float* hReal = &level.filterReal[c][p * numBins];
+			const float* hImag = &level.filterImag[c][p * numBins];
+			complexMultiplyAccumulate(xReal, xImag, hReal, hImag, sumReal, sumImag, numBins);
+			spectrum = spectrum == 0 ? level.numPartitions - 1 : spectrum - 1;
+		}
+
+		level.fft.inverse(sumReal, sumImag, level.timeBuffer.data());
+
+		// --- overlap-save: the second half is the valid linear convolution
+		float* output = level.output[c].data();
+		const float* valid = level.timeBuffer.data() + level.partitionLength;
+		for (uint32_t i = 0; i < level.partitionLength; i++)
+			output[(firstOutputTime + i) & outputMask] = valid[i];
+	}
+
+	level.spectrumIndex = level.spectrumIndex + 1 == level.numPartitions ? 0 : level.spectrumIndex + 1;
+}
+
+/**
+\brief At a partition boundary: hand each level whose block just completed its last 2P inputs, then
+compute it here or signal the worker
+*/
+void PartitionedConvolver::startLevelBlocks(uint64_t boundaryTime)
+{
+	bool workerHasBlocks = false;
+
+	for (std::unique_ptr<ConvolverLevel>& levelPointer : levels)
+	{
+		ConvolverLevel& level = *levelPointer;
+		if (boundaryTime % level.partitionLength != 0)
+			continue;
+
+		// --- the previous block's outputs start now; it must be done before the input is replaced
+		waitForLevel(level);
+
+		uint32_t frameLength = 2 * level.partitionLength;
+		uint32_t start = (uint32_t)((boundaryTime - frameLength) & historyMask);
+		uint32_t firstPart = historyMask + 1 - start < frameLength ? historyMask + 1 - start : frameLength;
+		for (uint32_t c = 0; c < numChannels; c++)
+		{
+			memcpy(level.input[c].data(), &inputHistory[c][start], firstPart * sizeof(float));
+			if (firstPart < frameLength)
+				memcpy(level.input[c].data() + firstPart, &inputHistory[c][0], (frameLength - firstPart) * sizeof(float));
+		}
+		level.blockTime = boundaryTime;
+
+		if (level.background && workerRunning.load(std::memory_order_relaxed))
+		{
+			level.blockPending.store(true, std::memory_order_release);
+			workerHasBlocks = true;
+		}
+		else
+			computeLevelBlock(level);
+	}
+
+	// --- notify without the lock; the worker also polls, so a missed wake-up only costs a millisecond
+	if (workerHasBlocks)
+		workerWakeUp.notify_one();
+}
+
+void PartitionedConvolver::waitForLevel(ConvolverLevel& level)
+{
+	if (!level.blockPending.load(std::memory_order_acquire))
+		return;
+
+	deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+	while (level.blockPending.load(std::memory_order_acquire))
+		std::this_thread::yield();
+}
+
+void PartitionedConvolver::processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t numFrames)
+{
+	if (numChannels == 0)
+		return;
+
+	uint32_t frame = 0;
+	while (frame < numFrames)
+	{
+		// --- process up to the next head-length boundary; every partition boundary is one of these
+		uint32_t untilBoundary = CONVOLVER_HEAD_LENGTH - (uint32_t)(sampleTime % CONVOLVER_HEAD_LENGTH);
+		uint32_t span = numFrames - frame < untilBoundary ? numFrames - frame : untilBoundary;
+
+		for (uint32_t c = 0; c < numChannels; c++)
+		{
+			const float* input = inputs[c] + frame;
+			float* output = outputs[c] + frame;
+
+			// --- history for the partitions
+			uint32_t writeIndex = (uint32_t)(sampleTime & historyMask);
+			uint32_t firstPart = historyMask + 1 - writeIndex < span ? historyMask + 1 - writeIndex : span;
+			memcpy(&inputHistory[c][writeIndex], input, firstPart * sizeof(float));
+			if (firstPart < span)
+				memcpy(&inputHistory[c][0], input + firstPart, (span - firstPart) * sizeof(float));
+
+			// --- direct head; the input is copied out before the output is written, so they may alias
+			float* line = headLine[c];
+			memcpy(line + CONVOLVER_HEAD_LENGTH - 1, input, span * sizeof(float));
+			const float* taps = headTaps[c];
+			for (uint32_t i = 0; i < span; i++)
+			{
+				float sum = 0.f;
+				for (uint32_t j = 0; j < CONVOLVER_HEAD_LENGTH; j++)
+					sum += taps[j] * line[i + j];
+				output[i] = sum;
+			}
+			memmove(line, line + span, (CONVOLVER_HEAD_LENGTH - 1) * sizeof(float));
+
+			// --- partition outputs due now
+			for (std::unique_ptr<ConvolverLevel>& level : levels)
+			{
+				const float* levelOutput = level->output[c].data();
+				uint32_t outputMask = 2 * level->partitionLength - 1;
+				for (uint32_t i = 0; i < span; i++)
+					output[i] += levelOutput[(sampleTime + i) & outputMask];
+			}
+		}
+
+		sampleTime += span;
+		frame += span;
+
+		if (sampleTime % CONVOLVER_HEAD_LENGTH == 0)
+			startLevelBlocks(sampleTime);
+	}
+}
+
+void PartitionedConvolver::startWorker()
+{
+	bool hasBackgroundLevel = false;
+	for (std::unique_ptr<ConvolverLevel>& level : levels)
+		hasBackgroundLevel = hasBackgroundLevel || level->background;
+
+	if (!hasBackgroundLevel)
+		return;
+
+	workerRunning.store(true);
+	worker = std::thread(&PartitionedConvolver::runWorker, this);
+}
+
+void PartitionedConvolver::stopWorker()
+{
+	if (!worker.joinable())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(workerMutex);
+		workerRunning.store(false);
+	}
+	workerWakeUp.notify_one();
+	worker.join();
+
+	// --- finish anything left so the levels are consistent
+	for (std::unique_ptr<ConvolverLevel>& level : levels)
+	{
+		if (level->blockPending.load(std::memory_order_acquire))
+		{
+			computeLevelBlock(*level);
+			level->blockPending.store(false, std::memory_order_release);
+		}
+	}
+}
+
+/**
+\brief Worker loop: always compute the shortest pending level first, since it has the nearest deadline
+*/
+void PartitionedConvolver::runWorker()
+{
+	while (workerRunning.load())
+	{
+		bool computed = false;
+		for (std::unique_ptr<ConvolverLevel>& level : levels)
+		{
+			if (level->background && level->blockPending.load(std::memory_order_acquire))
+			{
+				computeLevelBlock(*level);
+				level->blockPending.store(false, std::memory_order_release);
+				computed = true;
+				break;
+			}
+		}
+
+		if (computed)
+			continue;
+
+		std::unique_lock<std::mutex> lock(workerMutex);
+		workerWakeUp.wait_for(lock, std::chrono::milliseconds(1), [this]()
+		{
+			if (!workerRunning.load())
+				return true;
+			for (std::unique_ptr<ConvolverLevel>& level : levels)
+			{
+				if (level->blockPending.load(std::memory_order_acquire))
+					return true;
+			}
+			return false;
+		});
+	}
+}
+
+// --- FIRConvolver ---
+
+/**
+\brief Choose the method for an IR length and size the buffers; nothing is allocated or flushed when the
+layout is the same as before
+*/
+void FIRConvolver::configure(uint32_t length)
+{
+	uint32_t newPartitionLength = 0;
+	uint32_t newDirectLength = (length + 3) & ~3u;
+	if (length > FIR_DIRECT_MAX_LENGTH)
+	{
+		// --- power of two nearest 2 * sqrt(length), and shorter than the IR
+		double target = 2.0 * sqrt((double)length);
+		newPartitionLength = 32;
+		while (newPartitionLength * 2 < length && newPartitionLength * 1.5 < target)
+			newPartitionLength *= 2;
+		newDirectLength = newPartitionLength;
+	}
+
+	uint32_t newNumPartitions = newPartitionLength > 0 ? (length - 1) / newPartitionLength : 0;
+	impulseLength = length;
+
+	if (newDirectLength == directLength && newPartitionLength == partitionLength && newNumPartitions == numPartitions)
+		return;
+
+	directLength = newDirectLength;
+	partitionLength = newPartitionLength;
+	numPartitions = newNumPartitions;
+	numBins = partitionLength > 0 ? partitionLength + 1 : 0;
+
+	directTaps.assign(directLength, 0.f);
+	history.assign(2 * directLength, 0.f);
+
+	if (partitionLength > 0)
+	{
+		fft.initialize(2 * partitionLength);
+		filterReal.assign(numPartitions * numBins, 0.f);
+		filterImag.assign(numPartitions * numBins, 0.f);
+		spectraReal.assign(numPartitions * numBins, 0.f);
+		spectraImag.assign(numPartitions * numBins, 0.f);
+		inputBlock.assign(2 * partitionLength, 0.f);
+		tailOutput.assign(partitionLength, 0.f);
+		sumReal.assign(numBins, 0.f);
+		sumImag.assign(numBins, 0.f);
+		timeBuffer.assign(2 * partitionLength, 0.f);
+	}
+	else
+	{
+		filterReal.clear();
+		filterImag.clear();
+		spectraReal.clear();
+		spectraImag.clear();
+		inputBlock.clear();
+		tailOutput.clear();
+	}
+
+	reset();
+}
+
+void FIRConvolver::reset()
+{
+	std::fill(history.begin(), history.end(), 0.f);
+	std::fill(spectraReal.begin(), spectraReal.end(), 0.f);
+	std::fill(spectraImag.begin(), spectraImag.end(), 0.f);
+	std::fill(inputBlock.begin(), inputBlock.end(), 0.f);
+	std::fill(tailOutput.begin(), tailOutput.end(), 0.f);
+	historyIndex = 0;
+	spectrumIndex = 0;
+	blockPosition = 0;
+}
+
+/**
+\brief Partition p covers taps (p + 1)P to (p + 2)P and meets the input spectrum from p blocks ago; the valid
+second half of the overlap-save output is the partitions' share of the next block
+*/
+void FIRConvolver::computeBlock()
+{
+	fft.forward(inputBlock.data(), &spectraReal[spectrumIndex * numBins], &spectraImag[spectrumIndex * numBins]);
+
+	std::fill(sumReal.begin(), sumReal.end(), 0.f);
+	std::fill(sumImag.begin(), sumImag.end(), 0.f);
+
+	uint32_t spectrum = spectrumIndex;
+	for (uint32_t p = 0; p < numPartitions; p++)
+	{
+		complexMultiplyAccumulate(&spectraReal[spectrum * numBins], &spectraImag[spectrum * numBins],
+								  &filterReal[p * numBins], &filterImag[p * numBins], sumReal.data(), sumImag.data(), numBins);
+		spectrum = spectrum == 0 ? numPartitions - 1 : spectrum - 1;
+	}
+
+	fft.inverse(sumReal.data(), sumImag.data(), timeBuffer.data());
+	memcpy(tailOutput.data(), timeBuffer.data() + partitionLength, partitionLength * sizeof(float));
+
+	// --- the current block becomes the previous one
+	memcpy(inputBlock.data(), inputBlock.data() + partitionLength, partitionLength * sizeof(float));
+	spectrumIndex = spectrumIndex + 1 == numPartitions ? 0 : spectrumIndex + 1;
+}
+
+void FIRConvolver::processAudioBlock(const float* input, float* output, uint32_t numFrames)
+{
+	if (directLength == 0)
+	{
+		std::fill(output, output + numFrames, 0.f);
+		return;
+	}
+
+	const float* taps = directTaps.data();
+	float* line = history.data();
+
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		// --- read the input before the output is written, so they may alias
+		float xn = input[i];
+
+		historyIndex = historyIndex == 0 ? directLength - 1 : historyIndex - 1;
+		line[historyIndex] = xn;
+		line[historyIndex + directLength] = xn;
+		float yn = dotProduct(taps, line + historyIndex, directLength);
+
+		if (numPartitions > 0)
+		{
+			yn += tailOutput[blockPosition];
+			inputBlock[partitionLength + blockPosition] = xn;
+			if (++blockPosition == partitionLength)
+			{
+				computeBlock();
+				blockPosition = 0;
+			}
+		}
+
+		output[i] = yn;
+	}
+}
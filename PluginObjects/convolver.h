@@ -0,0 +1,310 @@
+#ifndef __convolver_h__
+#define __convolver_h__
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "builtinfft.h"
+
+// --- taps convolved directly; also the smallest FFT partition and the longest stretch processed between partition boundaries
+const uint32_t CONVOLVER_HEAD_LENGTH = 64;
+
+// --- partitions grow by 4x per level up to this size; the last level repeats it to the end of the IR
+const uint32_t CONVOLVER_MAX_PARTITION = 16384;
+
+// --- stereo
+const uint32_t CONVOLVER_MAX_CHANNELS = 2;
+
+// --- FIRConvolver: IRs up to this length are convolved directly; longer ones get FFT partitions behind a direct head
+const uint32_t FIR_DIRECT_MAX_LENGTH = 256;
+
+/**
+\class RealFFT
+\ingroup SynthClasses
+\brief
+Radix-2 FFT of a real signal on a pair of built-in FFT plans (builtinfft.h, r2c and c2r), with the
+float split-complex layout the convolvers use. The plans and scratch are created in initialize(); forward()
+and inverse() do not allocate. Copies share the read-only plans and get their own scratch.
+
+- forward(): fftLength real samples -> fftLength/2 + 1 complex bins (DC to Nyquist), unscaled
+- inverse(): the reverse, scaled so that inverse(forward(x)) == x
+*/
+class RealFFT
+{
+public:
+	RealFFT() {}
+	~RealFFT() {}
+
+	/** create the plans; _fftLength must be a power of two, at least 4 */
+	void initialize(uint32_t _fftLength);
+
+	/** real input to complex bins */
+	void forward(const float* input, float* real, float* imag);
+
+	/** complex bins to real output */
+	void inverse(const float* real, const float* imag, float* output);
+
+	/** transform length */
+	uint32_t getFFTLength() { return fftLength; }
+
+	/** number of complex bins */
+	uint32_t getNumBins() { return halfLength + 1; }
+
+protected:
+	uint32_t fftLength = 0;
+	uint32_t halfLength = 0;
+
+	std::shared_ptr<BuiltinFFTPlan> forwardPlan;	///< fftLength reals -> halfLength + 1 bins
+	std::shared_ptr<BuiltinFFTPlan> inversePlan;	///< halfLength + 1 bins -> fftLength reals, unscaled
+	std::vector<double> timeBuffer;					///< scratch, fftLength
+	std::vector<double> binBuffer;					///< scratch, halfLength + 1 interleaved bins
+};
+
+/**
+\struct ConvolverLevel
+\ingroup SynthStructures
+\brief
+One level of the partitioned convolver: a uniformly partitioned overlap-save convolution over a range of
+IR taps, with its own partition size. The frequency-domain delay line holds the spectra of the last
+numPartitions input blocks; each block produces partitionLength outputs that land tapOffset samples later.
+*/
+struct ConvolverLevel
+{
+	uint32_t partitionLength = 0;		///< P; the FFT is 2P
+	uint32_t tapOffset = 0;				///< first IR tap covered
+	uint32_t numPartitions = 0;			///< IR taps covered = numPartitions * P
+	uint32_t numBins = 0;				///< P + 1
+	bool background = false;			///< computed on the worker thread; true when tapOffset >= 2P
+
+	RealFFT fft;
+
+	// --- per channel
+	std::vector<float> filterReal[CONVOLVER_MAX_CHANNELS];		///< IR partition spectra, numPartitions * numBins
+	std::vector<float> filterImag[CONVOLVER_MAX_CHANNELS];
+	std::vector<float> spectraReal[CONVOLVER_MAX_CHANNELS];		///< frequency-domain delay line, numPartitions * numBins
+	std::vector<float> spectraImag[CONVOLVER_MAX_CHANNELS];
+	std::vector<float> input[CONVOLVER_MAX_CHANNELS];			///< the last 2P input samples at the block boundary
+	std::vector<float> output[CONVOLVER_MAX_CHANNELS];			///< output ring, 2P, indexed by absolute sample time
+
+	// --- scratch
+	std::vector<float> sumReal;
+	std::vector<float> sumImag;
+	std::vector<float> timeBuffer;
+
+	uint32_t spectrumIndex = 0;			///< newest spectrum in the delay line
+	uint64_t blockTime = 0;				///< sample time of the block boundary being computed
+
+	// --- audio thread -> worker handoff for background levels
+	std::atomic<bool> blockPending{ false };
+};
+
+/**
+\class PartitionedConvolver
+\ingroup SynthClasses
+\brief
+Zero-latency convolution with long (multi-second) mono or stereo impulse responses, using a non-uniform
+partition scheme:
+
+- the first CONVOLVER_HEAD_LENGTH taps are convolved directly, sample by sample
+- the next taps are covered by FFT partitions of the same length, computed on the audio thread at each
+  partition boundary
+- further levels use partitions 4x longer each time, up to CONVOLVER_MAX_PARTITION; a level whose first tap
+  is at least two partitions in never has its output due before its next boundary, so it is computed on a
+  background thread while the audio thread moves on
+
+Cost per sample is roughly constant in the IR length's logarithm instead of linear in it, and there is no
+latency. The output is wet only.
+
+Audio thread (never allocates):
+- processAudioBlock() on any number of frames; if a background block is not finished when its output is
+  due, the audio thread waits for it and counts a deadline miss
+
+Other threads:
+- setImpulseResponse() builds the partitions and starts the worker; reset() flushes the audio. Neither may
+  run at the same time as processAudioBlock(), just like any other reset()
+*/
+class PartitionedConvolver
+{
+public:
+	PartitionedConvolver() {}
+	~PartitionedConvolver() { stopWorker(); }
+
+	/** load an IR; channel c of the audio uses IR channel c, or the last IR channel if there are fewer
+	\param irChannels one pointer per IR channel
+	\param numIRChannels IR channel count
+	\param irLength IR length in samples; 0 clears the IR
+	\param _numChannels audio channels to process, up to CONVOLVER_MAX_CHANNELS
+	\return true if the IR was loaded
+	*/
+	bool setImpulseResponse(const float* const* irChannels, uint32_t numIRChannels, uint32_t irLength, uint32_t _numChannels);
+
+	/** clear the signal history; the IR stays loaded */
+	void reset();
+
+	/** convolve a block; inputs and outputs hold getNumChannels() pointers and may be the same buffers */
+	void processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t numFrames);
+
+	/** true once an IR is loaded */
+	bool hasImpulseResponse() { return impulseLength > 0; }
+
+	/** loaded IR length in samples */
+	uint32_t getImpulseLength() { return impulseLength; }
+
+	/** longest run of taps below -96dB of the IR peak, in samples; the output can stay silent this long before the tail arrives */
+	uint32_t getLongestQuietRun() { return longestQuietRun; }
+
+	/** audio channels processed */
+	uint32_t getNumChannels() { return numChannels; }
+
+	/** background blocks the audio thread had to wait for, since the IR was loaded */
+	uint64_t getDeadlineMisses() { return deadlineMisses.load(std::memory_order_relaxed); }
+
+protected:
+	uint32_t numChannels = 0;
+	uint32_t impulseLength = 0;
+	uint32_t longestQuietRun = 0;
+	uint64_t sampleTime = 0;			///< samples processed since reset()
+
+	// --- direct-form head: taps reversed so each output is one contiguous dot product
+	float headTaps[CONVOLVER_MAX_CHANNELS][CONVOLVER_HEAD_LENGTH] = { { 0.f } };
+	float headLine[CONVOLVER_MAX_CHANNELS][2 * CONVOLVER_HEAD_LENGTH] = { { 0.f } };	///< HEAD_LENGTH - 1 past samples, then the current stretch
+
+	// --- input history for the partition boundaries, a power of two >= 2 * longest partition
+	std::vector<float> inputHistory[CONVOLVER_MAX_CHANNELS];
+	uint32_t historyMask = 0;
+
+	// --- the partition levels, shortest first
+	std::vector<std::unique_ptr<ConvolverLevel>> levels;
+	void computeLevelBlock(ConvolverLevel& level);
+	void startLevelBlocks(uint64_t boundaryTime);
+
+	// --- worker thread for the background levels
+	std::thread worker;
+	std::mutex workerMutex;
+	std::condition_variable workerWakeUp;
+	std::atomic<bool> workerRunning{ false };
+	std::atomic<uint64_t> deadlineMisses{ 0 };
+	void startWorker();
+	void stopWorker();
+	void runWorker();
+	void waitForLevel(ConvolverLevel& level);
+};
+
+/**
+\class FIRConvolver
+\ingroup SynthClasses
+\brief
+Mono FIR filter with zero latency that picks the cheaper method for its IR length:
+
+- up to FIR_DIRECT_MAX_LENGTH taps: direct form, one SSE dot product per output over a mirrored history
+- longer: the first P taps direct, the rest as uniformly partitioned overlap-save FFT convolution in
+  partitions of P, with P the power of two nearest 2 * sqrt(length) so the direct head and the spectral
+  multiply-accumulate cost about the same per sample
+
+Unlike PartitionedConvolver there is no worker thread, and an IR of the same length replaces the current one
+without allocating, so objects like AnalogFIRFilter can recompute their IR in setParameters(). Use
+PartitionedConvolver for multi-second reverb IRs.
+*/
+class FIRConvolver
+{
+public:
+	FIRConvolver() {}
+	~FIRConvolver() {}
+
+	/** load an IR; allocates only when the length changes. The signal history is kept, so a new IR of the
+	    same length takes over without a gap
+	\param ir the taps
+	\param length IR length in samples; 0 clears the IR
+	\return true if the IR was loaded
+	*/
+	bool setImpulseResponse(const float* ir, uint32_t length) { return loadImpulseResponse(ir, length); }
+	bool setImpulseResponse(const double* ir, uint32_t length) { return loadImpulseResponse(ir, length); }
+
+	/** clear the signal history; the IR stays loaded */
+	void reset();
+
+	/** convolve a block; input and output may be the same buffer */
+	void processAudioBlock(const float* input, float* output, uint32_t numFrames);
+
+	/** convolve one sample */
+	float processAudioSample(float xn)
+	{
+		float yn = 0.f;
+		processAudioBlock(&xn, &yn, 1);
+		return yn;
+	}
+
+	/** loaded IR length in samples */
+	uint32_t getImpulseLength() { return impulseLength; }
+
+	/** FFT partition length, or 0 for the direct form */
+	uint32_t getPartitionLength() { return partitionLength; }
+
+protected:
+	uint32_t impulseLength = 0;
+
+	// --- direct form (all of a short IR, the head of a long one): taps padded to a multiple of 4 and a
+	//     history written twice so the window [index, index + directLength) is contiguous, newest first
+	uint32_t directLength = 0;
+	std::vector<float> directTaps;
+	std::vector<float> history;
+	uint32_t historyIndex = 0;
+
+	// --- FFT partitions after the head
+	uint32_t partitionLength = 0;		///< P; the FFT is 2P
+	uint32_t numPartitions = 0;
+	uint32_t numBins = 0;				///< P + 1
+	RealFFT fft;
+	std::vector<float> filterReal;		///< IR partition spectra, numPartitions * numBins
+	std::vector<float> filterImag;
+	std::vector<float> spectraReal;		///< frequency-domain delay line, numPartitions * numBins
+	std::vector<float> spectraImag;
+	uint32_t spectrumIndex = 0;			///< newest spectrum in the delay line
+	std::vector<float> inputBlock;		///< previous and current block of P inputs
+	std::vector<float> tailOutput;		///< the partitions' output for the current block
+	uint32_t blockPosition = 0;			///< samples of the current block received
+
+	// --- scratch
+	std::vector<float> sumReal;
+	std::vector<float> sumImag;
+	std::vector<float> timeBuffer;
+
+	// --- size the method and buffers for an IR length; allocates only if the layout changes
+	void configure(uint32_t length);
+
+	// --- at the end of a block: transform the last 2P inputs and compute the next block's partition output
+	void computeBlock();
+
+	// --- copy the taps into the direct form and the partition spectra
+	template <typename T>
+	bool loadImpulseResponse(const T* ir, uint32_t length)
+	{
+		if (length == 0 || !ir)
+		{
+			configure(0);
+			return length == 0;
+		}
+
+		configure(length);
+
+		for (uint32_t i = 0; i < directLength; i++)
+			directTaps[i] = i < length ? (float)ir[i] : 0.f;
+
+		for (uint32_t p = 0; p < numPartitions; p++)
+		{
+			uint32_t firstTap = (p + 1) * partitionLength;
+			for (uint32_t i = 0; i < 2 * partitionLength; i++)
+				timeBuffer[i] = i < partitionLength && firstTap + i < length ? (float)ir[firstTap + i] : 0.f;
+			fft.forward(timeBuffer.data(), &filterReal[p * numBins], &filterImag[p * numBins]);
+		}
+		return true;
+	}
+};
+
+#endif /* defined(__convolver_h__) */
@@ -113,7 +113,7 @@ public:
 
 protected:
 	// --- MIDI Data Interface
-	const const std::shared_ptr<MidiInputData> midiInputData = nullptr;
+	const std::shared_ptr<MidiInputData> midiInputData = nullptr;
 
 	// --- we share Parameters with other voice's same-components
 	std::shared_ptr<DCAParameters> parameters = nullptr;
@@ -271,6 +271,7 @@ public:
 
 	// --- accessors - allow owner to get our state
 	egState getState() { return state; }			///< returns current state of the EG finite state machine
+	double getEnvelopeOutput() { return envelopeOutput; }	///< returns the most recent envelope output sample
 
 	// --- output EG identifer access
 	bool isOutputEG() { return outputEG; }			///< returns true if this EG is connected to the output DCA
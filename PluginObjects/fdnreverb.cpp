@@ -0,0 +1,263 @@
+#include "fdnreverb.h"
+
+#include <math.h>
+#include <algorithm>
+
+/**
+\brief Size the interleaved buffers for FDN_MAX_DELAY_MSEC at the new sample rate, flush them and
+recompute the delays
+
+\param _sampleRate the new sample rate
+*/
+bool FDNReverbTank::reset(double _sampleRate)
+{
+	sampleRate = _sampleRate;
+
+	// --- a power of two so the read and write indexes wrap with a mask
+	uint32_t maxDelay = (uint32_t)(FDN_MAX_DELAY_MSEC * _sampleRate / 1000.0) + 1;
+	uint32_t bufferLength = 1;
+	while (bufferLength <= maxDelay)
+		bufferLength <<= 1;
+	bufferMask = bufferLength - 1;
+	writeIndex = 0;
+
+	lineBuffer.assign(bufferLength * FDN_NUM_LINES, 0.f);
+	apfBuffer[0].assign(bufferLength * FDN_NUM_LINES, 0.f);
+	apfBuffer[1].assign(bufferLength * FDN_NUM_LINES, 0.f);
+	preDelayBuffer.assign(bufferLength, 0.f);
+
+	for (uint32_t i = 0; i < FDN_NUM_LINES; i++)
+		lpfState[i] = 0.f;
+
+	for (uint32_t i = 0; i < NUM_CHANNELS; i++)
+		shelvingFilters[i].reset(_sampleRate);
+
+	updateTank();
+	return true;
+}
+
+/**
+\brief Process one mono sample; the output is the mono sum of the tank
+
+\param xn input
+\return the processed sample
+*/
+double FDNReverbTank::processAudioSample(double xn)
+{
+	float input = (float)xn;
+	float output = 0.f;
+	processAudioFrame(&input, &output, 1, 1);
+	return output;
+}
+
+/**
+\brief Process one interleaved frame through the block path, so frame and block processing give the same output
+*/
+bool FDNReverbTank::processAudioFrame(const float* inputFrame, float* outputFrame, uint32_t inputChannels, uint32_t outputChannels)
+{
+	const float* inputs[2] = { &inputFrame[0], inputChannels > 1 ? &inputFrame[1] : &inputFrame[0] };
+	float* outputs[2] = { &outputFrame[0], outputChannels > 1 ? &outputFrame[1] : &outputFrame[0] };
+	return processAudioBlock(inputs, outputs, inputChannels, outputChannels, 1);
+}
+
+/**
+\brief Process a block; mono-izes the input as ReverbTank does, runs the tank and the shelving filters and
+mixes with the dry signal
+
+\param inputs one pointer per input channel
+\param outputs one pointer per output channel; may be the same buffers as the inputs
+\param inputChannels 1 or 2
+\param outputChannels 1 or 2
+\param numFrames frames to process
+*/
+bool FDNReverbTank::processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t inputChannels, uint32_t outputChannels, uint32_t numFrames)
+{
+	if (lineBuffer.empty())
+		return false;
+
+	const double inputScale = 1.0 / inputChannels;
+
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		double xnL = inputs[0][i];
+		double xnR = inputChannels > 1 ? inputs[1][i] : 0.0;
+		double monoXn = inputScale*xnL + inputScale*xnR;
+
+		float tankL = 0.f;
+		float tankR = 0.f;
+		processTank((float)monoXn, tankL, tankR);
+
+		double tankOutL = shelvingFilters[0].processAudioSample(tankL);
+		double tankOutR = shelvingFilters[1].processAudioSample(tankR);
+
+		if (outputChannels == 1)
+			outputs[0][i] = (float)(dryMix*xnL + wetMix*(0.5*tankOutL + 0.5*tankOutR));
+		else
+		{
+			outputs[0][i] = (float)(dryMix*xnL + wetMix*tankOutL);
+			outputs[1][i] = (float)(dryMix*xnR + wetMix*tankOutR);
+		}
+	}
+
+	return true;
+}
+
+/**
+\brief One frame of the network: read the line outputs and taps, mix them through the Householder matrix,
+add the input, then run the allpasses and lowpass on all four lanes at once and write the lines
+
+\param monoInput mono input sample
+\param tankL left output taps
+\param tankR right output taps
+*/
+inline void FDNReverbTank::processTank(float monoInput, float& tankL, float& tankR)
+{
+	const uint32_t w = writeIndex;
+	const uint32_t mask = bufferMask;
+	float* line = lineBuffer.data();
+
+	// --- pre-delay; a zero delay reads the sample just written
+	preDelayBuffer[w] = monoInput;
+	float preDelayOut = preDelayBuffer[(w - preDelay) & mask];
+
+	// --- line outputs
+	alignas(16) float lineOut[FDN_NUM_LINES];
+	for (uint32_t k = 0; k < FDN_NUM_LINES; k++)
+		lineOut[k] = line[((w - lineDelay[k]) & mask) * FDN_NUM_LINES + k];
+
+	// --- output taps
+	for (uint32_t t = 0; t < numTaps; t++)
+	{
+		tankL += tapWeight[0][t] * line[((w - tapDelay[0][t]) & mask) * FDN_NUM_LINES + tapLane[0][t]];
+		tankR += tapWeight[1][t] * line[((w - tapDelay[1][t]) & mask) * FDN_NUM_LINES + tapLane[1][t]];
+	}
+
+#ifdef FDN_REVERB_SSE
+	// --- Householder feedback: v - 0.5 * sum(v), scaled by kRT, plus the signed input
+	__m128 v = _mm_load_ps(lineOut);
+	__m128 sum = _mm_add_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+	sum = _mm_add_ps(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 0, 3, 2)));
+	v = _mm_sub_ps(v, _mm_mul_ps(_mm_set1_ps(0.5f), sum));
+	v = _mm_mul_ps(v, _mm_set1_ps(feedbackGain));
+	v = _mm_add_ps(v, _mm_mul_ps(_mm_load_ps(inputSign), _mm_set1_ps(preDelayOut)));
+
+	// --- allpass diffusers: w = x + g*a, y = a - g*w
+	for (uint32_t j = 0; j < 2; j++)
+	{
+		float* apf = apfBuffer[j].data();
+		__m128 a = _mm_set_ps(apf[((w - apfDelay[j][3]) & mask) * FDN_NUM_LINES + 3],
+							  apf[((w - apfDelay[j][2]) & mask) * FDN_NUM_LINES + 2],
+							  apf[((w - apfDelay[j][1]) & mask) * FDN_NUM_LINES + 1],
+							  apf[((w - apfDelay[j][0]) & mask) * FDN_NUM_LINES + 0]);
+		__m128 g = _mm_set1_ps(apfGain[j]);
+		__m128 wn = _mm_add_ps(v, _mm_mul_ps(g, a));
+		v = _mm_sub_ps(a, _mm_mul_ps(g, wn));
+		_mm_storeu_ps(apf + w * FDN_NUM_LINES, wn);
+	}
+
+	// --- lowpass: y = (1 - g)x + g*state
+	v = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(1.f - lpfGain), v), _mm_mul_ps(_mm_set1_ps(lpfGain), _mm_load_ps(lpfState)));
+	_mm_store_ps(lpfState, v);
+	_mm_storeu_ps(line + w * FDN_NUM_LINES, v);
+#else
+	// --- the same operations lane by lane, in the same order as the SSE path
+	float sum = (lineOut[0] + lineOut[1]) + (lineOut[2] + lineOut[3]);
+	float v[FDN_NUM_LINES];
+	for (uint32_t k = 0; k < FDN_NUM_LINES; k++)
+		v[k] = (lineOut[k] - 0.5f*sum)*feedbackGain + inputSign[k] * preDelayOut;
+
+	for (uint32_t j = 0; j < 2; j++)
+	{
+		float* apf = apfBuffer[j].data();
+		const float g = apfGain[j];
+		for (uint32_t k = 0; k < FDN_NUM_LINES; k++)
+		{
+			float a = apf[((w - apfDelay[j][k]) & mask) * FDN_NUM_LINES + k];
+			float wn = v[k] + g*a;
+			v[k] = a - g*wn;
+			apf[w * FDN_NUM_LINES + k] = wn;
+		}
+	}
+
+	for (uint32_t k = 0; k < FDN_NUM_LINES; k++)
+	{
+		lpfState[k] = (1.f - lpfGain)*v[k] + lpfGain*lpfState[k];
+		line[w * FDN_NUM_LINES + k] = lpfState[k];
+	}
+#endif
+
+	writeIndex = (w + 1) & mask;
+}
+
+/**
+\brief Store the parameters; the shelving filters update now, the delays and taps as soon as the sample rate is known
+
+\param params the ReverbTank parameters
+*/
+void FDNReverbTank::setParameters(const ReverbTankParameters& params)
+{
+	TwoBandShelvingFilterParameters filterParams = shelvingFilters[0].getParameters();
+	filterParams.highShelf_fc = params.highShelf_fc;
+	filterParams.highShelfBoostCut_dB = params.highShelfBoostCut_dB;
+	filterParams.lowShelf_fc = params.lowShelf_fc;
+	filterParams.lowShelfBoostCut_dB = params.lowShelfBoostCut_dB;
+
+	shelvingFilters[0].setParameters(filterParams);
+	shelvingFilters[1].setParameters(filterParams);
+
+	parameters = params;
+	updateTank();
+}
+
+/**
+\brief Convert the parameters to delays in samples, taps and gains; unlike ReverbTank, the delay tweakers
+take effect in a single call
+*/
+void FDNReverbTank::updateTank()
+{
+	feedbackGain = (float)parameters.kRT;
+	lpfGain = (float)parameters.lpf_g;
+	dryMix = pow(10.0, parameters.dryLevel_dB / 20.0);
+	wetMix = pow(10.0, parameters.wetLevel_dB / 20.0);
+
+	if (sampleRate <= 0.0 || bufferMask == 0)
+		return;
+
+	const double samplesPerMSec = sampleRate / 1000.0;
+	auto toSamples = [&](double delay_mSec, uint32_t minimum) {
+		double samples = delay_mSec * samplesPerMSec + 0.5;
+		return (uint32_t)std::min(std::max(samples, (double)minimum), (double)bufferMask);
+	};
+
+	// --- the ReverbTank global max delay times
+	double globalAPFMaxDelay = (parameters.apfDelayWeight_Pct / 100.0)*parameters.apfDelayMax_mSec;
+	double globalFixedMaxDelay = (parameters.fixeDelayWeight_Pct / 100.0)*parameters.fixeDelayMax_mSec;
+
+	preDelay = toSamples(parameters.preDelayTime_mSec, 0);
+	for (uint32_t i = 0; i < FDN_NUM_LINES; i++)
+	{
+		apfDelay[0][i] = toSamples(globalAPFMaxDelay*apfDelayWeight[2 * i], 1);
+		apfDelay[1][i] = toSamples(globalAPFMaxDelay*apfDelayWeight[2 * i + 1], 1);
+		lineDelay[i] = toSamples(globalFixedMaxDelay*fixedDelayWeight[i], 1);
+	}
+
+	// --- the ReverbTank output taps: percentages of each line delay, alternating signs
+	const uint32_t tapLanes[maxTaps] = { 0, 1, 2, 3, 0, 1, 2, 3 };
+	const double tapPercent[2][maxTaps] = { { 23.0, 41.0, 59.0, 73.0, 31.0, 47.0, 67.0, 83.0 },
+											{ 29.0, 43.0, 61.0, 79.0, 37.0, 53.0, 71.0, 89.0 } };
+	const float weight = 0.707f;
+
+	numTaps = parameters.density == reverbDensity::kThick ? maxTaps : FDN_NUM_LINES;
+	for (uint32_t t = 0; t < numTaps; t++)
+	{
+		uint32_t lane = tapLanes[t];
+		for (uint32_t c = 0; c < 2; c++)
+		{
+			// --- tap 0 of the left channel is positive, of the right channel negative
+			float sign = ((lane & 1) == c) ? weight : -weight;
+			tapLane[c][t] = lane;
+			tapDelay[c][t] = std::max((uint32_t)(lineDelay[lane] * tapPercent[c][t] / 100.0 + 0.5), 1u);
+			tapWeight[c][t] = sign;
+		}
+	}
+}
@@ -0,0 +1,117 @@
+#ifndef __fdnReverb_h__
+#define __fdnReverb_h__
+
+#include "fxobjects.h"
+
+#include <vector>
+
+// --- 4-wide SSE for the line lanes; other targets use the scalar loops, which the compiler can still vectorize
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#include <xmmintrin.h>
+#define FDN_REVERB_SSE 1
+#endif
+
+// --- one SIMD lane per delay line; the same count as the ReverbTank branches so the weight tables carry over
+const uint32_t FDN_NUM_LINES = NUM_BRANCHES;
+
+// --- longest line, allpass and pre-delay, as in ReverbTank::reset()
+const double FDN_MAX_DELAY_MSEC = 100.0;
+
+/**
+\class FDNReverbTank
+\ingroup SynthClasses
+\brief
+Block-processing replacement for ReverbTank with the same ReverbTankParameters controls. Instead of a serial ring of
+branches built from NestedDelayAPF, SimpleLPF and SimpleDelay objects, the four branches run side by side as a
+feedback delay network, one SIMD lane per branch:
+
+- input: mono-ized, pre-delayed, then fed into every line with alternating sign
+- each line: two allpass diffusers (apfDelayMax_mSec * apfDelayWeight_Pct, the ReverbTank inner/outer weights),
+  the one-pole lowpass (lpf_g) and the line delay (fixeDelayMax_mSec * fixeDelayWeight_Pct, the ReverbTank weights)
+- feedback: the line outputs are mixed with a 4x4 Householder matrix and scaled by kRT; the matrix is orthogonal,
+  so kRT < 1 always decays
+- output: the same prime-percentage taps as ReverbTank (extra taps for kThick), then the two-band shelving filters
+
+The allpass and line buffers are interleaved, four lanes per frame, so each sample writes one vector per stage
+and the lane math (mix, allpass, lowpass) is one SIMD operation each. There are no per-sample virtual calls.
+The diffuser LFO modulation of ReverbTank is not modeled, so the sound is similar but not identical.
+
+Audio I/O:
+- mono or stereo in, mono or stereo out; processAudioBlock() is the fast path
+
+Control I/F:
+- Use ReverbTankParameters structure to get/set object params; reset() sizes the buffers for FDN_MAX_DELAY_MSEC
+*/
+class FDNReverbTank : public IAudioSignalProcessor
+{
+public:
+	FDNReverbTank() {}
+	~FDNReverbTank() {}
+
+	/** size and flush the buffers for the new sample rate */
+	virtual bool reset(double _sampleRate);
+
+	/** return true: this object can process frames */
+	virtual bool canProcessAudioFrame() { return true; }
+
+	/** process mono reverb tank */
+	virtual double processAudioSample(double xn);
+
+	/** process one frame */
+	virtual bool processAudioFrame(const float* inputFrame, float* outputFrame, uint32_t inputChannels, uint32_t outputChannels);
+
+	/** process a block of non-interleaved audio; the inputs and outputs may be the same buffers */
+	virtual bool processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t inputChannels, uint32_t outputChannels, uint32_t numFrames);
+
+	/** get parameters */
+	ReverbTankParameters getParameters() { return parameters; }
+
+	/** set parameters; the delay times are clamped to FDN_MAX_DELAY_MSEC */
+	void setParameters(const ReverbTankParameters& params);
+
+protected:
+	ReverbTankParameters parameters;
+	double sampleRate = 0.0;
+
+	// --- the tank for one frame; returns the wet left/right before the shelving filters
+	inline void processTank(float monoInput, float& tankL, float& tankR);
+
+	// --- recompute delays, taps and gains from the parameters
+	void updateTank();
+
+	// --- interleaved buffers: frame i of lane k is at [i * FDN_NUM_LINES + k]; lengths are powers of two
+	std::vector<float> lineBuffer;
+	std::vector<float> apfBuffer[2];
+	std::vector<float> preDelayBuffer;
+	uint32_t bufferMask = 0;			///< shared by all buffers
+	uint32_t writeIndex = 0;			///< shared by all buffers, advanced once per frame
+
+	// --- per-lane delays in samples, at least 1
+	uint32_t lineDelay[FDN_NUM_LINES] = { 1, 1, 1, 1 };
+	uint32_t apfDelay[2][FDN_NUM_LINES] = { { 1, 1, 1, 1 }, { 1, 1, 1, 1 } };
+	uint32_t preDelay = 0;
+
+	// --- output taps into the lines, per output channel: lane, delay in samples and signed weight
+	static const uint32_t maxTaps = 2 * FDN_NUM_LINES;
+	uint32_t tapLane[2][maxTaps] = { { 0 } };
+	uint32_t tapDelay[2][maxTaps] = { { 0 } };
+	float tapWeight[2][maxTaps] = { { 0.f } };
+	uint32_t numTaps = 0;
+
+	// --- lane state and gains
+	alignas(16) float lpfState[FDN_NUM_LINES] = { 0.f };
+	alignas(16) float inputSign[FDN_NUM_LINES] = { 1.f, -1.f, 1.f, -1.f };
+	float feedbackGain = 0.f;			///< kRT
+	float lpfGain = 0.f;				///< lpf_g
+	float apfGain[2] = { 0.5f, -0.5f };	///< outer, inner, as in ReverbTank
+	double dryMix = 1.0;
+	double wetMix = 1.0;
+
+	TwoBandShelvingFilter shelvingFilters[NUM_CHANNELS]; ///< 0 = left; 1 = right
+
+	// --- the ReverbTank weight tables
+	const double apfDelayWeight[FDN_NUM_LINES * 2] = { 0.317, 0.873, 0.477, 0.291, 0.993, 0.757, 0.179, 0.575 };
+	const double fixedDelayWeight[FDN_NUM_LINES] = { 1.0, 0.873, 0.707, 0.667 };
+};
+
+#endif /* defined(__fdnReverb_h__) */
@@ -17,6 +17,8 @@
 // -----------------------------------------------------------------------------
 #include <memory>
 #include <math.h>
+#include <map>
+#include <mutex>
 #include "fxobjects.h"
 
 /**
@@ -1043,19 +1045,69 @@ const SignalGenData LFO::renderAudioOutput()
 }
 
 
-#ifdef HAVE_FFTW
+/**
+\brief returns the shared plans for a transform length, planning them on first use
+
+- NOTES:<br>
+The plans are made out of place on scratch arrays from fftw_malloc(), so they are valid for any other
+fftw_malloc() arrays passed to the new-array execute functions. FFTW_ESTIMATE keeps the results
+repeatable from run to run.
+
+\param frameLength the FFT length - MUST be a power of 2
+
+\returns the plans; never destroyed
+*/
+const FFTWPlans* FFTWPlanCache::getPlans(unsigned int frameLength)
+{
+	static std::mutex plannerMutex;
+	static std::map<unsigned int, FFTWPlans*> cache;
+
+	std::lock_guard<std::mutex> lock(plannerMutex);
+	auto it = cache.find(frameLength);
+	if (it != cache.end())
+		return it->second;
+
+	double* real = fftw_alloc_real(frameLength);
+	fftw_complex* input = fftw_alloc_complex(frameLength);
+	fftw_complex* output = fftw_alloc_complex(frameLength);
+
+	FFTWPlans* plans = new FFTWPlans;
+	plans->frameLength = frameLength;
+	plans->forwardReal = fftw_plan_dft_r2c_1d(frameLength, real, output, FFTW_ESTIMATE);
+	plans->inverseReal = fftw_plan_dft_c2r_1d(frameLength, output, real, FFTW_ESTIMATE);
+	plans->forwardComplex = fftw_plan_dft_1d(frameLength, input, output, FFTW_FORWARD, FFTW_ESTIMATE);
+	plans->inverseComplex = fftw_plan_dft_1d(frameLength, input, output, FFTW_BACKWARD, FFTW_ESTIMATE);
+
+	fftw_free(real);
+	fftw_free(input);
+	fftw_free(output);
+
+	cache[frameLength] = plans;
+	return plans;
+}
 
 /**
-\brief destroys the FFTW arrays and plans.
+\brief fills bins frameLength/2 + 1 to frameLength - 1 of a real signal's spectrum with the conjugates of the lower bins
+
+\param bins the spectrum; the lower frameLength/2 + 1 bins are set
+\param frameLength the FFT length
 */
-void FastFFT::destroyFFTW()
+static void mirrorRealSpectrum(fftw_complex* bins, unsigned int frameLength)
 {
-#ifdef HAVE_FFTW
-	if (plan_forward)
-		fftw_destroy_plan(plan_forward);
-	if (plan_backward)
-		fftw_destroy_plan(plan_backward);
+	for (unsigned int i = frameLength / 2 + 1; i < frameLength; i++)
+	{
+		bins[i][0] = bins[frameLength - i][0];
+		bins[i][1] = -bins[frameLength - i][1];
+	}
+}
 
+/**
+\brief destroys the FFTW arrays; the plans are shared and stay in the FFTWPlanCache
+*/
+void FastFFT::destroyFFTW()
+{
+	if (fft_input_real)
+		fftw_free(fft_input_real);
 	if (fft_input)
 		fftw_free(fft_input);
 	if (fft_result)
@@ -1065,7 +1117,12 @@ void FastFFT::destroyFFTW()
 		fftw_free(ifft_input);
 	if (ifft_result)
 		fftw_free(ifft_result);
-#endif
+
+	fft_input_real = nullptr;
+	fft_input = nullptr;
+	fft_result = nullptr;
+	ifft_input = nullptr;
+	ifft_result = nullptr;
 }
 
 
@@ -1086,9 +1143,9 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	windowGainCorrection = 0.0;
 
 	if (windowBuffer)
-		delete windowBuffer;
+		fftw_free(windowBuffer);
 
-	windowBuffer = new double[frameLength];
+	windowBuffer = fftw_alloc_real(frameLength);
 	memset(&windowBuffer[0], 0, frameLength * sizeof(double));
 
 
@@ -1153,14 +1210,14 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 	windowGainCorrection = 1.0 / windowGainCorrection;
 
 	destroyFFTW();
-	fft_input = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	fft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
+	fft_input_real = fftw_alloc_real(frameLength);
+	fft_input = fftw_alloc_complex(frameLength);
+	fft_result = fftw_alloc_complex(frameLength);
 
-	ifft_input =  (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	ifft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
+	ifft_input = fftw_alloc_complex(frameLength);
+	ifft_result = fftw_alloc_complex(frameLength);
 
-	plan_forward = fftw_plan_dft_1d(frameLength, fft_input, fft_result, FFTW_FORWARD, FFTW_ESTIMATE);
-	plan_backward = fftw_plan_dft_1d(frameLength, ifft_input, ifft_result, FFTW_BACKWARD, FFTW_ESTIMATE);
+	plans = FFTWPlanCache::getPlans(frameLength);
 }
 
 /**
@@ -1175,18 +1232,24 @@ void FastFFT::initialize(unsigned int _frameLength, windowType _window)
 */
 fftw_complex* FastFFT::doFFT(double* inputReal, double* inputImag)
 {
-	// ------ load up the FFT input array
-	for (int i = 0; i < frameLength; i++)
+	if (inputImag)
 	{
-		fft_input[i][0] = inputReal[i];		// --- real
-		if (inputImag)
-			fft_input[i][1] = inputImag[i]; // --- imag
-		else
-			fft_input[i][1] = 0.0;
+		// ------ load up the complex FFT input array
+		for (int i = 0; i < frameLength; i++)
+		{
+			fft_input[i][0] = inputReal[i];		// --- real
+			fft_input[i][1] = inputImag[i];		// --- imag
+		}
+
+		// --- do the FFT
+		fftw_execute_dft(plans->forwardComplex, fft_input, fft_result);
+		return fft_result;
 	}
 
-	// --- do the FFT
-	fftw_execute(plan_forward);
+	// --- real input: half the work, then mirror the upper bins so all frameLength bins are valid
+	memcpy(fft_input_real, inputReal, frameLength * sizeof(double));
+	fftw_execute_dft_r2c(plans->forwardReal, fft_input_real, fft_result);
+	mirrorRealSpectrum(fft_result, frameLength);
 
 	return fft_result;
 }
@@ -1214,27 +1277,32 @@ fftw_complex* FastFFT::doInverseFFT(double* inputReal, double* inputImag)
 	}
 
 	// --- do the IFFT
-	fftw_execute(plan_backward);
+	fftw_execute_dft(plans->inverseComplex, ifft_input, ifft_result);
 
 	return ifft_result;
 }
 
 /**
-\brief destroys the FFTW arrays and plans.
+\brief destroys the FFTW arrays; the plans are shared and stay in the FFTWPlanCache
 */
 void PhaseVocoder::destroyFFTW()
 {
-	if (plan_forward)
-		fftw_destroy_plan(plan_forward);
-	if (plan_backward)
-		fftw_destroy_plan(plan_backward);
-
 	if (fft_input)
 		fftw_free(fft_input);
 	if (fft_result)
 		fftw_free(fft_result);
+	if (ifft_input)
+		fftw_free(ifft_input);
+	if (ifft_output)
+		fftw_free(ifft_output);
 	if (ifft_result)
 		fftw_free(ifft_result);
+
+	fft_input = nullptr;
+	fft_result = nullptr;
+	ifft_input = nullptr;
+	ifft_output = nullptr;
+	ifft_result = nullptr;
 }
 
 /**
@@ -1288,9 +1356,9 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 
 	// --- fixed window buffer
 	if (windowBuffer)
-		delete windowBuffer;
+		fftw_free(windowBuffer);
 
-	windowBuffer = new double[frameLength];
+	windowBuffer = fftw_alloc_real(frameLength);
 	memset(&windowBuffer[0], 0, frameLength * sizeof(double));
 
 	// --- this is from Reiss & McPherson's code
@@ -1369,15 +1437,15 @@ void PhaseVocoder::initialize(unsigned int _frameLength, unsigned int _hopSize,
 	needInverseFFT = false;
 	needOverlapAdd = false;
 
-#ifdef HAVE_FFTW
 	destroyFFTW();
-	fft_input = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	fft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-	ifft_result = (fftw_complex*)fftw_malloc(sizeof(fftw_complex) * frameLength);
-
-	plan_forward = fftw_plan_dft_1d(frameLength, fft_input, fft_result, FFTW_FORWARD, FFTW_ESTIMATE);
-	plan_backward = fftw_plan_dft_1d(frameLength, fft_result, ifft_result, FFTW_BACKWARD, FFTW_ESTIMATE);
-#endif
+	fft_input = fftw_alloc_real(frameLength);
+	fft_result = fftw_alloc_complex(frameLength);
+	ifft_input = fftw_alloc_complex(frameLength / 2 + 1);
+	ifft_output = fftw_alloc_real(frameLength);
+	ifft_result = fftw_alloc_complex(frameLength);
+	memset(&ifft_result[0][0], 0, frameLength * sizeof(fftw_complex));
+
+	plans = FFTWPlanCache::getPlans(frameLength);
 }
 
 /**
@@ -1431,15 +1499,15 @@ bool PhaseVocoder::advanceAndCheckFFT()
 	// --- load up the input to the FFT
 	for (int i = 0; i < frameLength; i++)
 	{
-		fft_input[i][0] = inputBuffer[inputReadIndex++] * windowBuffer[i];
-		fft_input[i][1] = 0.0; // use this if your data is complex valued
+		fft_input[i] = inputBuffer[inputReadIndex++] * windowBuffer[i];
 
 		// --- wrap if index > bufferlength - 1
 		inputReadIndex &= wrapMask;
 	}
 
-	// --- do the FFT
-	fftw_execute(plan_forward);
+	// --- do the real FFT, then mirror the upper bins so all frameLength bins are valid
+	fftw_execute_dft_r2c(plans->forwardReal, fft_input, fft_result);
+	mirrorRealSpectrum(fft_result, frameLength);
 
 	// --- in case user does not take IFFT, just to prevent zero output
 	needInverseFFT = true;
@@ -1510,13 +1578,20 @@ double PhaseVocoder::processAudioSample(double input, bool& fftReady)
 
 - NOTES:<br>
 This function is optional - if you need to sequence the output (synthesis) stage yourself <br>
-then you can call this function at the appropriate time - see the PSMVocoder object for an example
+then you can call this function at the appropriate time - see the PSMVocoder object for an example<br>
+This is a complex-to-real transform: it reads bins 0 to frameLength/2 of the FFT data and treats the upper<br>
+half as their conjugate mirror, so only the lower bins need processing.
 
 */
 void PhaseVocoder::doInverseFFT()
 {
-	// do the IFFT
-	fftw_execute(plan_backward);
+	// --- do the real IFFT on bins 0 to frameLength/2; c2r destroys its input, so leave the FFT data intact
+	memcpy(&ifft_input[0][0], &fft_result[0][0], (frameLength / 2 + 1) * sizeof(fftw_complex));
+	fftw_execute_dft_c2r(plans->inverseReal, ifft_input, ifft_output);
+
+	// --- the imaginary parts stay 0
+	for (unsigned int i = 0; i < frameLength; i++)
+		ifft_result[i][0] = ifft_output[i];
 
 	// --- output is now in ifft_result array
 	needInverseFFT = false;
@@ -1555,7 +1630,7 @@ void PhaseVocoder::doOverlapAdd(double* outputData, int length)
 	for (int i = 0; i < frameLength; i++)
 	{
 		// --- accumulate
-		outputBuffer[outputWriteIndex++] += windowHopCorrection * ifft_result[i][0];
+		outputBuffer[outputWriteIndex++] += windowHopCorrection * ifft_output[i];
 
 		// --- wrap if index > bufferlength - 1
 		outputWriteIndex &= wrapMaskOut;
@@ -1565,5 +1640,3 @@ void PhaseVocoder::doOverlapAdd(double* outputData, int length)
 	needOverlapAdd = false;
 }
 
-#endif
-
@@ -19,8 +19,10 @@
 
 #include <memory>
 #include <math.h>
+#include <string.h>
 #include "guiconstants.h"
 #include "filters.h"
+#include "convolver.h"
 #include <time.h>       /* time */
 
 /** @file fxobjects.h
@@ -70,6 +72,28 @@ inline bool checkFloatUnderflow(double& value)
 	return retValue;
 }
 
+// --- set to 1 to add a tiny DC offset to recursive state variables; this is a fallback for
+//     builds/CPUs where the DenormalGuard FTZ/DAZ switch is not available
+#ifndef ENABLE_ANTI_DENORMAL_DC
+#define ENABLE_ANTI_DENORMAL_DC 0
+#endif
+const double kAntiDenormalDC = 1.0e-20;	///< ~-400dB, far below audibility but keeps feedback state out of the denormal range
+
+/**
+@addAntiDenormalDC
+\ingroup FX-Functions
+
+@brief Add the anti-denormal DC offset to a feedback state variable (no-op unless ENABLE_ANTI_DENORMAL_DC is set)
+
+\param value - the state value to offset
+*/
+inline void addAntiDenormalDC(double& value)
+{
+#if ENABLE_ANTI_DENORMAL_DC
+	value += kAntiDenormalDC;
+#endif
+}
+
 /**
 @doLinearInterpolation
 \ingroup FX-Functions
@@ -118,6 +142,28 @@ inline double doLinearInterpolation(double y1, double y2, double fractional_X)
 	return fractional_X*y2 + (1.0 - fractional_X)*y1;
 }
 
+/**
+@doHermiteInterpolation
+\ingroup FX-Functions
+
+@brief performs 4-point, 3rd order Hermite interpolation between y1 and y2 using their outer neighbors;
+smoother than linear interpolation for modulated delay reads, at about twice the cost
+
+\param y0 - the point before y1
+\param y1 - the y coordinate of the first point
+\param y2 - the y coordinate of the second point
+\param y3 - the point after y2
+\param fractional_X - the interpolation location as a fractional distance between y1 and y2
+\return the interpolated value
+*/
+inline double doHermiteInterpolation(double y0, double y1, double y2, double y3, double fractional_X)
+{
+	double c1 = 0.5*(y2 - y0);
+	double c2 = y0 - 2.5*y1 + 2.0*y2 - 0.5*y3;
+	double c3 = 0.5*(y3 - y0) + 1.5*(y1 - y2);
+	return ((c3*fractional_X + c2)*fractional_X + c1)*fractional_X + y1;
+}
+
 /**
 @doLagrangeInterpolation
 \ingroup FX-Functions
@@ -1200,6 +1246,45 @@ public:
 		// --- do nothing
 		return false; // NOT handled
 	}
+
+	/** process a block of non-interleaved audio; the inputs and outputs may be the same buffers.
+	    The default runs processAudioFrame() frame by frame, or processAudioSample() on the first channel
+	    for objects that cannot process frames; objects with a real block path override it */
+	virtual bool processAudioBlock(const float* const* inputs,		/* one pointer per channel */
+								   float* const* outputs,
+								   uint32_t inputChannels,
+								   uint32_t outputChannels,
+								   uint32_t numFrames)
+	{
+		if (inputChannels == 0 || outputChannels == 0)
+			return false;
+
+		if (!canProcessAudioFrame())
+		{
+			for (uint32_t i = 0; i < numFrames; i++)
+				outputs[0][i] = (float)processAudioSample(inputs[0][i]);
+			return true;
+		}
+
+		const uint32_t maxFrameChannels = 8;
+		if (inputChannels > maxFrameChannels || outputChannels > maxFrameChannels)
+			return false;
+
+		float inputFrame[maxFrameChannels] = { 0.f };
+		float outputFrame[maxFrameChannels] = { 0.f };
+		for (uint32_t i = 0; i < numFrames; i++)
+		{
+			for (uint32_t c = 0; c < inputChannels; c++)
+				inputFrame[c] = inputs[c][i];
+
+			if (!processAudioFrame(inputFrame, outputFrame, inputChannels, outputChannels))
+				return false;
+
+			for (uint32_t c = 0; c < outputChannels; c++)
+				outputs[c][i] = outputFrame[c];
+		}
+		return true;
+	}
 };
 
 /**
@@ -1550,6 +1635,17 @@ public:
 	*/
 	virtual double processAudioSample(double xn);
 
+	/** process channel 0 of a block without the per-sample virtual call; the inputs and outputs may be the same buffers */
+	virtual bool processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t inputChannels, uint32_t outputChannels, uint32_t numFrames)
+	{
+		if (inputChannels == 0 || outputChannels == 0)
+			return false;
+
+		for (uint32_t i = 0; i < numFrames; i++)
+			outputs[0][i] = (float)AudioFilter::processAudioSample(inputs[0][i]);
+		return true;
+	}
+
 	/** --- sample rate change necessarily requires recalculation */
 	virtual void setSampleRate(double _sampleRate)
 	{
@@ -1582,6 +1678,9 @@ public:
 		calculateFilterCoeffs();
 	}
 
+	/** --- copy the coefficients, including the c0/d0 wet/dry mix, into a numCoeffs array (see BiquadCascade) */
+	void getCoefficients(double* coeffs) { memcpy(&coeffs[0], &coeffArray[0], sizeof(double)*numCoeffs); }
+
 	/** --- helper for Harma filters (phaser) */
 	double getG_value() { return biquad.getG_value(); }
 
@@ -2278,12 +2377,27 @@ private:
 };
 
 
+/**
+\enum delayInterpolation
+\ingroup Constants-Enums
+\brief
+Use this strongly typed enum to set how a CircularBuffer reads fractional delays.
+
+- enum class delayInterpolation { kNone, kLinear, kHermite };
+*/
+enum class delayInterpolation { kNone, kLinear, kHermite };
+
 /**
 \class CircularBuffer
 \ingroup FX-Objects
 \brief
 The CircularBuffer object implements a simple circular buffer. It uses a wrap mask to wrap the read or write index quickly.
 
+Besides the per-sample writeBuffer()/readBuffer(), whole blocks can be moved with writeBlock()/readBlock(): a block
+read at a fixed delay is at most two memcpy() calls (or a contiguous interpolation loop), and a block write is at
+most two memcpy() calls. A block read returns what readBuffer() would return during the next count writes, so it
+is only valid while none of those samples is written within the block; getBlockLimit() gives that length.
+
 \author Will Pirkle http://www.willpirkle.com
 \remark This object is included in Designing Audio Effects Plugins in C++ 2nd Ed. by Will Pirkle
 \version Revision : 1.0
@@ -2362,7 +2476,7 @@ public:
 		T y1 = readBuffer((int)delayInFractionalSamples);
 
 		// --- if no interpolation, just return value
-		if (!interpolate) return y1;
+		if (interpolationType == delayInterpolation::kNone) return y1;
 
 		// --- else do interpolation
 		//
@@ -2372,19 +2486,148 @@ public:
 		// --- get fractional part
 		double fraction = delayInFractionalSamples - (int)delayInFractionalSamples;
 
+		// --- Hermite needs the next newer sample too, which only exists from one sample of delay on
+		if (interpolationType == delayInterpolation::kHermite && (int)delayInFractionalSamples >= 1)
+			return doHermiteInterpolation(readBuffer((int)delayInFractionalSamples - 1), y1, y2,
+										  readBuffer((int)delayInFractionalSamples + 2), fraction);
+
 		// --- do the interpolation (you could try different types here)
 		return doLinearInterpolation(y1, y2, fraction);
 	}
 
+	/** write a block of values, oldest first; same as count calls to writeBuffer(). count must not exceed the buffer length */
+	void writeBlock(const T* input, unsigned int count)
+	{
+		unsigned int firstPart = bufferLength - writeIndex < count ? bufferLength - writeIndex : count;
+		memcpy(&buffer[writeIndex], input, firstPart * sizeof(T));
+		if (count > firstPart)
+			memcpy(&buffer[0], input + firstPart, (count - firstPart) * sizeof(T));
+
+		writeIndex = (writeIndex + count) & wrapMask;
+	}
+
+	/** read the values readBuffer(delayInSamples) returns during the next count writes; count must not exceed getBlockLimit() */
+	void readBlock(T* output, int delayInSamples, unsigned int count)
+	{
+		unsigned int readIndex = (writeIndex - 1 - delayInSamples) & wrapMask;
+		unsigned int firstPart = bufferLength - readIndex < count ? bufferLength - readIndex : count;
+		memcpy(output, &buffer[readIndex], firstPart * sizeof(T));
+		if (count > firstPart)
+			memcpy(output + firstPart, &buffer[0], (count - firstPart) * sizeof(T));
+	}
+
+	/** read the values readBuffer(delayInFractionalSamples) returns during the next count writes; count must not exceed getBlockLimit() */
+	void readBlock(T* output, double delayInFractionalSamples, unsigned int count)
+	{
+		int delayInSamples = (int)delayInFractionalSamples;
+		if (interpolationType == delayInterpolation::kNone)
+		{
+			readBlock(output, delayInSamples, count);
+			return;
+		}
+
+		double fraction = delayInFractionalSamples - delayInSamples;
+		bool hermite = interpolationType == delayInterpolation::kHermite && delayInSamples >= 1;
+
+		unsigned int frame = 0;
+		while (frame < count)
+		{
+			// --- taps run from index - 2 (older) to index + 1 (newer); where one wraps, do a single frame the slow way
+			unsigned int index = (writeIndex - 1 - delayInSamples + frame) & wrapMask;
+			if (index < 2 || index + 1 >= bufferLength)
+			{
+				int delay = delayInSamples - (int)frame;
+				T y1 = readBuffer(delay);
+				T y2 = readBuffer(delay + 1);
+				output[frame++] = hermite ? doHermiteInterpolation(readBuffer(delay - 1), y1, y2, readBuffer(delay + 2), fraction)
+										  : doLinearInterpolation(y1, y2, fraction);
+				continue;
+			}
+
+			// --- contiguous stretch: plain loops over one pointer
+			unsigned int span = bufferLength - 1 - index < count - frame ? bufferLength - 1 - index : count - frame;
+			const T* newer = &buffer[index + 1];
+			const T* taps = &buffer[index];
+			const T* older = &buffer[index - 1];
+			const T* oldest = &buffer[index - 2];
+			T* out = output + frame;
+			if (hermite)
+			{
+				for (unsigned int i = 0; i < span; i++)
+					out[i] = doHermiteInterpolation(newer[i], taps[i], older[i], oldest[i], fraction);
+			}
+			else
+			{
+				for (unsigned int i = 0; i < span; i++)
+					out[i] = fraction*older[i] + (1.0 - fraction)*taps[i];
+			}
+			frame += span;
+		}
+	}
+
+	/** modulated read: output[i] is what readBuffer(delaysInFractionalSamples[i]) returns after i more writes;
+	    count must not exceed getBlockLimit() for any of the delays at its frame */
+	void readBlock(T* output, const double* delaysInFractionalSamples, unsigned int count)
+	{
+		for (unsigned int i = 0; i < count; i++)
+		{
+			int delayInSamples = (int)delaysInFractionalSamples[i];
+			unsigned int index = writeIndex - 1 + i - delayInSamples;
+			T y1 = buffer[index & wrapMask];
+			if (interpolationType == delayInterpolation::kNone)
+			{
+				output[i] = y1;
+				continue;
+			}
+
+			double fraction = delaysInFractionalSamples[i] - delayInSamples;
+			T y2 = buffer[(index - 1) & wrapMask];
+			if (interpolationType == delayInterpolation::kHermite && delayInSamples >= 1)
+				output[i] = doHermiteInterpolation(buffer[(index + 1) & wrapMask], y1, y2, buffer[(index - 2) & wrapMask], fraction);
+			else
+				output[i] = fraction*y2 + (1.0 - fraction)*y1;
+		}
+	}
+
+	/** longest block that can be read at this delay before the block is written: each tap t can be read for
+	    (t mod bufferLength) + 1 frames before the reads reach the samples the block itself writes */
+	unsigned int getBlockLimit(double delayInFractionalSamples)
+	{
+		int delayInSamples = (int)delayInFractionalSamples;
+		int newestTap = delayInSamples;
+		int oldestTap = delayInSamples;
+		if (interpolationType != delayInterpolation::kNone)
+			oldestTap++;
+		if (interpolationType == delayInterpolation::kHermite && delayInSamples >= 1)
+		{
+			newestTap--;
+			oldestTap++;
+		}
+
+		unsigned int limit = bufferLength;
+		for (int tap = newestTap; tap <= oldestTap; tap++)
+		{
+			unsigned int tapLimit = ((unsigned int)tap & wrapMask) + 1;
+			limit = tapLimit < limit ? tapLimit : limit;
+		}
+		return limit;
+	}
+
 	/** enable or disable interpolation; usually used for diagnostics or in algorithms that require strict integer samples times */
-	void setInterpolate(bool b) { interpolate = b; }
+	void setInterpolate(bool b) { interpolationType = b ? delayInterpolation::kLinear : delayInterpolation::kNone; }
+
+	/** choose the fractional read; Hermite falls back to linear below one sample of delay */
+	void setInterpolation(delayInterpolation type) { interpolationType = type; }
+
+	/** buffer length, a power of 2 */
+	unsigned int getBufferLength() { return bufferLength; }
 
 private:
 	std::unique_ptr<T[]> buffer = nullptr;	///< smart pointer will auto-delete
 	unsigned int writeIndex = 0;		///> write index
 	unsigned int bufferLength = 1024;	///< must be nearest power of 2
 	unsigned int wrapMask = 1023;		///< must be (bufferLength - 1)
-	bool interpolate = true;			///< interpolation (default is ON)
+	delayInterpolation interpolationType = delayInterpolation::kLinear;	///< interpolation (default is linear)
 };
 
 
@@ -2534,8 +2777,11 @@ The AnalogFIRFilter object implements a somewhat silly algorithm that implaments
 magnitude response as a FIR filter. NOT DESIGNED to replace virtual analog; rather it is intended to show the
 frequency sampling method in an easy (and fun) way.
 
+The IR_LEN taps run through a FIRConvolver, which uses FFT partitions at this length; a parameter change
+recomputes the IR in place without allocating.
+
 Audio I/O:
-- Processes mono input to mono output.
+- Processes mono input to mono output; processAudioBlock() is the fast path.
 
 Control I/F:
 - Use AnalogFIRFilterParameters structure to get/set object params.
@@ -2552,12 +2798,13 @@ public:
 	~AnalogFIRFilter() {}	/* D-TOR */
 
 public:
-	/** reset members to initialized state */
+	/** reset members to initialized state; the IR is recomputed for the new sample rate */
 	virtual bool reset(double _sampleRate)
 	{
 		sampleRate = _sampleRate;
-		convolver.reset(_sampleRate);
-		convolver.init(IR_LEN);
+		convolver.reset();
+		if (parameters.fc > 0.0)
+			calculateFilterIR(parameters);
 		return true;
 	}
 
@@ -2569,12 +2816,22 @@ public:
 	virtual double processAudioSample(double xn)
 	{
 		// --- do the linear convolution
-		return convolver.processAudioSample(xn);
+		return convolver.processAudioSample((float)xn);
 	}
 
 	/** return false: this object only processes samples */
 	virtual bool canProcessAudioFrame() { return false; }
 
+	/** process channel 0 of a block; the inputs and outputs may be the same buffers */
+	virtual bool processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t inputChannels, uint32_t outputChannels, uint32_t numFrames)
+	{
+		if (inputChannels == 0 || outputChannels == 0)
+			return false;
+
+		convolver.processAudioBlock(inputs[0], outputs[0], numFrames);
+		return true;
+	}
+
 	/** get parameters: note use of custom structure for passing param data */
 	/**
 	\return AnalogFIRFilterParameters custom data structure
@@ -2591,33 +2848,39 @@ public:
 			_parameters.Q != parameters.Q ||
 			_parameters.filterType != parameters.filterType)
 		{
-			// --- set the filter IR for the convolver
-			AnalogMagData analogFilterData;
-			analogFilterData.sampleRate = sampleRate;
-			analogFilterData.magArray = &analogMagArray[0];
-			analogFilterData.dftArrayLen = IR_LEN;
-			analogFilterData.mirrorMag = false;
+			calculateFilterIR(_parameters);
+		}
 
-			analogFilterData.filterType = _parameters.filterType;
-			analogFilterData.fc = _parameters.fc; // 1000.0;
-			analogFilterData.Q = _parameters.Q;
+		parameters = _parameters;
+	}
 
-			// --- calculate the analog mag array
-			calculateAnalogMagArray(analogFilterData);
+private:
+	/** frequency sample the analog magnitude response into the convolver's IR */
+	void calculateFilterIR(const AnalogFIRFilterParameters& _parameters)
+	{
+		// --- set the filter IR for the convolver
+		AnalogMagData analogFilterData;
+		analogFilterData.sampleRate = sampleRate;
+		analogFilterData.magArray = &analogMagArray[0];
+		analogFilterData.dftArrayLen = IR_LEN;
+		analogFilterData.mirrorMag = false;
 
-			// --- frequency sample the mag array
-			freqSample(IR_LEN, analogMagArray, irArray, POSITIVE);
+		analogFilterData.filterType = _parameters.filterType;
+		analogFilterData.fc = _parameters.fc; // 1000.0;
+		analogFilterData.Q = _parameters.Q;
 
-			// --- update new frequency response
-			convolver.setImpulseResponse(irArray, IR_LEN);
-		}
+		// --- calculate the analog mag array
+		calculateAnalogMagArray(analogFilterData);
 
-		parameters = _parameters;
+		// --- frequency sample the mag array
+		freqSample(IR_LEN, analogMagArray, irArray, POSITIVE);
+
+		// --- update new frequency response
+		convolver.setImpulseResponse(irArray, IR_LEN);
 	}
 
-private:
 	AnalogFIRFilterParameters parameters; ///< object parameters
-	ImpulseConvolver convolver; ///< convolver object to perform FIR convolution
+	FIRConvolver convolver; ///< convolver object to perform FIR convolution
 	double analogMagArray[IR_LEN] = { 0.0 }; ///< array for analog magnitude response
 	double irArray[IR_LEN] = { 0.0 }; ///< array to hold calcualted IR
 	double sampleRate = 0.0; ///< storage for sample rate
@@ -2684,6 +2947,7 @@ struct AudioDelayParameters
 		leftDelay_mSec = params.leftDelay_mSec;
 		rightDelay_mSec = params.rightDelay_mSec;
 		delayRatio_Pct = params.delayRatio_Pct;
+		interpolation = params.interpolation;
 
 		return *this;
 	}
@@ -2698,8 +2962,12 @@ struct AudioDelayParameters
 	double leftDelay_mSec = 0.0;	///< left delay time
 	double rightDelay_mSec = 0.0;	///< right delay time
 	double delayRatio_Pct = 100.0;	///< dela ratio: right length = (delayRatio)*(left length)
+	delayInterpolation interpolation = delayInterpolation::kLinear;	///< fractional delay read
 };
 
+// --- AudioDelay::processAudioBlock() works in spans of at most this many frames (stack scratch)
+const unsigned int DELAY_BLOCK_LEN = 64;
+
 /**
 \class AudioDelay
 \ingroup FX-Objects
@@ -2845,6 +3113,31 @@ public:
 		return true;
 	}
 
+	/** process a block of non-interleaved audio; same result as processAudioFrame() frame by frame, but
+	    the delay lines are read and written in bulk, in spans no longer than the delay itself */
+	virtual bool processAudioBlock(const float* const* inputs,
+								   float* const* outputs,
+								   uint32_t inputChannels,
+								   uint32_t outputChannels,
+								   uint32_t numFrames)
+	{
+		return processDelayBlock(inputs, outputs, inputChannels, outputChannels, numFrames, nullptr);
+	}
+
+	/** process a block with the delay time changing every frame, for the modulated delay effects; the
+	    same delay is used for both channels and the delay time in the parameters is left unchanged
+	\param delays_mSec one delay time per frame
+	*/
+	bool processModulatedAudioBlock(const float* const* inputs,
+									float* const* outputs,
+									uint32_t inputChannels,
+									uint32_t outputChannels,
+									uint32_t numFrames,
+									const double* delays_mSec)
+	{
+		return processDelayBlock(inputs, outputs, inputChannels, outputChannels, numFrames, delays_mSec);
+	}
+
 	/** get parameters: note use of custom structure for passing param data */
 	/**
 	\return AudioDelayParameters custom data structure
@@ -2866,6 +3159,9 @@ public:
 		// --- save; rest of updates are cheap on CPU
 		parameters = _parameters;
 
+		delayBuffer_L.setInterpolation(parameters.interpolation);
+		delayBuffer_R.setInterpolation(parameters.interpolation);
+
 		// --- check update type first:
 		if (parameters.updateType == delayUpdateType::kLeftAndRight)
 		{
@@ -2910,6 +3206,107 @@ public:
 	}
 
 private:
+	/** block worker for both block functions; delays_mSec is nullptr for the fixed delay times */
+	bool processDelayBlock(const float* const* inputs, float* const* outputs, uint32_t inputChannels,
+						   uint32_t outputChannels, uint32_t numFrames, const double* delays_mSec)
+	{
+		// --- make sure we have input and outputs
+		if (inputChannels == 0 || outputChannels == 0)
+			return false;
+
+		// --- make sure we support this delay algorithm
+		if (parameters.algorithm != delayAlgorithm::kNormal &&
+			parameters.algorithm != delayAlgorithm::kPingPong)
+			return false;
+
+		bool stereo = outputChannels > 1;
+		double feedback = parameters.feedback_Pct / 100.0;
+
+		double delays_L[DELAY_BLOCK_LEN];
+		double delays_R[DELAY_BLOCK_LEN];
+		double yn_L[DELAY_BLOCK_LEN];
+		double yn_R[DELAY_BLOCK_LEN];
+		double dn_L[DELAY_BLOCK_LEN];
+		double dn_R[DELAY_BLOCK_LEN];
+
+		uint32_t frame = 0;
+		while (frame < numFrames)
+		{
+			uint32_t span = numFrames - frame < DELAY_BLOCK_LEN ? numFrames - frame : DELAY_BLOCK_LEN;
+
+			// --- the span must end before the reads reach samples written within it
+			if (delays_mSec)
+			{
+				for (uint32_t i = 0; i < span; i++)
+				{
+					delays_L[i] = delays_R[i] = delays_mSec[frame + i] * samplesPerMSec;
+					if (i > 0 && delayBuffer_L.getBlockLimit(delays_L[i]) <= i)
+						span = i;
+				}
+			}
+			else
+			{
+				unsigned int limit = delayBuffer_L.getBlockLimit(delayInSamples_L);
+				if (stereo)
+				{
+					unsigned int limit_R = delayBuffer_R.getBlockLimit(delayInSamples_R);
+					limit = limit_R < limit ? limit_R : limit;
+				}
+				span = limit < span ? limit : span;
+			}
+
+			// --- read the whole span from each line
+			if (delays_mSec)
+				delayBuffer_L.readBlock(yn_L, delays_L, span);
+			else
+				delayBuffer_L.readBlock(yn_L, delayInSamples_L, span);
+
+			if (stereo && delays_mSec)
+				delayBuffer_R.readBlock(yn_R, delays_R, span);
+			else if (stereo)
+				delayBuffer_R.readBlock(yn_R, delayInSamples_R, span);
+
+			const float* input_L = inputs[0] + frame;
+			const float* input_R = (inputChannels > 1 ? inputs[1] : inputs[0]) + frame;
+			float* output_L = outputs[0] + frame;
+			float* output_R = stereo ? outputs[1] + frame : nullptr;
+
+			// --- feedback and mix; inputs are picked up before the outputs are written, so they may alias
+			for (uint32_t i = 0; i < span; i++)
+			{
+				double xnL = input_L[i];
+				double xnR = input_R[i];
+
+				dn_L[i] = xnL + feedback*yn_L[i];
+				output_L[i] = (float)(dryMix*xnL + wetMix*yn_L[i]);
+
+				if (stereo)
+				{
+					dn_R[i] = xnR + feedback*yn_R[i];
+					output_R[i] = (float)(dryMix*xnR + wetMix*yn_R[i]);
+				}
+			}
+
+			// --- write the whole span to each line
+			if (!stereo)
+				delayBuffer_L.writeBlock(dn_L, span);
+			else if (parameters.algorithm == delayAlgorithm::kNormal)
+			{
+				delayBuffer_L.writeBlock(dn_L, span);
+				delayBuffer_R.writeBlock(dn_R, span);
+			}
+			else
+			{
+				delayBuffer_L.writeBlock(dn_R, span);
+				delayBuffer_R.writeBlock(dn_L, span);
+			}
+
+			frame += span;
+		}
+
+		return true;
+	}
+
 	AudioDelayParameters parameters; ///< object parameters
 
 	double sampleRate = 0.0;		///< current sample rate
@@ -3293,6 +3690,7 @@ struct ModulatedDelayParameters
 		lfoRate_Hz = params.lfoRate_Hz;
 		lfoDepth_Pct = params.lfoDepth_Pct;
 		feedback_Pct = params.feedback_Pct;
+		interpolation = params.interpolation;
 		return *this;
 	}
 
@@ -3301,6 +3699,7 @@ struct ModulatedDelayParameters
 	double lfoRate_Hz = 0.0;	///< mod delay LFO rate in Hz
 	double lfoDepth_Pct = 0.0;	///< mod delay LFO depth in %
 	double feedback_Pct = 0.0;	///< feedback in %
+	delayInterpolation interpolation = delayInterpolation::kLinear;	///< fractional delay read; kHermite is smoother on fast sweeps
 };
 
 /**
@@ -3375,46 +3774,7 @@ public:
 
 		// --- setup delay modulation
 		AudioDelayParameters params = delay.getParameters();
-		double minDelay_mSec = 0.0;
-		double maxDepth_mSec = 0.0;
-
-		// --- set delay times, wet/dry and feedback
-		if (parameters.algorithm == modDelaylgorithm::kFlanger)
-		{
-			minDelay_mSec = 0.1;
-			maxDepth_mSec = 7.0;
-			params.wetLevel_dB = -3.0;
-			params.dryLevel_dB = -3.0;
-		}
-		if (parameters.algorithm == modDelaylgorithm::kChorus)
-		{
-			minDelay_mSec = 10.0;
-			maxDepth_mSec = 30.0;
-			params.wetLevel_dB = -3.0;
-			params.dryLevel_dB = -0.0;
-			params.feedback_Pct = 0.0;
-		}
-		if (parameters.algorithm == modDelaylgorithm::kVibrato)
-		{
-			minDelay_mSec = 0.0;
-			maxDepth_mSec = 7.0;
-			params.wetLevel_dB = 0.0;
-			params.dryLevel_dB = -96.0;
-			params.feedback_Pct = 0.0;
-		}
-
-		// --- calc modulated delay times
-		double depth = parameters.lfoDepth_Pct / 100.0;
-		double modulationMin = minDelay_mSec;
-		double modulationMax = minDelay_mSec + maxDepth_mSec;
-
-		// --- flanger - unipolar
-		if (parameters.algorithm == modDelaylgorithm::kFlanger)
-			params.leftDelay_mSec = doUnipolarModulationFromMin(bipolarToUnipolar(depth * lfoOutput.normalOutput),
-															     modulationMin, modulationMax);
-		else
-			params.leftDelay_mSec = doBipolarModulation(depth * lfoOutput.normalOutput, modulationMin, modulationMax);
-
+		params.leftDelay_mSec = getModulatedDelay_mSec(params, lfoOutput.normalOutput);
 
 		// --- set right delay to match (*Hint Homework!)
 		params.rightDelay_mSec = params.leftDelay_mSec;
@@ -3426,6 +3786,45 @@ public:
 		return delay.processAudioFrame(inputFrame, outputFrame, inputChannels, outputChannels);
 	}
 
+	/** process a block of non-interleaved audio; same result as processAudioFrame() frame by frame. The LFO
+	    renders one delay time per frame and the delay line is read with those times in bulk */
+	virtual bool processAudioBlock(const float* const* inputs,
+								   float* const* outputs,
+								   uint32_t inputChannels,
+								   uint32_t outputChannels,
+								   uint32_t numFrames)
+	{
+		// --- make sure we have input and outputs
+		if (inputChannels == 0 || outputChannels == 0)
+			return false;
+
+		AudioDelayParameters params = delay.getParameters();
+		double delays_mSec[DELAY_BLOCK_LEN];
+
+		uint32_t frame = 0;
+		while (frame < numFrames)
+		{
+			uint32_t count = numFrames - frame < DELAY_BLOCK_LEN ? numFrames - frame : DELAY_BLOCK_LEN;
+			for (uint32_t i = 0; i < count; i++)
+				delays_mSec[i] = getModulatedDelay_mSec(params, lfo.renderAudioOutput().normalOutput);
+
+			// --- mix and feedback are fixed per algorithm; the last delay time is left in the delay's
+			//     parameters, as the frame path would
+			params.leftDelay_mSec = params.rightDelay_mSec = delays_mSec[count - 1];
+			delay.setParameters(params);
+
+			const float* blockInputs[2] = { inputs[0] + frame, inputChannels > 1 ? inputs[1] + frame : nullptr };
+			float* blockOutputs[2] = { outputs[0] + frame, outputChannels > 1 ? outputs[1] + frame : nullptr };
+			uint32_t blockInputChannels = inputChannels > 2 ? 2 : inputChannels;
+			uint32_t blockOutputChannels = outputChannels > 2 ? 2 : outputChannels;
+			if (!delay.processModulatedAudioBlock(blockInputs, blockOutputs, blockInputChannels, blockOutputChannels, count, delays_mSec))
+				return false;
+
+			frame += count;
+		}
+		return true;
+	}
+
 	/** get parameters: note use of custom structure for passing param data */
 	/**
 	\return ModulatedDelayParameters custom data structure
@@ -3452,10 +3851,54 @@ public:
 
 		AudioDelayParameters adParams = delay.getParameters();
 		adParams.feedback_Pct = parameters.feedback_Pct;
+		adParams.interpolation = parameters.interpolation;
 		delay.setParameters(adParams);
 	}
 
 private:
+	/** set the algorithm's mix and feedback in params and return the modulated delay time for one LFO value */
+	double getModulatedDelay_mSec(AudioDelayParameters& params, double lfoValue)
+	{
+		double minDelay_mSec = 0.0;
+		double maxDepth_mSec = 0.0;
+
+		// --- set delay times, wet/dry and feedback
+		if (parameters.algorithm == modDelaylgorithm::kFlanger)
+		{
+			minDelay_mSec = 0.1;
+			maxDepth_mSec = 7.0;
+			params.wetLevel_dB = -3.0;
+			params.dryLevel_dB = -3.0;
+		}
+		if (parameters.algorithm == modDelaylgorithm::kChorus)
+		{
+			minDelay_mSec = 10.0;
+			maxDepth_mSec = 30.0;
+			params.wetLevel_dB = -3.0;
+			params.dryLevel_dB = -0.0;
+			params.feedback_Pct = 0.0;
+		}
+		if (parameters.algorithm == modDelaylgorithm::kVibrato)
+		{
+			minDelay_mSec = 0.0;
+			maxDepth_mSec = 7.0;
+			params.wetLevel_dB = 0.0;
+			params.dryLevel_dB = -96.0;
+			params.feedback_Pct = 0.0;
+		}
+
+		// --- calc modulated delay times
+		double depth = parameters.lfoDepth_Pct / 100.0;
+		double modulationMin = minDelay_mSec;
+		double modulationMax = minDelay_mSec + maxDepth_mSec;
+
+		// --- flanger - unipolar
+		if (parameters.algorithm == modDelaylgorithm::kFlanger)
+			return doUnipolarModulationFromMin(bipolarToUnipolar(depth * lfoValue), modulationMin, modulationMax);
+
+		return doBipolarModulation(depth * lfoValue, modulationMin, modulationMax);
+	}
+
 	ModulatedDelayParameters parameters; ///< object parameters
 	AudioDelay delay;	///< the delay to modulate
 	LFO lfo;			///< the modulator
@@ -3788,6 +4231,7 @@ public:
 		double g = simpleLPFParameters.g;
 		double yn = (1.0 - g)*xn + g*state;
 		state = yn;
+		addAntiDenormalDC(state);
 		return yn;
 	}
 
@@ -4073,6 +4517,7 @@ public:
 			input = xn + comb_g*yn;
 		}
 
+		addAntiDenormalDC(input);
 		delay.writeDelay(input);
 
 		// --- done
@@ -4268,6 +4713,7 @@ public:
 
 		// form w(n) = x(n) + gw(n-D)
 		double wn = xn + apf_g*wnD;
+		addAntiDenormalDC(wn);
 
 		// form y(n) = -gw(n) + w(n-D)
 		double yn = -apf_g*wn + wnD;
@@ -5260,6 +5706,7 @@ public:
 
 			// --- update memory
 			integrator_z[0] = vn + lpf;
+			addAntiDenormalDC(integrator_z[0]);
 
 			// --- form the HPF = INPUT = LPF
 			double hpf = xn - lpf;
@@ -5305,6 +5752,8 @@ public:
 		// update memory
 		integrator_z[0] = alpha*hpf + bpf;
 		integrator_z[1] = alpha*bpf + lpf;
+		addAntiDenormalDC(integrator_z[0]);
+		addAntiDenormalDC(integrator_z[1]);
 
 		double filterOutputGain = pow(10.0, zvaFilterParameters.filterOutputGain_dB / 20.0);
 
@@ -8672,7 +9121,7 @@ protected:
 
 
 // ------------------------------------------------------------------ //
-// --- OBJECTS REQUIRING FFTW --------------------------------------- //
+// --- FFT OBJECTS: FFTW OR THE BUILT-IN FFT ------------------------ //
 // ------------------------------------------------------------------ //
 
 /**
@@ -8746,9 +9195,50 @@ inline std::unique_ptr<double[]> makeWindow(unsigned int windowLength, unsigned
 	return windowBuffer;
 }
 
-// --- FFTW ---
+// --- FFT backend: FFTW when HAVE_FFTW is defined (link libfftw3), otherwise the built-in FFT through its FFTW shim
+//     with the same API subset, so the objects below always build
 #ifdef HAVE_FFTW
 #include "fftw3.h"
+#else
+#include "builtinfftw.h"
+#endif
+
+/**
+\struct FFTWPlans
+\ingroup FFTW-Objects
+\brief
+The FFTW plans for one transform length, shared by every FastFFT and PhaseVocoder of that length.
+The plans are executed with the new-array functions (fftw_execute_dft_r2c() etc.) on each object's
+own fftw_malloc() buffers, which is thread-safe, so one set of plans serves all instances.
+
+- forwardReal: frameLength reals -> frameLength/2 + 1 bins
+- inverseReal: frameLength/2 + 1 bins -> frameLength reals; reads only those bins and destroys them
+- forwardComplex, inverseComplex: full complex transforms, for complex-valued data
+*/
+struct FFTWPlans
+{
+	unsigned int frameLength = 0;			///< transform length
+	fftw_plan forwardReal = nullptr;		///< r2c, out of place
+	fftw_plan inverseReal = nullptr;		///< c2r, out of place
+	fftw_plan forwardComplex = nullptr;		///< complex FFT, out of place
+	fftw_plan inverseComplex = nullptr;		///< complex IFFT, out of place
+};
+
+/**
+\class FFTWPlanCache
+\ingroup FFTW-Objects
+\brief
+Process-wide cache of FFTWPlans keyed by transform length. The first request for a length creates
+its plans; later requests return the same ones. The FFTW planner is not thread-safe, so the cache
+serializes it with a mutex: call getPlans() from initialize() and the like, never from the audio thread.
+The plans live until the process exits.
+*/
+class FFTWPlanCache
+{
+public:
+	/** get the plans for a transform length, creating them on first use */
+	static const FFTWPlans* getPlans(unsigned int frameLength);
+};
 
 /**
 \class FastFFT
@@ -8772,7 +9262,7 @@ class FastFFT
 public:
 	FastFFT() {}		/* C-TOR */
 	~FastFFT() {
-		if (windowBuffer) delete[] windowBuffer;
+		if (windowBuffer) fftw_free(windowBuffer);
 		destroyFFTW();
 	}	/* D-TOR */
 
@@ -8782,7 +9272,7 @@ public:
 	/** destroy FFTW objects and plans */
 	void destroyFFTW();
 
-	/** do the FFT and return real and imaginary arrays */
+	/** do the FFT and return real and imaginary arrays; real input (inputImag == nullptr) uses the real-to-complex transform */
 	fftw_complex* doFFT(double* inputReal, double* inputImag = nullptr);
 
 	/** do the IFFT and return real and imaginary arrays */
@@ -8792,15 +9282,15 @@ public:
 	unsigned int getFrameLength() { return frameLength; }
 
 protected:
-	// --- setup FFTW
-	fftw_complex*	fft_input = nullptr;		///< array for FFT input
+	// --- setup FFTW; all arrays are fftw_malloc()-aligned
+	double*			fft_input_real = nullptr;	///< array for real FFT input
+	fftw_complex*	fft_input = nullptr;		///< array for complex FFT input
 	fftw_complex*	fft_result = nullptr;		///< array for FFT output
 	fftw_complex*	ifft_input = nullptr;		///< array for IFFT input
 	fftw_complex*	ifft_result = nullptr;		///< array for IFFT output
-	fftw_plan       plan_forward = nullptr;		///< FFTW plan for FFT
-	fftw_plan		plan_backward = nullptr;	///< FFTW plan for IFFT
+	const FFTWPlans* plans = nullptr;			///< shared plans from FFTWPlanCache
 
-	double* windowBuffer = nullptr;				///< buffer for window (naked)
+	double* windowBuffer = nullptr;				///< buffer for window (naked, fftw_malloc()-aligned)
 	double windowGainCorrection = 1.0;			///< window gain correction
 	windowType window = windowType::kHannWindow; ///< window type
 	unsigned int frameLength = 0;				///< current FFT length
@@ -8833,7 +9323,7 @@ public:
 	~PhaseVocoder() {
 		if (inputBuffer) delete[] inputBuffer;
 		if (outputBuffer) delete[] outputBuffer;
-		if (windowBuffer) delete[] windowBuffer;
+		if (windowBuffer) fftw_free(windowBuffer);
 		destroyFFTW();
 	}	/* D-TOR */
 
@@ -8852,12 +9342,16 @@ public:
 	/** increment the FFT counter and do the FFT if it is ready */
 	bool advanceAndCheckFFT();
 
-	/** get FFT data for manipulation (yes, naked pointer so you can manipulate) */
+	/** get FFT data for manipulation (yes, naked pointer so you can manipulate); frameLength bins, of which
+	    the inverse FFT only reads 0 to frameLength/2: the upper half is the conjugate mirror of the lower one */
 	fftw_complex* getFFTData() { return fft_result; }
 
-	/** get IFFT data for manipulation (yes, naked pointer so you can manipulate) */
+	/** get IFFT data for manipulation (yes, naked pointer so you can manipulate); the imaginary parts are 0 */
 	fftw_complex* getIFFTData() { return ifft_result; }
 
+	/** get the number of bins the inverse FFT reads: frameLength/2 + 1 */
+	unsigned int getNumBins() { return frameLength / 2 + 1; }
+
 	/** do the inverse FFT (optional; will be called automatically if not used) */
 	void doInverseFFT();
 
@@ -8879,15 +9373,16 @@ public:
 	void setOverlapAddOnly(bool b){ bool overlapAddOnly = b; }
 
 protected:
-	// --- setup FFTW
-	fftw_complex*	fft_input = nullptr;		///< array for FFT input
+	// --- setup FFTW; all arrays are fftw_malloc()-aligned
+	double*			fft_input = nullptr;		///< array for FFT input (real)
 	fftw_complex*	fft_result = nullptr;		///< array for FFT output
-	fftw_complex*	ifft_result = nullptr;		///< array for IFFT output
-	fftw_plan       plan_forward = nullptr;		///< FFTW plan for FFT
-	fftw_plan		plan_backward = nullptr;	///< FFTW plan for IFFT
+	fftw_complex*	ifft_input = nullptr;		///< array for IFFT input: a copy of the lower bins, which the c2r transform destroys
+	double*			ifft_output = nullptr;		///< array for IFFT output (real)
+	fftw_complex*	ifft_result = nullptr;		///< array for IFFT output, for getIFFTData()
+	const FFTWPlans* plans = nullptr;			///< shared plans from FFTWPlanCache
 
 	// --- linear buffer for window
-	double*			windowBuffer = nullptr;		///< array for window
+	double*			windowBuffer = nullptr;		///< array for window (fftw_malloc()-aligned)
 
 	// --- circular buffers for input and output
 	double*			inputBuffer = nullptr;		///< input timeline (x)
@@ -9011,14 +9506,8 @@ public:
 		// --- copy the FFT into our local buffer for storage; also
 		//     we never want to hold a pointer to a FFT output
 		//     for more than one local function's worth
-		//     could replace with memcpy( )
-		for (int i = 0; i < 2; i++)
-		{
-			for (unsigned int j = 0; j < filterImpulseLength * 2; j++)
-			{
-				filterFFT[j][i] = fftOfFilter[j][i];
-			}
-		}
+		//     only the bins the real IFFT reads are needed (filterImpulseLength + 1)
+		memcpy(&filterFFT[0][0], &fftOfFilter[0][0], sizeof(fftw_complex) * (filterImpulseLength + 1));
 	}
 
 	/** process an input sample through convolver */
@@ -9037,10 +9526,8 @@ public:
 				fftw_complex* signalFFT = vocoder.getFFTData();
 				if (signalFFT)
 				{
-					unsigned int fff = vocoder.getFrameLength();
-
-					// --- complex multiply with FFT of IR
-					for (unsigned int i = 0; i < filterImpulseLength * 2; i++)
+					// --- complex multiply with FFT of IR; the upper half of the bins is implied by symmetry
+					for (unsigned int i = 0; i < vocoder.getNumBins(); i++)
 					{
 						// --- get real/imag parts of each FFT
 						ComplexNumber signal(signalFFT[i][0], signalFFT[i][1]);
@@ -9506,7 +9993,8 @@ public:
 
 			else // ---> old school
 			{
-				for (int i = 0; i < PSM_FFT_LEN; i++)
+				// --- only the bins the real IFFT reads; the upper half is implied by symmetry
+				for (int i = 0; i < (int)vocoder.getNumBins(); i++)
 				{
 					double mag_k = getMagnitude(fftData[i][0], fftData[i][1]);
 					double phi_k = getPhase(fftData[i][0], fftData[i][1]);
@@ -9995,5 +10483,3 @@ protected:
 	bool polyphase = true;									///< enable polyphase decomposition
 	FastConvolver polyPhaseConvolvers[maxSamplingRatio];	///< a set of sub-band convolvers for polyphase operation
 };
-
-#endif
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "synthdefs.h"
+#include "lookaheaddynamics.h"
 
 // --- this detector can receive signals and transmit detection values that are both > 0dBFS
 class TruLogDetector
@@ -170,7 +171,8 @@ protected:
 
 
 
-// --- custom limiter designed especially for self oscillating filters whose outputs are > 0dBFS
+// --- custom limiter designed especially for self oscillating filters whose outputs are > 0dBFS; the hard-knee
+//     limiter of LookaheadDynamics with no lookahead, so the gain is threshold/envelope with no logs per sample
 class Limiter
 {
 public:
@@ -179,49 +181,52 @@ public:
 
 	void reset(double _sampleRate)
 	{
-		// --- reset detector (always first)
-		detector.reset(_sampleRate);
-
-		// --- init; 
-		detector.initialize(0.1,	/* attack time mSec*/
-							25.0,	/* release time mSec*/
-							true,	/* true = analog time-constant */
-							ENVELOPE_DETECT_MODE_PEAK); /* peak detector*/
+		// --- one per voice: no delay lines
+		dynamics.setMaxLookahead_mSec(0.0);
+		dynamics.reset(_sampleRate);
+
+		// --- init; the envelope is not clamped, so inputs > 0dBFS are limited too, which is what oscillating filters output
+		LookaheadDynamicsParameters params = dynamics.getParameters();
+		params.hardLimitGate = true;
+		params.kneeWidth_dB = 0.0;
+		params.attackTime_mSec = 0.1;
+		params.releaseTime_mSec = 25.0;
+		params.detectMode = TLD_AUDIO_DETECT_MODE_PEAK;
+		params.threshold_dB = threshold_dB;
+		dynamics.setParameters(params);
+	}
 
-		// --- allow inputs > 0dBFS, which is what oscillating filters output
-		detector.setClampToUnityMax(false);
+	void setAttackTime(double attack_in_ms)
+	{
+		LookaheadDynamicsParameters params = dynamics.getParameters();
+		params.attackTime_mSec = attack_in_ms;
+		dynamics.setParameters(params);
 	}
 
-	void setAttackTime(double attack_in_ms) { detector.setAttackTime(attack_in_ms); }
-	void setReleaseTime(double release_in_ms) { detector.setReleaseTime(release_in_ms); }
-	void setThreshold_dB(double _threshold_dB) { threshold_dB = _threshold_dB; }
-	
-	float calcLimiterGain(float fDetectorValue, float fThreshold)
+	void setReleaseTime(double release_in_ms)
 	{
-		// --- slope variable // limiting is infinite ratio thus CS->1.0
-		//                       you can play with this for compression CS < 1.0
-		float CS = 1.0;
-		
-		// --- compute gain; threshold and detection values are in dB	
-		float yG = CS*(fThreshold - fDetectorValue);  // [Eq. 13.1]
+		LookaheadDynamicsParameters params = dynamics.getParameters();
+		params.releaseTime_mSec = release_in_ms;
+		dynamics.setParameters(params);
+	}
 
-		// --- clamp; this allows ratios of 1:1 to still operate
-		yG = fmin(0, yG);
+	// --- called on every filter update, so only a change recalculates
+	void setThreshold_dB(double _threshold_dB)
+	{
+		if (threshold_dB == _threshold_dB)
+			return;
+		threshold_dB = _threshold_dB;
 
-		// --- convert back to linear
-		return pow(10.0, yG / 20.0);
+		LookaheadDynamicsParameters params = dynamics.getParameters();
+		params.threshold_dB = threshold_dB;
+		dynamics.setParameters(params);
 	}
 
 	// --- do the limiter
-	double processAudio(double input)
-	{
-		double detectedValue_dB = detector.detect(input);
-		double gain = calcLimiterGain(detectedValue_dB, threshold_dB);
-		return input*gain;
-	}
+	double processAudio(double input) { return dynamics.processAudioSample(input); }
 
 protected:
-	TruLogDetector detector;
+	LookaheadDynamics dynamics;
 	double threshold_dB = -0.5; // (dB)
 };
 
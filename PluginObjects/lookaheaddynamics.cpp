@@ -0,0 +1,316 @@
+#include "lookaheaddynamics.h"
+
+#include <algorithm>
+
+#ifdef LOOKAHEAD_DYNAMICS_SSE2
+// --- four-wide fastLog2(); the same steps as the scalar version
+static inline __m128 fastLog2_ps(__m128 x)
+{
+	x = _mm_max_ps(x, _mm_set1_ps(1.17549435e-38f));
+
+	__m128i bits = _mm_castps_si128(x);
+	__m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+	__m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+	// --- fold the mantissa into [0.707, 1.414); the mask is -1 where it was folded
+	__m128 fold = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+	m = _mm_or_ps(_mm_and_ps(fold, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(fold, m));
+	exponent = _mm_sub_epi32(exponent, _mm_castps_si128(fold));
+
+	__m128 one = _mm_set1_ps(1.f);
+	__m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+	__m128 t2 = _mm_mul_ps(t, t);
+	__m128 p = _mm_add_ps(_mm_set1_ps(0.57707802f), _mm_mul_ps(t2, _mm_set1_ps(0.41219859f)));
+	p = _mm_add_ps(_mm_set1_ps(0.96179669f), _mm_mul_ps(t2, p));
+	p = _mm_add_ps(_mm_set1_ps(2.88539008f), _mm_mul_ps(t2, p));
+	return _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_mul_ps(t, p));
+}
+
+// --- four-wide fastExp2(); floor() without SSE4.1: truncate, then step down where that rounded up
+static inline __m128 fastExp2_ps(__m128 x)
+{
+	x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.f)), _mm_set1_ps(126.f));
+
+	__m128 y = _mm_add_ps(x, _mm_set1_ps(0.5f));
+	__m128i whole = _mm_cvttps_epi32(y);
+	whole = _mm_add_epi32(whole, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(whole), y)));
+	__m128 f = _mm_sub_ps(x, _mm_cvtepi32_ps(whole));
+
+	__m128 p = _mm_add_ps(_mm_set1_ps(0.00961813f), _mm_mul_ps(f, _mm_set1_ps(0.00133336f)));
+	p = _mm_add_ps(_mm_set1_ps(0.05550411f), _mm_mul_ps(f, p));
+	p = _mm_add_ps(_mm_set1_ps(0.24022651f), _mm_mul_ps(f, p));
+	p = _mm_add_ps(_mm_set1_ps(0.69314718f), _mm_mul_ps(f, p));
+	p = _mm_add_ps(_mm_set1_ps(1.f), _mm_mul_ps(f, p));
+
+	__m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(whole, _mm_set1_epi32(127)), 23));
+	return _mm_mul_ps(p, scale);
+}
+#endif
+
+/**
+\brief Allocate the ring for windows of up to maxWindow values and flush it
+
+\param maxWindow the longest window that setWindow() will ask for
+*/
+void SlidingWindowMax::setMaxWindow(uint32_t maxWindow)
+{
+	uint32_t length = 1;
+	while (length < maxWindow + 1)
+		length <<= 1;
+
+	values.assign(length, 0.f);
+	indexes.assign(length, 0);
+	mask = length - 1;
+	window = std::min(window, mask);
+	reset();
+}
+
+/**
+\brief Set the window length and flush
+
+\param _window 1 to the max window
+*/
+void SlidingWindowMax::setWindow(uint32_t _window)
+{
+	window = std::min(std::max(_window, 1u), std::max(mask, 1u));
+	reset();
+}
+
+/**
+\brief Size the delay lines and the peak hold for the max lookahead at the new sample rate, then flush; the
+vectors keep their storage when they do not grow
+
+\param _sampleRate the new sample rate
+*/
+bool LookaheadDynamics::reset(double _sampleRate)
+{
+	sampleRate = _sampleRate;
+	maxLookaheadSamples = (uint32_t)(maxLookahead_mSec * sampleRate / 1000.0 + 0.5);
+
+	uint32_t length = 1;
+	while (length < maxLookaheadSamples + 1)
+		length <<= 1;
+	delayMask = length - 1;
+	for (uint32_t c = 0; c < 2; c++)
+		delayLine[c].assign(length, 0.f);
+	writeIndex = 0;
+
+	peakHold.setMaxWindow(maxLookaheadSamples + 1);
+
+	// --- force the lookahead to be set up again
+	lookaheadSamples = 0;
+	envelope = 0.f;
+
+	updateDetector();
+	updateGainComputer();
+	return true;
+}
+
+/**
+\brief Store the parameters and recalculate the detector and gain computer; only a lookahead change flushes
+
+\param _parameters the new parameters
+*/
+void LookaheadDynamics::setParameters(const LookaheadDynamicsParameters& _parameters)
+{
+	parameters = _parameters;
+	if (sampleRate <= 0.0)
+		return;
+
+	updateDetector();
+	updateGainComputer();
+}
+
+/**
+\brief Attack and release coefficients (the AudioDetector analog time constant) and the lookahead length
+*/
+void LookaheadDynamics::updateDetector()
+{
+	attackCoeff = parameters.attackTime_mSec > 0.0 ? (float)exp(TLD_AUDIO_ENVELOPE_ANALOG_TC / (parameters.attackTime_mSec * sampleRate * 0.001)) : 0.f;
+	releaseCoeff = parameters.releaseTime_mSec > 0.0 ? (float)exp(TLD_AUDIO_ENVELOPE_ANALOG_TC / (parameters.releaseTime_mSec * sampleRate * 0.001)) : 0.f;
+
+	uint32_t lookahead = (uint32_t)(fmax(parameters.lookahead_mSec, 0.0) * sampleRate / 1000.0 + 0.5);
+	lookahead = std::min(lookahead, maxLookaheadSamples);
+	if (lookahead != lookaheadSamples || peakHold.getWindow() != lookahead + 1)
+	{
+		lookaheadSamples = lookahead;
+		peakHold.setWindow(lookahead + 1);
+		for (uint32_t c = 0; c < 2; c++)
+			std::fill(delayLine[c].begin(), delayLine[c].end(), 0.f);
+	}
+}
+
+/**
+\brief Gain computer constants in log2 units; see the member comments
+*/
+void LookaheadDynamics::updateGainComputer()
+{
+	bool expander = parameters.calculation == dynamicsProcessorType::kDownwardExpander;
+	bool rms = parameters.detectMode == TLD_AUDIO_DETECT_MODE_RMS || parameters.detectMode == TLD_AUDIO_DETECT_MODE_MS;
+	double ratio = fmax(parameters.ratio, 1.0);
+
+	levelScale = rms ? 0.5f : 1.f;
+	direction = expander ? -1.f : 1.f;
+	threshold2 = (float)(parameters.threshold_dB / DYNAMICS_DB_PER_LOG2);
+	kneeWidth2 = (float)(fmax(parameters.kneeWidth_dB, 0.0) / DYNAMICS_DB_PER_LOG2);
+	kneeScale = kneeWidth2 > 0.f ? 0.5f / kneeWidth2 : 0.f;
+
+	// --- a gate drops 1000 octaves per octave below the threshold, which fastExp2() clamps to 2^-126
+	if (expander)
+		slope = parameters.hardLimitGate ? -1000.f : (float)(1.0 - ratio);
+	else
+		slope = parameters.hardLimitGate ? -1.f : (float)(1.0 / ratio - 1.0);
+
+	linearLimiter = !expander && parameters.hardLimitGate && kneeWidth2 <= 0.f;
+	threshold = (float)dB2Raw(parameters.threshold_dB);
+	if (rms)
+		threshold *= threshold;
+
+	makeUpGain = (float)dB2Raw(parameters.outputGain_dB);
+}
+
+/**
+\brief The gain computer over levels[0 .. numFrames), four envelope values at a time, into gains[]
+
+\param numFrames frames in the chunk
+*/
+void LookaheadDynamics::computeGains(uint32_t numFrames)
+{
+	uint32_t i = 0;
+#ifdef LOOKAHEAD_DYNAMICS_SSE2
+	const __m128 vThreshold = _mm_set1_ps(threshold);
+	const __m128 vThreshold2 = _mm_set1_ps(threshold2);
+	const __m128 vDirection = _mm_set1_ps(direction);
+	const __m128 vLevelScale = _mm_set1_ps(levelScale);
+	const __m128 vSlope = _mm_set1_ps(slope);
+	const __m128 vHalfKnee = _mm_set1_ps(0.5f*kneeWidth2);
+	const __m128 vKneeScale = _mm_set1_ps(kneeScale);
+	const __m128 zero = _mm_setzero_ps();
+
+	for (; i + 4 <= numFrames; i += 4)
+	{
+		__m128 env = _mm_load_ps(levels + i);
+		__m128 gain;
+		if (linearLimiter)
+		{
+			gain = _mm_div_ps(vThreshold, _mm_max_ps(env, vThreshold));
+			if (levelScale < 1.f)
+				gain = _mm_sqrt_ps(gain);
+		}
+		else
+		{
+			__m128 u = _mm_mul_ps(vDirection, _mm_sub_ps(_mm_mul_ps(vLevelScale, fastLog2_ps(env)), vThreshold2));
+			__m128 gain2;
+			if (kneeWidth2 <= 0.f)
+				gain2 = _mm_mul_ps(vSlope, _mm_max_ps(u, zero));
+			else
+			{
+				__m128 q = _mm_max_ps(_mm_add_ps(u, vHalfKnee), zero);
+				__m128 knee = _mm_mul_ps(vSlope, _mm_mul_ps(_mm_mul_ps(q, q), vKneeScale));
+				__m128 above = _mm_cmpge_ps(u, vHalfKnee);
+				gain2 = _mm_or_ps(_mm_and_ps(above, _mm_mul_ps(vSlope, u)), _mm_andnot_ps(above, knee));
+			}
+			gain = fastExp2_ps(gain2);
+		}
+		_mm_store_ps(gains + i, gain);
+	}
+#endif
+	for (; i < numFrames; i++)
+		gains[i] = computeGain(levels[i]);
+}
+
+/**
+\brief Process a block of one or two stereo-linked channels in chunks of DYNAMICS_BLOCK_SIZE frames, and store
+the largest gain reduction of the block for metering
+
+\param inputs one pointer per channel
+\param outputs one pointer per channel; may be the inputs
+\param numChannels 1 or 2
+\param numFrames the number of frames
+*/
+void LookaheadDynamics::processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t numChannels, uint32_t numFrames)
+{
+	if (numChannels == 0)
+		return;
+	numChannels = std::min(numChannels, 2u);
+
+	float lowestGain = 1.f;
+	for (uint32_t offset = 0; offset < numFrames; offset += DYNAMICS_BLOCK_SIZE)
+	{
+		uint32_t chunkFrames = std::min(numFrames - offset, DYNAMICS_BLOCK_SIZE);
+		processChunk(inputs, outputs, numChannels, offset, chunkFrames);
+
+		for (uint32_t i = 0; i < chunkFrames; i++)
+			lowestGain = fminf(lowestGain, gains[i]);
+	}
+
+	parameters.gainReduction_dB = lowestGain > 0.f ? 20.0 * log10(lowestGain) : -96.0;
+}
+
+/**
+\brief One chunk: detect, lookahead, envelope, gain computer, then the gain on the (delayed) audio; the inputs
+are read completely before any output is written
+*/
+void LookaheadDynamics::processChunk(const float* const* inputs, float* const* outputs, uint32_t numChannels, uint32_t offset, uint32_t numFrames)
+{
+	const bool squared = levelScale < 1.f;
+
+	// --- detect: linked peak or square
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		float level = fabsf(inputs[0][offset + i]);
+		if (numChannels > 1)
+			level = fmaxf(level, fabsf(inputs[1][offset + i]));
+		levels[i] = squared ? level*level : level;
+	}
+
+	// --- lookahead: delay the audio and hold the peaks for the same time
+	const float* source[2] = { inputs[0] + offset, inputs[numChannels - 1] + offset };
+	if (lookaheadSamples > 0)
+	{
+		for (uint32_t c = 0; c < numChannels; c++)
+		{
+			float* line = delayLine[c].data();
+			for (uint32_t i = 0; i < numFrames; i++)
+			{
+				line[(writeIndex + i) & delayMask] = inputs[c][offset + i];
+				delayed[c][i] = line[(writeIndex + i - lookaheadSamples) & delayMask];
+			}
+			source[c] = delayed[c];
+		}
+		writeIndex = (writeIndex + numFrames) & delayMask;
+
+		for (uint32_t i = 0; i < numFrames; i++)
+			levels[i] = peakHold.process(levels[i]);
+	}
+
+	// --- envelope
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		float coeff = levels[i] > envelope ? attackCoeff : releaseCoeff;
+		envelope = coeff*(envelope - levels[i]) + levels[i];
+		if (envelope < 1.17549435e-38f)
+			envelope = 0.f;
+		levels[i] = envelope;
+	}
+
+	// --- a lookahead limiter never lets the delayed sample itself through above the threshold
+	if (lookaheadSamples > 0 && parameters.hardLimitGate && direction > 0.f && !squared)
+	{
+		for (uint32_t i = 0; i < numFrames; i++)
+		{
+			float peak = fabsf(source[0][i]);
+			if (numChannels > 1)
+				peak = fmaxf(peak, fabsf(source[1][i]));
+			levels[i] = fmaxf(levels[i], peak);
+		}
+	}
+
+	computeGains(numFrames);
+
+	for (uint32_t c = 0; c < numChannels; c++)
+	{
+		for (uint32_t i = 0; i < numFrames; i++)
+			outputs[c][offset + i] = source[c][i] * (gains[i] * makeUpGain);
+	}
+}
@@ -0,0 +1,331 @@
+#ifndef __lookaheadDynamics_h__
+#define __lookaheadDynamics_h__
+
+#include "fxobjects.h"
+
+#include <vector>
+
+// --- 4-wide SSE2 for the gain computer; other targets use the scalar loops
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LOOKAHEAD_DYNAMICS_SSE2 1
+#endif
+
+// --- frames per internal chunk; the blocks passed in may be any size
+const uint32_t DYNAMICS_BLOCK_SIZE = 64;
+
+// --- longest lookahead; reset() sizes the delay lines for it unless the owner asks for less
+const double DYNAMICS_MAX_LOOKAHEAD_MSEC = 10.0;
+
+// --- dB per octave of level: 20*log10(2); the gain computer works in log2 units
+const double DYNAMICS_DB_PER_LOG2 = 6.0205999132796239;
+
+/**
+@fastLog2
+\ingroup FX-Functions
+
+@brief log2(x) for x > 0 to about 4e-6 (2e-5 dB): the exponent from the float bits plus an odd series in
+t = (m - 1)/(m + 1) for the mantissa m folded into [0.707, 1.414); smaller values clamp to 2^-126
+
+\param x input value
+\return log2(x)
+*/
+inline float fastLog2(float x)
+{
+	x = fmaxf(x, 1.17549435e-38f);
+
+	int32_t bits = 0;
+	memcpy(&bits, &x, sizeof(float));
+	int32_t exponent = ((bits >> 23) & 0xFF) - 127;
+	bits = (bits & 0x007FFFFF) | 0x3F800000;
+
+	float m = 0.f;
+	memcpy(&m, &bits, sizeof(float));
+	if (m > 1.41421356f)
+	{
+		m *= 0.5f;
+		exponent++;
+	}
+
+	// --- log2(m) = 2/ln(2) * (t + t^3/3 + t^5/5 + t^7/7 + ...), |t| < 0.172
+	float t = (m - 1.f) / (m + 1.f);
+	float t2 = t*t;
+	return (float)exponent + t*(2.88539008f + t2*(0.96179669f + t2*(0.57707802f + t2*0.41219859f)));
+}
+
+/**
+@fastExp2
+\ingroup FX-Functions
+
+@brief 2^x to about 3e-6 relative (2e-5 dB): the integer part of x goes into the float exponent, the rest
+(-0.5 to 0.5) through the 5th order Taylor series; x is clamped to +/-126
+
+\param x input value
+\return 2^x
+*/
+inline float fastExp2(float x)
+{
+	x = fminf(fmaxf(x, -126.f), 126.f);
+
+	float whole = floorf(x + 0.5f);
+	float f = x - whole;
+	float p = 1.f + f*(0.69314718f + f*(0.24022651f + f*(0.05550411f + f*(0.00961813f + f*0.00133336f))));
+
+	int32_t bits = ((int32_t)whole + 127) << 23;
+	float scale = 0.f;
+	memcpy(&scale, &bits, sizeof(float));
+	return p*scale;
+}
+
+/**
+\class SlidingWindowMax
+\ingroup SynthClasses
+\brief
+Running maximum over the last N values in O(1) amortized time per value: a monotonic queue keeps only the values
+that can still become the maximum (each one larger than everything pushed after it), so the front is always the
+maximum of the window.
+
+The queue lives in a power-of-two ring that setMaxWindow() allocates; setWindow() and reset() only flush.
+*/
+class SlidingWindowMax
+{
+public:
+	SlidingWindowMax() {}
+	~SlidingWindowMax() {}
+
+	/** allocate for windows of up to maxWindow values; call from reset() only */
+	void setMaxWindow(uint32_t maxWindow);
+
+	/** set the window length (1 to the max window) and flush */
+	void setWindow(uint32_t _window);
+
+	/** flush the queue */
+	void reset() { head = 0; count = 0; counter = 0; }
+
+	/** push one value and return the maximum of the last getWindow() values */
+	inline float process(float x)
+	{
+		// --- values not larger than x can never be the maximum again
+		while (count > 0 && values[(head + count - 1) & mask] <= x)
+			count--;
+
+		uint32_t tail = (head + count) & mask;
+		values[tail] = x;
+		indexes[tail] = counter;
+		count++;
+
+		// --- the front leaves once it is window values old; unsigned math wraps with the counter
+		if (counter - indexes[head] >= window)
+		{
+			head = (head + 1) & mask;
+			count--;
+		}
+
+		counter++;
+		return values[head];
+	}
+
+	/** window length */
+	uint32_t getWindow() { return window; }
+
+protected:
+	std::vector<float> values;
+	std::vector<uint32_t> indexes;
+	uint32_t mask = 0;
+	uint32_t window = 1;
+	uint32_t head = 0;
+	uint32_t count = 0;
+	uint32_t counter = 0;
+};
+
+/**
+\struct LookaheadDynamicsParameters
+\ingroup SynthStructures
+\brief
+Custom parameter structure for the LookaheadDynamics object.
+*/
+struct LookaheadDynamicsParameters
+{
+	LookaheadDynamicsParameters() {}
+
+	/** all FXObjects parameter objects require overloaded= operator so remember to add new entries if you add new variables. */
+	LookaheadDynamicsParameters& operator=(const LookaheadDynamicsParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		calculation = params.calculation;
+		threshold_dB = params.threshold_dB;
+		ratio = params.ratio;
+		kneeWidth_dB = params.kneeWidth_dB;
+		hardLimitGate = params.hardLimitGate;
+		attackTime_mSec = params.attackTime_mSec;
+		releaseTime_mSec = params.releaseTime_mSec;
+		lookahead_mSec = params.lookahead_mSec;
+		detectMode = params.detectMode;
+		outputGain_dB = params.outputGain_dB;
+		// --- NOTE: do not set outbound variables??
+		gainReduction_dB = params.gainReduction_dB;
+		return *this;
+	}
+
+	// --- individual parameters
+	dynamicsProcessorType calculation = dynamicsProcessorType::kCompressor; ///< compressor (limiter) or downward expander (gate)
+	double threshold_dB = -10.0;		///< threshold in dB
+	double ratio = 4.0;					///< processor I/O gain ratio
+	double kneeWidth_dB = 0.0;			///< knee width in dB; 0 = hard knee
+	bool hardLimitGate = false;			///< infinite ratio: limiter, or gate for the expander
+	double attackTime_mSec = 5.0;		///< attack mSec (analog time constant)
+	double releaseTime_mSec = 100.0;	///< release mSec (analog time constant)
+	double lookahead_mSec = 0.0;		///< detector lookahead; the audio is delayed by this much
+	unsigned int detectMode = TLD_AUDIO_DETECT_MODE_PEAK; ///< TLD_AUDIO_DETECT_MODE_PEAK or TLD_AUDIO_DETECT_MODE_RMS
+	double outputGain_dB = 0.0;			///< make up gain
+
+	// --- outbound value, for owner to use gain-reduction metering
+	double gainReduction_dB = 0.0;		///< largest gain reduction of the last block (<= 0)
+};
+
+/**
+\class LookaheadDynamics
+\ingroup SynthClasses
+\brief
+Block-based compressor/limiter/expander for one channel or a stereo-linked pair. Each block runs in stages over the
+whole block rather than one sample at a time through a detector object:
+
+- detect: the linked peak (or square, for RMS) of the channels
+- lookahead: a SlidingWindowMax over lookahead + 1 samples holds each peak for the lookahead time while the audio is
+  delayed by the same time, so the envelope is already rising when the peak arrives
+- envelope: the analog attack/release one-pole of AudioDetector; the only serial stage
+- gain computer: threshold, ratio and knee in log2 units with fastLog2()/fastExp2(), four samples at a time, with the
+  branches of DynamicsProcessor::computeGain() as SIMD selects; a hard-knee limiter needs no logs at all, its gain is
+  threshold/envelope
+- with lookahead, a limiter also clamps to the delayed sample's own peak, so no sample leaves above the threshold
+
+processAudioSample() is the same engine for one sample of one channel, for per-voice use (the MoogFilter TruTone
+Limiter runs it with no lookahead).
+
+Audio I/O:
+- processAudioBlock(): one or two channels, stereo-linked; the inputs and outputs may be the same buffers
+
+Control I/F:
+- Use LookaheadDynamicsParameters structure to get/set object params; a lookahead change flushes the delay lines
+*/
+class LookaheadDynamics
+{
+public:
+	LookaheadDynamics() {}
+	~LookaheadDynamics() {}
+
+	/** size the delay lines for the max lookahead and flush; this allocates only when the buffers grow */
+	bool reset(double _sampleRate);
+
+	/** lower the max lookahead before reset() to save memory, e.g. 0 for per-voice limiters */
+	void setMaxLookahead_mSec(double _maxLookahead_mSec) { maxLookahead_mSec = fmin(fmax(_maxLookahead_mSec, 0.0), DYNAMICS_MAX_LOOKAHEAD_MSEC); }
+
+	/** get parameters */
+	LookaheadDynamicsParameters getParameters() { return parameters; }
+
+	/** set parameters */
+	void setParameters(const LookaheadDynamicsParameters& _parameters);
+
+	/** the audio delay in samples */
+	uint32_t getLatencyInSamples() { return lookaheadSamples; }
+
+	/** process a block of one or two channels */
+	void processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t numChannels, uint32_t numFrames);
+
+	/** process one sample of one channel */
+	inline double processAudioSample(double xn)
+	{
+		float input = (float)xn;
+		float output = 0.f;
+		const float* inputs[1] = { &input };
+		float* outputs[1] = { &output };
+
+		// --- no lookahead: skip the block machinery for per-voice use
+		if (lookaheadSamples == 0)
+		{
+			float level = parameters.detectMode == TLD_AUDIO_DETECT_MODE_PEAK ? fabsf(input) : input*input;
+			float coeff = level > envelope ? attackCoeff : releaseCoeff;
+			envelope = coeff*(envelope - level) + level;
+			if (envelope < 1.17549435e-38f)
+				envelope = 0.f;
+
+			return xn * (computeGain(envelope) * makeUpGain);
+		}
+
+		processAudioBlock(inputs, outputs, 1, 1);
+		return output;
+	}
+
+protected:
+	LookaheadDynamicsParameters parameters;
+	double sampleRate = 0.0;
+	double maxLookahead_mSec = DYNAMICS_MAX_LOOKAHEAD_MSEC;
+
+	// --- envelope one-pole
+	float attackCoeff = 0.f;
+	float releaseCoeff = 0.f;
+	float envelope = 0.f;
+
+	// --- gain computer constants, in log2 units: u = direction * (level - threshold) is how far the level is into
+	//     the active side (above for the compressor, below for the expander) and the gain is slope * u there, with a
+	//     quadratic knee of kneeWidth2 around u = 0; slope is 1/ratio - 1 for the compressor and 1 - ratio for the expander
+	bool linearLimiter = false;		///< hard-knee limiter: gain = threshold/level, no logs
+	float threshold = 1.f;			///< linear threshold (squared for RMS detection)
+	float threshold2 = 0.f;
+	float direction = 1.f;
+	float slope = 0.f;
+	float kneeWidth2 = 0.f;
+	float kneeScale = 0.f;			///< 1 / (2 * kneeWidth2)
+	float levelScale = 1.f;			///< 0.5 for RMS: the envelope is a square
+	float makeUpGain = 1.f;
+	void updateGainComputer();
+
+	// --- time constants and lookahead from the parameters; a lookahead change flushes the delay lines
+	void updateDetector();
+
+	// --- gain for one envelope value; the scalar version of computeGains()
+	inline float computeGain(float env)
+	{
+		if (linearLimiter)
+		{
+			float gain = threshold / fmaxf(env, threshold);
+			return levelScale < 1.f ? sqrtf(gain) : gain;
+		}
+
+		float u = direction*(levelScale*fastLog2(env) - threshold2);
+		float gain2 = 0.f;
+		if (kneeWidth2 <= 0.f)
+			gain2 = slope*fmaxf(u, 0.f);
+		else if (u >= 0.5f*kneeWidth2)
+			gain2 = slope*u;
+		else
+		{
+			float q = fmaxf(u + 0.5f*kneeWidth2, 0.f);
+			gain2 = slope*(q*q*kneeScale);
+		}
+		return fastExp2(gain2);
+	}
+
+	// --- lookahead: peak hold and one delay line per channel
+	SlidingWindowMax peakHold;
+	uint32_t lookaheadSamples = 0;
+	uint32_t maxLookaheadSamples = 0;
+	std::vector<float> delayLine[2];
+	uint32_t delayMask = 0;
+	uint32_t writeIndex = 0;
+
+	// --- per-chunk work buffers
+	alignas(16) float levels[DYNAMICS_BLOCK_SIZE] = { 0.f };
+	alignas(16) float gains[DYNAMICS_BLOCK_SIZE] = { 0.f };
+	float delayed[2][DYNAMICS_BLOCK_SIZE] = { { 0.f } };
+
+	// --- gain computer over a chunk of envelope values in levels[], into gains[]
+	void computeGains(uint32_t numFrames);
+
+	// --- one chunk of at most DYNAMICS_BLOCK_SIZE frames
+	void processChunk(const float* const* inputs, float* const* outputs, uint32_t numChannels, uint32_t offset, uint32_t numFrames);
+};
+
+#endif /* defined(__lookaheadDynamics_h__) */
@@ -0,0 +1,332 @@
+#include "masterfx.h"
+
+/**
+\brief Create the delay lines for the new sample rate and flush every slot; the slot states
+are rebuilt from the enable switches, so nothing is left draining
+
+\param _sampleRate the new sample rate
+*/
+bool MasterFXRack::reset(double _sampleRate)
+{
+	sampleRate = _sampleRate;
+
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		phaser[i].reset(_sampleRate);
+	}
+
+	compressor.setMaxLookahead_mSec(0.0);
+	compressor.reset(_sampleRate);
+	limiter.reset(_sampleRate);
+
+	chorus.reset(_sampleRate);
+	reverb.reset(_sampleRate);
+	convolver.reset();
+
+	// --- AudioDelay only sizes its buffers when told how long they need to be
+	delay.createDelayBuffers(_sampleRate, MASTER_FX_MAX_DELAY_MSEC);
+	delay.reset(_sampleRate);
+
+	// --- the delay times and detector constants depend on the sample rate
+	updateProcessors();
+	updateTailDetectors();
+
+	for (uint32_t i = 0; i < kNumMasterFXSlots; i++)
+		setSlotState(i, parameters.enableSlot[i] ? masterFXSlotState::kActive : masterFXSlotState::kBypassed);
+
+	return true;
+}
+
+/**
+\brief Store the rack parameters and update the slot states; a slot with a tail that is switched
+off keeps running until its tail has died out
+
+\param _parameters the new parameters
+*/
+void MasterFXRack::setParameters(const MasterFXParameters& _parameters)
+{
+	parameters = _parameters;
+
+	// --- clamp the delay times to the buffers created in reset()
+	boundValue(parameters.delayParameters.leftDelay_mSec, 0.0, MASTER_FX_MAX_DELAY_MSEC);
+	boundValue(parameters.delayParameters.rightDelay_mSec, 0.0, MASTER_FX_MAX_DELAY_MSEC);
+	boundValue(parameters.reverbParameters.preDelayTime_mSec, 0.0, 100.0);
+	boundValue(parameters.reverbParameters.apfDelayMax_mSec, 0.0, 100.0);
+	boundValue(parameters.reverbParameters.apfDelayWeight_Pct, 0.0, 100.0);
+	boundValue(parameters.reverbParameters.fixeDelayMax_mSec, 0.0, 100.0);
+	boundValue(parameters.reverbParameters.fixeDelayWeight_Pct, 0.0, 100.0);
+
+	updateProcessors();
+
+	for (uint32_t i = 0; i < kNumMasterFXSlots; i++)
+	{
+		if (parameters.enableSlot[i])
+			setSlotState(i, masterFXSlotState::kActive);
+		else if (slotState[i] == masterFXSlotState::kActive && slotHasTail(i))
+		{
+			tailDetector[i].reset();
+			setSlotState(i, masterFXSlotState::kDraining);
+		}
+		else if (slotState[i] == masterFXSlotState::kActive)
+			setSlotState(i, masterFXSlotState::kBypassed);
+	}
+
+	// --- the hold times follow the echo gaps
+	updateTailDetectors();
+}
+
+/**
+\brief Load the impulse response for the convolution slot; channel 0 is used for both sides of a mono IR.
+The IR is used at the rack's sample rate as it is, without resampling
+
+\param irChannels one pointer per IR channel
+\param numIRChannels 1 or 2
+\param irLength IR length in samples; 0 removes the IR and the slot passes the dry signal only
+\return true if the IR was loaded
+*/
+bool MasterFXRack::setImpulseResponse(const float* const* irChannels, uint32_t numIRChannels, uint32_t irLength)
+{
+	bool loaded = convolver.setImpulseResponse(irChannels, numIRChannels, irLength, 2);
+
+	// --- the echo gap of the convolution slot depends on the IR
+	updateTailDetectors();
+	return loaded;
+}
+
+/**
+\brief Set the threshold and hold time for the tail detectors; the hold time of each slot's
+detector is this hold time plus the slot's echo gap
+
+\param threshold_dB silence threshold
+\param holdTime_mSec hold time
+*/
+void MasterFXRack::setSilenceDetection(double threshold_dB, double holdTime_mSec)
+{
+	silenceThreshold_dB = threshold_dB;
+	silenceHoldTime_mSec = holdTime_mSec;
+	updateTailDetectors();
+}
+
+void MasterFXRack::updateTailDetectors()
+{
+	for (uint32_t i = 0; i < kNumMasterFXSlots; i++)
+		tailDetector[i].setParameters(silenceThreshold_dB, silenceHoldTime_mSec + getSlotTailGap_mSec(i), sampleRate);
+}
+
+void MasterFXRack::setSlotState(uint32_t slot, masterFXSlotState state)
+{
+	if (slotState[slot] == state)
+		return;
+
+	if (slotState[slot] == masterFXSlotState::kBypassed)
+		numProcessingSlots++;
+	else if (state == masterFXSlotState::kBypassed)
+		numProcessingSlots--;
+
+	slotState[slot] = state;
+}
+
+bool MasterFXRack::isDraining()
+{
+	for (uint32_t i = 0; i < kNumMasterFXSlots; i++)
+	{
+		if (slotState[i] == masterFXSlotState::kDraining)
+			return true;
+	}
+	return false;
+}
+
+/**
+\brief Longest time the output of a slot can stay silent before the input comes back as an echo
+
+\param slot the slot
+\return the gap in mSec; 0 for slots without a tail
+*/
+double MasterFXRack::getSlotTailGap_mSec(uint32_t slot)
+{
+	if (slot == kMasterFXDelay)
+		return fmax(parameters.delayParameters.leftDelay_mSec, parameters.delayParameters.rightDelay_mSec);
+
+	// --- chorus: the deepest modulation reaches 10 + 30 mSec, the flanger 0.1 + 7 mSec
+	if (slot == kMasterFXChorus)
+		return 40.0;
+
+	// --- reverb: pre-delay plus one pass through a line; the FDN feeds every line directly, so there is no serial ring to wait for
+	if (slot == kMasterFXReverb)
+	{
+		const ReverbTankParameters& reverbParameters = parameters.reverbParameters;
+		double lineDelay_mSec = 2.0*(reverbParameters.apfDelayWeight_Pct / 100.0)*reverbParameters.apfDelayMax_mSec +
+								(reverbParameters.fixeDelayWeight_Pct / 100.0)*reverbParameters.fixeDelayMax_mSec;
+		return reverbParameters.preDelayTime_mSec + lineDelay_mSec;
+	}
+
+	// --- convolution: the longest quiet stretch inside the IR
+	if (slot == kMasterFXConvolution && sampleRate > 0.0)
+		return 1000.0*convolver.getLongestQuietRun() / sampleRate;
+
+	return 0.0;
+}
+
+double MasterFXRack::getTailGap_mSec()
+{
+	double tailGap_mSec = 0.0;
+	for (uint32_t i = 0; i < kNumMasterFXSlots; i++)
+	{
+		if (parameters.enableSlot[i])
+			tailGap_mSec = fmax(tailGap_mSec, getSlotTailGap_mSec(i));
+	}
+	return tailGap_mSec;
+}
+
+void MasterFXRack::updateProcessors()
+{
+	for (uint32_t i = 0; i < 2; i++)
+		phaser[i].setParameters(parameters.phaserParameters);
+
+	// --- compressor is stereo-linked: both channels are driven by the louder one
+	LookaheadDynamicsParameters compressorParameters = compressor.getParameters();
+	compressorParameters.calculation = parameters.compressorParameters.calculation;
+	compressorParameters.threshold_dB = parameters.compressorParameters.threshold_dB;
+	compressorParameters.ratio = parameters.compressorParameters.ratio;
+	compressorParameters.kneeWidth_dB = parameters.compressorParameters.softKnee ? parameters.compressorParameters.kneeWidth_dB : 0.0;
+	compressorParameters.hardLimitGate = parameters.compressorParameters.hardLimitGate;
+	compressorParameters.attackTime_mSec = parameters.compressorParameters.attackTime_mSec;
+	compressorParameters.releaseTime_mSec = parameters.compressorParameters.releaseTime_mSec;
+	compressorParameters.outputGain_dB = parameters.compressorParameters.outputGain_dB;
+	compressor.setParameters(compressorParameters);
+
+	// --- the PeakLimiter settings: 10 dB soft knee, 5 mSec attack, 25 mSec release
+	LookaheadDynamicsParameters limiterParameters = limiter.getParameters();
+	limiterParameters.hardLimitGate = true;
+	limiterParameters.kneeWidth_dB = 10.0;
+	limiterParameters.attackTime_mSec = 5.0;
+	limiterParameters.releaseTime_mSec = 25.0;
+	limiterParameters.threshold_dB = parameters.limiterThreshold_dB;
+	limiterParameters.outputGain_dB = parameters.limiterMakeUpGain_dB;
+	limiterParameters.lookahead_mSec = parameters.limiterLookahead_mSec;
+	limiter.setParameters(limiterParameters);
+
+	chorus.setParameters(parameters.chorusParameters);
+	delay.setParameters(parameters.delayParameters);
+
+	convolutionWetGain = dB2Raw(parameters.convolutionWetLevel_dB);
+	convolutionDryGain = dB2Raw(parameters.convolutionDryLevel_dB);
+
+	reverb.setParameters(parameters.reverbParameters);
+}
+
+/**
+\brief Run one slot over a block of at most MASTER_FX_BLOCK_SIZE frames
+
+\param slot the slot to run
+\param inputL, inputR input block
+\param outputL, outputR output block; may be the input block
+\param numFrames frames to process
+*/
+void MasterFXRack::processSlot(uint32_t slot, const float* inputL, const float* inputR, float* outputL, float* outputR, uint32_t numFrames)
+{
+	switch (slot)
+	{
+		case kMasterFXPhaser:
+		{
+			for (uint32_t i = 0; i < numFrames; i++)
+			{
+				outputL[i] = (float)phaser[0].processAudioSample(inputL[i]);
+				outputR[i] = (float)phaser[1].processAudioSample(inputR[i]);
+			}
+			break;
+		}
+		case kMasterFXChorus:
+		case kMasterFXDelay:
+		case kMasterFXReverb:
+		{
+			IAudioSignalProcessor* processor = &chorus;
+			if (slot == kMasterFXDelay)
+				processor = &delay;
+			else if (slot == kMasterFXReverb)
+				processor = &reverb;
+
+			// --- the delay and chorus read and write their delay lines in bulk
+			const float* inputs[2] = { inputL, inputR };
+			float* outputs[2] = { outputL, outputR };
+			processor->processAudioBlock(inputs, outputs, 2, 2, numFrames);
+			break;
+		}
+		case kMasterFXConvolution:
+		{
+			if (!convolver.hasImpulseResponse())
+			{
+				for (uint32_t i = 0; i < numFrames; i++)
+				{
+					outputL[i] = (float)(convolutionDryGain*inputL[i]);
+					outputR[i] = (float)(convolutionDryGain*inputR[i]);
+				}
+				break;
+			}
+
+			const float* inputs[2] = { inputL, inputR };
+			float* wet[2] = { convolutionWet[0], convolutionWet[1] };
+			convolver.processAudioBlock(inputs, wet, numFrames);
+
+			for (uint32_t i = 0; i < numFrames; i++)
+			{
+				outputL[i] = (float)(convolutionDryGain*inputL[i] + convolutionWetGain*convolutionWet[0][i]);
+				outputR[i] = (float)(convolutionDryGain*inputR[i] + convolutionWetGain*convolutionWet[1][i]);
+			}
+			break;
+		}
+		case kMasterFXCompressor:
+		case kMasterFXLimiter:
+		{
+			LookaheadDynamics* dynamics = slot == kMasterFXCompressor ? &compressor : &limiter;
+			const float* inputs[2] = { inputL, inputR };
+			float* outputs[2] = { outputL, outputR };
+			dynamics->processAudioBlock(inputs, outputs, 2, numFrames);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+/**
+\brief Run the slot chain over a stereo block, in place; each slot processes the whole chunk before
+the next slot starts, and bypassed slots are not touched
+
+\param left left channel
+\param right right channel
+\param numFrames frames to process
+*/
+void MasterFXRack::processAudioBlock(float* left, float* right, uint32_t numFrames)
+{
+	while (numFrames > 0)
+	{
+		uint32_t chunkFrames = numFrames < MASTER_FX_BLOCK_SIZE ? numFrames : MASTER_FX_BLOCK_SIZE;
+
+		for (uint32_t slot = 0; slot < kNumMasterFXSlots && numProcessingSlots > 0; slot++)
+		{
+			if (slotState[slot] == masterFXSlotState::kActive)
+				processSlot(slot, left, right, left, right, chunkFrames);
+			else if (slotState[slot] == masterFXSlotState::kDraining)
+			{
+				// --- tail only: the dry signal passes, the slot's output on silence is added to it
+				processSlot(slot, silence, silence, tailBuffer[0], tailBuffer[1], chunkFrames);
+
+				bool tailIsSilent = false;
+				for (uint32_t i = 0; i < chunkFrames; i++)
+				{
+					left[i] += tailBuffer[0][i];
+					right[i] += tailBuffer[1][i];
+					tailIsSilent = tailDetector[slot].detectSilence(fmax(fabs(tailBuffer[0][i]), fabs(tailBuffer[1][i])));
+				}
+
+				if (tailIsSilent)
+					setSlotState(slot, masterFXSlotState::kBypassed);
+			}
+		}
+
+		left += chunkFrames;
+		right += chunkFrames;
+		numFrames -= chunkFrames;
+	}
+}
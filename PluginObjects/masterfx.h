@@ -0,0 +1,215 @@
+#ifndef __masterFX_h__
+#define __masterFX_h__
+
+#include "synthdefs.h"
+#include "fxobjects.h"
+#include "convolver.h"
+#include "fdnreverb.h"
+#include "lookaheaddynamics.h"
+
+// --- the rack processes at most this many frames per pass; SynthEngine::renderAudioBlock() feeds it in chunks of this size
+const uint32_t MASTER_FX_BLOCK_SIZE = 64;
+
+// --- longest echo the delay slot can hold; the delay times are clamped to this
+const double MASTER_FX_MAX_DELAY_MSEC = 2000.0;
+
+// --- the fixed slot graph: the slots always run in this order, each one either processing or skipped
+enum masterFXSlot { kMasterFXPhaser, kMasterFXChorus, kMasterFXDelay, kMasterFXReverb, kMasterFXConvolution, kMasterFXCompressor, kMasterFXLimiter, kNumMasterFXSlots };
+
+/**
+@getMasterFXSlotName
+\ingroup SynthFunctions
+\brief short name for a masterFXSlot, used by the offline tools to enable slots from the command line
+*/
+inline const char* getMasterFXSlotName(uint32_t slot)
+{
+	static const char* names[kNumMasterFXSlots] = { "phaser", "chorus", "delay", "reverb", "convolution", "compressor", "limiter" };
+	return slot < kNumMasterFXSlots ? names[slot] : "";
+}
+
+// --- slot state
+//     kBypassed:	not processed at all
+//     kActive:		processes the signal
+//     kDraining:	disabled, but still ringing; runs on silence and adds its tail to the dry signal until the tail dies out
+enum class masterFXSlotState { kBypassed, kActive, kDraining };
+
+/**
+\struct MasterFXParameters
+\ingroup SynthStructures
+\brief Parameters for the master FX rack: one enable switch per slot plus the FX-object parameters for each slot.
+The defaults are set up for a series insert chain, so every slot with a dry/wet mix passes the dry signal at unity.
+*/
+struct MasterFXParameters
+{
+	MasterFXParameters()
+	{
+		phaserParameters.lfoRate_Hz = 0.2;
+		phaserParameters.lfoDepth_Pct = 50.0;
+		phaserParameters.intensity_Pct = 50.0;
+
+		chorusParameters.algorithm = modDelaylgorithm::kChorus;
+		chorusParameters.lfoRate_Hz = 0.5;
+		chorusParameters.lfoDepth_Pct = 50.0;
+
+		delayParameters.wetLevel_dB = -12.0;
+		delayParameters.dryLevel_dB = 0.0;
+		delayParameters.feedback_Pct = 30.0;
+		delayParameters.leftDelay_mSec = 250.0;
+		delayParameters.rightDelay_mSec = 375.0;
+
+		reverbParameters.preDelayTime_mSec = 25.0;
+		reverbParameters.lpf_g = 0.3;
+		reverbParameters.kRT = 0.7;
+		reverbParameters.lowShelf_fc = 150.0;
+		reverbParameters.highShelf_fc = 4000.0;
+		reverbParameters.wetLevel_dB = -12.0;
+		reverbParameters.dryLevel_dB = 0.0;
+
+		compressorParameters.ratio = 4.0;
+		compressorParameters.threshold_dB = -12.0;
+		compressorParameters.kneeWidth_dB = 6.0;
+		compressorParameters.attackTime_mSec = 5.0;
+		compressorParameters.releaseTime_mSec = 100.0;
+	}
+
+	MasterFXParameters& operator=(const MasterFXParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		for (uint32_t i = 0; i < kNumMasterFXSlots; i++)
+			enableSlot[i] = params.enableSlot[i];
+
+		phaserParameters = params.phaserParameters;
+		chorusParameters = params.chorusParameters;
+		delayParameters = params.delayParameters;
+		reverbParameters = params.reverbParameters;
+		compressorParameters = params.compressorParameters;
+
+		convolutionWetLevel_dB = params.convolutionWetLevel_dB;
+		convolutionDryLevel_dB = params.convolutionDryLevel_dB;
+
+		limiterThreshold_dB = params.limiterThreshold_dB;
+		limiterMakeUpGain_dB = params.limiterMakeUpGain_dB;
+		limiterLookahead_mSec = params.limiterLookahead_mSec;
+
+		return *this;
+	}
+
+	// --- slot switches, indexed with masterFXSlot; all off = the rack is skipped entirely
+	bool enableSlot[kNumMasterFXSlots] = { false };
+
+	// --- FX-object parameters, one set per slot
+	PhaseShifterParameters phaserParameters;
+	ModulatedDelayParameters chorusParameters;
+	AudioDelayParameters delayParameters;			///< delay times are clamped to MASTER_FX_MAX_DELAY_MSEC
+	ReverbTankParameters reverbParameters;			///< pre-delay and the branch delay tweakers are clamped to 100 mSec
+	DynamicsProcessorParameters compressorParameters;	///< always stereo-linked; the sidechain flag is ignored
+
+	// --- convolution reverb mix; the impulse response itself is loaded with SynthEngine::setMasterFXImpulseResponse()
+	double convolutionWetLevel_dB = -12.0;
+	double convolutionDryLevel_dB = 0.0;
+
+	// --- brickwall limiter at the end of the chain
+	double limiterThreshold_dB = -1.0;
+	double limiterMakeUpGain_dB = 0.0;
+	double limiterLookahead_mSec = 0.0;			///< 0 to DYNAMICS_MAX_LOOKAHEAD_MSEC; delays the output by this much, which is not reported as plugin latency
+};
+
+/**
+\class MasterFXRack
+\ingroup SynthClasses
+\brief
+Post-voice master effects for the SynthEngine, built from the FX objects in fxobjects.h. The slot graph is fixed
+(see masterFXSlot) and every FX object is a member, so nothing is created or destroyed while audio runs; only
+reset() allocates the delay lines.
+
+Operation:
+- processAudioBlock() runs each non-bypassed slot over the whole block before moving to the next slot
+- a bypassed slot costs nothing; when no slot is processing, isProcessing() is false and the engine skips the rack
+- disabling a delay, chorus, reverb or convolution slot lets its tail ring out (kDraining) instead of cutting it; the slot
+  drops to kBypassed once the tail has been below the silence threshold for the slot's longest echo gap
+- getTailGap_mSec() tells the engine how long the output may stay quiet before an echo arrives, so it does not
+  go to sleep in the gap between two repeats
+
+Control I/F:
+Use MasterFXParameters structure via the SynthEngineParameters
+*/
+class MasterFXRack
+{
+public:
+	MasterFXRack() {}
+	~MasterFXRack() {}
+
+	// --- create the delay lines and flush all slots; this allocates, so call it from reset() only
+	bool reset(double _sampleRate);
+
+	// --- slot switches and FX-object parameters
+	void setParameters(const MasterFXParameters& _parameters);
+	MasterFXParameters getParameters() { return parameters; }
+
+	// --- load the convolution slot's impulse response (one pointer per channel, mono or stereo); this allocates
+	//     and starts the convolver's worker thread, so call it only while audio is not running
+	bool setImpulseResponse(const float* const* irChannels, uint32_t numIRChannels, uint32_t irLength);
+
+	// --- threshold and hold time for the tail detectors of the draining slots
+	void setSilenceDetection(double threshold_dB, double holdTime_mSec);
+
+	// --- process a stereo block in place; numFrames may be any size
+	void processAudioBlock(float* left, float* right, uint32_t numFrames);
+
+	// --- true if any slot is active or draining
+	bool isProcessing() { return numProcessingSlots > 0; }
+
+	// --- true if a disabled slot is still ringing out
+	bool isDraining();
+
+	// --- longest gap between the input and its first echo over the enabled slots, in mSec
+	double getTailGap_mSec();
+
+	// --- state of one slot
+	masterFXSlotState getSlotState(uint32_t slot) { return slot < kNumMasterFXSlots ? slotState[slot] : masterFXSlotState::kBypassed; }
+
+protected:
+	MasterFXParameters parameters;
+	double sampleRate = 0.0;
+
+	// --- FX objects; the mono-only processors get one per channel
+	PhaseShifter phaser[2];
+	ModulatedDelay chorus;
+	AudioDelay delay;
+	FDNReverbTank reverb;
+	LookaheadDynamics compressor;	///< stereo-linked
+	LookaheadDynamics limiter;		///< stereo-linked
+	PartitionedConvolver convolver;
+	double convolutionWetGain = 0.0;
+	double convolutionDryGain = 1.0;
+	float convolutionWet[2][MASTER_FX_BLOCK_SIZE] = { { 0.f } };	///< wet output of the convolver for one chunk
+
+	// --- slot state, and how many slots are not bypassed
+	masterFXSlotState slotState[kNumMasterFXSlots] = { masterFXSlotState::kBypassed };
+	uint32_t numProcessingSlots = 0;
+	void setSlotState(uint32_t slot, masterFXSlotState state);
+
+	// --- tail detection for draining slots
+	SilenceDetector tailDetector[kNumMasterFXSlots];
+	double silenceThreshold_dB = -96.0;
+	double silenceHoldTime_mSec = 10.0;
+	void updateTailDetectors();
+
+	// --- a slot with a tail rings on after its input stops; the others are bypassed at once
+	bool slotHasTail(uint32_t slot) { return slot == kMasterFXChorus || slot == kMasterFXDelay || slot == kMasterFXReverb || slot == kMasterFXConvolution; }
+	double getSlotTailGap_mSec(uint32_t slot);
+
+	// --- push the stored parameters to the FX objects
+	void updateProcessors();
+
+	// --- run one slot over up to MASTER_FX_BLOCK_SIZE frames; the input and output may be the same buffers
+	void processSlot(uint32_t slot, const float* inputL, const float* inputR, float* outputL, float* outputR, uint32_t numFrames);
+
+	// --- draining slots run on silence and their output is mixed into the signal
+	float silence[MASTER_FX_BLOCK_SIZE] = { 0.f };
+	float tailBuffer[2][MASTER_FX_BLOCK_SIZE] = { { 0.f } };
+};
+
+#endif /* defined(__masterFX_h__) */
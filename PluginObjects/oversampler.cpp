@@ -0,0 +1,474 @@
+#include "oversampler.h"
+
+#include <algorithm>
+
+// --- zeroth order modified Bessel function of the first kind, for the Kaiser window
+static double besselI0(double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	for (int k = 1; k < 50; k++)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		if (term < sum * 1.0e-17)
+			break;
+	}
+	return sum;
+}
+
+/**
+\brief Kaiser-windowed ideal halfband (cutoff fs/4); the side taps are the odd offsets from the center, and they are
+scaled so the DC gain is exactly 1
+
+\param _numTaps non-zero side taps: a multiple of 4, at most HALFBAND_FIR_MAX_TAPS
+\param attenuation_dB stopband attenuation for the Kaiser beta
+*/
+void HalfbandFIR::design(uint32_t _numTaps, double attenuation_dB)
+{
+	numTaps = std::min(std::max(_numTaps & ~3u, 4u), HALFBAND_FIR_MAX_TAPS);
+
+	double beta = 0.0;
+	if (attenuation_dB > 50.0)
+		beta = 0.1102*(attenuation_dB - 8.7);
+	else if (attenuation_dB > 21.0)
+		beta = 0.5842*pow(attenuation_dB - 21.0, 0.4) + 0.07886*(attenuation_dB - 21.0);
+
+	// --- tap j is at the odd offset 2j - (numTaps - 1) from the center; the window reaches zero-valued even
+	//     offsets at +/- numTaps
+	double sum = 0.0;
+	double taps[HALFBAND_FIR_MAX_TAPS] = { 0.0 };
+	for (uint32_t j = 0; j < numTaps; j++)
+	{
+		double offset = 2.0*j - (numTaps - 1.0);
+		double ratio = offset / numTaps;
+		double window = besselI0(beta*sqrt(1.0 - ratio*ratio)) / besselI0(beta);
+		taps[j] = window * sin(kPi*offset / 2.0) / (kPi*offset);
+		sum += taps[j];
+	}
+
+	// --- the side taps carry half the DC gain, the center tap (0.5) the other half
+	for (uint32_t j = 0; j < numTaps; j++)
+		coeffs[j] = (float)(0.5*taps[j] / sum);
+
+	reset();
+}
+
+void HalfbandFIR::reset()
+{
+	std::fill(history, history + 2 * HALFBAND_FIR_MAX_TAPS, 0.f);
+	std::fill(centerDelay, centerDelay + HALFBAND_FIR_MAX_TAPS / 2, 0.f);
+	historyIndex = 0;
+	centerIndex = 0;
+}
+
+/**
+\brief Write a sample at the front of the doubled history and return its dot product with the side taps
+*/
+inline float HalfbandFIR::pushAndFilter(float xn)
+{
+	historyIndex = historyIndex == 0 ? numTaps - 1 : historyIndex - 1;
+	history[historyIndex] = xn;
+	history[historyIndex + numTaps] = xn;
+
+	const float* window = &history[historyIndex];
+
+#ifdef OVERSAMPLER_SSE
+	__m128 acc = _mm_setzero_ps();
+	for (uint32_t j = 0; j < numTaps; j += 4)
+		acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(window + j), _mm_load_ps(coeffs + j)));
+
+	acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+	acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+	return _mm_cvtss_f32(acc);
+#else
+	float acc[4] = { 0.f, 0.f, 0.f, 0.f };
+	for (uint32_t j = 0; j < numTaps; j += 4)
+	{
+		for (uint32_t k = 0; k < 4; k++)
+			acc[k] += window[j + k] * coeffs[j + k];
+	}
+	return (acc[0] + acc[2]) + (acc[1] + acc[3]);
+#endif
+}
+
+/**
+\brief y[2m] = 2 * sum(g * x), y[2m+1] = x[m - numTaps/2 + 1], the center tap times the zero-stuffing gain of 2
+*/
+void HalfbandFIR::upsample(const float* input, float* output, uint32_t numFrames)
+{
+	const uint32_t centerOffset = numTaps / 2 - 1;
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		output[2 * i] = 2.f * pushAndFilter(input[i]);
+		output[2 * i + 1] = history[historyIndex + centerOffset];
+	}
+}
+
+/**
+\brief z[m] = sum(g * y[2m - 2j]) + 0.5 * y[2(m - numTaps/2) + 1]: the even samples run through the side taps,
+the odd samples are delayed to the center tap
+*/
+void HalfbandFIR::downsample(const float* input, float* output, uint32_t numFrames)
+{
+	const uint32_t centerLength = numTaps / 2;
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		float yn = pushAndFilter(input[2 * i]) + 0.5f * centerDelay[centerIndex];
+		centerDelay[centerIndex] = input[2 * i + 1];
+		centerIndex = centerIndex + 1 == centerLength ? 0 : centerIndex + 1;
+		output[i] = yn;
+	}
+}
+
+// --- sum of the theta series of the elliptic halfband design
+static double thetaNumerator(double q, int order, int c)
+{
+	double sum = 0.0;
+	double term = 0.0;
+	double sign = 1.0;
+	int i = 0;
+	do
+	{
+		term = sign * pow(q, (double)(i*(i + 1))) * sin((2 * i + 1)*c*kPi / order);
+		sum += term;
+		sign = -sign;
+		i++;
+	} while (fabs(term) > 1.0e-100 && i < 100);
+	return sum;
+}
+
+static double thetaDenominator(double q, int order, int c)
+{
+	double sum = 0.0;
+	double term = 0.0;
+	double sign = -1.0;
+	int i = 1;
+	do
+	{
+		term = sign * pow(q, (double)(i*i)) * cos(2 * i*c*kPi / order);
+		sum += term;
+		sign = -sign;
+		i++;
+	} while (fabs(term) > 1.0e-100 && i < 100);
+	return sum;
+}
+
+/**
+\brief Elliptic polyphase halfband design (after Valenzuela and Constantinides): the order follows from the
+attenuation and transition width, then each allpass coefficient from the theta-function expansion
+
+\param attenuation_dB stopband attenuation
+\param transition transition band width relative to the high sample rate
+*/
+void HalfbandIIR::design(double attenuation_dB, double transition)
+{
+	// --- elliptic modulus and nome for the transition band
+	double k = tan((1.0 - 2.0*transition)*kPi / 4.0);
+	k *= k;
+	double kRoot = pow(1.0 - k*k, 0.25);
+	double e = 0.5*(1.0 - kRoot) / (1.0 + kRoot);
+	double e4 = e*e*e*e;
+	double q = e*(1.0 + e4*(2.0 + e4*(15.0 + 150.0*e4)));
+
+	// --- odd filter order for the attenuation, then clamp to the storage
+	double attenuation = pow(10.0, -attenuation_dB / 10.0);
+	double a = attenuation / (1.0 - attenuation);
+	int order = (int)ceil(log(a*a / 16.0) / log(q));
+	order = std::max(order | 1, 3);
+	numCoeffs = std::min((uint32_t)(order - 1) / 2, HALFBAND_IIR_MAX_COEFFS);
+	order = 2 * numCoeffs + 1;
+
+	for (uint32_t i = 0; i < numCoeffs; i++)
+	{
+		int c = i + 1;
+		double ww = thetaNumerator(q, order, c)*pow(q, 0.25) / (thetaDenominator(q, order, c) + 0.5);
+		double wwSquared = ww*ww;
+		double x = sqrt((1.0 - wwSquared*k)*(1.0 - wwSquared / k)) / (1.0 + wwSquared);
+		coeffs[i] = (1.0 - x) / (1.0 + x);
+	}
+
+	reset();
+}
+
+void HalfbandIIR::reset()
+{
+	std::fill(stateX, stateX + HALFBAND_IIR_MAX_COEFFS, 0.0);
+	std::fill(stateY, stateY + HALFBAND_IIR_MAX_COEFFS, 0.0);
+}
+
+/**
+\brief One low-rate sample through both branches; section i belongs to branch i & 1 and computes
+y = c * (x - y[n-1]) + x[n-1]
+*/
+inline void HalfbandIIR::processBranches(double& branch0, double& branch1)
+{
+	uint32_t i = 0;
+	for (; i + 1 < numCoeffs; i += 2)
+	{
+		double y0 = coeffs[i] * (branch0 - stateY[i]) + stateX[i];
+		stateX[i] = branch0;
+		stateY[i] = y0;
+		branch0 = y0;
+
+		double y1 = coeffs[i + 1] * (branch1 - stateY[i + 1]) + stateX[i + 1];
+		stateX[i + 1] = branch1;
+		stateY[i + 1] = y1;
+		branch1 = y1;
+	}
+
+	if (i < numCoeffs)
+	{
+		double y0 = coeffs[i] * (branch0 - stateY[i]) + stateX[i];
+		stateX[i] = branch0;
+		stateY[i] = y0;
+		branch0 = y0;
+	}
+}
+
+void HalfbandIIR::upsample(const float* input, float* output, uint32_t numFrames)
+{
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		double branch0 = input[i];
+		double branch1 = input[i];
+		processBranches(branch0, branch1);
+		output[2 * i] = (float)branch0;
+		output[2 * i + 1] = (float)branch1;
+	}
+}
+
+void HalfbandIIR::downsample(const float* input, float* output, uint32_t numFrames)
+{
+	for (uint32_t i = 0; i < numFrames; i++)
+	{
+		double branch0 = input[2 * i + 1];
+		double branch1 = input[2 * i];
+		processBranches(branch0, branch1);
+		output[i] = (float)(0.5*(branch0 + branch1));
+	}
+}
+
+/**
+\brief Each section is (c + z^-2)/(1 + c z^-2) at the high rate, with a DC group delay of 2(1 - c)/(1 + c). A stage
+delays by the mean of its branches; the extra sample of branch 1 in the upsampler is taken back by the downsampler,
+which feeds branch 0 the later sample of each pair, so the round trip is the sum over the sections, halved for
+low-rate samples
+*/
+double HalfbandIIR::getLatency()
+{
+	double delay = 0.0;
+	for (uint32_t i = 0; i < numCoeffs; i++)
+		delay += (1.0 - coeffs[i]) / (1.0 + coeffs[i]);
+
+	return delay;
+}
+
+/**
+\brief Design every stage once; the first stage has the 0.45 fs passband, the later ones only reject images
+*/
+Oversampler::Oversampler()
+{
+	const uint32_t firTaps[OVERSAMPLER_MAX_STAGES] = { 64, 16, 12 };
+	const double iirTransition[OVERSAMPLER_MAX_STAGES] = { 0.0275, 0.125, 0.1875 };
+	const double attenuation_dB = 100.0;
+
+	for (uint32_t s = 0; s < OVERSAMPLER_MAX_STAGES; s++)
+	{
+		firUp[s].design(firTaps[s], attenuation_dB);
+		firDown[s].design(firTaps[s], attenuation_dB);
+		iirUp[s].design(attenuation_dB, iirTransition[s]);
+		iirDown[s].design(attenuation_dB, iirTransition[s]);
+	}
+}
+
+bool Oversampler::reset(double /*_sampleRate*/)
+{
+	for (uint32_t s = 0; s < OVERSAMPLER_MAX_STAGES; s++)
+	{
+		firUp[s].reset();
+		firDown[s].reset();
+		iirUp[s].reset();
+		iirDown[s].reset();
+	}
+	return true;
+}
+
+void Oversampler::setParameters(const OversamplerParameters& params)
+{
+	bool changed = params.ratio != parameters.ratio || params.filter != parameters.filter;
+	parameters = params;
+	if (changed)
+		reset(0.0);
+}
+
+/**
+\brief Stage s runs at 2^s times the base rate, so its low-rate delay counts 1 / 2^s base-rate samples
+*/
+double Oversampler::getLatencyInSamples()
+{
+	double latency = 0.0;
+	const uint32_t numStages = (uint32_t)parameters.ratio;
+	for (uint32_t s = 0; s < numStages; s++)
+	{
+		double stageLatency = parameters.filter == oversamplingFilter::kLinearPhaseFIR ? firUp[s].getLatency() : iirUp[s].getLatency();
+		latency += stageLatency / (1 << s);
+	}
+	return latency;
+}
+
+void Oversampler::upsampleBlock(const float* input, float* output, uint32_t numFrames)
+{
+	const uint32_t ratio = getRatio();
+	for (uint32_t offset = 0; offset < numFrames; offset += OVERSAMPLER_BLOCK_SIZE)
+	{
+		uint32_t chunk = std::min(OVERSAMPLER_BLOCK_SIZE, numFrames - offset);
+		upsampleChunk(input + offset, output + offset * ratio, chunk);
+	}
+}
+
+void Oversampler::downsampleBlock(const float* input, float* output, uint32_t numFrames)
+{
+	const uint32_t ratio = getRatio();
+	for (uint32_t offset = 0; offset < numFrames; offset += OVERSAMPLER_BLOCK_SIZE)
+	{
+		uint32_t chunk = std::min(OVERSAMPLER_BLOCK_SIZE, numFrames - offset);
+		downsampleChunk(input + offset * ratio, output + offset, chunk);
+	}
+}
+
+/**
+\brief Stages from the base rate up; the last stage writes the output, the others alternate between the stage buffers
+*/
+void Oversampler::upsampleChunk(const float* input, float* output, uint32_t numFrames)
+{
+	const uint32_t numStages = (uint32_t)parameters.ratio;
+	if (numStages == 0)
+	{
+		std::copy(input, input + numFrames, output);
+		return;
+	}
+
+	const float* source = input;
+	for (uint32_t s = 0; s < numStages; s++)
+	{
+		float* destination = s == numStages - 1 ? output : stageBuffer[s & 1];
+		if (parameters.filter == oversamplingFilter::kLinearPhaseFIR)
+			firUp[s].upsample(source, destination, numFrames << s);
+		else
+			iirUp[s].upsample(source, destination, numFrames << s);
+		source = destination;
+	}
+}
+
+/**
+\brief Stages from the highest rate down; the base-rate stage writes the output
+*/
+void Oversampler::downsampleChunk(const float* input, float* output, uint32_t numFrames)
+{
+	const uint32_t numStages = (uint32_t)parameters.ratio;
+	if (numStages == 0)
+	{
+		std::copy(input, input + numFrames, output);
+		return;
+	}
+
+	const float* source = input;
+	for (int s = numStages - 1; s >= 0; s--)
+	{
+		float* destination = s == 0 ? output : stageBuffer[s & 1];
+		if (parameters.filter == oversamplingFilter::kLinearPhaseFIR)
+			firDown[s].downsample(source, destination, numFrames << s);
+		else
+			iirDown[s].downsample(source, destination, numFrames << s);
+		source = destination;
+	}
+}
+
+/**
+\brief Flush the oversamplers and reset the hosted processor at the oversampled rate
+
+\param _sampleRate the base sample rate
+*/
+bool OversampledProcessor::reset(double _sampleRate)
+{
+	sampleRate = _sampleRate;
+	oversamplers[0].reset(_sampleRate);
+	oversamplers[1].reset(_sampleRate);
+
+	if (!processor)
+		return false;
+
+	return processor->reset(_sampleRate * oversamplers[0].getRatio());
+}
+
+void OversampledProcessor::setParameters(const OversamplerParameters& params)
+{
+	bool ratioChanged = params.ratio != oversamplers[0].getParameters().ratio;
+	oversamplers[0].setParameters(params);
+	oversamplers[1].setParameters(params);
+
+	if (ratioChanged && processor && sampleRate > 0.0)
+		processor->reset(sampleRate * oversamplers[0].getRatio());
+}
+
+double OversampledProcessor::processAudioSample(double xn)
+{
+	float input = (float)xn;
+	float output = 0.f;
+	const float* inputs[1] = { &input };
+	float* outputs[1] = { &output };
+	processAudioBlock(inputs, outputs, 1, 1, 1);
+	return output;
+}
+
+bool OversampledProcessor::processAudioFrame(const float* inputFrame, float* outputFrame, uint32_t inputChannels, uint32_t outputChannels)
+{
+	const float* inputs[2] = { &inputFrame[0], inputChannels > 1 ? &inputFrame[1] : &inputFrame[0] };
+	float* outputs[2] = { &outputFrame[0], outputChannels > 1 ? &outputFrame[1] : &outputFrame[0] };
+	return processAudioBlock(inputs, outputs, std::min(inputChannels, 2u), std::min(outputChannels, 2u), 1);
+}
+
+/**
+\brief Upsample each channel into the oversampled buffers, run the hosted processor in place on them and
+downsample into the outputs, OVERSAMPLER_BLOCK_SIZE frames at a time
+
+\param inputs one pointer per input channel
+\param outputs one pointer per output channel; may be the same buffers as the inputs
+\param inputChannels input channel count
+\param outputChannels output channel count
+\param numFrames frames to process
+*/
+bool OversampledProcessor::processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t inputChannels, uint32_t outputChannels, uint32_t numFrames)
+{
+	if (!processor || inputChannels == 0 || outputChannels == 0)
+		return false;
+
+	// --- frame processors get both channels, the others only the first
+	uint32_t channels = 1;
+	if (processor->canProcessAudioFrame())
+		channels = std::min(std::min(inputChannels, outputChannels), 2u);
+
+	const uint32_t ratio = oversamplers[0].getRatio();
+	float* oversampled[2] = { oversampledBuffer[0], oversampledBuffer[1] };
+
+	for (uint32_t offset = 0; offset < numFrames; offset += OVERSAMPLER_BLOCK_SIZE)
+	{
+		uint32_t chunk = std::min(OVERSAMPLER_BLOCK_SIZE, numFrames - offset);
+
+		for (uint32_t c = 0; c < channels; c++)
+			oversamplers[c].upsampleBlock(inputs[c] + offset, oversampled[c], chunk);
+
+		if (!processor->processAudioBlock(oversampled, oversampled, channels, channels, chunk * ratio))
+			return false;
+
+		for (uint32_t c = 0; c < channels; c++)
+			oversamplers[c].downsampleBlock(oversampled[c], outputs[c] + offset, chunk);
+
+		// --- the remaining outputs get the first channel
+		for (uint32_t c = channels; c < outputChannels; c++)
+			std::copy(outputs[0] + offset, outputs[0] + offset + chunk, outputs[c] + offset);
+	}
+
+	return true;
+}
@@ -0,0 +1,298 @@
+#ifndef __oversampler_h__
+#define __oversampler_h__
+
+#include "fxobjects.h"
+
+// --- 4-wide SSE for the FIR dot products; other targets use the scalar loop, which the compiler can still vectorize
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#include <xmmintrin.h>
+#define OVERSAMPLER_SSE 1
+#endif
+
+/**
+\enum oversamplingRatio
+\ingroup Constants-Enums
+\brief
+Use this strongly typed enum to set the Oversampler ratio; each step is one more 2x halfband stage.
+
+- enum class oversamplingRatio { k1x, k2x, k4x, k8x };
+*/
+enum class oversamplingRatio { k1x, k2x, k4x, k8x };
+
+/**
+\enum oversamplingFilter
+\ingroup Constants-Enums
+\brief
+Use this strongly typed enum to choose the halfband filters of the Oversampler.
+
+- kLinearPhaseFIR: Kaiser-windowed halfband FIRs; flat phase, about 70 samples of round trip latency at 4x
+- kHalfbandIIR: polyphase allpass (elliptic) halfbands; a few samples of low-frequency delay, non-linear phase
+
+- enum class oversamplingFilter { kLinearPhaseFIR, kHalfbandIIR };
+*/
+enum class oversamplingFilter { kLinearPhaseFIR, kHalfbandIIR };
+
+// --- one 2x stage per doubling
+const uint32_t OVERSAMPLER_MAX_STAGES = 3;
+const uint32_t OVERSAMPLER_MAX_RATIO = 1 << OVERSAMPLER_MAX_STAGES;
+
+// --- base-rate frames per internal chunk; the blocks passed in may be any size
+const uint32_t OVERSAMPLER_BLOCK_SIZE = 64;
+
+// --- longest FIR polyphase branch and longest allpass chain of any stage
+const uint32_t HALFBAND_FIR_MAX_TAPS = 64;
+const uint32_t HALFBAND_IIR_MAX_COEFFS = 12;
+
+/**
+@countForOversamplingRatio
+\ingroup FX-Functions
+
+@brief returns the oversampling ratio as a numeric value
+
+\param ratio - enum class ratio value
+\return 1, 2, 4 or 8
+*/
+inline uint32_t countForOversamplingRatio(oversamplingRatio ratio)
+{
+	return 1u << (uint32_t)ratio;
+}
+
+/**
+\struct OversamplerParameters
+\ingroup SynthClasses
+\brief
+Custom parameter structure for the Oversampler and OversampledProcessor objects.
+*/
+struct OversamplerParameters
+{
+	OversamplerParameters() {}
+
+	/** all FXObjects parameter objects require overloaded= operator so remember to add new entries if you add new variables. */
+	OversamplerParameters& operator=(const OversamplerParameters& params)	// need this override for collections to work
+	{
+		if (this == &params)
+			return *this;
+
+		ratio = params.ratio;
+		filter = params.filter;
+		return *this;
+	}
+
+	// --- individual parameters
+	oversamplingRatio ratio = oversamplingRatio::k2x;					///< 1x, 2x, 4x or 8x
+	oversamplingFilter filter = oversamplingFilter::kLinearPhaseFIR;	///< FIR or IIR halfbands
+};
+
+/**
+\class HalfbandFIR
+\ingroup SynthClasses
+\brief
+One 2x stage of Kaiser-windowed halfband FIR, in polyphase form. Every other tap of a halfband is zero except
+the center one (0.5), so one branch is a pure delay and the other a dot product over the non-zero taps, which
+runs four taps at a time with SSE over a doubled (mirrored) history so the window never wraps.
+
+An instance runs in one direction only: either upsample() or downsample().
+
+Latency: the up/down round trip is numTaps - 1 samples at the low rate.
+*/
+class HalfbandFIR
+{
+public:
+	HalfbandFIR() {}
+	~HalfbandFIR() {}
+
+	/** design the filter; numTaps is the number of non-zero side taps (a multiple of 4, at most HALFBAND_FIR_MAX_TAPS) */
+	void design(uint32_t _numTaps, double attenuation_dB);
+
+	/** clear the history */
+	void reset();
+
+	/** numFrames low-rate samples in, 2 * numFrames out */
+	void upsample(const float* input, float* output, uint32_t numFrames);
+
+	/** 2 * numFrames high-rate samples in, numFrames out */
+	void downsample(const float* input, float* output, uint32_t numFrames);
+
+	/** round trip delay in low-rate samples */
+	uint32_t getLatency() { return numTaps - 1; }
+
+protected:
+	uint32_t numTaps = 0;									///< non-zero side taps
+	alignas(16) float coeffs[HALFBAND_FIR_MAX_TAPS] = { 0.f };	///< the non-zero side taps, newest sample first
+
+	// --- history for the dot product, written twice so the window [index, index + numTaps) is contiguous
+	float history[2 * HALFBAND_FIR_MAX_TAPS] = { 0.f };
+	uint32_t historyIndex = 0;
+
+	// --- downsampler only: the odd samples feed the center tap numTaps / 2 pairs later
+	float centerDelay[HALFBAND_FIR_MAX_TAPS / 2] = { 0.f };
+	uint32_t centerIndex = 0;
+
+	// --- push one sample into the history and return the dot product with the taps
+	inline float pushAndFilter(float xn);
+};
+
+/**
+\class HalfbandIIR
+\ingroup SynthClasses
+\brief
+One 2x stage of polyphase allpass halfband IIR: H(z) = 0.5 * [A0(z^2) + z^-1 A1(z^2)] with the two branches
+made of first-order allpass sections in z^2, whose coefficients come from the elliptic halfband design for the
+requested stopband attenuation and transition width. Each branch runs at the low rate, so a stage costs one
+multiply per coefficient per low-rate sample.
+
+An instance runs in one direction only: either upsample() or downsample().
+*/
+class HalfbandIIR
+{
+public:
+	HalfbandIIR() {}
+	~HalfbandIIR() {}
+
+	/** design the filter; transition is the transition band width relative to the high sample rate (0 to 0.5) */
+	void design(double attenuation_dB, double transition);
+
+	/** clear the allpass states */
+	void reset();
+
+	/** numFrames low-rate samples in, 2 * numFrames out */
+	void upsample(const float* input, float* output, uint32_t numFrames);
+
+	/** 2 * numFrames high-rate samples in, numFrames out */
+	void downsample(const float* input, float* output, uint32_t numFrames);
+
+	/** round trip group delay at DC, in low-rate samples */
+	double getLatency();
+
+protected:
+	uint32_t numCoeffs = 0;
+	double coeffs[HALFBAND_IIR_MAX_COEFFS] = { 0.0 };		///< even indexes in branch 0, odd indexes in branch 1
+	double stateX[HALFBAND_IIR_MAX_COEFFS] = { 0.0 };		///< previous input of each section
+	double stateY[HALFBAND_IIR_MAX_COEFFS] = { 0.0 };		///< previous output of each section
+
+	// --- run both branches on one sample each
+	inline void processBranches(double& branch0, double& branch1);
+};
+
+/**
+\class Oversampler
+\ingroup SynthClasses
+\brief
+Block-based 2x/4x/8x up and down sampling for one channel, as a cascade of 2x halfband stages. The first stage has
+the steep filter (it sets the passband, about 0.45 fs); the later stages only have to reject images of an already
+band-limited signal, so they are short.
+
+All stages are designed in the constructor and use fixed storage; reset() and setParameters() only flush, so
+both are safe on the audio thread (MoogFilter flushes its voice state while audio runs).
+
+Typical use, per block:
+- upsampleBlock(input, buffer, numFrames): buffer holds getRatio() * numFrames samples
+- run the nonlinear stage on buffer at getRatio() times the sample rate
+- downsampleBlock(buffer, output, numFrames)
+
+Control I/F:
+- Use OversamplerParameters structure to get/set object params
+*/
+class Oversampler
+{
+public:
+	Oversampler();
+	~Oversampler() {}
+
+	/** flush the stages; the filters do not depend on the sample rate */
+	bool reset(double _sampleRate);
+
+	/** get parameters */
+	OversamplerParameters getParameters() { return parameters; }
+
+	/** set parameters; changing the ratio or filter flushes the stages */
+	void setParameters(const OversamplerParameters& params);
+
+	/** 1, 2, 4 or 8 */
+	uint32_t getRatio() { return countForOversamplingRatio(parameters.ratio); }
+
+	/** the up/down round trip delay in base-rate samples; the IIR value is the group delay at DC */
+	double getLatencyInSamples();
+
+	/** numFrames base-rate samples in, getRatio() * numFrames out; the buffers may not overlap */
+	void upsampleBlock(const float* input, float* output, uint32_t numFrames);
+
+	/** getRatio() * numFrames samples in, numFrames base-rate samples out; the buffers may not overlap */
+	void downsampleBlock(const float* input, float* output, uint32_t numFrames);
+
+protected:
+	OversamplerParameters parameters;
+
+	// --- stage s runs between 2^s and 2^(s+1) times the base rate; separate state for each direction
+	HalfbandFIR firUp[OVERSAMPLER_MAX_STAGES];
+	HalfbandFIR firDown[OVERSAMPLER_MAX_STAGES];
+	HalfbandIIR iirUp[OVERSAMPLER_MAX_STAGES];
+	HalfbandIIR iirDown[OVERSAMPLER_MAX_STAGES];
+
+	// --- ping-pong buffers between the stages of one chunk
+	float stageBuffer[2][OVERSAMPLER_BLOCK_SIZE * OVERSAMPLER_MAX_RATIO / 2] = { { 0.f } };
+
+	// --- up or down sample one chunk of at most OVERSAMPLER_BLOCK_SIZE base-rate frames
+	void upsampleChunk(const float* input, float* output, uint32_t numFrames);
+	void downsampleChunk(const float* input, float* output, uint32_t numFrames);
+};
+
+/**
+\class OversampledProcessor
+\ingroup SynthClasses
+\brief
+Hosts any IAudioSignalProcessor at 2x/4x/8x the sample rate, so nonlinear stages (TriodeClassA, ClassATubePre,
+BitCrusher, ...) alias less without each one rolling its own resampler.
+
+Operation:
+- reset() resets the hosted processor at getRatio() times the sample rate
+- each block is upsampled, run through the hosted processor's processAudioBlock() and downsampled
+- objects that can process frames get up to two channels; the others get channel 0 and their output goes to
+  every output channel, so use one OversampledProcessor per channel for mono objects, as the master FX rack does
+
+Control I/F:
+- Use OversamplerParameters structure to get/set object params; changing the ratio resets the hosted processor
+  at the new rate, which is not real-time safe for processors whose reset() allocates
+*/
+class OversampledProcessor : public IAudioSignalProcessor
+{
+public:
+	OversampledProcessor(std::shared_ptr<IAudioSignalProcessor> _processor) : processor(_processor) {}
+	~OversampledProcessor() {}
+
+	/** flush the oversamplers and reset the hosted processor at the oversampled rate */
+	virtual bool reset(double _sampleRate);
+
+	/** process one sample through the oversampled processor */
+	virtual double processAudioSample(double xn);
+
+	/** return true if the hosted processor can process frames */
+	virtual bool canProcessAudioFrame() { return processor && processor->canProcessAudioFrame(); }
+
+	/** process one frame */
+	virtual bool processAudioFrame(const float* inputFrame, float* outputFrame, uint32_t inputChannels, uint32_t outputChannels);
+
+	/** process a block of non-interleaved audio; the inputs and outputs may be the same buffers */
+	virtual bool processAudioBlock(const float* const* inputs, float* const* outputs, uint32_t inputChannels, uint32_t outputChannels, uint32_t numFrames);
+
+	/** get parameters */
+	OversamplerParameters getParameters() { return oversamplers[0].getParameters(); }
+
+	/** set parameters */
+	void setParameters(const OversamplerParameters& params);
+
+	/** the hosted processor, to set its own parameters */
+	std::shared_ptr<IAudioSignalProcessor> getProcessor() { return processor; }
+
+	/** the up/down round trip delay in base-rate samples */
+	double getLatencyInSamples() { return oversamplers[0].getLatencyInSamples(); }
+
+protected:
+	std::shared_ptr<IAudioSignalProcessor> processor = nullptr;
+	double sampleRate = 0.0;
+
+	Oversampler oversamplers[2];	///< 0 = left; 1 = right
+	float oversampledBuffer[2][OVERSAMPLER_BLOCK_SIZE * OVERSAMPLER_MAX_RATIO] = { { 0.f } };
+};
+
+#endif /* defined(__oversampler_h__) */
@@ -95,6 +95,8 @@ bool SynthVoice::initialize(PluginInfo pluginInfo)
 // --- ISynthComponent
 bool SynthVoice::reset(double _sampleRate)
 {
+	sampleRate = _sampleRate;
+
 	// --- clear output array
 	synthOutputData.clear();
 
@@ -119,6 +121,12 @@ bool SynthVoice::reset(double _sampleRate)
 	updateGranularity = 64; ///< update every 128 render-cycles
 	granularityCounter = -1;
 
+	// --- voice is idle after a reset; the engine rebuilds its allocation lists to match
+	voiceIsRunning = false;
+	stealPending = false;
+	stealNoteOffPending = false;
+	voiceNoteState = voiceState::kNoteOffState;
+
 	/// Clear modulator output arrays
 	lfo1Output.clear();
 	lfo2Output.clear();
@@ -181,22 +189,29 @@ const SynthRenderData SynthVoice::renderAudioOutput()
 	// --- run the granularity counter
 	bool updateAllModRoutings = needsComponentUpdate();
 
+	// --- component timings; no-op unless the engine's monitor is at perfDetail::kComponent
+	PerfLapTimer lapTimer(perfMonitor);
+
 	// --- update/render (add more here)
 	lfo1->update(updateAllModRoutings);
 	lfo1Output = lfo1->renderModulatorOutput();
 
 	lfo2->update(updateAllModRoutings);
 	lfo2Output = lfo2->renderModulatorOutput();
+	lapTimer.lap(kPerfLFO);
 	
 	// --- update/render (add more here)
 	ampEG->update(updateAllModRoutings);
 	ampEGOutput = ampEG->renderModulatorOutput();
+	lapTimer.lap(kPerfEG);
 
 	// --- FILTER **MOOG**	
 	moogFilter->update(updateAllModRoutings);
+	lapTimer.lap(kPerfFilter);
 
 	// --- do all mods	
 	runModulationMatrix(updateAllModRoutings);
+	lapTimer.lap(kPerfModMatrix);
 
 	// --- update modulate-ees (add more here)
 	osc1->update(updateAllModRoutings);
@@ -204,8 +219,6 @@ const SynthRenderData SynthVoice::renderAudioOutput()
 	osc3->update(updateAllModRoutings);
 	osc4->update(updateAllModRoutings);
 
-	dca->update(updateAllModRoutings);
-
 	// --- render Oscillators (add more here)
 	osc1Output = osc1->renderAudioOutput();
 	osc2Output = osc2->renderAudioOutput();
@@ -219,6 +232,8 @@ const SynthRenderData SynthVoice::renderAudioOutput()
 		+ parameters->vectorJSData.vectorB * osc2Output.outputs[0]
 		+ parameters->vectorJSData.vectorC * osc3Output.outputs[0]
 		+ parameters->vectorJSData.vectorD * osc4Output.outputs[0];
+	lapTimer.lap(kPerfOscillator);
+
 	// --- do the filtering
 	// add more here
 
@@ -231,13 +246,30 @@ const SynthRenderData SynthVoice::renderAudioOutput()
 	// **MOOG**
 	// --- run through filter
 	moogFilter->processSynthAudio(&audioData);
+	lapTimer.lap(kPerfFilter);
 
 	// --- inline, copy MONO output back to input
 	audioData.inputs[0] = audioData.outputs[0];
 	audioData.numOutputChannels = 2;// stereo out
 
-	// --- dca will make stereo and pan
+	// --- dca will make stereo and pan; its modulation inputs were set by the matrix above
+	dca->update(updateAllModRoutings);
 	dca->processSynthAudio(&audioData);
+	lapTimer.lap(kPerfDCA);
+
+	// --- released note whose tail is now inaudible: stop it early, no need to wait for the EG to reach kOff;
+	//     the amp EG level counts too, so a momentarily silent output (a square LFO on the DCA, a slow
+	//     wavetable attack, a zero crossing stretch of a sync/FM patch) cannot cut a release that is still loud
+	if (voiceIsRunning && !stealPending && voiceNoteState == voiceState::kNoteOffState)
+	{
+		double outputPeak = fmax(fabs(audioData.outputs[0]), fabs(audioData.outputs[1]));
+		if (silenceDetector.detectSilence(fmax(outputPeak, ampEG->getEnvelopeOutput())))
+		{
+			ampEG->reset(sampleRate);
+			voiceIsRunning = false;
+			flushVoiceState();
+		}
+	}
 
 	// --- check for note off condition
 	if (voiceIsRunning)
@@ -256,11 +288,19 @@ const SynthRenderData SynthVoice::renderAudioOutput()
 				// --- turn on the new note
 				doNoteOn(voiceMIDIEvent);
 
+				// --- the new note was already released while we were shutting down
+				if (stealNoteOffPending)
+					doNoteOff(voiceMIDIEvent);
+
 				// --- stealing accomplished!
 				stealPending = false;
+				stealNoteOffPending = false;
 			}
 			else
+			{
 				voiceIsRunning = false;
+				flushVoiceState();
+			}
 		}
 	}
 
@@ -309,6 +349,10 @@ bool SynthVoice::doNoteOn(midiEvent& event)
 	// --- needed forLFO  modes
 	lfo1->doNoteOn(midiPitch, event.midiData1, event.midiData2);
 
+	// --- a voice starting from idle picks up a changed NLP switch; a running voice (legato, steal) keeps its
+	//     ladder rate until it next goes idle
+	if (!voiceIsRunning)
+		moogFilter->applyNLPSwitch();
 	moogFilter->doNoteOn(midiPitch, event.midiData1, event.midiData2);
 
 	// --- set the flag
@@ -334,20 +378,48 @@ bool SynthVoice::doNoteOff(midiEvent& event)
 	return true;
 }
 
+/**
+\brief Stop the voice immediately with no release or shutdown ramp; the caller is responsible for any de-clicking
+*/
+void SynthVoice::silenceVoice()
+{
+	ampEG->reset(sampleRate);
+
+	voiceIsRunning = false;
+	stealPending = false;
+	stealNoteOffPending = false;
+	voiceNoteState = voiceState::kNoteOffState;
+
+	flushVoiceState();
+}
+
+/**
+\brief Clear the filter state of a voice that has stopped so that a ringing/self-oscillating filter
+does not keep its energy (or decay into denormals) while the voice is idle, and arm the silence detector for the next note
+*/
+void SynthVoice::flushVoiceState()
+{
+	// **MOOG**
+	moogFilter->reset(sampleRate);
+
+	silenceDetector.reset();
+}
+
 bool SynthVoice::processMIDIEvent(midiEvent& event)
 {
 	// --- the voice only needs to process note on and off
 	//     Other MIDI info such as CC can be found in global midi table via our midiData interface
 	if (event.midiMessage == NOTE_ON)
 	{
-		// --- clear timestamp
-		clearTimestamp();
+		// --- fresh note, restart the silence hold time
+		silenceDetector.reset();
 
 		// --- detect if we are being stolen:
 		if (isVoiceActive())
 		{
 			// --- save information
 			voiceStealMIDIEvent = event;
+			stealNoteOffPending = false;
 
 			// --- set amp EG into shutdown mode
 			ampEG->shutdown();
@@ -362,6 +434,14 @@ bool SynthVoice::processMIDIEvent(midiEvent& event)
 	}
 	else if (event.midiMessage == NOTE_OFF)
 	{
+		// --- note-off for a note that has not started yet (we are still shutting down the stolen one);
+		//     flag it so the new note is released as soon as it starts instead of hanging
+		if (stealPending)
+		{
+			stealNoteOffPending = true;
+			return true;
+		}
+
 		// --- call the subfunction
 		doNoteOff(event);
 	}
@@ -432,7 +512,26 @@ SynthEngine::SynthEngine()
 
 		// --- pass safe pointer to voices to share the common matrix core
 		synthVoices[i]->setModMatrixPtrs(parameters.modSourceData, parameters.modDestinationData);
+		synthVoices[i]->setPerfMonitor(&perfMonitor);
+		synthVoices[i]->setVoiceIndex(i);
+	}
+
+	// --- ghost voices are identical, they just live outside of the allocation lists
+	for (unsigned int i = 0; i < NUM_GHOST_VOICES; i++)
+	{
+		ghostVoices[i].reset(new SynthVoice(midiInputData, midiOutputData, parameters.voiceParameters, waveTableData));
+		ghostVoices[i]->setModMatrixPtrs(parameters.modSourceData, parameters.modDestinationData);
+		ghostVoices[i]->setPerfMonitor(&perfMonitor);
+		ghostVoices[i]->setVoiceIndex(MAX_VOICES + i);
 	}
+
+	// --- all voices start out free, no notes mapped
+	clearVoiceAllocation();
+
+	// --- debug builds log note and steal events, as the old TRACE output did
+#if defined(_DEBUG) && defined(_WIN32)
+	traceLog.setLevel(traceLevel::kInfo);
+#endif
 }
 
 /**
@@ -454,8 +553,24 @@ bool SynthEngine::reset(double _sampleRate)
 		synthVoices[i]->reset(_sampleRate); // this calls reset() on the smart-pointers underlying naked pointer
 	}
 
+	for (unsigned int i = 0; i < NUM_GHOST_VOICES; i++)
+	{
+		ghostVoices[i]->reset(_sampleRate);
+		ghostFaders[i].reset();
+		ghostFading[i] = false;
+	}
+	sampleRate = _sampleRate;
+
 	// --- create FX
-	// add more here
+	masterFX.reset(_sampleRate);
+
+	// --- silence detectors are sample-rate based
+	updateSilenceDetection();
+	engineSleeping = false;
+
+	// --- voices are all idle now
+	clearVoiceAllocation();
+	perfMonitor.reset(_sampleRate);
 
 	return true;
 }
@@ -497,6 +612,9 @@ bool SynthEngine::initialize(PluginInfo pluginInfo)
 
 	}
 
+	for (unsigned int i = 0; i < NUM_GHOST_VOICES; i++)
+		ghostVoices[i]->initialize(pluginInfo);
+
 	return true;
 }
 
@@ -511,6 +629,39 @@ bool SynthEngine::initialize(PluginInfo pluginInfo)
 //}
 
 const SynthRenderData SynthEngine::renderAudioOutput()
+{
+	acquireParameters();
+
+	// --- asleep: nothing is sounding and the output has already decayed; skip all rendering
+	if (engineSleeping)
+	{
+		synthOutputData.clear();
+		synthOutputData.channelCount = 2;
+		return synthOutputData;
+	}
+
+	renderVoiceMix();
+
+	// --- master FX, one frame at a time here; renderAudioBlock() runs them on whole chunks
+	if (masterFX.isProcessing())
+	{
+		float left = (float)synthOutputData.synthOutputs[LEFT_CHANNEL];
+		float right = (float)synthOutputData.synthOutputs[RIGHT_CHANNEL];
+		masterFX.processAudioBlock(&left, &right, 1);
+		synthOutputData.synthOutputs[LEFT_CHANNEL] = left;
+		synthOutputData.synthOutputs[RIGHT_CHANNEL] = right;
+	}
+
+	finishOutputSample();
+
+	// --- note that this is const, and therefore read-only
+	return synthOutputData;
+}
+
+/**
+\brief Render the active and ghost voices and sum them into synthOutputData, before the master volume
+*/
+void SynthEngine::renderVoiceMix()
 {
 	// --- clear accumumlators
 	synthOutputData.clear();
@@ -523,9 +674,19 @@ const SynthRenderData SynthEngine::renderAudioOutput()
 	if (parameters.mode == synthMode::kUnison)
 		gainFactor = 0.125;
 
-	// --- loop through voices and render/accumulate them
-	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	// --- note-ons from here on belong to the next sample; voices started before it may be stolen again
+	renderPassCount++;
+
+	// --- per-voice timing, if the monitor wants it
+	bool timingVoices = perfMonitor.isTimingVoices();
+
+	// --- loop through the active voices only and render/accumulate them
+	int i = activeVoices.getOldest();
+	while (i >= 0)
 	{
+		// --- grab the link first; the voice may retire below
+		int nextVoice = activeVoices.getNewer(i);
+
 		// --- blend active voices
 		if (synthVoices[i]->isVoiceActive())
 		{
@@ -533,14 +694,54 @@ const SynthRenderData SynthEngine::renderAudioOutput()
 			voiceRender.clear();
 
 			// --- render the voice
+			uint64_t voiceStartTicks = timingVoices ? readPerfTicks() : 0;
 			voiceRender = synthVoices[i]->renderAudioOutput();
+			if (timingVoices)
+				perfMonitor.addVoiceTicks(i, readPerfTicks() - voiceStartTicks);
 
 			// --- accumulate results
 			synthOutputData.synthOutputs[LEFT_CHANNEL] += gainFactor *  voiceRender.synthOutputs[0];
 			synthOutputData.synthOutputs[RIGHT_CHANNEL] += gainFactor * voiceRender.synthOutputs[1];
 		}
+
+		// --- EG expired: move voice back to the free list and drop its note mapping
+		if (!synthVoices[i]->isVoiceActive())
+			retireVoice(i);
+
+		i = nextVoice;
 	}
 
+	// --- fade out the ghost voices holding stolen notes
+	for (unsigned int g = 0; g < NUM_GHOST_VOICES; g++)
+	{
+		if (!ghostFading[g])
+			continue;
+
+		voiceRender = ghostVoices[g]->renderAudioOutput();
+
+		// --- crossfade FROM the stolen note TO silence
+		double gain = 0.0;
+		bool fading = ghostFaders[g].crossfade(XFadeType::kConstantPower, 1.0, 0.0, gain);
+
+		synthOutputData.synthOutputs[LEFT_CHANNEL] += gainFactor * gain * voiceRender.synthOutputs[0];
+		synthOutputData.synthOutputs[RIGHT_CHANNEL] += gainFactor * gain * voiceRender.synthOutputs[1];
+
+		// --- done: park the ghost for the next steal
+		if (!fading || !ghostVoices[g]->isVoiceActive())
+		{
+			ghostVoices[g]->silenceVoice();
+			ghostFaders[g].reset();
+			ghostFading[g] = false;
+		}
+	}
+}
+
+/**
+\brief Apply the master volume to synthOutputData and put the engine to sleep once the voices
+are idle, the FX tails are gone and the output has been quiet for the hold time
+*/
+void SynthEngine::finishOutputSample()
+{
 	// --- apply master volume
 	//     globalMIDIData[kMIDIMasterVolume] = 0 -> 16383
 	//	   mapping to -60dB(0.001) to +12dB(4.0)
@@ -550,8 +751,65 @@ const SynthRenderData SynthEngine::renderAudioOutput()
 	synthOutputData.synthOutputs[LEFT_CHANNEL] *= masterVol;
 	synthOutputData.synthOutputs[RIGHT_CHANNEL] *= masterVol;
 
-	// --- note that this is const, and therefore read-only
-	return synthOutputData;
+	// --- go to sleep once nothing is left sounding; the next note-on wakes us up
+	bool voicesIdle = activeVoices.getCount() == 0;
+	for (unsigned int g = 0; g < NUM_GHOST_VOICES; g++)
+		voicesIdle = voicesIdle && !ghostFading[g];
+
+	// --- a switched-off FX slot that is still ringing keeps us awake too
+	voicesIdle = voicesIdle && !masterFX.isDraining();
+
+	if (voicesIdle)
+		engineSleeping = engineSilenceDetector.detectSilence(fmax(fabs(synthOutputData.synthOutputs[LEFT_CHANNEL]), fabs(synthOutputData.synthOutputs[RIGHT_CHANNEL])));
+	else
+		engineSilenceDetector.reset();
+}
+
+/**
+\brief Load the impulse response for the master FX convolution slot. The IR's quiet stretches can
+hold the output silent for a while, so the silence detection is updated to ride them out
+
+\param irChannels one pointer per IR channel
+\param numIRChannels 1 (mono) or 2 (stereo)
+\param irLength IR length in samples, at the engine sample rate
+\return true if the IR was loaded
+*/
+bool SynthEngine::setMasterFXImpulseResponse(const float* const* irChannels, uint32_t numIRChannels, uint32_t irLength)
+{
+	bool loaded = masterFX.setImpulseResponse(irChannels, numIRChannels, irLength);
+	updateSilenceDetection();
+	return loaded;
+}
+
+/**
+\brief Set the master FX rack parameters; a change in the rack's echo gaps re-arms the silence detectors
+
+\param masterFXParameters the new rack parameters
+*/
+void SynthEngine::setMasterFXParameters(const MasterFXParameters& masterFXParameters)
+{
+	// --- the FX echo gaps stretch the engine's hold time
+	double tailGap_mSec = masterFX.getTailGap_mSec();
+	masterFX.setParameters(masterFXParameters);
+
+	if (tailGap_mSec != masterFX.getTailGap_mSec())
+		updateSilenceDetection();
+}
+
+/**
+\brief Push the silence threshold and hold time to the engine and voice detectors
+*/
+void SynthEngine::updateSilenceDetection()
+{
+	// --- the engine output may go quiet between two FX echoes; hold on for the longest gap as well
+	engineSilenceDetector.setParameters(parameters.silenceThreshold_dB, parameters.silenceHoldTime_mSec + masterFX.getTailGap_mSec(), sampleRate);
+	masterFX.setSilenceDetection(parameters.silenceThreshold_dB, parameters.silenceHoldTime_mSec);
+
+	for (unsigned int i = 0; i < MAX_VOICES; i++)
+		synthVoices[i]->setSilenceDetection(parameters.silenceThreshold_dB, parameters.silenceHoldTime_mSec);
+
+	for (unsigned int i = 0; i < NUM_GHOST_VOICES; i++)
+		ghostVoices[i]->setSilenceDetection(parameters.silenceThreshold_dB, parameters.silenceHoldTime_mSec);
 }
 
 
@@ -566,8 +824,15 @@ MIDI CC information is placed in the shared CC array.
 */
 bool SynthEngine::processMIDIEvent(midiEvent& event)
 {
+	// --- a note-on must see the mode and steal settings published before it
+	acquireParameters();
+
 	if (parameters.enableMIDINoteEvents && event.midiMessage == NOTE_ON)
 	{
+		// --- wake up
+		engineSleeping = false;
+		engineSilenceDetector.reset();
+
 		// --- set current MIDI data
 		midiInputData->globalMIDIData[kCurrentMIDINoteNumber] = event.midiData1;
 		midiInputData->globalMIDIData[kCurrentMIDINoteVelocity] = event.midiData2;
@@ -575,51 +840,75 @@ bool SynthEngine::processMIDIEvent(midiEvent& event)
 		// --- stash the last midi note in the event's aux data member!
 		event.auxUintData1 = midiInputData->globalMIDIData[kLastMIDINoteNumber];
 
-		TRACE("-- Note On Ch:%d Note:%d Vel:%d \n", event.midiChannel, event.midiData1, event.midiData2);
-		TRACE("-- LAST Note On Note:%d \n", event.auxUintData1);
+		traceLog.record(traceLevel::kInfo, "-- Note On Ch:%d Note:%d Vel:%d \n", event.midiChannel, event.midiData1, event.midiData2);
+		traceLog.record(traceLevel::kVerbose, "-- LAST Note On Note:%d \n", event.auxUintData1);
 
 		// --- mono mode
 		if (parameters.mode == synthMode::kMono)
 		{
 			// --- just use voice 0 and do the note EG variables will handle the rest
 			synthVoices[0]->processMIDIEvent(event);
+			claimVoice(0);
 		}
 		else if (parameters.mode == synthMode::kPoly)
 		{
+			uint32_t midiChannel = event.midiChannel & 0x0F;
+			uint32_t midiNoteNumber = event.midiData1 & 0x7F;
+
+			// --- same note re-struck on this channel before its note-off: release the old voice
+			//     first, otherwise it loses its map entry and can never receive a note-off
+			int heldVoiceIndex = noteVoiceMap[midiChannel][midiNoteNumber];
+			if (heldVoiceIndex >= 0)
+			{
+				midiEvent noteOffEvent = event;
+				noteOffEvent.midiMessage = NOTE_OFF;
+				synthVoices[heldVoiceIndex]->processMIDIEvent(noteOffEvent);
+				unmapVoiceNote(heldVoiceIndex);
+			}
+
 			// --- get index of the next available voice (for note on events)
 			int voiceIndex = getFreeVoiceIndex();
 
 			if (voiceIndex < 0)
 			{
 				voiceIndex = getVoiceIndexToSteal();
-				TRACE("-- Note On STEALING -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
+				if (voiceIndex >= 0)
+					perfMonitor.countVoiceSteal();
+				traceLog.record(traceLevel::kInfo, "-- Note On STEALING -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
 			}
 
 			// --- trigger next available note
 			if (voiceIndex >= 0)
 			{
+				// --- a stolen voice gives up its old note; note-offs for it are now ignored
+				unmapVoiceNote(voiceIndex);
+
+				// --- fast steal: old note moves to a ghost, slot is idle again and starts the note right now
+				if (parameters.stealMode == voiceStealMode::kCrossfade && synthVoices[voiceIndex]->isVoiceActive())
+					startGhostFade(voiceIndex);
+
 				synthVoices[voiceIndex]->processMIDIEvent(event);
-				TRACE("-- Note On -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
-			}
-			else // --- steal voice
-				TRACE("-- DID NOT getFreeVoiceIndex index:%d \n", voiceIndex);
+				traceLog.record(traceLevel::kInfo, "-- Note On -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
 
-			// --- increment all timestamps for note-on voices
-			for (int i = 0; i < MAX_VOICES; i++)
-			{
-				if (synthVoices[i]->isVoiceActive())
-					synthVoices[i]->incrementTimestamp();
+				// --- voice becomes the newest; this replaces the old timestamp increment loop
+				claimVoice(voiceIndex);
+				mapVoiceNote(voiceIndex, midiChannel, midiNoteNumber);
 			}
+			else // --- steal voice
+				traceLog.record(traceLevel::kWarning, "-- DID NOT getFreeVoiceIndex index:%d \n", voiceIndex);
 		}
 		else if (parameters.mode == synthMode::kUnison)
 		{
 			// --- UNISON mode is heavily dependent on the manufacturer's 
 			//     implementation and decision
 			//     for the synth core, we will use 3 voices detuned as: -parameters.unisonDetune_Cents, 0, +parameters.unisonDetune_Cents
-			synthVoices[0]->processMIDIEvent(event);
-			synthVoices[1]->processMIDIEvent(event);
-			synthVoices[2]->processMIDIEvent(event);
-			synthVoices[3]->processMIDIEvent(event);
+			// --- up to 4 unison voices, fewer if the engine is built with less
+			for (unsigned int i = 0; i < 4 && i < MAX_VOICES; i++)
+				synthVoices[i]->processMIDIEvent(event);
+
+			// --- keep the allocation lists in range
+			for (unsigned int i = 0; i < 4 && i < MAX_VOICES; i++)
+				claimVoice(i);
 		}
 
 		// --- need to store these for things like portamento
@@ -629,7 +918,7 @@ bool SynthEngine::processMIDIEvent(midiEvent& event)
 	}
 	else if (parameters.enableMIDINoteEvents && event.midiMessage == NOTE_OFF)
 	{
-		TRACE("-- Note Off Ch:%d Note:%d Vel:%d \n", event.midiChannel, event.midiData1, event.midiData2);
+		traceLog.record(traceLevel::kInfo, "-- Note Off Ch:%d Note:%d Vel:%d \n", event.midiChannel, event.midiData1, event.midiData2);
 
 		// --- for mono, we only use one voice, number [0]
 		if (parameters.mode == synthMode::kMono)
@@ -642,34 +931,29 @@ bool SynthEngine::processMIDIEvent(midiEvent& event)
 		}
 		else if (parameters.mode == synthMode::kPoly)
 		{
-			// --- find the note with this MIDI number (this implies that note numbers and voices are exclusive to each other)
-			int voiceIndex = getActiveVoiceIndexInNoteOn(event.midiData1);
-			
-			if (voiceIndex < 0)
-			{
-				voiceIndex = getStealingVoiceIndexInNoteOn(event.midiData1);
-				if (voiceIndex >= 0)
-					TRACE("-- Note OFF on STEAL-PENDING -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
-			}
+			// --- one lookup finds the voice playing this note, or the voice that is stealing for it
+			int voiceIndex = noteVoiceMap[event.midiChannel & 0x0F][event.midiData1 & 0x7F];
 
 			if (voiceIndex >= 0)
 			{
+				if (synthVoices[voiceIndex]->voiceIsStealing())
+					traceLog.record(traceLevel::kInfo, "-- Note OFF on STEAL-PENDING -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
+
 				synthVoices[voiceIndex]->processMIDIEvent(event);
-				TRACE("-- Note Off -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
+				unmapVoiceNote(voiceIndex);
+				traceLog.record(traceLevel::kInfo, "-- Note Off -> Voice:%d Note:%d Vel:%d \n", voiceIndex, event.midiData1, event.midiData2);
 			}
-			else
-				TRACE("-- DID NOT FOUND NOTE OFF index:%d \n", voiceIndex);
-			// --- this is very bad - it means we probably have a stuck note... :\
+			else // --- harmless: the note was stolen or has already retired
+				traceLog.record(traceLevel::kInfo, "-- DID NOT FOUND NOTE OFF index:%d \n", voiceIndex);
 
 			return true;
 		}
 		else if (parameters.mode == synthMode::kUnison)
 		{
 			// --- this will get complicated with voice stealing.
-			synthVoices[0]->processMIDIEvent(event);
-			synthVoices[1]->processMIDIEvent(event);
-			synthVoices[2]->processMIDIEvent(event);
-			synthVoices[3]->processMIDIEvent(event);
+			// --- up to 4 unison voices, fewer if the engine is built with less
+			for (unsigned int i = 0; i < 4 && i < MAX_VOICES; i++)
+				synthVoices[i]->processMIDIEvent(event);
 
 			return true;
 		}
@@ -679,14 +963,14 @@ bool SynthEngine::processMIDIEvent(midiEvent& event)
 		// --- store the data in our arrays; sub-components have access to all data via safe IMIDIData pointer
 		if (event.midiMessage == PITCH_BEND)
 		{
-			TRACE("-- Pitch Bend Ch:%d LSB:%d MSB:%d \n", event.midiChannel, event.midiData1, event.midiData2);
+			traceLog.record(traceLevel::kVerbose, "-- Pitch Bend Ch:%d LSB:%d MSB:%d \n", event.midiChannel, event.midiData1, event.midiData2);
 
 			midiInputData->globalMIDIData[kMIDIPitchBendDataLSB] = event.midiData1;
 			midiInputData->globalMIDIData[kMIDIPitchBendDataMSB] = event.midiData2;
 		}
 		if (event.midiMessage == CONTROL_CHANGE)
 		{
-			TRACE("-- MIDI CC Ch:%d CC:%d Value:%d \n", event.midiChannel, event.midiData1, event.midiData2);
+			traceLog.record(traceLevel::kVerbose, "-- MIDI CC Ch:%d CC:%d Value:%d \n", event.midiChannel, event.midiData1, event.midiData2);
 
 			// --- store CC event in globally shared array
 			midiInputData->ccMIDIData[event.midiData1] = event.midiData2;
@@ -719,9 +1003,16 @@ SynthEngineParameters SynthEngine::getParameters()
 
 void SynthEngine::setParameters(const SynthEngineParameters& _parameters)
 {
+	// --- only re-arm the silence detectors if their settings change
+	bool silenceChanged = parameters.silenceThreshold_dB != _parameters.silenceThreshold_dB ||
+		parameters.silenceHoldTime_mSec != _parameters.silenceHoldTime_mSec;
+
 	// --- store parameters
 	parameters = _parameters;
 
+	if (silenceChanged)
+		updateSilenceDetection();
+
 	// --- master volume maps to MIDI RPN see http://www.somascape.org/midi/tech/spec.html#usx7F0401
 	double masterVolumeRaw = dB2Raw(parameters.masterVolume_dB);
 	boundValue(masterVolumeRaw, 0.001, 4.0);
@@ -762,6 +1053,14 @@ void SynthEngine::setParameters(const SynthEngineParameters& _parameters)
 	// --- map -8192 -> 8191 to MIDI 14-bit
 	bipolarIntToMIDI14_bit(mtFine, -8192, 8191, midiInputData->globalMIDIData[kMIDIMasterTuneFineLSB], midiInputData->globalMIDIData[kMIDIMasterTuneFineMSB]);
 
+	// --- no per-voice detune/pan outside of unison; set these even when no voice is running
+	//     because setParameters() is no longer called on every buffer
+	if (parameters.mode != synthMode::kUnison)
+	{
+		parameters.voiceParameters->voiceUnisonDetune_Cents = 0.0;
+		parameters.voiceParameters->dcaParameters->panValue = 0.0;
+	}
+
 	// --- now trickle down the voice parameters
 	for (unsigned int i = 0; i < MAX_VOICES; i++)
 	{
@@ -801,86 +1100,217 @@ void SynthEngine::setParameters(const SynthEngineParameters& _parameters)
 	}
 }
 
-// --- find the first free voice
+// --- find the longest-idle free voice; O(1)
 int SynthEngine::getFreeVoiceIndex()
 {
-	for (unsigned int i = 0; i < MAX_VOICES; i++)
-	{
-		// --- return index of first free voice we find
-		if (!synthVoices[i]->isVoiceActive())
-			return i;
-	}
-
-	// --- didn't find any
-	return -1;
+	// --- -1 if there are none left
+	return freeVoices.getOldest();
 }
 
+/**
+\brief Pick the voice to steal for the stealPolicy. The candidates are found from the live voice states on every call,
+so each note-on of a chord that lands on one sample sees the voices the previous steals left; at most MAX_VOICES voices
+are walked, and only when every voice is busy.
+*/
 int SynthEngine::getVoiceIndexToSteal()
 {
-	// --- find oldest note
-	int index = -1;
-	int maxTime = 0;
-	int lowPitch = 120;
-	int maxTimeIndex = 0;
-	int secondLongestTime = 0;
-	int secondLongestIndex = 0;
-	int lowPitchIndex = 0;
-
-	// --- add your heuristic code here to return the index of the voice to steal
-	for (int i = 0; i < MAX_VOICES; i++) {
-		if (synthVoices[i]->getTimestamp() > maxTime) {
-			maxTime = synthVoices[i]->getTimestamp();
-			maxTimeIndex = i;
-		}
-	}
+	int oldestVoice = -1;			// --- oldest candidate
+	int nextOldestVoice = -1;		// --- second-oldest candidate
+	int quietestVoice = -1;			// --- candidate with the lowest amp EG level
+	int lowestPitchVoice = -1;		// --- candidate holding the lowest note
+	int oldestReleasedVoice = -1;	// --- oldest candidate past its note-off
+	double quietestLevel = 0.0;
+	unsigned int lowestPitch = kNumMIDINotes;
+
+	// --- the walk is oldest-first, so the first candidate of each kind is also the oldest of that kind
+	for (int i = activeVoices.getOldest(); i >= 0; i = activeVoices.getNewer(i))
+	{
+		if (!isStealCandidate(i))
+			continue;
+
+		if (oldestVoice < 0)
+			oldestVoice = i;
+		else if (nextOldestVoice < 0)
+			nextOldestVoice = i;
 
-	for (int i = 0; i < MAX_VOICES; i++) {
-		if (synthVoices[i]->getTimestamp() < maxTime && synthVoices[i]->getTimestamp() > secondLongestTime) {
-			secondLongestTime = synthVoices[i]->getTimestamp();
-			secondLongestIndex = i;
+		double level = synthVoices[i]->getAmpEGLevel();
+		if (quietestVoice < 0 || level < quietestLevel)
+		{
+			quietestLevel = level;
+			quietestVoice = i;
 		}
-	}
 
-	for (int i = 0; i < MAX_VOICES; i++) {
-		if (synthVoices[i]->getMIDINoteNumber() < lowPitch) {
-			lowPitch = synthVoices[i]->getMIDINoteNumber();
-			lowPitchIndex = i;
+		if (synthVoices[i]->getMIDINoteNumber() < lowestPitch)
+		{
+			lowestPitch = synthVoices[i]->getMIDINoteNumber();
+			lowestPitchVoice = i;
 		}
+
+		if (oldestReleasedVoice < 0 && synthVoices[i]->getVoiceState() == voiceState::kNoteOffState)
+			oldestReleasedVoice = i;
 	}
 
-	if (maxTimeIndex = lowPitchIndex)
-		index = secondLongestIndex;
-	else
-		index = maxTimeIndex;
+	// --- every voice is being stolen or was started on this sample: fall back to the oldest note
+	if (oldestVoice < 0)
+		return activeVoices.getOldest();
 
+	int index = oldestVoice;
+	switch (parameters.stealPolicy)
+	{
+		case voiceStealPolicy::kQuietest:
+		{
+			index = quietestVoice;
+			break;
+		}
+		case voiceStealPolicy::kProtectLowestPitch:
+		{
+			// --- keep the bass note; take the next oldest instead, if there is one
+			if (index == lowestPitchVoice && nextOldestVoice >= 0)
+				index = nextOldestVoice;
+			break;
+		}
+		case voiceStealPolicy::kReleaseFirst:
+		{
+			if (oldestReleasedVoice >= 0)
+				index = oldestReleasedVoice;
+			break;
+		}
+		case voiceStealPolicy::kOldest:
+		default:
+			break;
+	}
 
-	// --- index should always be >= 0
 	return index;
 }
 
+/**
+\brief Swap a sounding voice with an idle ghost voice and start fading the ghost out; the voice slot is left idle
+so that its next note-on starts immediately instead of waiting for the EG shutdown
 
-int SynthEngine::getActiveVoiceIndexInNoteOn(unsigned int midiNoteNumber)
+\return true if a ghost was free, false if the caller must fall back to the EG shutdown steal
+*/
+bool SynthEngine::startGhostFade(int voiceIndex)
 {
-	for (unsigned int i = 0; i < MAX_VOICES; i++)
+	// --- a voice that is already shutting down for a steal finishes that steal normally
+	if (synthVoices[voiceIndex]->voiceIsStealing())
+		return false;
+
+	for (unsigned int g = 0; g < NUM_GHOST_VOICES; g++)
 	{
-		if (synthVoices[i]->isVoiceActive() &&
-			synthVoices[i]->getVoiceState() == voiceState::kNoteOnState &&
-			synthVoices[i]->getMIDINoteNumber() == midiNoteNumber)
-			return i;
+		if (ghostFading[g])
+			continue;
+
+		// --- swap the objects, not the indexes: the allocation lists and note map stay valid; the noise
+		//     streams are indexed by slot, so they swap back and each slot keeps its own sequence
+		std::swap(synthVoices[voiceIndex], ghostVoices[g]);
+		synthVoices[voiceIndex]->swapNoiseState(*ghostVoices[g]);
+		synthVoices[voiceIndex]->silenceVoice();
+
+		double xfadeTime_mSec = fmax(1.0, fmin(5.0, parameters.stealXFadeTime_mSec));
+		ghostFaders[g].setXFadeTime(xfadeTime_mSec*sampleRate / 1000.0);
+		ghostFaders[g].reset();
+		ghostFading[g] = true;
+		return true;
 	}
+
+	// --- all ghosts busy
+	return false;
+}
+
+/**
+\brief A sounding voice may be stolen unless it is already being stolen or its note started on this sample
+*/
+bool SynthEngine::isStealCandidate(int voiceIndex)
+{
+	return !synthVoices[voiceIndex]->voiceIsStealing() && voiceStartPass[voiceIndex] != renderPassCount;
+}
+
+int SynthEngine::getActiveVoiceIndexInNoteOn(unsigned int midiNoteNumber, unsigned int midiChannel)
+{
+	int voiceIndex = noteVoiceMap[midiChannel & 0x0F][midiNoteNumber & 0x7F];
+
+	if (voiceIndex >= 0 &&
+		synthVoices[voiceIndex]->getVoiceState() == voiceState::kNoteOnState &&
+		!synthVoices[voiceIndex]->voiceIsStealing())
+		return voiceIndex;
+
 	return -1;
 }
 
-int SynthEngine::getStealingVoiceIndexInNoteOn(unsigned int midiNoteNumber)
+int SynthEngine::getStealingVoiceIndexInNoteOn(unsigned int midiNoteNumber, unsigned int midiChannel)
+{
+	int voiceIndex = noteVoiceMap[midiChannel & 0x0F][midiNoteNumber & 0x7F];
+
+	if (voiceIndex >= 0 && synthVoices[voiceIndex]->voiceIsStealing())
+		return voiceIndex;
+
+	return -1;
+}
+
+/**
+\brief Put every voice on the free list and clear the note-to-voice map; called at construction and reset
+*/
+void SynthEngine::clearVoiceAllocation()
 {
+	activeVoices.clear();
+	freeVoices.clear();
+
 	for (unsigned int i = 0; i < MAX_VOICES; i++)
 	{
-		if (synthVoices[i]->isVoiceActive() &&
-			synthVoices[i]->getVoiceState() == voiceState::kNoteOnState &&
-			synthVoices[i]->voiceIsStealing() && 
-			synthVoices[i]->getStealMIDINoteNumber() == midiNoteNumber)
-			return i;
+		freeVoices.pushNewest(i);
+		voiceMappedNote[i] = -1;
 	}
-	return -1;
+
+	for (unsigned int channel = 0; channel < kNumMIDIChannels; channel++)
+	{
+		for (unsigned int note = 0; note < kNumMIDINotes; note++)
+			noteVoiceMap[channel][note] = -1;
+	}
+}
+
+/**
+\brief Move a voice that was just given a note-on to the newest end of the active list
+*/
+void SynthEngine::claimVoice(int voiceIndex)
+{
+	freeVoices.remove(voiceIndex);
+	activeVoices.pushNewest(voiceIndex);
+	voiceStartPass[voiceIndex] = renderPassCount;
+	perfMonitor.setActiveVoices(activeVoices.getCount());
+}
+
+/**
+\brief Return a voice whose EG has expired to the free list
+*/
+void SynthEngine::retireVoice(int voiceIndex)
+{
+	unmapVoiceNote(voiceIndex);
+	activeVoices.remove(voiceIndex);
+	freeVoices.pushNewest(voiceIndex);
+	perfMonitor.setActiveVoices(activeVoices.getCount());
+}
+
+/**
+\brief Record that a voice is now sounding (or stealing for) a channel/note pair
+*/
+void SynthEngine::mapVoiceNote(int voiceIndex, uint32_t midiChannel, uint32_t midiNoteNumber)
+{
+	noteVoiceMap[midiChannel][midiNoteNumber] = voiceIndex;
+	voiceMappedNote[voiceIndex] = midiChannel*kNumMIDINotes + midiNoteNumber;
 }
 
+/**
+\brief Remove a voice's note from the map, if the map still points at this voice
+*/
+void SynthEngine::unmapVoiceNote(int voiceIndex)
+{
+	int mappedNote = voiceMappedNote[voiceIndex];
+	if (mappedNote < 0)
+		return;
+
+	int& mapEntry = noteVoiceMap[mappedNote / kNumMIDINotes][mappedNote % kNumMIDINotes];
+	if (mapEntry == voiceIndex)
+		mapEntry = -1;
+
+	voiceMappedNote[voiceIndex] = -1;
+}
@@ -10,6 +10,9 @@
 #include "vafilters.h"
 #include "synthlfo.h"
 #include "dca_eg.h"
+#include "synthperf.h"
+#include "masterfx.h"
+#include "trace.h"
 
 #include <array>
 
@@ -212,7 +215,7 @@ struct ModDestination
 	uint32_t channelEnable[MAX_MODULATION_CHANNELS] = { 0 };
 	double channelIntensity[MAX_MODULATION_CHANNELS] = { 0.0 };	
 	
-	bool channelHardwire[MAX_MODULATION_CHANNELS] = { 0.0 };
+	bool channelHardwire[MAX_MODULATION_CHANNELS] = { false };
 	double hardwireIntensity[MAX_MODULATION_CHANNELS] = { 1.0 };
 
 	// --- use separate intensities for each channel
@@ -269,11 +272,6 @@ public:
 	// --- voice state
 	voiceState getVoiceState() { return voiceNoteState; }
 	
-	// --- timestamps for determining note age; public because containing object needs to manipulate them
-	unsigned int getTimestamp() { return timestamp; }	///< get current timestamp, the higher the value, the older the voice has been running
-	void incrementTimestamp() { timestamp++; }			///< increment timestamp when a new note is triggered
-	void clearTimestamp() { timestamp = 0; }			///< reset timestamp after voice is turned off
-
 	unsigned int getMIDINoteNumber() { return voiceMIDIEvent.midiData1; } // note is data byte 1, velocity is byte 2
 	unsigned int getStealMIDINoteNumber() { return voiceStealMIDIEvent.midiData1; } // note is data byte 1, velocity is byte 2
 	
@@ -287,10 +285,46 @@ public:
 
 	bool voiceIsStealing() { return stealPending; }
 
+	// --- current amp EG level, used by the engine to find the quietest voice to steal
+	double getAmpEGLevel() { return ampEG ? ampEG->getEnvelopeOutput() : 0.0; }
+
+	// --- hard stop: EG back to zero/off, voice idle; used when a ghost voice finishes its fade
+	void silenceVoice();
+
+	// --- released voices retire early once their output and amp EG level both stay below the threshold
+	void setSilenceDetection(double threshold_dB, double holdTime_mSec)
+	{
+		silenceDetector.setParameters(threshold_dB, holdTime_mSec, sampleRate);
+	}
+
+	// --- engine's instrumentation; the voice charges its component timings here
+	void setPerfMonitor(SynthPerfMonitor* _perfMonitor) { perfMonitor = _perfMonitor; }
+
+	// --- unique index of this voice in the engine; gives each of its LFOs its own noise stream
+	void setVoiceIndex(uint32_t voiceIndex)
+	{
+		lfo1->setNoiseStream(2 * voiceIndex);
+		lfo2->setNoiseStream(2 * voiceIndex + 1);
+	}
+
+	// --- exchange the slot-indexed noise state with another voice, after the engine swaps the two objects
+	void swapNoiseState(SynthVoice& other)
+	{
+		lfo1->swapNoiseState(*other.lfo1);
+		lfo2->swapNoiseState(*other.lfo2);
+	}
+
 protected:
 	// --- parameters
 	std::shared_ptr<SynthVoiceParameters> parameters = nullptr;
 
+	// --- needed to reset the EG in silenceVoice()
+	double sampleRate = 0.0;
+
+	// --- early retirement for inaudible release tails; filter state is flushed on retirement
+	SilenceDetector silenceDetector;
+	void flushVoiceState();
+
 	// --- interface pointer
 	const std::shared_ptr<MidiInputData> midiInputData = nullptr;
 	const std::shared_ptr<MidiOutputData> midiOutputData = nullptr;
@@ -370,6 +404,7 @@ protected:
 
 	// --- for voice stealing
 	bool stealPending = false;
+	bool stealNoteOffPending = false;	///< note-off arrived for the stealing note before it could start; release it as soon as it does
 	midiEvent voiceStealMIDIEvent;
 
 	// --- smart pointers to the oscillator objects
@@ -399,12 +434,12 @@ protected:
 	// --- DCA(s)
 	std::unique_ptr<DCA> dca;
 
+	// --- instrumentation, owned by the engine
+	SynthPerfMonitor* perfMonitor = nullptr;
+
 	// --- output data structure
 	SynthRenderData synthOutputData;
 
-	// --- voice timestamp, for knowing the age of a voice
-	unsigned int timestamp = 0;						///<voice timestamp, for knowing the age of a voice
-
 	// --- granularity counter
 	uint32_t updateGranularity = 1;					///< number of sample invervals to wait between component updates
 	int granularityCounter = -1;					///< the counter for gramular updating; -1 = update NOW
@@ -432,9 +467,102 @@ protected:
 	}
 };
 
+/**
+\struct VoiceAgeList
+\ingroup SynthStructures
+\brief Intrusive doubly-linked list of voice indexes ordered from oldest to newest. The links are fixed arrays indexed by
+voice number, so the voices themselves are the nodes: insert, remove and oldest/newest lookups are all O(1) and never allocate.
+*/
+struct VoiceAgeList
+{
+	VoiceAgeList() { clear(); }
+
+	// --- empty the list
+	void clear()
+	{
+		for (unsigned int i = 0; i < MAX_VOICES; i++)
+		{
+			older[i] = -1;
+			newer[i] = -1;
+			linked[i] = false;
+		}
+		oldest = -1;
+		newest = -1;
+		count = 0;
+	}
+
+	// --- link a voice as the newest entry; a voice that is already linked is moved to the newest slot
+	void pushNewest(int voiceIndex)
+	{
+		if (linked[voiceIndex])
+			remove(voiceIndex);
+
+		older[voiceIndex] = newest;
+		newer[voiceIndex] = -1;
+
+		if (newest >= 0)
+			newer[newest] = voiceIndex;
+		else
+			oldest = voiceIndex;
+
+		newest = voiceIndex;
+		linked[voiceIndex] = true;
+		count++;
+	}
+
+	// --- unlink a voice from anywhere in the list
+	void remove(int voiceIndex)
+	{
+		if (!linked[voiceIndex])
+			return;
+
+		if (older[voiceIndex] >= 0)
+			newer[older[voiceIndex]] = newer[voiceIndex];
+		else
+			oldest = newer[voiceIndex];
+
+		if (newer[voiceIndex] >= 0)
+			older[newer[voiceIndex]] = older[voiceIndex];
+		else
+			newest = older[voiceIndex];
+
+		older[voiceIndex] = -1;
+		newer[voiceIndex] = -1;
+		linked[voiceIndex] = false;
+		count--;
+	}
+
+	bool contains(int voiceIndex) { return linked[voiceIndex]; }	///< true if voice is in this list
+	int getOldest() { return oldest; }								///< oldest voice, or -1 if empty
+	int getNewest() { return newest; }								///< newest voice, or -1 if empty
+	int getNewer(int voiceIndex) { return newer[voiceIndex]; }		///< next-newest voice, or -1 at the end of the list
+	int getOlder(int voiceIndex) { return older[voiceIndex]; }		///< next-oldest voice, or -1 at the start of the list
+	uint32_t getCount() { return count; }							///< number of linked voices
+
+protected:
+	int older[MAX_VOICES];		///< link towards the oldest voice
+	int newer[MAX_VOICES];		///< link towards the newest voice
+	bool linked[MAX_VOICES];	///< membership flag for O(1) contains()
+	int oldest = -1;
+	int newest = -1;
+	uint32_t count = 0;
+};
+
 // --- engine mode: poly, mono or unison
 enum class synthMode { kPoly, kMono, kUnison };
 
+// --- voice stealing policy for poly mode:
+//     kOldest			- steal the oldest note
+//     kQuietest		- steal the voice with the lowest amp EG level (least audible steal)
+//     kProtectLowestPitch	- steal the oldest note unless it is the bass note, then the next oldest
+//     kReleaseFirst	- steal the oldest voice already in its release phase, else the oldest note
+enum class voiceStealPolicy { kOldest, kQuietest, kProtectLowestPitch, kReleaseFirst };
+
+// --- how a stolen voice hands over to the new note:
+//     kShutdownEG	- ramp the amp EG down over its shutdown time, then start the new note in the same voice
+//     kCrossfade	- move the old note to a ghost voice that fades out, start the new note immediately
+enum class voiceStealMode { kShutdownEG, kCrossfade };
+
 
 
 /**
@@ -455,6 +583,11 @@ struct SynthEngineParameters
 
 		enableMIDINoteEvents = params.enableMIDINoteEvents;
 		mode = params.mode;
+		stealPolicy = params.stealPolicy;
+		stealMode = params.stealMode;
+		stealXFadeTime_mSec = params.stealXFadeTime_mSec;
+		silenceThreshold_dB = params.silenceThreshold_dB;
+		silenceHoldTime_mSec = params.silenceHoldTime_mSec;
 		masterVolume_dB = params.masterVolume_dB;
 		masterPitchBendSensCoarse = params.masterPitchBendSensCoarse;
 		masterPitchBendSensFine = params.masterPitchBendSensFine;
@@ -480,6 +613,16 @@ struct SynthEngineParameters
 	// --- global synth mode
 	synthMode mode = synthMode::kMono;// kPoly;
 
+	// --- how a voice is chosen when all voices are busy
+	voiceStealPolicy stealPolicy = voiceStealPolicy::kProtectLowestPitch;
+	voiceStealMode stealMode = voiceStealMode::kShutdownEG;
+	double stealXFadeTime_mSec = 2.0;	///< ghost voice fade-out time for voiceStealMode::kCrossfade, clamped to [1, 5] mSec
+
+	// --- silence detection: released voices retire, and the idle engine sleeps, once the
+	//     output peak (and a voice's amp EG level) stays below the threshold for the hold time
+	double silenceThreshold_dB = -96.0;
+	double silenceHoldTime_mSec = 10.0;
+
 	// --- global master volume control, controls each output DCA's master volume
 	double masterVolume_dB = 0.0;
 
@@ -533,9 +676,9 @@ struct SynthEngineParameters
 		modDestinationData->at(destination).masterIntensity = intensity;
 	}
 
-	void setMM_DestDefaultValue(uint32_t destination, double default)
+	void setMM_DestDefaultValue(uint32_t destination, double defaultValue)
 	{
-		modDestinationData->at(destination).defautValue = default;
+		modDestinationData->at(destination).defautValue = defaultValue;
 	}
 
 	void setMM_DestHighPriority(uint32_t destination, bool _priorityModulation)
@@ -582,20 +725,108 @@ public:
 	virtual bool processMIDIEvent(midiEvent& event);
 	virtual bool initialize(PluginInfo pluginInfo);
 
+	// --- render a block straight into non-interleaved channel buffers of float or double samples
+	//     rightOutput may be nullptr for mono; a sleeping engine just clears the block
+	template <typename T>
+	void renderAudioBlock(T* leftOutput, T* rightOutput, uint32_t numFrames)
+	{
+		acquireParameters();
+
+		if (engineSleeping)
+		{
+			memset(leftOutput, 0, numFrames * sizeof(T));
+			if (rightOutput)
+				memset(rightOutput, 0, numFrames * sizeof(T));
+			return;
+		}
+
+		if (!masterFX.isProcessing())
+		{
+			for (uint32_t i = 0; i < numFrames; i++)
+			{
+				const SynthRenderData render = renderAudioOutput();
+				leftOutput[i] = (T)render.synthOutputs[LEFT_CHANNEL];
+				if (rightOutput)
+					rightOutput[i] = (T)render.synthOutputs[RIGHT_CHANNEL];
+			}
+			return;
+		}
+
+		// --- master FX: render the voice mix a chunk at a time, run the rack over the chunk, then apply the master volume
+		uint32_t frame = 0;
+		while (frame < numFrames)
+		{
+			if (engineSleeping)
+			{
+				memset(leftOutput + frame, 0, (numFrames - frame) * sizeof(T));
+				if (rightOutput)
+					memset(rightOutput + frame, 0, (numFrames - frame) * sizeof(T));
+				return;
+			}
+
+			uint32_t chunkFrames = numFrames - frame < MASTER_FX_BLOCK_SIZE ? numFrames - frame : MASTER_FX_BLOCK_SIZE;
+			for (uint32_t i = 0; i < chunkFrames; i++)
+			{
+				renderVoiceMix();
+				masterFXBlock[LEFT_CHANNEL][i] = (float)synthOutputData.synthOutputs[LEFT_CHANNEL];
+				masterFXBlock[RIGHT_CHANNEL][i] = (float)synthOutputData.synthOutputs[RIGHT_CHANNEL];
+			}
+
+			masterFX.processAudioBlock(masterFXBlock[LEFT_CHANNEL], masterFXBlock[RIGHT_CHANNEL], chunkFrames);
+
+			for (uint32_t i = 0; i < chunkFrames; i++)
+			{
+				// --- fell asleep part way through the chunk: the rest is silence, as it is in renderAudioOutput()
+				if (engineSleeping)
+					synthOutputData.clear();
+				else
+				{
+					synthOutputData.synthOutputs[LEFT_CHANNEL] = masterFXBlock[LEFT_CHANNEL][i];
+					synthOutputData.synthOutputs[RIGHT_CHANNEL] = masterFXBlock[RIGHT_CHANNEL][i];
+					finishOutputSample();
+				}
+
+				leftOutput[frame + i] = (T)synthOutputData.synthOutputs[LEFT_CHANNEL];
+				if (rightOutput)
+					rightOutput[frame + i] = (T)synthOutputData.synthOutputs[RIGHT_CHANNEL];
+			}
+			frame += chunkFrames;
+		}
+	}
+
 	// --- get parameters
 	SynthEngineParameters getParameters();
 
 	// --- set parameters
 	void setParameters(const SynthEngineParameters& _parameters);
+
+	// --- hand a complete parameter block to the render side (one writer thread at a time); it is applied
+	//     whole by the next render or MIDI call, so the engine never runs on a half-written block
+	void publishParameters(const SynthEngineParameters& _parameters) { parameterExchange.publish(_parameters); }
+
+	// --- post-voice FX rack, between the voice sum and the master volume; all slots off by default
+	//     kept apart from setParameters() so the rack is only re-cooked when one of its settings changes
+	void setMasterFXParameters(const MasterFXParameters& masterFXParameters);
+	MasterFXParameters getMasterFXParameters() { return masterFX.getParameters(); }
+
+	// --- impulse response for the master FX convolution slot; allocates and starts a worker thread,
+	//     so call it only while audio is not running, like reset()
+	bool setMasterFXImpulseResponse(const float* const* irChannels, uint32_t numIRChannels, uint32_t irLength);
+
+	// --- direct access to the shared voice parameters; changes here are seen by all voices
+	//     without a getParameters()/setParameters() round trip
+	std::shared_ptr<SynthVoiceParameters> getVoiceParameters() { return parameters.voiceParameters; }
 	
 	// --- helper function to get the array index of next available voice
 	//     returns -1 if NO more voices are avaialable - time to steal a voice
 	int getFreeVoiceIndex();
-	int getVoiceIndexToSteal();
 
-	// --- get a currently running voice with a specific number
-	int getActiveVoiceIndexInNoteOn(unsigned int midiNoteNumber);
-	int getStealingVoiceIndexInNoteOn(unsigned int midiNoteNumber);
+	// --- choose the voice to steal using parameters.stealPolicy; override to plug in a custom policy
+	virtual int getVoiceIndexToSteal();
+
+	// --- get a currently running voice with a specific number; O(1) lookups in the note-to-voice map
+	int getActiveVoiceIndexInNoteOn(unsigned int midiNoteNumber, unsigned int midiChannel = 0);
+	int getStealingVoiceIndexInNoteOn(unsigned int midiNoteNumber, unsigned int midiChannel = 0);
 
 	// --- helpers for populating oscillator waveform GUI controls
 	//     for synths, these are usually the only dynamic items like this
@@ -603,6 +834,12 @@ public:
 
 	std::vector<std::string> getBankNames(uint32_t voiceIndex, uint32_t oscillatorIndex);
 
+	// --- real-time instrumentation: wrap each buffer in beginBlock()/endBlock() and read the frames on another thread
+	SynthPerfMonitor& getPerfMonitor() { return perfMonitor; }
+
+	// --- deferred MIDI/voice allocation log; setLevel() from a non-audio thread to turn it on
+	TraceLogger& getTraceLog() { return traceLog; }
+
 protected:
 	// --- our outputs, same number as synth voice!
 	SynthRenderData synthOutputData;
@@ -610,6 +847,14 @@ protected:
 	// --- our modifiers (parameters)
 	SynthEngineParameters parameters;
 
+	// --- blocks from publishParameters(); the render side picks up the newest one with acquireParameters()
+	ParameterSnapshotExchange<SynthEngineParameters> parameterExchange;
+	void acquireParameters()
+	{
+		if (parameterExchange.acquire())
+			setParameters(parameterExchange.read());
+	}
+
 	// --- shared MIDI tables, via IMIDIData
 	std::shared_ptr<MidiInputData> midiInputData = std::make_shared<MidiInputData>();
 	std::shared_ptr<MidiOutputData> midiOutputData = std::make_shared<MidiOutputData>();
@@ -620,8 +865,55 @@ protected:
 	// --- shared tables, in case they are huge or need a long creation time
 	std::shared_ptr<WaveTableData> waveTableData = std::make_shared<WaveTableData>();
 
+	// --- voice allocation: every voice lives in exactly one of these two lists
+	VoiceAgeList activeVoices;		///< sounding voices, oldest note-on first
+	VoiceAgeList freeVoices;		///< idle voices, longest-idle first
+
+	// --- note-to-voice map per MIDI channel; -1 = note is not sounding
+	int noteVoiceMap[kNumMIDIChannels][kNumMIDINotes];
+	int voiceMappedNote[MAX_VOICES];	///< (channel * kNumMIDINotes + note) held by each voice, or -1
+
+	// --- voice allocation helpers
+	void clearVoiceAllocation();
+	void claimVoice(int voiceIndex);
+	void retireVoice(int voiceIndex);
+	void mapVoiceNote(int voiceIndex, uint32_t midiChannel, uint32_t midiNoteNumber);
+	void unmapVoiceNote(int voiceIndex);
+
+	// --- steal candidates: a voice whose note started on the current sample (several note-ons of a chord) is
+	//     not stolen again by the next note-on of that sample
+	uint64_t renderPassCount = 0;				///< renderVoiceMix() calls; note-ons between two calls share a value
+	uint64_t voiceStartPass[MAX_VOICES] = { 0 };	///< renderPassCount when each voice was last claimed
+	bool isStealCandidate(int voiceIndex);
+
+	// --- ghost voices for crossfade stealing: a stolen note is swapped in here and faded out
+	//     while its voice slot starts the new note on the same sample
+	std::unique_ptr<SynthVoice> ghostVoices[NUM_GHOST_VOICES] = { 0 };
+	XFader ghostFaders[NUM_GHOST_VOICES];
+	bool ghostFading[NUM_GHOST_VOICES] = { false };
+	double sampleRate = 0.0;
+	bool startGhostFade(int voiceIndex);
+
+	// --- engine sleeps (returns zeros without rendering) when no voice is sounding and the output has gone quiet
+	SilenceDetector engineSilenceDetector;
+	bool engineSleeping = false;
+	void updateSilenceDetection();
+
+	// --- the two halves of renderAudioOutput(): sum the voices into synthOutputData, then
+	//     apply the master volume and check for sleep; the master FX run in between
+	void renderVoiceMix();
+	void finishOutputSample();
+
+	// --- per-block timings, voice counts, steals and deadline misses
+	SynthPerfMonitor perfMonitor;
+
+	// --- note on/off, steal and controller events; formatted off the audio thread
+	TraceLogger traceLog;
+
 private:
 	// --- ADD FX Here...
+	MasterFXRack masterFX;
+	float masterFXBlock[2][MASTER_FX_BLOCK_SIZE] = { { 0.f } };	///< one chunk of voice mix for the rack, non-interleaved
 
 };
 
@@ -2,6 +2,8 @@
 #define __synthDefs_h__
 #include <stdint.h>
 #include <cmath>
+#include <ctime>
+#include <atomic>
 #include "pluginstructures.h"	// <-- this is for midi event struct defintion; we can use same struct as RAFX
 #include "fxobjects.h"			// <-- this is for helper functions
 
@@ -39,6 +41,7 @@ Definitions for synth components.
 
 
 const unsigned int MAX_VOICES = 3;			// --- in Debug mode, you may only get 2 or 3 for extreme-synths; in Release mode you will easily get 32, even up to 64 depending on algorithms
+const unsigned int NUM_GHOST_VOICES = 2;	// --- spare voices that fade out stolen notes during a crossfade steal; these do not add polyphony
 const unsigned int MAX_SYNTH_CHANNELS = 32;	// --- VST3 allows for 22.1, so 32 should cover us
 const unsigned int MAX_OSC_CHANNELS = 32;	// --- VST3 allows for 22.1, so 32 should cover us
 const unsigned int MAX_PROCESSOR_CHANNELS = 32;	// --- VST3 allows for 22.1, so 32 should cover us
@@ -166,6 +169,49 @@ inline double doPNSequence(uint32_t& uPNRegister)
 	return fOut;
 }
 
+// --- noise seed shared by all synth noise sources
+//     0 (default) = seed from the clock, so every run sounds different
+//     anything else = every noise source is seeded from this seed and its own stream (see makeSynthNoiseSeed()), so
+//     renders repeat bit-for-bit (offline/golden renders)
+inline uint32_t& synthNoiseSeed() { static uint32_t seed = 0; return seed; }
+inline void setSynthNoiseSeed(uint32_t seed) { synthNoiseSeed() = seed; }
+inline uint32_t getSynthNoiseSeed() { return synthNoiseSeed(); }
+
+// --- seed for one noise source: the synth noise seed mixed with the source's stream index, so sources created
+//     together never share a sequence; with no synth noise seed the clock is read once per process and a running
+//     instance count stands in for it, so two plugin instances differ as well
+inline uint32_t makeSynthNoiseSeed(uint32_t streamIndex)
+{
+	uint32_t seed = getSynthNoiseSeed();
+	if (seed == 0)
+	{
+		static const uint32_t clockSeed = (uint32_t)time(NULL);
+		static std::atomic<uint32_t> instanceCount(0);
+		seed = clockSeed + 0x632BE5ABu * instanceCount++;
+	}
+
+	// --- integer hash, so neighbouring streams land far apart
+	uint32_t x = seed + 0x9E3779B9u * (streamIndex + 1);
+	x ^= x >> 16;
+	x *= 0x85EBCA6Bu;
+	x ^= x >> 13;
+	x *= 0xC2B2AE35u;
+	x ^= x >> 16;
+	return x != 0 ? x : 1;
+}
+
+// --- white noise from a 32-bit xorshift register owned by the caller; unlike rand() or arc4random()
+//     each object keeps its own sequence and it can be seeded; register must be non-zero
+inline double doWhiteNoise(uint32_t& uNoiseRegister)
+{
+	uNoiseRegister ^= uNoiseRegister << 13;
+	uNoiseRegister ^= uNoiseRegister >> 17;
+	uNoiseRegister ^= uNoiseRegister << 5;
+
+	// --- [0, 2^32 - 1] -> [-1.0, +1.0]
+	return 2.0*((double)uNoiseRegister / 4294967295.0) - 1.0;
+}
+
 /**
 \struct SynthRenderData
 \ingroup SynthStructures
@@ -348,6 +394,10 @@ enum globalMIDI {
 // --- CC MIDI max
 const uint32_t kNumMIDICCs = 128;
 
+// --- note and channel counts for per-note lookup tables
+const uint32_t kNumMIDINotes = 128;
+const uint32_t kNumMIDIChannels = 16;
+
 /**
 \struct MidiInterfaceData
 \ingroup SynthStructures
@@ -988,6 +1038,46 @@ protected:
 	uint32_t xfadeTime_Counter = 0;
 };
 
+/**
+\struct SilenceDetector
+\ingroup SynthStructures
+\brief Reports silence once the peak input has stayed below a threshold for a hold time; any louder sample restarts the hold
+*/
+struct SilenceDetector
+{
+public:
+	SilenceDetector() {}
+
+	// --- threshold is in dB, hold time in mSec
+	void setParameters(double threshold_dB, double holdTime_mSec, double sampleRate)
+	{
+		threshold = pow(10.0, threshold_dB / 20.0);
+		holdTimer.setTargetValueInSamples((uint32_t)(holdTime_mSec*sampleRate / 1000.0));
+	}
+
+	void reset() { holdTimer.resetTimer(); }
+
+	// --- returns TRUE once the input has been quiet for the hold time
+	bool detectSilence(double peak)
+	{
+		if (fabs(peak) > threshold)
+		{
+			holdTimer.resetTimer();
+			return false;
+		}
+
+		if (holdTimer.timerExpired())
+			return true;
+
+		holdTimer.advanceTimer();
+		return false;
+	}
+
+protected:
+	double threshold = 0.00001584893; ///< -96dB
+	Timer holdTimer;
+};
+
 /**
 \struct XHoldFader
 \ingroup SynthStructures
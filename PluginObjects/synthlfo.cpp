@@ -121,8 +121,8 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 	}
 	else if (parameters->waveform == LFOWaveform::kNoise)
 	{
-		lfoOutputData.modulationOutputs[kLFONormalOutput] = doWhiteNoise();
-		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = doWhiteNoise();
+		lfoOutputData.modulationOutputs[kLFONormalOutput] = doWhiteNoise(noiseRegister);
+		lfoOutputData.modulationOutputs[kLFOQuadPhaseOutput] = doWhiteNoise(noiseRegister);
 	}
 	else if (parameters->waveform == LFOWaveform::kQRNoise)
 	{
@@ -135,7 +135,7 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 		if (randomSHCounter < 0)
 		{
 			if (parameters->waveform == LFOWaveform::kRSH)
-				randomSHValue = doWhiteNoise();
+				randomSHValue = doWhiteNoise(noiseRegister);
 			else
 				randomSHValue = doPNSequence(pnRegister);
 
@@ -149,7 +149,7 @@ const ModOutputData SynthLFO::renderModulatorOutput()
 			randomSHCounter -= sampleRate / parameters->frequency_Hz;
 
 			if (parameters->waveform == LFOWaveform::kRSH)
-				randomSHValue = doWhiteNoise();
+				randomSHValue = doWhiteNoise(noiseRegister);
 			else
 				randomSHValue = doPNSequence(pnRegister);
 		}
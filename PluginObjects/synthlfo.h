@@ -100,20 +100,39 @@ public:
 	SynthLFO(const std::shared_ptr<MidiInputData> _midiInputData, std::shared_ptr<SynthLFOParameters> _parameters)
 		: midiInputData(_midiInputData) 
 	, parameters(_parameters){
-		srand(time(NULL)); // --- seed random number generator
-
-		// --- randomize the PN register
-		pnRegister = rand();
+		// --- randomize (or, with a fixed synth noise seed, preset) the PN and noise registers
+		seedNoiseRegisters();
 
 	}	/* C-TOR */
 	virtual ~SynthLFO() {}				/* D-TOR */
 
+	/** set the noise stream, a value unique to this LFO within its synth (the owner's voice and LFO index), and reseed;
+	with a fixed synth noise seed the stream keeps renders repeatable while every LFO runs its own sequence */
+	void setNoiseStream(uint32_t stream)
+	{
+		noiseStream = stream;
+		seedNoiseRegisters();
+	}
+
+	/** exchange noise streams and register states with another LFO; used when the engine swaps voice objects
+	between slots, so each slot keeps running its own noise sequence */
+	void swapNoiseState(SynthLFO& other)
+	{
+		std::swap(noiseStream, other.noiseStream);
+		std::swap(pnRegister, other.pnRegister);
+		std::swap(noiseRegister, other.noiseRegister);
+	}
+
 	// --- ISynthOscillator
 	virtual bool reset(double _sampleRate)
 	{
 		sampleRate = _sampleRate;
 		phaseInc = parameters->frequency_Hz / sampleRate;
 
+		// --- with a fixed seed, every reset restarts the same noise sequences
+		if (getSynthNoiseSeed() != 0)
+			seedNoiseRegisters();
+
 		// --- Delay and Ramp Reset
 		delayTimer.resetTimer();
 		rampTimer.resetTimer();
@@ -199,9 +218,25 @@ protected:
 
 	// --- 32-bit register for RS&H
 	uint32_t pnRegister = 0;			///< 32 bit register for PN oscillator
+	uint32_t noiseRegister = 1;			///< 32 bit xorshift register for white noise and RS&H; never 0
 	int randomSHCounter = -1;			///< random sample/hold counter;  -1 is reset condition
 	double randomSHValue = 0.0;			///< current output, needed because we hold this output for some number of samples = (sampleRate / oscFrequency)
 
+	uint32_t noiseStream = 0;			///< per-instance noise stream; see setNoiseStream()
+
+	/**
+	\brief seed the PN and noise registers for this LFO's noise stream (see makeSynthNoiseSeed())
+	*/
+	void seedNoiseRegisters()
+	{
+		uint32_t seed = makeSynthNoiseSeed(noiseStream);
+
+		pnRegister = seed;
+		noiseRegister = seed * 2654435761u; // --- decorrelate from the PN register
+		if (noiseRegister == 0)
+			noiseRegister = 1;
+	}
+
 	/**
 	\struct checkAndWrapModulo
 	\brief Check a modulo counter and wrap it if necessary
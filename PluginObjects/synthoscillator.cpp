@@ -53,8 +53,9 @@ bool SynthOsc::reset(double _sampleRate)
 	wavetableOscillator->reset(_sampleRate);
 	wavetableOscillator->setModulators(modulators);
 
-	// --- for noise generation
-	srand(time(NULL));
+	// --- for noise generation; a fixed synth noise seed makes renders repeatable
+	uint32_t noiseSeed = getSynthNoiseSeed();
+	srand(noiseSeed != 0 ? noiseSeed : (unsigned int)time(NULL));
 
 	return true;
 }
@@ -0,0 +1,274 @@
+#ifndef __synthPerf_h__
+#define __synthPerf_h__
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+
+#include "synthdefs.h"
+#include "readerwriterqueue.h"	// <-- same lock-free queue the custom views use
+
+// --- cycle counter for the per-component timers
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define SYNTH_PERF_RDTSC 1
+#elif (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#include <x86intrin.h>
+#define SYNTH_PERF_RDTSC 1
+#endif
+
+const unsigned int PERF_QUEUE_LEN = 256;	///< blocks held in the queue to the GUI/offline reader; ~2.7 sec at 512 frames, 48kHz
+
+/**
+@readPerfTicks
+\ingroup SynthFunctions
+\brief cheapest available timestamp for the instrumentation: TSC on x86, the virtual counter on ARM64,
+otherwise the steady clock in nanoseconds. Only differences are meaningful; the unit is converted to time
+with the block wall-clock time (see SynthPerfFrame::getTicksPerSecond())
+
+\return timestamp in ticks
+*/
+inline uint64_t readPerfTicks()
+{
+#if defined(SYNTH_PERF_RDTSC)
+	return __rdtsc();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+	uint64_t ticks = 0;
+	__asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+	return ticks;
+#else
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// --- voice components that get their own timer; the order follows SynthVoice::renderAudioOutput()
+enum perfComponent { kPerfLFO, kPerfEG, kPerfModMatrix, kPerfOscillator, kPerfFilter, kPerfDCA, kNumPerfComponents };
+
+/**
+@getPerfComponentName
+\ingroup SynthFunctions
+\brief short column name for a perfComponent, used by the CSV/JSON dumps
+*/
+inline const char* getPerfComponentName(uint32_t component)
+{
+	static const char* names[kNumPerfComponents] = { "lfo", "eg", "matrix", "osc", "filter", "dca" };
+	return component < kNumPerfComponents ? names[component] : "";
+}
+
+// --- how much is timed; each level includes the ones before it
+//     kBlock:		engine time, voice counts, steals, deadline misses; two timestamps per block
+//     kVoice:		+ time per voice; one timestamp per voice per sample
+//     kComponent:	+ time per voice component (osc, filter, EG, LFO, DCA, matrix); seven timestamps per voice per sample
+enum class perfDetail { kOff, kBlock, kVoice, kComponent };
+
+/**
+\struct SynthPerfFrame
+\ingroup SynthStructures
+\brief
+The measurements for one processAudioBuffers() call, as published by SynthPerfMonitor.
+
+- ticks are readPerfTicks() units; component and voice ticks add up over all voices and samples in the block
+- blockTime_nSec is wall-clock time, so load = blockTime_nSec / (numFrames / sampleRate) needs no tick calibration
+- the counters ending in Total run from the last reset() so a reader that drops frames still sees every steal and miss
+*/
+struct SynthPerfFrame
+{
+	SynthPerfFrame() {}
+
+	uint64_t blockIndex = 0;							///< blocks since reset()
+	uint32_t numFrames = 0;								///< frames in the block
+	double sampleRate = 0.0;							///< sample rate for the block
+
+	uint64_t blockTicks = 0;							///< whole block, in ticks
+	uint64_t blockTime_nSec = 0;						///< whole block, wall clock
+	uint64_t voiceTicks[MAX_VOICES] = { 0 };			///< per voice slot (perfDetail::kVoice and up)
+	uint64_t componentTicks[kNumPerfComponents] = { 0 };///< per component, all voices (perfDetail::kComponent)
+
+	uint32_t activeVoices = 0;							///< sounding voices at the end of the block
+	uint32_t peakActiveVoices = 0;						///< most voices sounding at once during the block
+	uint32_t voiceSteals = 0;							///< note-ons in this block that had to steal a voice
+	bool deadlineMiss = false;							///< block took longer than its deadline
+
+	uint64_t voiceStealsTotal = 0;						///< steals since reset()
+	uint64_t deadlineMissesTotal = 0;					///< deadline misses since reset()
+	uint64_t droppedFramesTotal = 0;					///< frames the reader did not collect in time
+
+	// --- fraction of the real-time budget used; 1.0 = the block took as long as it lasts
+	double getLoad() const
+	{
+		double blockDuration_nSec = sampleRate > 0.0 ? 1.0e9 * numFrames / sampleRate : 0.0;
+		return blockDuration_nSec > 0.0 ? blockTime_nSec / blockDuration_nSec : 0.0;
+	}
+
+	// --- tick rate estimated from this block; converts voice/component ticks to time
+	double getTicksPerSecond() const { return blockTime_nSec > 0 ? 1.0e9 * blockTicks / blockTime_nSec : 0.0; }
+};
+
+/**
+\class SynthPerfMonitor
+\ingroup SynthClasses
+\brief
+Low-overhead real-time instrumentation for the synth engine. The audio thread fills one SynthPerfFrame per
+buffer and publishes it through a lock-free single-producer/single-consumer queue; the GUI timer or the
+offline renderer reads the frames on its own thread.
+
+Audio thread (never blocks or allocates):
+- beginBlock() / endBlock() around the buffer
+- addVoiceTicks(), addComponentTicks() from the render loops; use isTimingVoices() and isTimingComponents()
+  to skip the timestamps when that level is off
+- countVoiceSteal(), setActiveVoices() from the voice allocator
+
+Reader thread:
+- readFrame() until it returns false; if the reader falls behind, new frames are dropped and counted
+
+Control (any thread): setDetail(), setDeadlineLoad()
+*/
+class SynthPerfMonitor
+{
+public:
+	SynthPerfMonitor() {}
+
+	// --- sample rate for the deadline; clears the running totals
+	void reset(double _sampleRate)
+	{
+		sampleRate = _sampleRate;
+		frame = SynthPerfFrame();
+		blockIndex = 0;
+		voiceStealsTotal = 0;
+		deadlineMissesTotal = 0;
+		droppedFramesTotal = 0;
+		activeVoices = 0;
+		inBlock = false;
+	}
+
+	// --- what to time; see perfDetail
+	void setDetail(perfDetail _detail) { detail.store(_detail, std::memory_order_relaxed); }
+	perfDetail getDetail() const { return detail.load(std::memory_order_relaxed); }
+
+	// --- a block misses its deadline when it takes longer than this fraction of its own duration
+	void setDeadlineLoad(double load) { deadlineLoad.store(load, std::memory_order_relaxed); }
+
+	// --- AUDIO THREAD: start timing a buffer
+	void beginBlock(uint32_t numFrames)
+	{
+		blockDetail = detail.load(std::memory_order_relaxed);
+		inBlock = blockDetail != perfDetail::kOff;
+		if (!inBlock)
+			return;
+
+		memset(frame.voiceTicks, 0, sizeof(frame.voiceTicks));
+		memset(frame.componentTicks, 0, sizeof(frame.componentTicks));
+		frame.numFrames = numFrames;
+		frame.voiceSteals = 0;
+		frame.peakActiveVoices = activeVoices;
+
+		blockStartTime = std::chrono::steady_clock::now();
+		blockStartTicks = readPerfTicks();
+	}
+
+	// --- AUDIO THREAD: finish the buffer and publish its frame
+	void endBlock()
+	{
+		if (!inBlock)
+			return;
+		inBlock = false;
+
+		frame.blockTicks = readPerfTicks() - blockStartTicks;
+		frame.blockTime_nSec = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - blockStartTime).count();
+		frame.blockIndex = blockIndex++;
+		frame.sampleRate = sampleRate;
+		frame.activeVoices = activeVoices;
+
+		frame.deadlineMiss = frame.getLoad() > deadlineLoad.load(std::memory_order_relaxed);
+		if (frame.deadlineMiss)
+			deadlineMissesTotal++;
+
+		frame.voiceStealsTotal = voiceStealsTotal;
+		frame.deadlineMissesTotal = deadlineMissesTotal;
+		frame.droppedFramesTotal = droppedFramesTotal;
+
+		// --- never waits: a full queue means nobody is reading, so the frame is dropped
+		if (!perfQueue.try_enqueue(frame))
+			droppedFramesTotal++;
+	}
+
+	// --- AUDIO THREAD: which timers are running in this block
+	bool isTimingVoices() const { return inBlock && blockDetail >= perfDetail::kVoice; }
+	bool isTimingComponents() const { return inBlock && blockDetail >= perfDetail::kComponent; }
+
+	// --- AUDIO THREAD: accumulate timer results
+	void addVoiceTicks(uint32_t voiceIndex, uint64_t ticks) { if (voiceIndex < MAX_VOICES) frame.voiceTicks[voiceIndex] += ticks; }
+	void addComponentTicks(uint32_t component, uint64_t ticks) { frame.componentTicks[component] += ticks; }
+
+	// --- AUDIO THREAD: voice allocator events; counted even outside a timed block
+	void countVoiceSteal()
+	{
+		voiceStealsTotal++;
+		if (inBlock)
+			frame.voiceSteals++;
+	}
+
+	void setActiveVoices(uint32_t count)
+	{
+		activeVoices = count;
+		if (inBlock && count > frame.peakActiveVoices)
+			frame.peakActiveVoices = count;
+	}
+
+	// --- READER THREAD: oldest unread frame; returns false when the queue is empty
+	bool readFrame(SynthPerfFrame& perfFrame) { return perfQueue.try_dequeue(perfFrame); }
+
+protected:
+	// --- control
+	std::atomic<perfDetail> detail{ perfDetail::kBlock };
+	std::atomic<double> deadlineLoad{ 1.0 };
+
+	// --- audio thread state
+	SynthPerfFrame frame;
+	perfDetail blockDetail = perfDetail::kOff;
+	bool inBlock = false;
+	double sampleRate = 0.0;
+	uint64_t blockIndex = 0;
+	uint64_t blockStartTicks = 0;
+	std::chrono::steady_clock::time_point blockStartTime;
+	uint32_t activeVoices = 0;
+	uint64_t voiceStealsTotal = 0;
+	uint64_t deadlineMissesTotal = 0;
+	uint64_t droppedFramesTotal = 0;
+
+	// --- audio thread -> reader; sized once here, never allocates afterwards
+	moodycamel::ReaderWriterQueue<SynthPerfFrame, PERF_QUEUE_LEN> perfQueue{ PERF_QUEUE_LEN };
+};
+
+/**
+\struct PerfLapTimer
+\ingroup SynthStructures
+\brief
+Splits one stretch of code into consecutive component timings: each lap() charges the time since the
+previous lap to a component. Does nothing, not even read the clock, when the monitor is not timing components.
+*/
+struct PerfLapTimer
+{
+	PerfLapTimer(SynthPerfMonitor* _monitor)
+	{
+		monitor = _monitor && _monitor->isTimingComponents() ? _monitor : nullptr;
+		if (monitor)
+			lastTicks = readPerfTicks();
+	}
+
+	void lap(uint32_t component)
+	{
+		if (!monitor)
+			return;
+
+		uint64_t ticks = readPerfTicks();
+		monitor->addComponentTicks(component, ticks - lastTicks);
+		lastTicks = ticks;
+	}
+
+	SynthPerfMonitor* monitor = nullptr;
+	uint64_t lastTicks = 0;
+};
+
+#endif /* defined(__synthPerf_h__) */
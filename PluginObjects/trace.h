@@ -3,15 +3,24 @@
 #ifndef __TRACE_H__850CE873
 #define __TRACE_H__850CE873
 
+#if defined(_WIN32)
 #include <crtdbg.h>
+#endif
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <thread>
+
+#include "readerwriterqueue.h"	// <-- same lock-free queue the custom views use
 
-#ifdef _DEBUG
+#if defined(_DEBUG) && defined(_WIN32)
 #define TRACEMAXSTRING	1024
 
-char szBuffer[TRACEMAXSTRING];
+static char szBuffer[TRACEMAXSTRING];
 inline void TRACE(const char* format,...)
 {
 	va_list args;
@@ -31,8 +40,182 @@ inline void TRACE(const char* format,...)
 				TRACE
 #else
 // Remove for release mode
-#define TRACE  ((void)0)
-#define TRACEF ((void)0)
+#define TRACE(...)  ((void)0)
+#define TRACEF(...) ((void)0)
 #endif
 
-#endif // __TRACE_H__850CE873
\ No newline at end of file
+// -----------------------------------------------------------------------------
+// --- real-time safe deferred logging
+//
+//     TRACE above formats on the calling thread, which is the audio thread for most synth code.
+//     TraceLogger records fixed-size binary events instead and formats them on a background thread.
+
+const unsigned int TRACE_QUEUE_LEN = 1024;	///< events buffered between the audio thread and the writer thread
+const unsigned int TRACE_MAX_ARGS = 4;		///< integer arguments per event
+
+// --- runtime log levels; an event is recorded when its level is at or below the logger's level
+enum class traceLevel { kOff, kWarning, kInfo, kVerbose };
+
+/**
+\struct TraceEvent
+\ingroup SynthStructures
+\brief
+One logged event. The format must be a string literal: only its address is stored, and it doubles as the event id.
+*/
+struct TraceEvent
+{
+	const char* format = nullptr;			///< printf format, string literal; %d/%u/%x only
+	uint64_t time_nSec = 0;					///< steady clock time of the event
+	int32_t args[TRACE_MAX_ARGS] = { 0 };	///< integer arguments
+	traceLevel level = traceLevel::kOff;	///< level it was logged at
+};
+
+/**
+\class TraceLogger
+\ingroup SynthClasses
+\brief
+Real-time safe logger: the audio thread records TraceEvents into a lock-free single-producer/single-consumer
+queue and a writer thread formats and prints them, so enabling logging never adds formatting, locks or
+allocations to the audio thread.
+
+Operation:
+- record() is the only call for the audio thread; it costs one atomic load when the level is filtered out
+  and a fixed-size copy into the queue otherwise; a full queue drops the event and counts it
+- setLevel() (control thread) enables or disables logging at run time and starts or stops the writer thread
+- the writer wakes every few milliseconds, formats the waiting events and passes each line to the sink;
+  the default sink is the debugger output in Windows debug builds and stderr otherwise
+- one producer thread per logger
+*/
+class TraceLogger
+{
+public:
+	TraceLogger() {}
+	~TraceLogger() { stopWriter(); }
+
+	// --- where formatted lines go; set before enabling, it is called on the writer thread
+	void setSink(std::function<void(const char*)> _sink) { sink = _sink; }
+
+	// --- CONTROL THREAD: change the level; kOff stops the writer thread after it prints what is queued
+	void setLevel(traceLevel _level)
+	{
+		level.store(_level, std::memory_order_relaxed);
+		if (_level == traceLevel::kOff)
+			stopWriter();
+		else
+			startWriter();
+	}
+
+	traceLevel getLevel() const { return level.load(std::memory_order_relaxed); }
+	bool isEnabled(traceLevel eventLevel) const { return eventLevel != traceLevel::kOff && eventLevel <= level.load(std::memory_order_relaxed); }
+
+	// --- AUDIO THREAD: log an event with up to TRACE_MAX_ARGS integer arguments
+	template <typename... Args>
+	void record(traceLevel eventLevel, const char* format, Args... args)
+	{
+		static_assert(sizeof...(Args) <= TRACE_MAX_ARGS, "too many TraceLogger arguments");
+		if (!isEnabled(eventLevel))
+			return;
+
+		TraceEvent event;
+		event.format = format;
+		event.level = eventLevel;
+		event.time_nSec = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+		const int32_t values[] = { (int32_t)args..., 0 };
+		for (uint32_t i = 0; i < sizeof...(Args); i++)
+			event.args[i] = values[i];
+
+		if (!eventQueue.try_enqueue(event))
+			droppedEvents.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// --- WRITER/CONTROL THREAD: format and print everything queued so far; returns the number of events
+	//     used by the writer thread, or directly when no writer is running (single threaded tools)
+	uint32_t flush()
+	{
+		uint32_t count = 0;
+		TraceEvent event;
+		char line[TRACEMAXLINE];
+
+		while (eventQueue.try_dequeue(event))
+		{
+			if (startTime_nSec == 0)
+				startTime_nSec = event.time_nSec;
+
+			int length = snprintf(line, TRACEMAXLINE, "[%10.6f] ", (double)(event.time_nSec - startTime_nSec) * 1.0e-9);
+			snprintf(line + length, TRACEMAXLINE - length, event.format, event.args[0], event.args[1], event.args[2], event.args[3]);
+			writeLine(line);
+			count++;
+		}
+
+		uint64_t dropped = droppedEvents.load(std::memory_order_relaxed);
+		if (dropped != reportedDrops)
+		{
+			snprintf(line, TRACEMAXLINE, "-- trace: %llu events dropped (queue full)\n", (unsigned long long)(dropped - reportedDrops));
+			writeLine(line);
+			reportedDrops = dropped;
+		}
+
+		return count;
+	}
+
+	// --- events lost to a full queue since construction
+	uint64_t getDroppedEventCount() const { return droppedEvents.load(std::memory_order_relaxed); }
+
+protected:
+	static const unsigned int TRACEMAXLINE = 256;
+
+	// --- pass one line to the sink or the default output
+	void writeLine(const char* line)
+	{
+		if (sink)
+			sink(line);
+		else
+		{
+#if defined(_DEBUG) && defined(_WIN32)
+			_RPT0(_CRT_WARN, line);
+#else
+			fputs(line, stderr);
+#endif
+		}
+	}
+
+	void startWriter()
+	{
+		if (writerThread.joinable())
+			return;
+
+		writerRunning.store(true, std::memory_order_release);
+		writerThread = std::thread([this]()
+		{
+			while (writerRunning.load(std::memory_order_acquire))
+			{
+				flush();
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			}
+			flush();
+		});
+	}
+
+	void stopWriter()
+	{
+		if (!writerThread.joinable())
+			return;
+
+		writerRunning.store(false, std::memory_order_release);
+		writerThread.join();
+	}
+
+	std::atomic<traceLevel> level{ traceLevel::kOff };
+	std::atomic<uint64_t> droppedEvents{ 0 };
+	moodycamel::ReaderWriterQueue<TraceEvent, TRACE_QUEUE_LEN> eventQueue{ TRACE_QUEUE_LEN };
+
+	// --- writer side
+	std::function<void(const char*)> sink;
+	std::thread writerThread;
+	std::atomic<bool> writerRunning{ false };
+	uint64_t startTime_nSec = 0;
+	uint64_t reportedDrops = 0;
+};
+
+#endif // __TRACE_H__850CE873
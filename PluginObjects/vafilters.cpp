@@ -39,6 +39,9 @@ bool MoogFilter::update(bool updateAllModRoutings)
 	if (!updateAllModRoutings)
 		return true;
 
+	// --- NOTE: the NLP switch changes the ladder rate, so it is not applied here mid-note;
+	//           see applyNLPSwitch()
+
 	// --- update limiter; NOTE: this does not use much CPU at all; dB are subtracted
 	//     and no raw conversions are done - cheap
 	limiters[MONO_CHANNEL].setThreshold_dB(parameters->truToneThreshold_dB);
@@ -79,17 +82,12 @@ bool MoogFilter::update(bool updateAllModRoutings)
 	return true; // handled
 }
 
-// --- process function
-bool MoogFilter::processSynthAudio(SynthProcessorData* audioData)
+/**
+\brief One sample through the 4th order ladder; with the NLP on, the ladder input is soft-clipped
+\return the ladder output
+*/
+inline double MoogFilter::processLadder(double xn)
 {
-	// --- make sure we have input and outputs
-	if (audioData->numInputChannels == 0 || audioData->numOutputChannels == 0)
-		return false;
-
-	// --- this is a mono object, so it only has one input and one output channel
-	//     other channels will be ignored
-	double xn = audioData->inputs[MONO_CHANNEL];
-
 	// --- 4th order MOOG:
 	double sigma = 0.0;
 
@@ -99,19 +97,49 @@ bool MoogFilter::processSynthAudio(SynthProcessorData* audioData)
 		beta[2] * subFilter[2].getS0Port() +
 		beta[3] * subFilter[3].getS0Port();
 
-	// --- gain comp is a simple on/off switch LPF ONLY!!!!
-	if (parameters->enableGainComp)
-		xn *= 1.0 + 0.5*K; // --- increase 0.5 for MORE bass
-
 	// --- now figure out u(n) = alpha0*[x(n) - K*sigma]
 	double u = alpha0*(xn - K*sigma);
+	if (nlpOversampled)
+		u = softClipWaveShaper(u, 1.0);
 
 	// --- send u -> LPF1 and then cascade the outputs to form y(n)
 	//     NOTE: verbose version; you can nest these function calls
 	double y0 = subFilter[0].processAudioSample(u); //< --- NOT x(n), u(n)
 	double y1 = subFilter[1].processAudioSample(y0);
 	double y2 = subFilter[2].processAudioSample(y1);
-	double yn = subFilter[3].processAudioSample(y2);
+	return subFilter[3].processAudioSample(y2);
+}
+
+// --- process function
+bool MoogFilter::processSynthAudio(SynthProcessorData* audioData)
+{
+	// --- make sure we have input and outputs
+	if (audioData->numInputChannels == 0 || audioData->numOutputChannels == 0)
+		return false;
+
+	// --- this is a mono object, so it only has one input and one output channel
+	//     other channels will be ignored
+	double xn = audioData->inputs[MONO_CHANNEL];
+
+	// --- gain comp is a simple on/off switch LPF ONLY!!!!
+	if (parameters->enableGainComp)
+		xn *= 1.0 + 0.5*K; // --- increase 0.5 for MORE bass
+
+	double yn = 0.0;
+	if (!nlpOversampled)
+		yn = processLadder(xn);
+	else
+	{
+		// --- run the nonlinear ladder at the oversampled rate
+		float input = (float)xn;
+		float output = 0.f;
+		float oversampled[OVERSAMPLER_MAX_RATIO] = { 0.f };
+		oversampler.upsampleBlock(&input, oversampled, 1);
+		for (uint32_t i = 0; i < oversampler.getRatio(); i++)
+			oversampled[i] = (float)processLadder(oversampled[i]);
+		oversampler.downsampleBlock(oversampled, &output, 1);
+		yn = output;
+	}
 
 	// -- do the limiter for self oscillation; could also nest with above if you want
 	audioData->outputs[MONO_CHANNEL] = limiters[MONO_CHANNEL].processAudio(yn);
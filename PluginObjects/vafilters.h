@@ -4,6 +4,7 @@
 // --- includes
 #include "synthdefs.h"
 #include "limiter.h"
+#include "oversampler.h"
 
 const int NUM_SUBFILTERS = 4;
 const uint32_t SINGLE_CHANNEL = 1;
@@ -32,6 +33,9 @@ public:
 
 	// --- need alpha
 	double getAlpha() { return alpha; }
+
+	// --- the rate the coefficients were calculated for
+	double getSampleRate() { return sampleRate; }
 	double getLittle_g() 
 	{
 		double fc = zvaFilterParameters.fc;
@@ -107,6 +111,10 @@ struct MoogFilterParameters
 \ingroup SynthClasses
 \brief Encapsulates a Moog Ladder Filter.
 
+With enableNLP the ladder input is soft-clipped and the ladder runs at twice the sample rate through a halfband
+IIR Oversampler, so the saturation aliases less; the IIR halfbands add only a few samples of delay.
+Toggling enableNLP takes effect at the next reset() or applyNLPSwitch(), when the filter is at rest.
+
 \author Will Pirkle
 \version Revision : 1.0
 \date Date : 2019 / 11 / 04
@@ -126,6 +134,12 @@ public:
 		{
 			subFilter[i].setParameters(params);
 		}
+
+		// --- NLP oversampling: low latency matters more than linear phase inside a voice
+		OversamplerParameters oversamplerParams;
+		oversamplerParams.ratio = oversamplingRatio::k2x;
+		oversamplerParams.filter = oversamplingFilter::kHalfbandIIR;
+		oversampler.setParameters(oversamplerParams);
 	}		
 	~MoogFilter() {}	/* D-TOR */
 
@@ -138,10 +152,20 @@ public:
 	// --- set sample rate, then update coeffs
 	virtual bool reset(double _sampleRate)
 	{
+		sampleRate = _sampleRate;
+
+		// --- the ladder runs oversampled when the NLP is on; the coefficients follow the ladder rate
+		nlpOversampled = parameters->enableNLP;
+		oversampler.reset(_sampleRate);
+		double ladderRate = nlpOversampled ? _sampleRate * oversampler.getRatio() : _sampleRate;
+
 		// --- initialize four identical ZVAFilters as LPF1 types
 		for (int i = 0; i < NUM_SUBFILTERS; i++)
 		{
-			subFilter[i].reset(_sampleRate);
+			bool rateChanged = subFilter[i].getSampleRate() != ladderRate;
+			subFilter[i].reset(ladderRate);
+			if (rateChanged)
+				subFilter[i].calculateFilterCoeffs();
 		}
 
 		// ---for self oscillating pure sine
@@ -152,9 +176,20 @@ public:
 		return true;
 	}
 
+	// --- pick up a changed NLP switch (and with it the ladder rate); the owner calls this only while the
+	//     filter is at rest, e.g. on a note-on from idle, so the switch never clicks mid-note
+	void applyNLPSwitch()
+	{
+		if (sampleRate > 0.0 && parameters->enableNLP != nlpOversampled)
+			reset(sampleRate);
+	}
+
 	// --- the processor function
 	virtual bool processSynthAudio(SynthProcessorData* audioData);
 
+	// --- one sample through the ladder at the ladder rate
+	inline double processLadder(double xn);
+
 	// --- calculate MOOG coefficients
 	//     
 	void calculateFilterCoeffs()
@@ -189,7 +224,7 @@ public:
 
 protected:
 	// --- MIDI Data Interface
-	const const std::shared_ptr<MidiInputData> midiInputData = nullptr;
+	const std::shared_ptr<MidiInputData> midiInputData = nullptr;
 
 	// --- we share Parameters with other voice's same-components
 	std::shared_ptr<MoogFilterParameters> parameters = nullptr;
@@ -210,6 +245,11 @@ protected:
 
 	double keyTrackPitch = 440.0;
 	bool noteOn = false;
+
+	// --- NLP oversampling
+	double sampleRate = 0.0;
+	bool nlpOversampled = false;	///< the ladder runs at oversampler.getRatio() times sampleRate
+	Oversampler oversampler;
 };
 
 #endif /* defined(__vaFilters_h__) */
@@ -7,8 +7,8 @@
 // --- wavetable objects and structs
 #include "wavetablebank.h"
 
-#include "wavetables\AKWF_0.h"
-#include "wavetables\AKWF_1.h"
+#include "wavetables/AKWF_0.h"
+#include "wavetables/AKWF_1.h"
 
 // --- stores MAX_BANKS_PER_PLUGIN sets of IWaveBanks (128)
 //     NOTE: this is the ONE AND ONLY wavetable datasource for the entire synth